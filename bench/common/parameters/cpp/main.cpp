@@ -0,0 +1,77 @@
+// Copyright (C) 2015 The FEniCS Project
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2015-01-22
+// Last changed: 2015-01-22
+
+#include <dolfin.h>
+
+using namespace dolfin;
+
+#define NUM_REPS 10000000
+
+int main(int argc, char* argv[])
+{
+  info("Timing access to parameters (%d repetitions)", NUM_REPS);
+
+  Parameters p("p");
+  p.add("tolerance", 1e-9);
+  Parameters q("solver");
+  q.add("maximum_iterations", 25);
+  p.add(q);
+
+  // Access by key
+  double sum = 0.0;
+  Timer timer_key("Access by key");
+  for (int i = 0; i < NUM_REPS; i++)
+  {
+    const double value = p["tolerance"];
+    sum += value;
+  }
+  timer_key.stop();
+
+  // Access by key in nested parameter set
+  std::size_t n = 0;
+  Timer timer_nested_key("Access by key (nested)");
+  for (int i = 0; i < NUM_REPS; i++)
+  {
+    const int value = p("solver")["maximum_iterations"];
+    n += value;
+  }
+  timer_nested_key.stop();
+
+  // Access through handles
+  const ParameterHandle<double> tolerance(p, "tolerance");
+  Timer timer_handle("Access by handle");
+  for (int i = 0; i < NUM_REPS; i++)
+    sum += tolerance;
+  timer_handle.stop();
+
+  const ParameterHandle<int> maximum_iterations(p,
+                                                "solver.maximum_iterations");
+  Timer timer_nested_handle("Access by handle (nested)");
+  for (int i = 0; i < NUM_REPS; i++)
+    n += maximum_iterations;
+  timer_nested_handle.stop();
+
+  dolfin::cout << "sum = " << sum << ", n = " << n << dolfin::endl
+               << dolfin::endl;
+
+  list_timings();
+
+  return 0;
+}
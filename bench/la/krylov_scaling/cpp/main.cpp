@@ -0,0 +1,217 @@
+// Copyright (C) 2015 The FEniCS Project
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2015-01-22
+// Last changed: 2015-01-22
+//
+// This benchmark solves a 3D Poisson problem with classical and
+// pipelined PETSc Krylov methods and reports, per iteration, the
+// time spent in global reductions (MPI_Allreduce and non-blocking
+// MPI_Iallreduce) as a fraction of the solve time. Reductions are
+// timed through the MPI profiling interface. For non-blocking
+// reductions, the time to post the reduction and the time waiting
+// for its completion (MPI_Wait/MPI_Waitall) are counted, but not the
+// work overlapped in between. Run with a weak-scaling
+// series of process counts, e.g.
+//
+//     mpirun -n 64 ./bench_la_krylov_scaling_cpp --size 64
+
+#include <algorithm>
+#include <vector>
+#include <dolfin.h>
+#include "Poisson.h"
+
+using namespace dolfin;
+
+#define SIZE 32
+
+// Time and number of calls to MPI reductions (collected using the
+// MPI profiling interface)
+namespace
+{
+  double reduction_time = 0.0;
+  std::size_t num_reductions = 0;
+
+  // Non-blocking reductions which have not been waited for
+  std::vector<MPI_Request> reduction_requests;
+
+  // Remove request from pending reductions, and return true if it
+  // was a reduction
+  bool complete_reduction(MPI_Request request)
+  {
+    std::vector<MPI_Request>::iterator it
+      = std::find(reduction_requests.begin(), reduction_requests.end(),
+                  request);
+    if (it == reduction_requests.end())
+      return false;
+    reduction_requests.erase(it);
+    return true;
+  }
+}
+
+extern "C"
+int MPI_Allreduce(const void* sendbuf, void* recvbuf, int count,
+                  MPI_Datatype datatype, MPI_Op op, MPI_Comm comm)
+{
+  const double t0 = PMPI_Wtime();
+  const int ierr = PMPI_Allreduce(sendbuf, recvbuf, count, datatype, op,
+                                  comm);
+  reduction_time += PMPI_Wtime() - t0;
+  ++num_reductions;
+  return ierr;
+}
+
+#if MPI_VERSION >= 3
+extern "C"
+int MPI_Iallreduce(const void* sendbuf, void* recvbuf, int count,
+                   MPI_Datatype datatype, MPI_Op op, MPI_Comm comm,
+                   MPI_Request* request)
+{
+  const double t0 = PMPI_Wtime();
+  const int ierr = PMPI_Iallreduce(sendbuf, recvbuf, count, datatype, op,
+                                   comm, request);
+  reduction_time += PMPI_Wtime() - t0;
+  ++num_reductions;
+  reduction_requests.push_back(*request);
+  return ierr;
+}
+
+extern "C"
+int MPI_Wait(MPI_Request* request, MPI_Status* status)
+{
+  // The request is reset by MPI_Wait, so check it first
+  const bool reduction = complete_reduction(*request);
+  const double t0 = PMPI_Wtime();
+  const int ierr = PMPI_Wait(request, status);
+  if (reduction)
+    reduction_time += PMPI_Wtime() - t0;
+  return ierr;
+}
+
+extern "C"
+int MPI_Waitall(int count, MPI_Request requests[], MPI_Status statuses[])
+{
+  bool reduction = false;
+  for (int i = 0; i < count; ++i)
+    reduction = complete_reduction(requests[i]) || reduction;
+  const double t0 = PMPI_Wtime();
+  const int ierr = PMPI_Waitall(count, requests, statuses);
+  if (reduction)
+    reduction_time += PMPI_Wtime() - t0;
+  return ierr;
+}
+#endif
+
+class Source : public Expression
+{
+  void eval(Array<double>& values, const Array<double>& x) const
+  {
+    const double dx = x[0] - 0.5;
+    const double dy = x[1] - 0.5;
+    const double dz = x[2] - 0.5;
+    values[0] = 500.0*exp(-(dx*dx + dy*dy + dz*dz)/0.02);
+  }
+};
+
+int main(int argc, char* argv[])
+{
+  // Parse command-line arguments
+  parameters.add("size", SIZE);
+  parameters.parse(argc, argv);
+  const std::size_t n = (int) parameters["size"];
+  const std::size_t num_processes = dolfin::MPI::size(MPI_COMM_WORLD);
+
+  info("Global reductions in PETSc Krylov solvers (3D Poisson, %d x %d x %d, %d processes)",
+       n, n, n, num_processes);
+
+  // Make sure PETSc is used
+  parameters["linear_algebra_backend"] = "PETSc";
+
+  // Create mesh, function space and forms
+  UnitCubeMesh mesh(n, n, n);
+  Poisson::FunctionSpace V(mesh);
+  Poisson::BilinearForm a(V, V);
+  Poisson::LinearForm L(V);
+  Source f;
+  L.f = f;
+
+  // Assemble system
+  Constant zero(0.0);
+  DirichletBC bc(V, zero, DomainBoundary());
+  PETScMatrix A;
+  PETScVector b;
+  assemble_system(A, b, a, L, bc);
+
+  // Methods to benchmark (only those available in PETSc)
+  std::vector<std::string> methods;
+  const std::vector<std::pair<std::string, std::string> >
+    available = PETScKrylovSolver::methods();
+  const char* candidates[] = {"cg", "pipecg", "groppcg", "pipecr",
+                              "gmres", "pgmres"};
+  for (std::size_t i = 0; i < 6; ++i)
+  {
+    for (std::size_t j = 0; j < available.size(); ++j)
+    {
+      if (available[j].first == candidates[i])
+        methods.push_back(candidates[i]);
+    }
+  }
+
+  Table table("Krylov solver reductions");
+  for (std::size_t i = 0; i < methods.size(); ++i)
+  {
+    PETScKrylovSolver solver(methods[i], "jacobi");
+    solver.parameters["report"] = false;
+    solver.parameters["relative_tolerance"] = 1.0e-8;
+
+    PETScVector x;
+    A.init_vector(x, 1);
+
+    // Solve, measuring time in reductions
+    dolfin::MPI::barrier(MPI_COMM_WORLD);
+    reduction_time = 0.0;
+    num_reductions = 0;
+    reduction_requests.clear();
+    const double t0 = MPI_Wtime();
+    const std::size_t num_iterations = solver.solve(A, x, b);
+    const double t = MPI_Wtime() - t0;
+    const double t_reduction = reduction_time;
+    const std::size_t num_solver_reductions = num_reductions;
+
+    // Maximum over processes
+    const double t_max = dolfin::MPI::max(MPI_COMM_WORLD, t);
+    const double t_reduction_max = dolfin::MPI::max(MPI_COMM_WORLD, t_reduction);
+    const double fraction = dolfin::MPI::max(MPI_COMM_WORLD, t_reduction/t);
+
+    table(methods[i], "iterations") = num_iterations;
+    table(methods[i], "time") = t_max;
+    table(methods[i], "time/iteration") = t_max/num_iterations;
+    table(methods[i], "reductions/iteration")
+      = (double) num_solver_reductions/num_iterations;
+    table(methods[i], "reduction time/iteration")
+      = t_reduction_max/num_iterations;
+    table(methods[i], "reduction fraction") = fraction;
+
+    if (dolfin::MPI::rank(MPI_COMM_WORLD) == 0)
+      info("BENCH %s %g", methods[i].c_str(), t_max);
+  }
+
+  // Report
+  info(table, true);
+
+  return 0;
+}
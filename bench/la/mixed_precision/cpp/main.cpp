@@ -0,0 +1,160 @@
+// Copyright (C) 2015 The FEniCS Project
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2015-01-21
+// Last changed: 2015-01-21
+//
+// This benchmark compares a double precision Jacobi preconditioned
+// Krylov solve of the Poisson demo problem with mixed precision
+// iterative refinement (single precision inner solves), reporting
+// solve time, final residual and the memory used by the matrix
+// storage. Run with --num_threads n to use threaded kernels.
+
+#include <dolfin.h>
+#include "Poisson.h"
+
+using namespace dolfin;
+
+#define SIZE 512
+
+// Source term (right-hand side)
+class Source : public Expression
+{
+  void eval(Array<double>& values, const Array<double>& x) const
+  {
+    double dx = x[0] - 0.5;
+    double dy = x[1] - 0.5;
+    values[0] = 10*exp(-(dx*dx + dy*dy) / 0.02);
+  }
+};
+
+// Normal derivative (Neumann boundary condition)
+class dUdN : public Expression
+{
+  void eval(Array<double>& values, const Array<double>& x) const
+  {
+    values[0] = sin(5*x[0]);
+  }
+};
+
+// Sub domain for Dirichlet boundary condition
+class DirichletBoundary : public SubDomain
+{
+  bool inside(const Array<double>& x, bool on_boundary) const
+  {
+    return x[0] < DOLFIN_EPS or x[0] > 1.0 - DOLFIN_EPS;
+  }
+};
+
+// Relative residual |b - Ax|/|b|
+double residual(const GenericMatrix& A, const GenericVector& x,
+                const GenericVector& b)
+{
+  std::shared_ptr<GenericVector> r = b.copy();
+  A.mult(x, *r);
+  *r -= b;
+  return r->norm("l2")/b.norm("l2");
+}
+
+int main(int argc, char* argv[])
+{
+  info("Poisson demo problem (%d x %d) with double and mixed precision solvers",
+       SIZE, SIZE);
+
+  // Parse command-line arguments
+  parameters.parse(argc, argv);
+
+  // Use uBLAS backend
+  parameters["linear_algebra_backend"] = "uBLAS";
+
+  // Create mesh and function space
+  UnitSquareMesh mesh(SIZE, SIZE);
+  Poisson::FunctionSpace V(mesh);
+
+  // Define boundary condition
+  Constant u0(0.0);
+  DirichletBoundary boundary;
+  DirichletBC bc(V, u0, boundary);
+
+  // Define variational forms
+  Poisson::BilinearForm a(V, V);
+  Poisson::LinearForm L(V);
+  Source f;
+  dUdN g;
+  L.f = f;
+  L.g = g;
+
+  // Assemble system
+  std::shared_ptr<Matrix> A(new Matrix);
+  Vector b;
+  assemble_system(*A, b, a, L, bc);
+
+  const double tol = 1.0e-10;
+  Table table("Double vs mixed precision (Jacobi BiCGStab)");
+
+  // Memory of double precision matrix (compressed row storage)
+  const std::size_t N = A->size(0);
+  const std::size_t nnz = A->nnz();
+  const std::size_t double_memory
+    = nnz*(sizeof(double) + sizeof(std::size_t)) + (N + 1)*sizeof(std::size_t);
+
+  // Double precision solve
+  {
+    uBLASKrylovSolver solver("bicgstab", "jacobi");
+    solver.parameters["report"] = false;
+    solver.parameters["relative_tolerance"] = tol;
+
+    Vector x;
+    Timer timer("Double precision solve");
+    const std::size_t num_iterations = solver.solve(*A, x, b);
+    const double t = timer.stop();
+
+    table("double", "iterations") = num_iterations;
+    table("double", "time") = t;
+    table("double", "residual") = residual(*A, x, b);
+    table("double", "matrix memory (MB)") = double_memory/1048576.0;
+    info("BENCH double %g", t);
+  }
+
+  // Mixed precision solve (includes building single precision copy)
+  {
+    MixedPrecisionSolver solver(A, "bicgstab");
+    solver.parameters["report"] = false;
+    solver.parameters["relative_tolerance"] = tol;
+
+    Vector x;
+    Timer timer("Mixed precision solve");
+    const std::size_t num_iterations = solver.solve(x, b);
+    const double t = timer.stop();
+
+    std::stringstream iterations;
+    iterations << num_iterations << " (" << solver.inner_iterations() << ")";
+    table("mixed", "iterations") = iterations.str();
+    table("mixed", "time") = t;
+    table("mixed", "residual") = residual(*A, x, b);
+    table("mixed", "matrix memory (MB)")
+      = (double_memory + solver.memory_usage())/1048576.0;
+    table("mixed", "single precision copy (MB)")
+      = solver.memory_usage()/1048576.0;
+    info("BENCH mixed %g", t);
+  }
+
+  // Report results
+  info(table, true);
+
+  return 0;
+}
@@ -0,0 +1,133 @@
+// Copyright (C) 2015 The FEniCS Project
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2015-01-20
+// Last changed: 2015-01-20
+//
+// This benchmark solves the Poisson demo problem with the uBLAS
+// Krylov solver and reports the number of iterations and the solve
+// time for each of the available preconditioners. Run with
+// --num_threads n to use threaded preconditioners.
+
+#include <dolfin.h>
+#include "Poisson.h"
+
+using namespace dolfin;
+
+#define SIZE 256
+
+// Source term (right-hand side)
+class Source : public Expression
+{
+  void eval(Array<double>& values, const Array<double>& x) const
+  {
+    double dx = x[0] - 0.5;
+    double dy = x[1] - 0.5;
+    values[0] = 10*exp(-(dx*dx + dy*dy) / 0.02);
+  }
+};
+
+// Normal derivative (Neumann boundary condition)
+class dUdN : public Expression
+{
+  void eval(Array<double>& values, const Array<double>& x) const
+  {
+    values[0] = sin(5*x[0]);
+  }
+};
+
+// Sub domain for Dirichlet boundary condition
+class DirichletBoundary : public SubDomain
+{
+  bool inside(const Array<double>& x, bool on_boundary) const
+  {
+    return x[0] < DOLFIN_EPS or x[0] > 1.0 - DOLFIN_EPS;
+  }
+};
+
+int main(int argc, char* argv[])
+{
+  info("Poisson demo problem (%d x %d) with uBLAS Krylov solver and different preconditioners",
+       SIZE, SIZE);
+
+  // Parse command-line arguments
+  parameters.parse(argc, argv);
+
+  // Use uBLAS backend
+  parameters["linear_algebra_backend"] = "uBLAS";
+
+  // Create mesh and function space
+  UnitSquareMesh mesh(SIZE, SIZE);
+  Poisson::FunctionSpace V(mesh);
+
+  // Define boundary condition
+  Constant u0(0.0);
+  DirichletBoundary boundary;
+  DirichletBC bc(V, u0, boundary);
+
+  // Define variational forms
+  Poisson::BilinearForm a(V, V);
+  Poisson::LinearForm L(V);
+  Source f;
+  dUdN g;
+  L.f = f;
+  L.g = g;
+
+  // Assemble system
+  Matrix A;
+  Vector b;
+  assemble_system(A, b, a, L, bc);
+
+  // Preconditioners (name, ILU fill level)
+  std::vector<std::pair<std::string, int> > pcs;
+  pcs.push_back(std::make_pair("none", 0));
+  pcs.push_back(std::make_pair("jacobi", 0));
+  pcs.push_back(std::make_pair("chebyshev", 0));
+  pcs.push_back(std::make_pair("ilu", 0));
+  pcs.push_back(std::make_pair("ilu", 1));
+  pcs.push_back(std::make_pair("ilu", 2));
+
+  Table table("uBLAS Krylov solver (GMRES)");
+  for (std::size_t i = 0; i < pcs.size(); ++i)
+  {
+    std::stringstream name;
+    name << pcs[i].first;
+    if (pcs[i].first == "ilu")
+      name << "(" << pcs[i].second << ")";
+
+    uBLASKrylovSolver solver("gmres", pcs[i].first);
+    solver.parameters["report"] = false;
+    solver.parameters["error_on_nonconvergence"] = false;
+    solver.parameters("preconditioner")("ilu")["fill_level"] = pcs[i].second;
+    solver.parameters("preconditioner")("jacobi")["block_size"]
+      = (int) V.dofmap()->block_size;
+
+    Vector x;
+    Timer timer("uBLAS Krylov solve");
+    const std::size_t num_iterations = solver.solve(A, x, b);
+    const double t = timer.stop();
+
+    table(name.str(), "iterations") = num_iterations;
+    table(name.str(), "time") = t;
+    info("BENCH %s %g", name.str().c_str(), t);
+  }
+
+  // Report results
+  info(table, true);
+
+  return 0;
+}
@@ -0,0 +1,70 @@
+// Copyright (C) 2015 The FEniCS Project
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2015-01-22
+// Last changed: 2015-01-22
+//
+// This benchmark measures the time for creating a distributed unit
+// cube mesh, with each process generating its own block of the mesh
+// ("blocks") and with the mesh built on process 0 and distributed by
+// the mesh partitioner ("partitioner"). Run it in parallel, e.g.
+//
+//   mpirun -n 8 ./bench-mesh-distributedbox --ghost_mode shared_facet
+
+#include <dolfin.h>
+
+using namespace dolfin;
+
+#define NUM_REPS 3
+#define SIZE 64
+
+int main(int argc, char* argv[])
+{
+  parameters.parse(argc, argv);
+
+  const std::size_t num_processes = dolfin::MPI::size(MPI_COMM_WORLD);
+  info("Creating unit cube of size %d x %d x %d on %d processes (%d repetitions)",
+       SIZE, SIZE, SIZE, num_processes, NUM_REPS);
+
+  // Create small mesh first to exclude initialisation of MPI
+  UnitCubeMesh(MPI_COMM_SELF, 1, 1, 1);
+
+  const std::vector<std::string> methods = {"blocks", "partitioner"};
+  for (std::size_t i = 0; i < methods.size(); ++i)
+  {
+    parameters["structured_mesh_partitioning"] = methods[i];
+
+    double t = 0.0;
+    for (int j = 0; j < NUM_REPS; j++)
+    {
+      dolfin::MPI::barrier(MPI_COMM_WORLD);
+      tic();
+      UnitCubeMesh mesh(SIZE, SIZE, SIZE);
+      t += dolfin::MPI::max(MPI_COMM_WORLD, toc());
+      if (j == 0)
+      {
+        info("%s: %d cells and %d ghost cells on process 0", methods[i].c_str(),
+             mesh.topology().ghost_offset(3),
+             mesh.num_cells() - mesh.topology().ghost_offset(3));
+      }
+    }
+
+    info("BENCH %s %g", methods[i].c_str(), t/NUM_REPS);
+  }
+
+  return 0;
+}
@@ -0,0 +1,102 @@
+// Copyright (C) 2015 The FEniCS Project
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2015-01-22
+// Last changed: 2015-01-22
+//
+// This benchmark compares the graph partitioners (SCOTCH, ParMETIS)
+// with the space-filling curve partitioners (Hilbert, Morton) when
+// distributing a unit cube mesh. It reports the time spent computing
+// the cell partition, the edge cut (number of facets shared between
+// processes) and the load imbalance (max/average number of cells).
+// Run in parallel, e.g.
+//
+//     mpirun -n 16 ./bench_mesh_partitioning_cpp --size 64
+
+#include <dolfin.h>
+
+using namespace dolfin;
+
+#define SIZE 32
+
+int main(int argc, char* argv[])
+{
+  // Parse command-line arguments
+  parameters.add("size", SIZE);
+  parameters.parse(argc, argv);
+  const std::size_t n = (int) parameters["size"];
+  const std::size_t num_processes = dolfin::MPI::size(MPI_COMM_WORLD);
+
+  info("Partitioning unit cube of size %d x %d x %d on %d processes",
+       n, n, n, num_processes);
+  if (num_processes == 1)
+  {
+    info("This benchmark must be run in parallel.");
+    return 0;
+  }
+
+  // Partitioners to compare
+  std::vector<std::string> partitioners;
+  if (has_scotch())
+    partitioners.push_back("SCOTCH");
+  if (has_parmetis())
+    partitioners.push_back("ParMETIS");
+  partitioners.push_back("Hilbert");
+  partitioners.push_back("Morton");
+
+  // Distribute built-in meshes with the mesh partitioner (rather
+  // than generating a block on each process)
+  parameters["structured_mesh_partitioning"] = "partitioner";
+
+  Table table("Mesh partitioning");
+  for (std::size_t i = 0; i < partitioners.size(); ++i)
+  {
+    parameters["mesh_partitioner"] = partitioners[i];
+
+    // Create (and distribute) mesh
+    UnitCubeMesh mesh(n, n, n);
+    const double t = dolfin::MPI::max(MPI_COMM_WORLD,
+                              timing("Compute cell partition", true));
+
+    // Count facets on process boundaries (each is seen from both
+    // sides)
+    const std::size_t D = mesh.topology().dim();
+    std::size_t num_cut_facets = 0;
+    for (FacetIterator f(mesh); !f.end(); ++f)
+    {
+      if (f->num_entities(D) == 1 && f->num_global_entities(D) == 2)
+        ++num_cut_facets;
+    }
+    const std::size_t edge_cut = dolfin::MPI::sum(MPI_COMM_WORLD, num_cut_facets)/2;
+
+    // Load imbalance
+    const std::size_t num_cells = mesh.num_cells();
+    const double imbalance = (double) dolfin::MPI::max(MPI_COMM_WORLD, num_cells)
+      *num_processes/(double) dolfin::MPI::sum(MPI_COMM_WORLD, num_cells);
+
+    table(partitioners[i], "partition time") = t;
+    table(partitioners[i], "edge cut") = edge_cut;
+    table(partitioners[i], "imbalance") = imbalance;
+
+    info("BENCH %s %g", partitioners[i].c_str(), t);
+  }
+
+  // Report
+  info(table, true);
+
+  return 0;
+}
@@ -0,0 +1,169 @@
+// Copyright (C) 2015 The FEniCS Project
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2015-01-22
+// Last changed: 2015-01-22
+//
+// This benchmark measures the effect of reordering mesh entities
+// (MeshOrdering::reorder) on matrix assembly and Function::eval. It
+// reports time and last-level cache misses (read from the DOLFIN
+// performance counters, when available) for the original ordering
+// and after Hilbert curve and reverse Cuthill-McKee reordering. The mesh is
+// read from file, e.g.
+//
+//     ./bench_mesh_reordering_cpp --mesh mesh.xml.gz
+//
+// If no mesh file is given, a unit cube mesh with randomly permuted
+// cells and vertices is used to mimic the ordering produced by an
+// unstructured mesh generator.
+
+#include <cstdlib>
+#include <dolfin.h>
+#include <dolfin/log/LogManager.h>
+#include <dolfin/mesh/MeshOrdering.h>
+#include "Poisson.h"
+
+using namespace dolfin;
+
+#define SIZE 32
+#define NUM_REPS 5
+#define NUM_POINTS 100000
+
+namespace
+{
+  // Return last-level cache misses of the calling thread counted by
+  // the DOLFIN performance counters (-1 if not available)
+  double cache_misses()
+  {
+    PerformanceCounters::Counts counts;
+    if (!LogManager::logger.performance_counters().read(counts))
+      return -1.0;
+    return counts[PerformanceCounters::cache_misses];
+  }
+
+  // Randomly permute cells and vertices of mesh
+  void shuffle(Mesh& mesh)
+  {
+    const std::size_t D = mesh.topology().dim();
+    std::vector<std::vector<std::size_t> > entity_map(D + 1);
+    const std::size_t dims[2] = {0, D};
+    for (std::size_t i = 0; i < 2; ++i)
+    {
+      const std::size_t n = mesh.topology().ghost_offset(dims[i]);
+      std::vector<std::size_t>& map = entity_map[dims[i]];
+      map.resize(mesh.num_entities(dims[i]));
+      for (std::size_t j = 0; j < map.size(); ++j)
+        map[j] = j;
+      for (std::size_t j = n; j > 1; --j)
+        std::swap(map[j - 1], map[std::rand() % j]);
+    }
+    MeshOrdering::reorder(mesh, entity_map);
+  }
+}
+
+class Source : public Expression
+{
+  void eval(Array<double>& values, const Array<double>& x) const
+  { values[0] = x[0] + 2.0*x[1]*x[1] - x[2]; }
+};
+
+int main(int argc, char* argv[])
+{
+  // Parse command-line arguments
+  parameters.add("mesh", "");
+  parameters.add("size", SIZE);
+  parameters.parse(argc, argv);
+  const std::string filename = parameters["mesh"];
+  const std::size_t n = (int) parameters["size"];
+
+  // Read or create mesh
+  Mesh mesh0;
+  if (filename.empty())
+  {
+    info("Reordering of randomly permuted unit cube mesh (%d x %d x %d)",
+         (int) n, (int) n, (int) n);
+    mesh0 = UnitCubeMesh(n, n, n);
+    shuffle(mesh0);
+  }
+  else
+  {
+    info("Reordering of mesh from file %s", filename.c_str());
+    mesh0 = Mesh(filename);
+  }
+
+  // Evaluation points: cell midpoints in random order
+  std::vector<Point> points;
+  for (CellIterator c(mesh0); !c.end() && points.size() < NUM_POINTS; ++c)
+    points.push_back(c->midpoint());
+  for (std::size_t j = points.size(); j > 1; --j)
+    std::swap(points[j - 1], points[std::rand() % j]);
+
+  const std::string orderings[3] = {"original", "hilbert", "rcm"};
+  Table table("Mesh reordering");
+  set_performance_counters_active();
+  for (std::size_t i = 0; i < 3; ++i)
+  {
+    // Reorder copy of mesh
+    Mesh mesh(mesh0);
+    if (orderings[i] != "original")
+      MeshOrdering::reorder(mesh, orderings[i]);
+
+    Poisson::FunctionSpace V(mesh);
+    Poisson::BilinearForm a(V, V);
+    Matrix A;
+    assemble(A, a);
+
+    // Assemble matrix
+    Timer t0(orderings[i] + " assembly");
+    double misses_assembly = cache_misses();
+    for (std::size_t r = 0; r < NUM_REPS; ++r)
+      assemble(A, a);
+    if (misses_assembly >= 0.0)
+      misses_assembly = cache_misses() - misses_assembly;
+    const double t_assembly = t0.stop()/NUM_REPS;
+
+    // Evaluate function at points
+    Function u(V);
+    Source f;
+    u.interpolate(f);
+    mesh.bounding_box_tree();
+    Array<double> values(1);
+    Timer t1(orderings[i] + " eval");
+    double misses_eval = cache_misses();
+    for (std::size_t j = 0; j < points.size(); ++j)
+    {
+      const Array<double> x(mesh.geometry().dim(),
+                            const_cast<double*>(points[j].coordinates()));
+      u.eval(values, x);
+    }
+    if (misses_eval >= 0.0)
+      misses_eval = cache_misses() - misses_eval;
+    const double t_eval = t1.stop();
+
+    table(orderings[i], "assembly time") = t_assembly;
+    table(orderings[i], "assembly cache misses") = misses_assembly/NUM_REPS;
+    table(orderings[i], "eval time") = t_eval;
+    table(orderings[i], "eval cache misses") = misses_eval;
+
+    info("BENCH %s %g", orderings[i].c_str(), t_assembly);
+  }
+
+  // Report
+  info(table, true);
+
+  return 0;
+}
@@ -0,0 +1,79 @@
+// Copyright (C) 2015 The FEniCS Project
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+//
+// First added:  2015-01-22
+// Last changed: 2015-01-22
+//
+// This benchmark measures the time for uniform and marker-based
+// (Plaza) refinement of a unit cube mesh as a function of the number
+// of threads.
+
+#include <dolfin.h>
+
+using namespace dolfin;
+
+#define SIZE 32
+#define MAX_THREADS 4
+
+int main(int argc, char* argv[])
+{
+  parameters.add("size", SIZE);
+  parameters.add("max_threads", MAX_THREADS);
+  parameters.parse(argc, argv);
+  const int n = parameters["size"];
+  const int max_threads = parameters["max_threads"];
+
+  info("Threaded refinement of unit cube of size %d x %d x %d", n, n, n);
+
+  UnitCubeMesh mesh(n, n, n);
+
+  // Mark cells in half of the domain for marker-based refinement
+  CellFunction<bool> markers(mesh, false);
+  for (CellIterator c(mesh); !c.end(); ++c)
+    markers[*c] = c->midpoint().x() < 0.5;
+
+  parameters["refinement_algorithm"] = "plaza";
+  Table table("Threaded refinement");
+  for (int num_threads = 0; num_threads <= max_threads;
+       num_threads = (num_threads == 0 ? 1 : 2*num_threads))
+  {
+    parameters["num_threads"] = num_threads;
+    const std::string threads = std::to_string(num_threads);
+
+    tic();
+    Mesh uniform = refine(mesh);
+    const double t_uniform = toc();
+
+    tic();
+    Mesh marked = refine(mesh, markers);
+    const double t_marked = toc();
+
+    table(threads, "uniform") = t_uniform;
+    table(threads, "plaza") = t_marked;
+    table(threads, "uniform cells") = uniform.size_global(3);
+    table(threads, "plaza cells") = marked.size_global(3);
+
+    info("BENCH uniform-%d %g", num_threads, t_uniform);
+    info("BENCH plaza-%d %g", num_threads, t_marked);
+  }
+  parameters["num_threads"] = 0;
+
+  info(table, true);
+
+  return 0;
+}
@@ -16,7 +16,12 @@
 // along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 //
 // First added:  2006-11-01
-// Last changed: 2010-05-03
+// Last changed: 2015-01-22
+//
+// This benchmark measures the time for creating a unit cube mesh
+// (which hands flat vertex and cell arrays to MeshEditor) and, for
+// comparison, the time for building the same mesh one entity at a
+// time with MeshEditor::add_vertex/add_cell.
 
 #include <dolfin.h>
 
@@ -25,6 +30,59 @@ using namespace dolfin;
 #define NUM_REPS 10
 #define SIZE 128
 
+// Build unit cube mesh one entity at a time
+void build_per_entity(Mesh& mesh, std::size_t n)
+{
+  MeshEditor editor;
+  editor.open(mesh, CellType::tetrahedron, 3, 3);
+
+  editor.init_vertices((n + 1)*(n + 1)*(n + 1));
+  std::vector<double> x(3);
+  std::size_t vertex = 0;
+  for (std::size_t iz = 0; iz <= n; iz++)
+  {
+    x[2] = static_cast<double>(iz)/static_cast<double>(n);
+    for (std::size_t iy = 0; iy <= n; iy++)
+    {
+      x[1] = static_cast<double>(iy)/static_cast<double>(n);
+      for (std::size_t ix = 0; ix <= n; ix++)
+      {
+        x[0] = static_cast<double>(ix)/static_cast<double>(n);
+        editor.add_vertex(vertex++, x);
+      }
+    }
+  }
+
+  editor.init_cells(6*n*n*n);
+  std::size_t cell = 0;
+  std::vector<std::size_t> v(4);
+  for (std::size_t iz = 0; iz < n; iz++)
+  {
+    for (std::size_t iy = 0; iy < n; iy++)
+    {
+      for (std::size_t ix = 0; ix < n; ix++)
+      {
+        const std::size_t v0 = iz*(n + 1)*(n + 1) + iy*(n + 1) + ix;
+        const std::size_t v1 = v0 + 1;
+        const std::size_t v2 = v0 + (n + 1);
+        const std::size_t v3 = v1 + (n + 1);
+        const std::size_t v4 = v0 + (n + 1)*(n + 1);
+        const std::size_t v5 = v1 + (n + 1)*(n + 1);
+        const std::size_t v6 = v2 + (n + 1)*(n + 1);
+        const std::size_t v7 = v3 + (n + 1)*(n + 1);
+        v[0] = v0; v[1] = v1; v[2] = v3; v[3] = v7; editor.add_cell(cell++, v);
+        v[0] = v0; v[1] = v1; v[2] = v7; v[3] = v5; editor.add_cell(cell++, v);
+        v[0] = v0; v[1] = v5; v[2] = v7; v[3] = v4; editor.add_cell(cell++, v);
+        v[0] = v0; v[1] = v3; v[2] = v2; v[3] = v7; editor.add_cell(cell++, v);
+        v[0] = v0; v[1] = v6; v[2] = v4; v[3] = v7; editor.add_cell(cell++, v);
+        v[0] = v0; v[1] = v2; v[2] = v6; v[3] = v7; editor.add_cell(cell++, v);
+      }
+    }
+  }
+
+  editor.close();
+}
+
 int main(int argc, char* argv[])
 {
   info("Creating unit cube of size %d x %d x %d (%d repetitions)",
@@ -32,11 +90,28 @@ int main(int argc, char* argv[])
 
   parameters.parse(argc, argv);
 
+  // Create small mesh first to exclude initialisation of MPI
+  UnitCubeMesh(1, 1, 1);
+
+  double t_bulk = 0.0;
+  double t_entity = 0.0;
   for (int i = 0; i < NUM_REPS; i++)
   {
+    // Create mesh using bulk construction
+    tic();
     UnitCubeMesh mesh(SIZE, SIZE, SIZE);
+    t_bulk += toc();
     dolfin::cout << "Created unit cube: " << mesh << dolfin::endl;
+
+    // Create same mesh one entity at a time
+    tic();
+    Mesh mesh_per_entity;
+    build_per_entity(mesh_per_entity, SIZE);
+    t_entity += toc();
   }
 
+  info("BENCH %g", t_bulk);
+  info("BENCH add_vertex/add_cell %g", t_entity);
+
   return 0;
 }
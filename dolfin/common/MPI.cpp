@@ -22,6 +22,7 @@
 // Modified by Joachim B Haga 2012
 // Modified by Martin Sandve Alnes 2014
 
+#include <algorithm>
 #include <numeric>
 #include <dolfin/log/dolfin_log.h>
 #include "SubSystemsManager.h"
@@ -47,6 +48,115 @@ MPI_Info& dolfin::MPIInfo::operator*()
 //-----------------------------------------------------------------------------
 #endif
 //-----------------------------------------------------------------------------
+dolfin::MPINeighborComm::MPINeighborComm(const MPI_Comm comm,
+                                         const std::vector<int>& destinations,
+                                         bool symmetric)
+{
+  init(comm, symmetric ? &destinations : NULL, destinations);
+}
+//-----------------------------------------------------------------------------
+dolfin::MPINeighborComm::MPINeighborComm(const MPI_Comm comm,
+                                         const std::vector<int>& sources,
+                                         const std::vector<int>& destinations)
+{
+  init(comm, &sources, destinations);
+}
+//-----------------------------------------------------------------------------
+dolfin::MPINeighborComm::~MPINeighborComm()
+{
+#ifdef HAS_MPI
+  MPI_Comm_free(&_comm);
+#endif
+}
+//-----------------------------------------------------------------------------
+std::size_t dolfin::MPINeighborComm::destination_index(int process) const
+{
+  auto it = std::lower_bound(_destination_index.begin(),
+                             _destination_index.end(),
+                             std::make_pair(process, (std::size_t) 0));
+  if (it == _destination_index.end() || it->first != process)
+  {
+    dolfin_error("MPI.cpp",
+                 "find destination in neighbourhood",
+                 "Process %d is not a destination", process);
+  }
+  return it->second;
+}
+//-----------------------------------------------------------------------------
+void dolfin::MPINeighborComm::init(const MPI_Comm comm,
+                                   const std::vector<int>* sources,
+                                   const std::vector<int>& destinations)
+{
+#if defined(HAS_MPI) && MPI_VERSION >= 3
+  SubSystemsManager::init_mpi();
+  if (sources)
+  {
+    // Neighbours are kept in the given order
+    _sources = *sources;
+    _destinations = destinations;
+    MPI_Dist_graph_create_adjacent(comm, _sources.size(), _sources.data(),
+                                   MPI_UNWEIGHTED, _destinations.size(),
+                                   _destinations.data(), MPI_UNWEIGHTED,
+                                   MPI_INFO_NULL, 0, &_comm);
+  }
+  else
+  {
+    // Give edges from this process only (the array of destinations
+    // may not be null, also when empty), and get the order of
+    // neighbours from MPI
+    const int rank = MPI::rank(comm);
+    const int degree = destinations.size();
+    const int no_destination = 0;
+    MPI_Dist_graph_create(comm, 1, &rank, &degree,
+                          degree > 0 ? destinations.data() : &no_destination,
+                          MPI_UNWEIGHTED, MPI_INFO_NULL, 0, &_comm);
+    int indegree, outdegree, weighted;
+    MPI_Dist_graph_neighbors_count(_comm, &indegree, &outdegree, &weighted);
+    _sources.resize(indegree);
+    _destinations.resize(outdegree);
+    MPI_Dist_graph_neighbors(_comm, indegree, _sources.data(), MPI_UNWEIGHTED,
+                             outdegree, _destinations.data(), MPI_UNWEIGHTED);
+  }
+#elif defined(HAS_MPI)
+  // No distributed graph communicators before MPI-3, so keep a copy
+  // of the communicator (exchanges use MPI::all_to_all)
+  SubSystemsManager::init_mpi();
+  MPI_Comm_dup(comm, &_comm);
+  _destinations = destinations;
+  if (sources)
+    _sources = *sources;
+  else
+  {
+    // Sources are the processes which have this process as a
+    // destination
+    std::vector<std::vector<int> > send_data(MPI::size(comm));
+    std::vector<std::vector<int> > recv_data;
+    for (std::size_t i = 0; i < destinations.size(); ++i)
+      send_data[destinations[i]].push_back(1);
+    MPI::all_to_all(comm, send_data, recv_data);
+    _sources.clear();
+    for (std::size_t p = 0; p < recv_data.size(); ++p)
+    {
+      if (!recv_data[p].empty())
+        _sources.push_back(p);
+    }
+  }
+#else
+  _comm = comm;
+  if (!destinations.empty() || (sources && !sources->empty()))
+  {
+    dolfin_error("MPI.cpp",
+                 "create neighbourhood",
+                 "DOLFIN has been configured without MPI support");
+  }
+#endif
+
+  _destination_index.resize(_destinations.size());
+  for (std::size_t i = 0; i < _destinations.size(); ++i)
+    _destination_index[i] = std::make_pair(_destinations[i], i);
+  std::sort(_destination_index.begin(), _destination_index.end());
+}
+//-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
 unsigned int dolfin::MPI::rank(const MPI_Comm comm)
 {
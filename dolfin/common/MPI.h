@@ -62,6 +62,71 @@ namespace dolfin
   };
   #endif
 
+  /// This class wraps a distributed graph communicator which
+  /// connects each process to a (small) set of neighbouring
+  /// processes, as used by the neighbourhood collectives
+  /// MPI::neighbor_all_to_all. Each process gives the processes it
+  /// sends to (destinations) and receives from (sources). Creating
+  /// the communicator is collective, but neither it nor the
+  /// exchanges cost memory or communication proportional to the
+  /// number of processes. With MPI versions before 3 (which lack
+  /// neighbourhood collectives) the exchanges fall back to
+  /// MPI::all_to_all over the whole communicator.
+
+  class MPINeighborComm
+  {
+  public:
+
+    /// Create neighbourhood with given destinations. If symmetric,
+    /// the sources are the destinations (the neighbours of each
+    /// process must then include the process in their neighbours).
+    /// Otherwise the sources are computed.
+    MPINeighborComm(const MPI_Comm comm,
+                    const std::vector<int>& destinations,
+                    bool symmetric=true);
+
+    /// Create neighbourhood with given sources and destinations
+    MPINeighborComm(const MPI_Comm comm, const std::vector<int>& sources,
+                    const std::vector<int>& destinations);
+
+    /// Destructor
+    ~MPINeighborComm();
+
+    /// Return distributed graph communicator
+    MPI_Comm comm() const
+    { return _comm; }
+
+    /// Return processes to receive from (in the order used for
+    /// received data)
+    const std::vector<int>& sources() const
+    { return _sources; }
+
+    /// Return processes to send to (in the order used for sent data)
+    const std::vector<int>& destinations() const
+    { return _destinations; }
+
+    /// Return position of process in destinations
+    std::size_t destination_index(int process) const;
+
+  private:
+
+    // Create communicator (sources computed if not given)
+    void init(const MPI_Comm comm, const std::vector<int>* sources,
+              const std::vector<int>& destinations);
+
+    // Not copyable
+    MPINeighborComm(const MPINeighborComm&);
+    MPINeighborComm& operator=(const MPINeighborComm&);
+
+    MPI_Comm _comm;
+    std::vector<int> _sources;
+    std::vector<int> _destinations;
+
+    // Destinations sorted by process, with position
+    std::vector<std::pair<int, std::size_t> > _destination_index;
+
+  };
+
   /// This class provides utility functions for easy communication
   /// with MPI and handles cases when DOLFIN is not configured with
   /// MPI.
@@ -95,6 +160,24 @@ namespace dolfin
                              std::vector<std::vector<T> >& in_values,
                              std::vector<std::vector<T> >& out_values);
 
+    /// Send send_values[send_offsets[i]:send_offsets[i + 1]] to the
+    /// ith destination of the neighbourhood and receive the values
+    /// from the ith source in recv_values[recv_offsets[i]:recv_offsets[i
+    /// + 1]] (wrapper for MPI_Neighbor_alltoallv)
+    template<typename T>
+      static void neighbor_all_to_all(const MPINeighborComm& comm,
+                                      const std::vector<T>& send_values,
+                                      const std::vector<int>& send_offsets,
+                                      std::vector<T>& recv_values,
+                                      std::vector<int>& recv_offsets);
+
+    /// Send in_values[i] to the ith destination of the neighbourhood
+    /// and receive the values from the ith source in out_values[i]
+    template<typename T>
+      static void neighbor_all_to_all(const MPINeighborComm& comm,
+                                const std::vector<std::vector<T> >& in_values,
+                                std::vector<std::vector<T> >& out_values);
+
     /// Broadcast vector of value from broadcaster to all processes
     template<typename T>
       static void broadcast(const MPI_Comm comm, std::vector<T>& value,
@@ -229,6 +312,7 @@ namespace dolfin
 
   #ifdef HAS_MPI
   // Specialisations for MPI_Datatypes
+  template<> inline MPI_Datatype MPI::mpi_type<char>() { return MPI_CHAR; }
   template<> inline MPI_Datatype MPI::mpi_type<float>() { return MPI_FLOAT; }
   template<> inline MPI_Datatype MPI::mpi_type<double>() { return MPI_DOUBLE; }
   template<> inline MPI_Datatype MPI::mpi_type<short int>()
@@ -324,6 +408,110 @@ namespace dolfin
     #endif
   }
   //---------------------------------------------------------------------------
+  template<typename T>
+    void dolfin::MPI::neighbor_all_to_all(const MPINeighborComm& comm,
+                                          const std::vector<T>& send_values,
+                                          const std::vector<int>& send_offsets,
+                                          std::vector<T>& recv_values,
+                                          std::vector<int>& recv_offsets)
+  {
+    const std::size_t num_sources = comm.sources().size();
+    const std::size_t num_destinations = comm.destinations().size();
+    dolfin_assert(send_offsets.size() == num_destinations + 1);
+
+    #if defined(HAS_MPI) && MPI_VERSION >= 3
+    // Data size per destination
+    std::vector<int> data_size_send(num_destinations);
+    for (std::size_t i = 0; i < num_destinations; ++i)
+      data_size_send[i] = send_offsets[i + 1] - send_offsets[i];
+
+    // Get received data sizes
+    std::vector<int> data_size_recv(num_sources);
+    MPI_Neighbor_alltoall(data_size_send.data(), 1, mpi_type<int>(),
+                          data_size_recv.data(), 1, mpi_type<int>(),
+                          comm.comm());
+
+    // Build receive offset
+    recv_offsets.resize(num_sources + 1);
+    recv_offsets[0] = 0;
+    std::partial_sum(data_size_recv.begin(), data_size_recv.end(),
+                     recv_offsets.begin() + 1);
+
+    // Send/receive data
+    recv_values.resize(recv_offsets[num_sources]);
+    MPI_Neighbor_alltoallv(send_values.data(),
+                           data_size_send.data(), send_offsets.data(),
+                           mpi_type<T>(),
+                           recv_values.data(), data_size_recv.data(),
+                           recv_offsets.data(), mpi_type<T>(), comm.comm());
+    #elif defined(HAS_MPI)
+    // Exchange with all processes, sending nothing to processes
+    // outside the neighbourhood
+    std::vector<std::vector<T> > send_data(MPI::size(comm.comm()));
+    std::vector<std::vector<T> > recv_data;
+    for (std::size_t i = 0; i < num_destinations; ++i)
+    {
+      send_data[comm.destinations()[i]].assign(
+        send_values.begin() + send_offsets[i],
+        send_values.begin() + send_offsets[i + 1]);
+    }
+    MPI::all_to_all(comm.comm(), send_data, recv_data);
+
+    // Pack received data in the order of the sources
+    recv_offsets.resize(num_sources + 1);
+    recv_offsets[0] = 0;
+    for (std::size_t i = 0; i < num_sources; ++i)
+    {
+      recv_offsets[i + 1] = recv_offsets[i]
+        + recv_data[comm.sources()[i]].size();
+    }
+    recv_values.clear();
+    recv_values.reserve(recv_offsets[num_sources]);
+    for (std::size_t i = 0; i < num_sources; ++i)
+    {
+      const std::vector<T>& data = recv_data[comm.sources()[i]];
+      recv_values.insert(recv_values.end(), data.begin(), data.end());
+    }
+    #else
+    dolfin_assert(num_sources == 0 && num_destinations == 0);
+    recv_values.clear();
+    recv_offsets.assign(1, 0);
+    #endif
+  }
+  //---------------------------------------------------------------------------
+  template<typename T>
+    void dolfin::MPI::neighbor_all_to_all(const MPINeighborComm& comm,
+                                const std::vector<std::vector<T> >& in_values,
+                                std::vector<std::vector<T> >& out_values)
+  {
+    // Pack data
+    const std::size_t num_destinations = comm.destinations().size();
+    dolfin_assert(in_values.size() == num_destinations);
+    std::vector<int> send_offsets(num_destinations + 1, 0);
+    for (std::size_t i = 0; i < num_destinations; ++i)
+      send_offsets[i + 1] = send_offsets[i] + in_values[i].size();
+    std::vector<T> send_values;
+    send_values.reserve(send_offsets.back());
+    for (std::size_t i = 0; i < num_destinations; ++i)
+      send_values.insert(send_values.end(), in_values[i].begin(),
+                         in_values[i].end());
+
+    // Send/receive data
+    std::vector<T> recv_values;
+    std::vector<int> recv_offsets;
+    neighbor_all_to_all(comm, send_values, send_offsets, recv_values,
+                        recv_offsets);
+
+    // Repack data
+    const std::size_t num_sources = comm.sources().size();
+    out_values.resize(num_sources);
+    for (std::size_t i = 0; i < num_sources; ++i)
+    {
+      out_values[i].assign(recv_values.begin() + recv_offsets[i],
+                           recv_values.begin() + recv_offsets[i + 1]);
+    }
+  }
+  //---------------------------------------------------------------------------
   template<> inline
     void dolfin::MPI::all_to_all(const MPI_Comm comm,
                                  std::vector<std::vector<bool> >& in_values,
@@ -0,0 +1,86 @@
+// Copyright (C) 2015 The FEniCS Project
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2015-01-22
+// Last changed: 2015-01-22
+
+#include <mutex>
+#include <set>
+#include "MemoryTracked.h"
+
+using namespace dolfin;
+
+namespace
+{
+  // Live objects. Do NOT make this a global static object; the
+  // function here ensures that it is created before (and destroyed
+  // after) the first registered object.
+  struct Registry
+  {
+    std::set<const MemoryTracked*> objects;
+    std::mutex mutex;
+  };
+
+  Registry& registry()
+  {
+    static Registry the_registry;
+    return the_registry;
+  }
+}
+
+//-----------------------------------------------------------------------------
+MemoryTracked::MemoryTracked(std::string subsystem)
+  : _memory_subsystem(subsystem)
+{
+  Registry& objects = registry();
+  std::lock_guard<std::mutex> lock(objects.mutex);
+  objects.objects.insert(this);
+}
+//-----------------------------------------------------------------------------
+MemoryTracked::MemoryTracked(const MemoryTracked& object)
+  : _memory_subsystem(object._memory_subsystem)
+{
+  Registry& objects = registry();
+  std::lock_guard<std::mutex> lock(objects.mutex);
+  objects.objects.insert(this);
+}
+//-----------------------------------------------------------------------------
+MemoryTracked::~MemoryTracked()
+{
+  Registry& objects = registry();
+  std::lock_guard<std::mutex> lock(objects.mutex);
+  objects.objects.erase(this);
+}
+//-----------------------------------------------------------------------------
+std::map<std::string, std::pair<std::size_t, std::size_t> >
+MemoryTracked::memory_usage_by_subsystem()
+{
+  std::map<std::string, std::pair<std::size_t, std::size_t> > usage;
+  Registry& objects = registry();
+  std::lock_guard<std::mutex> lock(objects.mutex);
+  for (std::set<const MemoryTracked*>::const_iterator it
+         = objects.objects.begin(); it != objects.objects.end(); ++it)
+  {
+    std::pair<std::size_t, std::size_t>& subsystem
+      = usage[(*it)->memory_subsystem()];
+    subsystem.first += 1;
+    subsystem.second += (*it)->memory_usage();
+  }
+
+  return usage;
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,96 @@
+// Copyright (C) 2015 The FEniCS Project
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2015-01-22
+// Last changed: 2015-01-22
+
+#ifndef __MEMORY_TRACKED_H
+#define __MEMORY_TRACKED_H
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace dolfin
+{
+
+  /// Common base class for objects whose memory usage is accounted
+  /// per subsystem (e.g. "Mesh topology" or "Dof maps"). Objects
+  /// register themselves on construction (also when copied) and the
+  /// memory usage of all live objects of each subsystem is reported
+  /// by memory_summary().
+
+  class MemoryTracked
+  {
+  public:
+
+    /// Return (approximate) number of bytes used by the object,
+    /// including the storage it owns
+    virtual std::size_t memory_usage() const = 0;
+
+    /// Return subsystem of object
+    const std::string& memory_subsystem() const
+    { return _memory_subsystem; }
+
+    /// Return number of live objects and their total memory usage in
+    /// bytes for each subsystem on this process
+    static std::map<std::string, std::pair<std::size_t, std::size_t> >
+      memory_usage_by_subsystem();
+
+    /// Return number of bytes used by the elements of a vector
+    template <typename T>
+    static std::size_t vector_memory_usage(const std::vector<T>& x)
+    { return x.capacity()*sizeof(T); }
+
+    /// Return number of bytes used by a vector of vectors
+    template <typename T>
+    static std::size_t
+      vector_memory_usage(const std::vector<std::vector<T> >& x)
+    {
+      std::size_t bytes = x.capacity()*sizeof(std::vector<T>);
+      for (std::size_t i = 0; i < x.size(); i++)
+        bytes += x[i].capacity()*sizeof(T);
+      return bytes;
+    }
+
+  protected:
+
+    /// Create object of given subsystem
+    explicit MemoryTracked(std::string subsystem);
+
+    /// Copy constructor (registers the copy)
+    MemoryTracked(const MemoryTracked& object);
+
+    /// Assignment (registration is kept)
+    MemoryTracked& operator= (const MemoryTracked& object)
+    { return *this; }
+
+    /// Destructor
+    virtual ~MemoryTracked();
+
+  private:
+
+    // Subsystem of object
+    std::string _memory_subsystem;
+
+  };
+
+}
+
+#endif
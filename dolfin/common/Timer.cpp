@@ -16,20 +16,46 @@
 // along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 //
 // First added:  2013-09-08
-// Last changed:
+// Last changed: 2015-01-22
+
+#include <chrono>
+#include <sstream>
 
 #include <dolfin/parameter/GlobalParameters.h>
+#include <dolfin/parameter/ParameterHandle.h>
 #include <dolfin/log/LogManager.h>
 #include "timing.h"
 #include "Timer.h"
 
 using namespace dolfin;
 
+namespace
+{
+  // Monotonic wall time in seconds
+  inline double monotonic_time()
+  {
+    return std::chrono::duration<double>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+}
+
+//-----------------------------------------------------------------------------
+Timer::Timer(std::string task) : _task(0), _handle(0), t(0.0), stopped(true),
+                                 _counting(false)
+{
+  // Handle to prefix parameter (one per thread, since handles are not
+  // thread-safe)
+  thread_local const ParameterHandle<std::string>
+    prefix(parameters, "timer_prefix");
+  const std::string& p = prefix.value();
+  _task = task_id(p.empty() ? task : p + task);
+  start();
+}
 //-----------------------------------------------------------------------------
-Timer::Timer(std::string task) : _task(""), t(time()), stopped(false)
+Timer::Timer(std::size_t task) : _task(task), _handle(0), t(0.0),
+                                 stopped(true), _counting(false)
 {
-  const std::string prefix = parameters["timer_prefix"];
-  _task = prefix + task;
+  start();
 }
 //-----------------------------------------------------------------------------
 Timer::~Timer()
@@ -40,15 +66,41 @@ Timer::~Timer()
 //-----------------------------------------------------------------------------
 void Timer::start()
 {
-  t = time();
+  // Enter task in the call tree (a running timer is just restarted)
+  if (stopped)
+    _handle = LogManager::logger.timing_registry().start(_task);
+  _counting = LogManager::logger.performance_counters().read(_counts);
+  t = monotonic_time();
   stopped = false;
 }
 //-----------------------------------------------------------------------------
 double Timer::stop()
 {
-  t = time() - t;
-  LogManager::logger.register_timing(_task, t);
+  const double start_time = t;
+  t = monotonic_time() - start_time;
+
+  // Add performance counts
+  if (_counting)
+  {
+    PerformanceCounters& counters = LogManager::logger.performance_counters();
+    PerformanceCounters::Counts counts;
+    if (counters.read(counts))
+      counters.add(_task, _counts, counts);
+  }
+
+  TimingRegistry& registry = LogManager::logger.timing_registry();
+  registry.stop(_handle, t);
+  LogManager::logger.trace_recorder().record(_task, start_time, t);
   stopped = true;
+
+  // Print a message (only formatted if it will be printed)
+  if (LogManager::logger.get_log_level() <= TRACE)
+  {
+    std::stringstream line;
+    line << "Elapsed time: " << t << " (" << registry.task_name(_task) << ")";
+    LogManager::logger.log(line.str(), TRACE);
+  }
+
   return t;
 }
 //-----------------------------------------------------------------------------
@@ -57,3 +109,8 @@ double Timer::value() const
   return t;
 }
 //-----------------------------------------------------------------------------
+std::size_t Timer::task_id(std::string task)
+{
+  return LogManager::logger.timing_registry().task_id(task);
+}
+//-----------------------------------------------------------------------------
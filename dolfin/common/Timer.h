@@ -16,12 +16,14 @@
 // along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 //
 // First added:  2008-06-13
-// Last changed: 2010-11-16
+// Last changed: 2015-01-22
 
 #ifndef __TIMER_H
 #define __TIMER_H
 
+#include <cstddef>
 #include <string>
+#include <dolfin/log/PerformanceCounters.h>
 
 namespace dolfin
 {
@@ -41,14 +43,42 @@ namespace dolfin
   /// by calling
   ///
   ///   list_timings();
+  ///
+  /// Timers which are started while another timer is running (on
+  /// the same thread) are nested, and list_timings prints the tree
+  /// of tasks with inclusive and exclusive times. Timers may be used
+  /// in threads. For timers in hot loops, the task name may be
+  /// registered once and the timer created from the task id, which
+  /// avoids string handling:
+  ///
+  ///   static const std::size_t task = Timer::task_id("Solve vertex");
+  ///   Timer timer(task);
+  ///
+  /// The start and duration of each timing may also be recorded in
+  /// a timeline, which is written to file by
+  ///
+  ///   start_trace();
+  ///   ...
+  ///   write_trace("trace.json");
+  ///
+  /// When hardware performance counters are switched on by
+  ///
+  ///   set_performance_counters_active();
+  ///
+  /// timers also count cycles, instructions and cache misses, which
+  /// are reported by timings().
 
   class Timer
   {
   public:
 
-    /// Create timer
+    /// Create timer (the task name is prefixed by the global
+    /// parameter "timer_prefix")
     Timer(std::string task);
 
+    /// Create timer for task with given id (see task_id)
+    explicit Timer(std::size_t task);
+
     /// Destructor
     ~Timer();
 
@@ -61,10 +91,17 @@ namespace dolfin
     /// Return value of timer (or time at start if not stopped)
     double value() const;
 
+    /// Return id of task with given name (without prefix), for use
+    /// in Timer(std::size_t)
+    static std::size_t task_id(std::string task);
+
   private:
 
-    // Name of task
-    std::string _task;
+    // Id of task
+    std::size_t _task;
+
+    // Handle of the running task in the timing registry
+    std::size_t _handle;
 
     // Start time
     double t;
@@ -72,6 +109,10 @@ namespace dolfin
     // True if timer has been stopped
     bool stopped;
 
+    // Performance counts at start, if counted
+    PerformanceCounters::Counts _counts;
+    bool _counting;
+
   };
 
 }
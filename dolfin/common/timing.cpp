@@ -16,7 +16,7 @@
 // along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 //
 // First added:  2003-12-21
-// Last changed: 2012-11-01
+// Last changed: 2015-01-22
 
 // Uncomment this for testing std::clock
 //#define _WIN32
@@ -111,3 +111,23 @@ double dolfin::timing(std::string task, bool reset)
   return LogManager::logger.timing(task, reset);
 }
 //-----------------------------------------------------------------------------
+void dolfin::start_trace(std::size_t capacity)
+{
+  LogManager::logger.start_trace(capacity);
+}
+//-----------------------------------------------------------------------------
+void dolfin::stop_trace()
+{
+  LogManager::logger.stop_trace();
+}
+//-----------------------------------------------------------------------------
+void dolfin::write_trace(std::string filename)
+{
+  LogManager::logger.write_trace(filename);
+}
+//-----------------------------------------------------------------------------
+void dolfin::set_performance_counters_active(bool active)
+{
+  LogManager::logger.performance_counters().set_active(active);
+}
+//-----------------------------------------------------------------------------
@@ -16,11 +16,12 @@
 // along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 //
 // First added:  2005-12-21
-// Last changed: 2012-11-01
+// Last changed: 2015-01-22
 
 #ifndef __TIMING_H
 #define __TIMING_H
 
+#include <cstddef>
 #include <string>
 #include <dolfin/log/Table.h>
 
@@ -53,6 +54,25 @@ namespace dolfin
   /// for task
   double timing(std::string task, bool reset=false);
 
+  /// Start recording a timeline of timed tasks (see Timer) and
+  /// progress updates (see Progress) on each process, keeping at
+  /// most the given number of most recent events per thread
+  /// (collective)
+  void start_trace(std::size_t capacity=1000000);
+
+  /// Stop recording the timeline
+  void stop_trace();
+
+  /// Write the recorded timeline of all processes to a file in the
+  /// Chrome trace event format, which may be viewed in
+  /// chrome://tracing or other trace viewers (collective)
+  void write_trace(std::string filename);
+
+  /// Switch counting of hardware performance counters (cycles,
+  /// instructions and last level cache misses) in timers on or off
+  /// (only available on Linux). The counts are reported by timings().
+  void set_performance_counters_active(bool active=true);
+
 }
 
 #endif
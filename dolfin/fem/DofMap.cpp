@@ -24,7 +24,7 @@
 // Modified by Jan Blechta, 2013
 //
 // First added:  2007-03-01
-// Last changed: 2014-09-08
+// Last changed: 2015-01-22
 
 #include <unordered_map>
 
@@ -43,8 +43,8 @@ using namespace dolfin;
 //-----------------------------------------------------------------------------
 DofMap::DofMap(std::shared_ptr<const ufc::dofmap> ufc_dofmap,
                const Mesh& mesh)
-  : _ufc_dofmap(ufc_dofmap), _is_view(false), _global_dimension(0),
-    _ufc_offset(0), _global_offset(0)
+  : MemoryTracked("Dof maps"), _ufc_dofmap(ufc_dofmap), _is_view(false),
+    _global_dimension(0), _ufc_offset(0), _global_offset(0)
 {
   dolfin_assert(_ufc_dofmap);
 
@@ -55,8 +55,8 @@ DofMap::DofMap(std::shared_ptr<const ufc::dofmap> ufc_dofmap,
 DofMap::DofMap(std::shared_ptr<const ufc::dofmap> ufc_dofmap,
                const Mesh& mesh,
                std::shared_ptr<const SubDomain> constrained_domain)
-  : _ufc_dofmap(ufc_dofmap), _is_view(false), _global_dimension(0),
-    _ufc_offset(0), _global_offset(0)
+  : MemoryTracked("Dof maps"), _ufc_dofmap(ufc_dofmap), _is_view(false),
+    _global_dimension(0), _ufc_offset(0), _global_offset(0)
 {
   dolfin_assert(_ufc_dofmap);
 
@@ -69,7 +69,8 @@ DofMap::DofMap(std::shared_ptr<const ufc::dofmap> ufc_dofmap,
 //-----------------------------------------------------------------------------
 DofMap::DofMap(const DofMap& parent_dofmap,
   const std::vector<std::size_t>& component, const Mesh& mesh)
-  : _is_view(true), _global_dimension(0), _ufc_offset(0),
+  : MemoryTracked("Dof maps"), _is_view(true), _global_dimension(0),
+    _ufc_offset(0),
     _global_offset(parent_dofmap._global_offset),
     _local_ownership_size(parent_dofmap._local_ownership_size)
 {
@@ -79,7 +80,8 @@ DofMap::DofMap(const DofMap& parent_dofmap,
 //-----------------------------------------------------------------------------
 DofMap::DofMap(std::unordered_map<std::size_t, std::size_t>& collapsed_map,
                const DofMap& dofmap_view, const Mesh& mesh)
-  :  _ufc_dofmap(dofmap_view._ufc_dofmap), _is_view(false),
+  :  MemoryTracked("Dof maps"), _ufc_dofmap(dofmap_view._ufc_dofmap),
+     _is_view(false),
      _global_dimension(0), _ufc_offset(0), _global_offset(0),
      _local_ownership_size(0)
 {
@@ -125,7 +127,7 @@ DofMap::DofMap(std::unordered_map<std::size_t, std::size_t>& collapsed_map,
   }
 }
 //-----------------------------------------------------------------------------
-DofMap::DofMap(const DofMap& dofmap)
+DofMap::DofMap(const DofMap& dofmap) : MemoryTracked(dofmap)
 {
   // Copy data
   _dofmap = dofmap._dofmap;
@@ -447,6 +449,29 @@ void DofMap::check_provided_entities(const ufc::dofmap& dofmap,
   }
 }
 //-----------------------------------------------------------------------------
+std::size_t DofMap::memory_usage() const
+{
+  std::size_t bytes = sizeof(*this)
+    + vector_memory_usage(_dofmap)
+    + vector_memory_usage(_num_mesh_entities_global)
+    + vector_memory_usage(_ufc_local_to_local)
+    + vector_memory_usage(_local_to_global_unowned)
+    + vector_memory_usage(_off_process_owner);
+
+  // Shared nodes (hash table buckets and nodes) and neighbours
+  // (tree nodes)
+  bytes += _shared_nodes.bucket_count()*sizeof(void*);
+  std::unordered_map<int, std::vector<int> >::const_iterator node;
+  for (node = _shared_nodes.begin(); node != _shared_nodes.end(); ++node)
+  {
+    bytes += 2*sizeof(void*) + sizeof(*node)
+      + vector_memory_usage(node->second);
+  }
+  bytes += _neighbours.size()*(4*sizeof(void*) + sizeof(int));
+
+  return bytes;
+}
+//-----------------------------------------------------------------------------
 std::string DofMap::str(bool verbose) const
 {
   std::stringstream s;
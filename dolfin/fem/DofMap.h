@@ -23,7 +23,7 @@
 // Modified by Jan Blechta, 2013
 //
 // First added:  2007-03-01
-// Last changed: 2014-07-04
+// Last changed: 2015-01-22
 
 #ifndef __DOLFIN_DOF_MAP_H
 #define __DOLFIN_DOF_MAP_H
@@ -38,6 +38,7 @@
 #include <unordered_map>
 #include <ufc.h>
 
+#include <dolfin/common/MemoryTracked.h>
 #include <dolfin/common/types.h>
 #include <dolfin/mesh/Cell.h>
 #include "GenericDofMap.h"
@@ -52,7 +53,7 @@ namespace dolfin
   /// reorder the dofs when running in parallel. Sub-dofmaps, both
   /// views and copies, are supported.
 
-  class DofMap : public GenericDofMap
+  class DofMap : public GenericDofMap, public MemoryTracked
   {
   public:
 
@@ -413,6 +414,13 @@ namespace dolfin
     const std::vector<std::vector<dolfin::la_index> >& data() const
     { return _dofmap; }
 
+    /// Return number of bytes used by the dof map
+    ///
+    /// *Returns*
+    ///     std::size_t
+    ///         The number of bytes.
+    std::size_t memory_usage() const;
+
     /// Return informal string representation (pretty-print)
     ///
     /// *Arguments*
@@ -397,9 +397,11 @@ std::size_t DofMapBuilder::build_constrained_vertex_indices(
   // MPI process number
   const std::size_t proc_num = MPI::rank(mesh.mpi_comm());
 
-  // Communication data structures
+  // Communication data structures (for each neighbouring process)
+  const MPINeighborComm neighbors(mpi_comm,
+    DistributedMeshTools::compute_neighbor_processes(mesh));
   std::vector<std::vector<std::size_t>>
-    new_shared_vertex_indices(MPI::size(mesh.mpi_comm()));
+    new_shared_vertex_indices(neighbors.destinations().size());
 
   // Compute modified global vertex indices
   std::size_t new_index = 0;
@@ -439,13 +441,13 @@ std::size_t DofMapBuilder::build_constrained_vertex_indices(
         std::vector<std::pair<unsigned int, unsigned int>>::const_iterator p;
         for (p = sharing_procs.begin(); p != sharing_procs.end(); ++p)
         {
-          dolfin_assert(p->first < new_shared_vertex_indices.size());
+          const std::size_t n = neighbors.destination_index(p->first);
 
           // Local index on remote process
-          new_shared_vertex_indices[p->first].push_back(p->second);
+          new_shared_vertex_indices[n].push_back(p->second);
 
           // Modified global index
-          new_shared_vertex_indices[p->first].push_back(new_index);
+          new_shared_vertex_indices[n].push_back(new_index);
         }
 
         new_index++;
@@ -469,8 +471,8 @@ std::size_t DofMapBuilder::build_constrained_vertex_indices(
 
   // Send/receive new indices for shared vertices
   std::vector<std::vector<std::size_t>> received_vertex_data;
-  MPI::all_to_all(mesh.mpi_comm(), new_shared_vertex_indices,
-                  received_vertex_data);
+  MPI::neighbor_all_to_all(neighbors, new_shared_vertex_indices,
+                           received_vertex_data);
 
   // Set index for shared vertices that have been numbered by another
   // process
@@ -1585,11 +1587,21 @@ void DofMapBuilder::compute_node_reordering(
   old_to_new_local.clear();
   old_to_new_local.resize(node_ownership.size(), -1);
 
+  // Neighbouring processes (sharing nodes)
+  std::set<int> sharing_processes;
+  for (auto it = node_to_sharing_processes.begin();
+       it != node_to_sharing_processes.end(); ++it)
+  {
+    sharing_processes.insert(it->second.begin(), it->second.end());
+  }
+  const MPINeighborComm neighbors(mpi_comm,
+    std::vector<int>(sharing_processes.begin(), sharing_processes.end()));
+
   // Renumber owned nodes, and buffer nodes that are owned but shared
   // with another process
-  const std::size_t mpi_size = MPI::size(mpi_comm);
-  std::vector<std::vector<std::size_t> > send_buffer(mpi_size);
-  std::vector<std::vector<std::size_t> > recv_buffer(mpi_size);
+  std::vector<std::vector<std::size_t> >
+    send_buffer(neighbors.destinations().size());
+  std::vector<std::vector<std::size_t> > recv_buffer;
   std::size_t counter = 0;
   for (std::size_t old_node_index_local = 0;
        old_node_index_local < node_ownership.size();
@@ -1614,8 +1626,9 @@ void DofMapBuilder::compute_node_reordering(
         for (auto p = it->second.begin(); p != it->second.end(); ++p)
         {
           // Buffer old and new global indices to send
-          send_buffer[*p].push_back(old_local_to_global[old_node_index_local]);
-          send_buffer[*p].push_back(process_offset + node_remap[counter]);
+          const std::size_t n = neighbors.destination_index(*p);
+          send_buffer[n].push_back(old_local_to_global[old_node_index_local]);
+          send_buffer[n].push_back(process_offset + node_remap[counter]);
         }
       }
 
@@ -1623,15 +1636,17 @@ void DofMapBuilder::compute_node_reordering(
     ++counter;
   }
 
-  MPI::all_to_all(mpi_comm, send_buffer, recv_buffer);
+  MPI::neighbor_all_to_all(neighbors, send_buffer, recv_buffer);
 
   local_to_global_unowned.resize(unowned_local_size);
   off_process_owner.resize(unowned_local_size);
   std::size_t off_process_node_counter = 0;
 
-  for (std::size_t src = 0; src != mpi_size; ++src)
-    for (auto q = recv_buffer[src].begin();
-         q != recv_buffer[src].end(); q += 2)
+  for (std::size_t n = 0; n != recv_buffer.size(); ++n)
+  {
+    const int src = neighbors.sources()[n];
+    for (auto q = recv_buffer[n].begin();
+         q != recv_buffer[n].end(); q += 2)
     {
       const std::size_t received_old_node_index_global = *q;
       const std::size_t received_new_node_index_global = *(q + 1);
@@ -1650,6 +1665,7 @@ void DofMapBuilder::compute_node_reordering(
       old_to_new_local[received_old_node_index_local] = new_index_local;
       off_process_node_counter++;
     }
+  }
 
   // Sanity check
   for (auto it : old_to_new_local)
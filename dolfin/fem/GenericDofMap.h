@@ -185,6 +185,9 @@ namespace dolfin
     /// reduce memory use)
     virtual void clear_sub_map_data() = 0;
 
+    /// Return number of bytes used by the dof map
+    virtual std::size_t memory_usage() const = 0;
+
     /// Return informal string representation (pretty-print)
     virtual std::string str(bool verbose) const = 0;
 
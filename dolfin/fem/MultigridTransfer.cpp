@@ -0,0 +1,322 @@
+// Copyright (C) 2015 The FEniCS Project
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2015-01-22
+// Last changed: 2015-01-22
+
+#include <cmath>
+#include <boost/multi_array.hpp>
+
+#include <dolfin/common/constants.h>
+#include <dolfin/common/Timer.h>
+#include <dolfin/function/FunctionSpace.h>
+#include <dolfin/la/GenericLinearAlgebraFactory.h>
+#include <dolfin/la/GenericMatrix.h>
+#include <dolfin/la/GenericSparsityPattern.h>
+#include <dolfin/la/GenericVector.h>
+#include <dolfin/la/TensorLayout.h>
+#include <dolfin/log/log.h>
+#include <dolfin/mesh/Cell.h>
+#include <dolfin/mesh/Mesh.h>
+#include <dolfin/mesh/MeshData.h>
+#include "FiniteElement.h"
+#include "GenericDofMap.h"
+#include "MultigridTransfer.h"
+
+using namespace dolfin;
+
+//-----------------------------------------------------------------------------
+MultigridTransfer::MultigridTransfer(
+  std::shared_ptr<const FunctionSpace> V_coarse,
+  std::shared_ptr<const FunctionSpace> V_fine)
+  : _V_coarse(V_coarse), _V_fine(V_fine)
+{
+  dolfin_assert(_V_coarse);
+  dolfin_assert(_V_fine);
+  compute_weights();
+}
+//-----------------------------------------------------------------------------
+MultigridTransfer::~MultigridTransfer()
+{
+  // Do nothing
+}
+//-----------------------------------------------------------------------------
+void MultigridTransfer::assemble_prolongation(GenericMatrix& P) const
+{
+  Timer timer("Multigrid transfer: assemble prolongation");
+
+  const Mesh& mesh = *_V_fine->mesh();
+  std::vector<const GenericDofMap*> dofmaps(2);
+  dofmaps[0] = _V_fine->dofmap().get();
+  dofmaps[1] = _V_coarse->dofmap().get();
+
+  // Create layout for initialising matrix
+  std::shared_ptr<TensorLayout> tensor_layout = P.factory().create_layout(2);
+  dolfin_assert(tensor_layout);
+
+  std::vector<std::size_t> global_dimensions(2);
+  std::vector<std::pair<std::size_t, std::size_t> > local_range(2);
+  std::vector<const std::vector<std::size_t>* > local_to_global(2);
+  std::vector<const std::vector<int>* > off_process_owner(2);
+  const std::vector<std::size_t> block_sizes(2, 1);
+  for (std::size_t i = 0; i < 2; ++i)
+  {
+    global_dimensions[i] = dofmaps[i]->global_dimension();
+    local_range[i] = dofmaps[i]->ownership_range();
+    local_to_global[i] = &(dofmaps[i]->local_to_global_unowned());
+    off_process_owner[i] = &(dofmaps[i]->off_process_owner());
+  }
+  tensor_layout->init(mesh.mpi_comm(), global_dimensions, 1, local_range);
+
+  tensor_layout->local_to_global_map.resize(2);
+  for (std::size_t i = 0; i < 2; ++i)
+  {
+    const std::size_t local_size
+      = local_range[i].second - local_range[i].first
+      + dofmaps[i]->block_size*local_to_global[i]->size();
+    tensor_layout->local_to_global_map[i].resize(local_size);
+    for (std::size_t j = 0; j < local_size; ++j)
+      tensor_layout->local_to_global_map[i][j]
+        = dofmaps[i]->local_to_global_index(j);
+  }
+
+  // Build sparsity pattern from rows of prolongation
+  const std::size_t num_rows = _row_offsets.size() - 1;
+  if (tensor_layout->sparsity_pattern())
+  {
+    GenericSparsityPattern& pattern = *tensor_layout->sparsity_pattern();
+    pattern.init(mesh.mpi_comm(), global_dimensions, local_range,
+                 local_to_global, off_process_owner, block_sizes);
+
+    std::vector<dolfin::la_index> row(1), columns;
+    std::vector<const std::vector<dolfin::la_index>* > entries(2);
+    entries[0] = &row;
+    entries[1] = &columns;
+    for (std::size_t i = 0; i < num_rows; ++i)
+    {
+      row[0] = i;
+      columns.assign(_columns.begin() + _row_offsets[i],
+                     _columns.begin() + _row_offsets[i + 1]);
+      pattern.insert_local(entries);
+    }
+    pattern.apply();
+  }
+
+  // Initialise matrix and insert rows
+  P.init(*tensor_layout);
+  for (std::size_t i = 0; i < num_rows; ++i)
+  {
+    const dolfin::la_index row = i;
+    P.set_local(_values.data() + _row_offsets[i], 1, &row,
+                _row_offsets[i + 1] - _row_offsets[i],
+                _columns.data() + _row_offsets[i]);
+  }
+  P.apply("insert");
+}
+//-----------------------------------------------------------------------------
+void MultigridTransfer::apply_prolongation(GenericVector& x_fine,
+                                           const GenericVector& x_coarse) const
+{
+  const GenericDofMap& dofmap = *_V_fine->dofmap();
+  if (x_fine.empty())
+    x_fine.init(_V_fine->mesh()->mpi_comm(), dofmap.ownership_range());
+
+  if (x_fine.size() != dofmap.global_dimension()
+      || x_coarse.size() != _V_coarse->dofmap()->global_dimension())
+  {
+    dolfin_error("MultigridTransfer.cpp",
+                 "apply prolongation",
+                 "Vector sizes do not match the function spaces");
+  }
+
+  // Get coarse values of all local coarse dofs (including ghosts)
+  std::vector<double> coarse_values;
+  x_coarse.gather(coarse_values, _coarse_global_dofs);
+
+  // Compute fine values
+  const std::size_t num_rows = _row_offsets.size() - 1;
+  std::vector<double> fine_values(num_rows, 0.0);
+  for (std::size_t i = 0; i < num_rows; ++i)
+  {
+    double value = 0.0;
+    for (std::size_t k = _row_offsets[i]; k < _row_offsets[i + 1]; ++k)
+      value += _values[k]*coarse_values[_columns[k]];
+    fine_values[i] = value;
+  }
+
+  x_fine.set_local(fine_values);
+  x_fine.apply("insert");
+}
+//-----------------------------------------------------------------------------
+void MultigridTransfer::apply_restriction(GenericVector& x_coarse,
+                                          const GenericVector& x_fine) const
+{
+  const GenericDofMap& dofmap = *_V_coarse->dofmap();
+  if (x_coarse.empty())
+    x_coarse.init(_V_coarse->mesh()->mpi_comm(), dofmap.ownership_range());
+
+  if (x_coarse.size() != dofmap.global_dimension()
+      || x_fine.size() != _V_fine->dofmap()->global_dimension())
+  {
+    dolfin_error("MultigridTransfer.cpp",
+                 "apply restriction",
+                 "Vector sizes do not match the function spaces");
+  }
+
+  std::vector<double> fine_values;
+  x_fine.get_local(fine_values);
+
+  // Accumulate contributions to all local coarse dofs (including
+  // ghosts), which are then added to their owners
+  std::vector<double> coarse_values(_coarse_global_dofs.size(), 0.0);
+  const std::size_t num_rows = _row_offsets.size() - 1;
+  dolfin_assert(fine_values.size() == num_rows);
+  for (std::size_t i = 0; i < num_rows; ++i)
+  {
+    const double value = fine_values[i];
+    for (std::size_t k = _row_offsets[i]; k < _row_offsets[i + 1]; ++k)
+      coarse_values[_columns[k]] += _values[k]*value;
+  }
+
+  x_coarse.zero();
+  x_coarse.add(coarse_values.data(), coarse_values.size(),
+               _coarse_global_dofs.data());
+  x_coarse.apply("add");
+}
+//-----------------------------------------------------------------------------
+void MultigridTransfer::compute_weights()
+{
+  Timer timer("Multigrid transfer: compute weights");
+
+  const Mesh& coarse_mesh = *_V_coarse->mesh();
+  const Mesh& fine_mesh = *_V_fine->mesh();
+  const FiniteElement& element = *_V_coarse->element();
+  const GenericDofMap& coarse_dofmap = *_V_coarse->dofmap();
+  const GenericDofMap& fine_dofmap = *_V_fine->dofmap();
+  const std::size_t tdim = fine_mesh.topology().dim();
+
+  // Check that the spaces are compatible
+  if (element.signature() != _V_fine->element()->signature())
+  {
+    dolfin_error("MultigridTransfer.cpp",
+                 "create multigrid transfer",
+                 "Coarse and fine function spaces must use the same element");
+  }
+  if (!fine_mesh.data().exists("parent_cell", tdim)
+      || fine_mesh.data().array("parent_cell", tdim).size()
+         != fine_mesh.num_cells())
+  {
+    dolfin_error("MultigridTransfer.cpp",
+                 "create multigrid transfer",
+                 "Fine mesh has no parent cell data (it must be created by refinement of the coarse mesh without redistribution)");
+  }
+  const std::vector<std::size_t>& parent_cell
+    = fine_mesh.data().array("parent_cell", tdim);
+
+  // Global indices of local coarse dofs
+  const std::pair<std::size_t, std::size_t> coarse_range
+    = coarse_dofmap.ownership_range();
+  const std::size_t num_coarse_dofs = coarse_range.second - coarse_range.first
+    + coarse_dofmap.block_size*coarse_dofmap.local_to_global_unowned().size();
+  _coarse_global_dofs.resize(num_coarse_dofs);
+  for (std::size_t j = 0; j < num_coarse_dofs; ++j)
+    _coarse_global_dofs[j] = coarse_dofmap.local_to_global_index(j);
+
+  // Dofs of a vector-valued element are ordered by component
+  std::size_t value_size = 1;
+  for (std::size_t i = 0; i < element.value_rank(); ++i)
+    value_size *= element.value_dimension(i);
+  const std::size_t space_dimension = element.space_dimension();
+  const std::size_t num_scalar_dofs = space_dimension/value_size;
+
+  // Compute row of each owned fine dof, from the first cell it is
+  // found in
+  const std::pair<std::size_t, std::size_t> fine_range
+    = fine_dofmap.ownership_range();
+  const std::size_t num_rows = fine_range.second - fine_range.first;
+  std::vector<std::vector<std::pair<dolfin::la_index, double> > >
+    rows(num_rows);
+  std::vector<bool> computed(num_rows, false);
+
+  std::vector<double> fine_vertex_coordinates, coarse_vertex_coordinates;
+  boost::multi_array<double, 2> coordinates;
+  std::vector<double> values(space_dimension*value_size);
+  for (std::size_t c = 0; c < fine_mesh.num_cells(); ++c)
+  {
+    const Cell fine_cell(fine_mesh, c);
+    const std::vector<dolfin::la_index>& fine_dofs
+      = fine_dofmap.cell_dofs(c);
+
+    fine_cell.get_vertex_coordinates(fine_vertex_coordinates);
+    fine_dofmap.tabulate_coordinates(coordinates, fine_vertex_coordinates,
+                                     fine_cell);
+
+    const Cell coarse_cell(coarse_mesh, parent_cell[c]);
+    const std::vector<dolfin::la_index>& coarse_dofs
+      = coarse_dofmap.cell_dofs(coarse_cell.index());
+
+    coarse_cell.get_vertex_coordinates(coarse_vertex_coordinates);
+    const int orientation = coarse_mesh.cell_orientations().empty()
+      ? -1 : coarse_mesh.cell_orientations()[coarse_cell.index()];
+
+    for (std::size_t l = 0; l < fine_dofs.size(); ++l)
+    {
+      const std::size_t i = fine_dofs[l];
+      if (i >= num_rows || computed[i])
+        continue;
+      computed[i] = true;
+
+      // Evaluate coarse basis functions at fine dof, for the
+      // component of the fine dof
+      element.evaluate_basis_all(values.data(), &coordinates[l][0],
+                                 coarse_vertex_coordinates.data(),
+                                 orientation);
+      const std::size_t component = l/num_scalar_dofs;
+      for (std::size_t j = 0; j < coarse_dofs.size(); ++j)
+      {
+        const double w = values[j*value_size + component];
+        if (std::abs(w) > DOLFIN_EPS_LARGE)
+          rows[i].push_back(std::make_pair(coarse_dofs[j], w));
+      }
+    }
+  }
+
+  for (std::size_t i = 0; i < num_rows; ++i)
+  {
+    if (!computed[i])
+    {
+      dolfin_error("MultigridTransfer.cpp",
+                   "create multigrid transfer",
+                   "Owned fine dof %d is not in any local cell", (int) i);
+    }
+  }
+
+  // Compress rows
+  _row_offsets.assign(1, 0);
+  _columns.clear();
+  _values.clear();
+  for (std::size_t i = 0; i < num_rows; ++i)
+  {
+    for (auto &w : rows[i])
+    {
+      _columns.push_back(w.first);
+      _values.push_back(w.second);
+    }
+    _row_offsets.push_back(_columns.size());
+  }
+}
+//-----------------------------------------------------------------------------
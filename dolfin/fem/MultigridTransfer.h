@@ -0,0 +1,95 @@
+// Copyright (C) 2015 The FEniCS Project
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2015-01-22
+// Last changed: 2015-01-22
+
+#ifndef __MULTIGRID_TRANSFER_H
+#define __MULTIGRID_TRANSFER_H
+
+#include <memory>
+#include <vector>
+#include <dolfin/common/types.h>
+
+namespace dolfin
+{
+
+  // Forward declarations
+  class FunctionSpace;
+  class GenericMatrix;
+  class GenericVector;
+
+  /// This class provides the prolongation and restriction operators
+  /// between Lagrange function spaces on two successive levels of a
+  /// mesh hierarchy, as needed by geometric multigrid.
+  ///
+  /// The fine mesh must have been created by refinement of the
+  /// coarse mesh (without redistribution), so that it carries the
+  /// mesh data "parent_cell". The two function spaces must use the
+  /// same (Lagrange or vector Lagrange) element. The prolongation
+  /// P maps coarse dofs to fine dofs, with P_ij the value of the
+  /// coarse basis function j at the fine dof i, and restriction is
+  /// its transpose. The weights are computed once on construction
+  /// and may be applied matrix-free or assembled into a matrix.
+
+  class MultigridTransfer
+  {
+  public:
+
+    /// Create transfer operators between coarse and fine function
+    /// spaces
+    MultigridTransfer(std::shared_ptr<const FunctionSpace> V_coarse,
+                      std::shared_ptr<const FunctionSpace> V_fine);
+
+    /// Destructor
+    ~MultigridTransfer();
+
+    /// Assemble prolongation matrix (rows are fine dofs, columns
+    /// coarse dofs). The transpose gives the restriction.
+    void assemble_prolongation(GenericMatrix& P) const;
+
+    /// Compute x_fine = P x_coarse without forming P
+    void apply_prolongation(GenericVector& x_fine,
+                            const GenericVector& x_coarse) const;
+
+    /// Compute x_coarse = P^T x_fine without forming P
+    void apply_restriction(GenericVector& x_coarse,
+                           const GenericVector& x_fine) const;
+
+  private:
+
+    // Compute weights of prolongation
+    void compute_weights();
+
+    // Coarse and fine function spaces
+    std::shared_ptr<const FunctionSpace> _V_coarse;
+    std::shared_ptr<const FunctionSpace> _V_fine;
+
+    // Rows of prolongation (compressed, one row per owned fine dof)
+    // with columns as local coarse dof indices
+    std::vector<std::size_t> _row_offsets;
+    std::vector<dolfin::la_index> _columns;
+    std::vector<double> _values;
+
+    // Global index of each local coarse dof
+    std::vector<dolfin::la_index> _coarse_global_dofs;
+
+  };
+
+}
+
+#endif
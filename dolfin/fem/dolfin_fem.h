@@ -11,6 +11,7 @@
 #include <dolfin/fem/BasisFunction.h>
 #include <dolfin/fem/DirichletBC.h>
 #include <dolfin/fem/PointSource.h>
+#include <dolfin/fem/MultigridTransfer.h>
 #include <dolfin/fem/assemble.h>
 #include <dolfin/fem/LocalSolver.h>
 #include <dolfin/fem/solve.h>
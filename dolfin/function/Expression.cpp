@@ -18,16 +18,121 @@
 // Modified by Johan Hake, 2009.
 //
 // First added:  2009-09-28
-// Last changed: 2011-11-14
+// Last changed: 2015-01-22
 
+#include <algorithm>
+
+#ifdef HAS_OPENMP
+#include <omp.h>
+#endif
+
+#include <dolfin/fem/FiniteElement.h>
 #include <dolfin/log/log.h>
 #include <dolfin/mesh/Cell.h>
 #include <dolfin/mesh/Mesh.h>
 #include <dolfin/mesh/Vertex.h>
+#include <dolfin/parameter/GlobalParameters.h>
+#include <dolfin/parameter/ParameterHandle.h>
 #include "Expression.h"
 
 using namespace dolfin;
 
+namespace
+{
+  // Minimum number of points evaluated with threads
+  const std::size_t min_threaded_points = 256;
+
+  // Number of cells for which vertex values are computed at once
+  const std::size_t vertex_values_block_size = 1024;
+
+  // UFC function which records the points (and their cells) at which
+  // it is evaluated, returning zero values
+  class PointRecorder : public ufc::function
+  {
+  public:
+
+    PointRecorder(std::size_t value_size) : _value_size(value_size) {}
+
+    void evaluate(double* values, const double* coordinates,
+                  const ufc::cell& cell) const
+    {
+      points.insert(points.end(), coordinates,
+                    coordinates + cell.geometric_dimension);
+      cells.push_back(&cell);
+      std::fill(values, values + _value_size, 0.0);
+    }
+
+    // Points and cells
+    mutable std::vector<double> points;
+    mutable std::vector<const ufc::cell*> cells;
+
+  private:
+
+    const std::size_t _value_size;
+
+  };
+
+  // UFC function which returns values computed beforehand, in the
+  // order of evaluation
+  class ValueReplayer : public ufc::function
+  {
+  public:
+
+    ValueReplayer(const std::vector<double>& values, std::size_t value_size)
+      : _values(values), _value_size(value_size), _next(0) {}
+
+    void evaluate(double* values, const double* coordinates,
+                  const ufc::cell& cell) const
+    {
+      dolfin_assert(_next + _value_size <= _values.size());
+      std::copy(_values.begin() + _next,
+                _values.begin() + _next + _value_size, values);
+      _next += _value_size;
+    }
+
+  private:
+
+    const std::vector<double>& _values;
+    const std::size_t _value_size;
+    mutable std::size_t _next;
+
+  };
+
+  // Restrict expression to cells (compute expansion coefficients),
+  // evaluating it at the points of all cells at once. The dofs of
+  // the element are evaluated twice: first to find the points, then
+  // to compute the coefficients from the values at the points.
+  void restrict_cells(const Expression& expression, double* w,
+                      const FiniteElement& element, std::size_t num_cells,
+                      const double* const* vertex_coordinates,
+                      const ufc::cell* const* ufc_cells)
+  {
+    const std::size_t space_dimension = element.space_dimension();
+    const std::size_t value_size = expression.value_size();
+
+    PointRecorder recorder(value_size);
+    for (std::size_t i = 0; i < num_cells; ++i)
+    {
+      element.evaluate_dofs(w + i*space_dimension, recorder,
+                            vertex_coordinates[i], ufc_cells[i]->orientation,
+                            *ufc_cells[i]);
+    }
+
+    std::vector<double> values(recorder.cells.size()*value_size);
+    Array<double> _values(values.size(), values.data());
+    const Array<double> x(recorder.points.size(), recorder.points.data());
+    expression.eval_many(_values, x, recorder.cells);
+
+    ValueReplayer replayer(values, value_size);
+    for (std::size_t i = 0; i < num_cells; ++i)
+    {
+      element.evaluate_dofs(w + i*space_dimension, replayer,
+                            vertex_coordinates[i], ufc_cells[i]->orientation,
+                            *ufc_cells[i]);
+    }
+  }
+}
+
 //-----------------------------------------------------------------------------
 Expression::Expression()
 {
@@ -79,6 +184,53 @@ void Expression::eval(Array<double>& values, const Array<double>& x) const
                "Missing eval() function (must be overloaded)");
 }
 //-----------------------------------------------------------------------------
+void Expression::eval_many(Array<double>& values, const Array<double>& x,
+                           const std::vector<const ufc::cell*>& cells) const
+{
+  const std::size_t num_points = cells.size();
+  if (num_points == 0)
+    return;
+  const std::size_t size = value_size();
+  const std::size_t gdim = x.size()/num_points;
+  dolfin_assert(values.size() == num_points*size);
+
+  // Serial, since eval() may be implemented in Python
+  for (std::size_t i = 0; i < num_points; ++i)
+  {
+    Array<double> _values(size, values.data() + i*size);
+    const Array<double> _x(gdim, const_cast<double*>(x.data()) + i*gdim);
+    eval(_values, _x, *cells[i]);
+  }
+}
+//-----------------------------------------------------------------------------
+void Expression::eval_many_threaded(Array<double>& values,
+                                    const Array<double>& x,
+                                    const std::vector<const ufc::cell*>& cells) const
+{
+  const std::size_t num_points = cells.size();
+  if (num_points == 0)
+    return;
+  const std::size_t size = value_size();
+  const std::size_t gdim = x.size()/num_points;
+  dolfin_assert(values.size() == num_points*size);
+
+  #ifdef HAS_OPENMP
+  // Evaluate large batches with threads, unless already called from
+  // threads
+  thread_local const ParameterHandle<int>
+    num_threads(dolfin::parameters, "num_threads");
+  const int threads = std::max(num_threads.value(), 1);
+  #pragma omp parallel for schedule(static) num_threads(threads) \
+    if (threads > 1 && num_points >= min_threaded_points && !omp_in_parallel())
+  #endif
+  for (std::size_t i = 0; i < num_points; ++i)
+  {
+    Array<double> _values(size, values.data() + i*size);
+    const Array<double> _x(gdim, const_cast<double*>(x.data()) + i*gdim);
+    eval(_values, _x, *cells[i]);
+  }
+}
+//-----------------------------------------------------------------------------
 std::size_t Expression::value_rank() const
 {
   return _value_shape.size();
@@ -102,43 +254,83 @@ void Expression::restrict(double* w,
                           const double* vertex_coordinates,
                           const ufc::cell& ufc_cell) const
 {
-  // Restrict as UFC function (by calling eval)
-  restrict_as_ufc_function(w, element, dolfin_cell, vertex_coordinates,
-                           ufc_cell);
+  // Restrict as UFC function, evaluating all points at once
+  const ufc::cell* ufc_cells[1] = {&ufc_cell};
+  restrict_cells(*this, w, element, 1, &vertex_coordinates, ufc_cells);
+}
+//-----------------------------------------------------------------------------
+void Expression::restrict_many(
+  double* w,
+  const FiniteElement& element,
+  const std::vector<Cell>& dolfin_cells,
+  const std::vector<std::vector<double> >& vertex_coordinates,
+  const std::vector<ufc::cell>& ufc_cells) const
+{
+  dolfin_assert(vertex_coordinates.size() == dolfin_cells.size());
+  dolfin_assert(ufc_cells.size() == dolfin_cells.size());
+
+  std::vector<const double*> _vertex_coordinates(dolfin_cells.size());
+  std::vector<const ufc::cell*> _ufc_cells(dolfin_cells.size());
+  for (std::size_t i = 0; i < dolfin_cells.size(); ++i)
+  {
+    _vertex_coordinates[i] = vertex_coordinates[i].data();
+    _ufc_cells[i] = &ufc_cells[i];
+  }
+  restrict_cells(*this, w, element, dolfin_cells.size(),
+                 _vertex_coordinates.data(), _ufc_cells.data());
 }
 //-----------------------------------------------------------------------------
 void Expression::compute_vertex_values(std::vector<double>& vertex_values,
                                        const Mesh& mesh) const
 {
-  // Local data for vertex values
   const std::size_t size = value_size();
-  Array<double> local_vertex_values(size);
+  const std::size_t gdim = mesh.geometry().dim();
 
   // Resize vertex_values
   vertex_values.resize(size*mesh.num_vertices());
 
-  // Iterate over cells, overwriting values when repeatedly visiting vertices
-  ufc::cell ufc_cell;
-  for (CellIterator cell(mesh, "all"); !cell.end(); ++cell)
+  // Iterate over blocks of cells, evaluating at the vertices of all
+  // cells of a block at once and overwriting values when repeatedly
+  // visiting vertices
+  std::vector<ufc::cell> ufc_cells(vertex_values_block_size);
+  std::vector<double> x, local_vertex_values;
+  std::vector<const ufc::cell*> cells;
+  std::vector<std::size_t> vertices;
+  CellIterator cell(mesh, "all");
+  while (!cell.end())
   {
-    // Update cell data
-    cell->get_cell_data(ufc_cell);
-
-    // Iterate over cell vertices
-    for (VertexIterator vertex(*cell); !vertex.end(); ++vertex)
+    x.clear();
+    cells.clear();
+    vertices.clear();
+    for (std::size_t c = 0; c < vertex_values_block_size && !cell.end();
+         ++c, ++cell)
     {
-      // Wrap coordinate data
-      const Array<double> x(mesh.geometry().dim(),
-                            const_cast<double*>(vertex->x()));
+      // Update cell data
+      cell->get_cell_data(ufc_cells[c]);
 
-      // Evaluate at vertex
-      eval(local_vertex_values, x, ufc_cell);
+      // Collect cell vertices
+      for (VertexIterator vertex(*cell); !vertex.end(); ++vertex)
+      {
+        x.insert(x.end(), vertex->x(), vertex->x() + gdim);
+        cells.push_back(&ufc_cells[c]);
+        vertices.push_back(vertex->index());
+      }
+    }
+
+    // Evaluate at vertices
+    local_vertex_values.resize(size*vertices.size());
+    Array<double> _values(local_vertex_values.size(),
+                          local_vertex_values.data());
+    const Array<double> _x(x.size(), x.data());
+    eval_many(_values, _x, cells);
 
-      // Copy to array
+    // Copy to array
+    for (std::size_t k = 0; k < vertices.size(); ++k)
+    {
       for (std::size_t i = 0; i < size; i++)
       {
-        const std::size_t global_index = i*mesh.num_vertices() + vertex->index();
-        vertex_values[global_index] = local_vertex_values[i];
+        const std::size_t global_index = i*mesh.num_vertices() + vertices[k];
+        vertex_values[global_index] = local_vertex_values[k*size + i];
       }
     }
   }
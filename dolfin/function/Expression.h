@@ -16,7 +16,7 @@
 // along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 //
 // First added:  2009-09-28
-// Last changed: 2011-08-15
+// Last changed: 2015-01-22
 
 #ifndef __EXPRESSION_H
 #define __EXPRESSION_H
@@ -44,6 +44,14 @@ namespace dolfin
   /// The geometric dimension (the size of x) and the value rank and
   /// dimensions of an expression must supplied as arguments to the
   /// constructor.
+  ///
+  /// Expressions are evaluated at many points at once (e.g. at all
+  /// dofs of a cell or at all vertices of a block of cells) through
+  /// eval_many(), which by default calls eval() for each point in
+  /// turn. Expressions with a thread-safe eval() (e.g. compiled
+  /// expressions) may overload eval_many() to call
+  /// eval_many_threaded(), which evaluates large batches of points in
+  /// parallel when the global parameter "num_threads" is set.
 
   class Expression : public GenericFunction
   {
@@ -111,6 +119,20 @@ namespace dolfin
     ///         The coordinates of the point.
     virtual void eval(Array<double>& values, const Array<double>& x) const;
 
+    /// Evaluate at a batch of points, each in a given cell.
+    ///
+    /// *Arguments*
+    ///     values (_Array_ <double>)
+    ///         The values at the points (value_size() values per
+    ///         point, stored point by point).
+    ///     x (_Array_ <double>)
+    ///         The coordinates of the points (stored point by point).
+    ///     cells (std::vector<const ufc::cell*>)
+    ///         The cell which contains each point.
+    virtual void eval_many(Array<double>& values,
+                           const Array<double>& x,
+                           const std::vector<const ufc::cell*>& cells) const;
+
     /// Return value rank.
     ///
     /// *Returns*
@@ -146,6 +168,28 @@ namespace dolfin
                           const double* vertex_coordinates,
                           const ufc::cell& ufc_cell) const;
 
+    /// Restrict function to a block of cells (compute expansion
+    /// coefficients w, element.space_dimension() for each cell), with
+    /// one call to eval_many() for the points of all cells.
+    ///
+    /// *Arguments*
+    ///     w (list of doubles)
+    ///         Expansion coefficients.
+    ///     element (_FiniteElement_)
+    ///         The element.
+    ///     dolfin_cells (std::vector<_Cell_>)
+    ///         The cells.
+    ///     vertex_coordinates (std::vector<std::vector<double> >)
+    ///         The vertex coordinates of each cell.
+    ///     ufc_cells (std::vector<ufc::cell>)
+    ///         The ufc::cells.
+    virtual void
+      restrict_many(double* w,
+                    const FiniteElement& element,
+                    const std::vector<Cell>& dolfin_cells,
+                    const std::vector<std::vector<double> >& vertex_coordinates,
+                    const std::vector<ufc::cell>& ufc_cells) const;
+
     /// Compute values at all mesh vertices.
     ///
     /// *Arguments*
@@ -158,6 +202,12 @@ namespace dolfin
 
   protected:
 
+    // Evaluate at a batch of points like eval_many(), using threads
+    // for large batches when "num_threads" is set. eval() must be
+    // thread-safe.
+    void eval_many_threaded(Array<double>& values, const Array<double>& x,
+                            const std::vector<const ufc::cell*>& cells) const;
+
     // Value shape
     std::vector<std::size_t> _value_shape;
 
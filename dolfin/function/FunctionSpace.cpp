@@ -22,7 +22,7 @@
 // Modified by Ola Skavhaug, 2009.
 //
 // First added:  2008-09-11
-// Last changed: 2014-06-11
+// Last changed: 2015-01-22
 
 #include <vector>
 #include <dolfin/common/utils.h>
@@ -158,30 +158,50 @@ void FunctionSpace::interpolate(GenericVector& expansion_coefficients,
   }
   expansion_coefficients.zero();
 
-  // Initialize local arrays
-  std::vector<double> cell_coefficients(_dofmap->max_cell_dimension());
+  // Initialize local arrays for blocks of cells
+  const std::size_t max_block_size = 1024;
+  const std::size_t space_dimension = _element->space_dimension();
+  std::vector<double> cell_coefficients(max_block_size*space_dimension);
+  std::vector<Cell> cells;
+  std::vector<std::vector<double> > vertex_coordinates(max_block_size);
+  std::vector<ufc::cell> ufc_cells(max_block_size);
 
-  // Iterate over mesh and interpolate on each cell
-  ufc::cell ufc_cell;
-  std::vector<double> vertex_coordinates;
-  for (CellIterator cell(*_mesh); !cell.end(); ++cell)
+  // Iterate over mesh and interpolate on blocks of cells (so that
+  // the function may evaluate the points of all cells at once)
+  CellIterator cell(*_mesh);
+  while (!cell.end())
   {
-    // Update to current cell
-    cell->get_vertex_coordinates(vertex_coordinates);
-    cell->get_cell_data(ufc_cell);
+    // Update to current cells
+    cells.clear();
+    for (; cells.size() < max_block_size && !cell.end(); ++cell)
+    {
+      const std::size_t c = cells.size();
+      cell->get_vertex_coordinates(vertex_coordinates[c]);
+      cell->get_cell_data(ufc_cells[c]);
+      cells.push_back(*cell);
+    }
+    if (cells.size() < max_block_size)
+    {
+      vertex_coordinates.resize(cells.size());
+      ufc_cells.resize(cells.size());
+    }
 
-    // Restrict function to cell
-    v.restrict(cell_coefficients.data(), *_element, *cell,
-               vertex_coordinates.data(), ufc_cell);
+    // Restrict function to cells
+    v.restrict_many(cell_coefficients.data(), *_element, cells,
+                    vertex_coordinates, ufc_cells);
 
-    // Tabulate dofs
-    const std::vector<dolfin::la_index>& cell_dofs
-      = _dofmap->cell_dofs(cell->index());
+    for (std::size_t c = 0; c < cells.size(); ++c)
+    {
+      // Tabulate dofs
+      const std::vector<dolfin::la_index>& cell_dofs
+        = _dofmap->cell_dofs(cells[c].index());
 
-    // Copy dofs to vector
-    expansion_coefficients.set_local(cell_coefficients.data(),
-                                     _dofmap->cell_dimension(cell->index()),
-                                     cell_dofs.data());
+      // Copy dofs to vector
+      expansion_coefficients.set_local(cell_coefficients.data()
+                                       + c*space_dimension,
+                                       _dofmap->cell_dimension(cells[c].index()),
+                                       cell_dofs.data());
+    }
   }
 
   // Finalise changes
@@ -16,13 +16,14 @@
 // along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 //
 // First added:  2009-09-28
-// Last changed: 2014-03-25
+// Last changed: 2015-01-22
 
 #include <string>
 #include <dolfin/common/Array.h>
 #include <dolfin/fem/FiniteElement.h>
 #include <dolfin/geometry/Point.h>
 #include <dolfin/log/log.h>
+#include <dolfin/mesh/Cell.h>
 #include "GenericFunction.h"
 
 using namespace dolfin;
@@ -189,6 +190,24 @@ void GenericFunction::evaluate(double* values,
   eval(_values, x, cell);
 }
 //-----------------------------------------------------------------------------
+void GenericFunction::restrict_many(
+  double* w,
+  const FiniteElement& element,
+  const std::vector<Cell>& dolfin_cells,
+  const std::vector<std::vector<double> >& vertex_coordinates,
+  const std::vector<ufc::cell>& ufc_cells) const
+{
+  dolfin_assert(vertex_coordinates.size() == dolfin_cells.size());
+  dolfin_assert(ufc_cells.size() == dolfin_cells.size());
+
+  const std::size_t space_dimension = element.space_dimension();
+  for (std::size_t i = 0; i < dolfin_cells.size(); ++i)
+  {
+    restrict(w + i*space_dimension, element, dolfin_cells[i],
+             vertex_coordinates[i].data(), ufc_cells[i]);
+  }
+}
+//-----------------------------------------------------------------------------
 void GenericFunction::restrict_as_ufc_function(double* w,
                                                const FiniteElement& element,
                                                const Cell& dolfin_cell,
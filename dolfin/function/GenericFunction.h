@@ -18,11 +18,12 @@
 // Modified by Garth N. Wells, 2009.
 //
 // First added:  2009-09-28
-// Last changed: 2011-01-19
+// Last changed: 2015-01-22
 
 #ifndef __GENERIC_FUNCTION_H
 #define __GENERIC_FUNCTION_H
 
+#include <vector>
 #include <ufc.h>
 #include <dolfin/common/Array.h>
 #include <dolfin/common/Variable.h>
@@ -84,6 +85,16 @@ namespace dolfin
 
     //--- Optional functions to be implemented by sub-classes ---
 
+    /// Restrict function to a block of cells (compute expansion
+    /// coefficients w, element.space_dimension() for each cell). The
+    /// default implementation calls restrict for each cell.
+    virtual void
+      restrict_many(double* w,
+                    const FiniteElement& element,
+                    const std::vector<Cell>& dolfin_cells,
+                    const std::vector<std::vector<double> >& vertex_coordinates,
+                    const std::vector<ufc::cell>& ufc_cells) const;
+
     /// Update off-process ghost coefficients
     virtual void update() const {}
 
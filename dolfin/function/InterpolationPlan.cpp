@@ -0,0 +1,629 @@
+// Copyright (C) 2015 The FEniCS Project
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2015-01-22
+// Last changed: 2015-01-22
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <ufc.h>
+
+#include <dolfin/common/MPI.h>
+#include <dolfin/common/Timer.h>
+#include <dolfin/common/constants.h>
+#include <dolfin/fem/FiniteElement.h>
+#include <dolfin/fem/GenericDofMap.h>
+#include <dolfin/geometry/BoundingBoxTree.h>
+#include <dolfin/geometry/Point.h>
+#include <dolfin/la/GenericLinearAlgebraFactory.h>
+#include <dolfin/la/GenericMatrix.h>
+#include <dolfin/la/GenericSparsityPattern.h>
+#include <dolfin/la/GenericVector.h>
+#include <dolfin/la/TensorLayout.h>
+#include <dolfin/log/log.h>
+#include <dolfin/mesh/Cell.h>
+#include <dolfin/mesh/Mesh.h>
+#include "Function.h"
+#include "FunctionSpace.h"
+#include "LagrangeInterpolator.h"
+#include "InterpolationPlan.h"
+
+using namespace dolfin;
+
+//-----------------------------------------------------------------------------
+InterpolationPlan::InterpolationPlan(
+  std::shared_ptr<const FunctionSpace> receiving_space,
+  std::shared_ptr<const FunctionSpace> assigning_space)
+  : _receiving_space(receiving_space), _assigning_space(assigning_space),
+    _space_dimension(0), _value_size(0), _num_local_evaluations(0),
+    _num_points_not_found(0)
+{
+  Timer timer("Init interpolation plan");
+
+  dolfin_assert(_receiving_space);
+  dolfin_assert(_assigning_space);
+  dolfin_assert(_receiving_space->element());
+  dolfin_assert(_assigning_space->element());
+  const FiniteElement& element = *_receiving_space->element();
+  const FiniteElement& element0 = *_assigning_space->element();
+
+  // Check that function ranks match
+  if (element.value_rank() != element0.value_rank())
+  {
+    dolfin_error("InterpolationPlan.cpp",
+                 "create interpolation plan",
+                 "Rank of assigning space (%d) does not match rank of receiving space (%d)",
+                 element0.value_rank(), element.value_rank());
+  }
+
+  // Check that function dims match
+  for (std::size_t i = 0; i < element.value_rank(); ++i)
+  {
+    if (element.value_dimension(i) != element0.value_dimension(i))
+    {
+      dolfin_error("InterpolationPlan.cpp",
+                   "create interpolation plan",
+                   "Dimension %d of assigning space (%d) does not match dimension %d of receiving space (%d)",
+                   i, element0.value_dimension(i), i,
+                   element.value_dimension(i));
+    }
+  }
+
+  // Check that geometric dimensions match
+  dolfin_assert(_receiving_space->mesh());
+  dolfin_assert(_assigning_space->mesh());
+  if (_receiving_space->mesh()->geometry().dim()
+      != _assigning_space->mesh()->geometry().dim())
+  {
+    dolfin_error("InterpolationPlan.cpp",
+                 "create interpolation plan",
+                 "Geometric dimensions of the meshes do not match");
+  }
+
+  _space_dimension = element0.space_dimension();
+  _value_size = 1;
+  for (std::size_t i = 0; i < element0.value_rank(); ++i)
+    _value_size *= element0.value_dimension(i);
+
+  // Compute interpolation points and locate them
+  std::vector<double> points;
+  _init_points(points);
+  _init_evaluations(points);
+}
+//-----------------------------------------------------------------------------
+InterpolationPlan::~InterpolationPlan()
+{
+  // Do nothing
+}
+//-----------------------------------------------------------------------------
+void InterpolationPlan::interpolate(Function& u, const Function& u0) const
+{
+  // Check function spaces
+  dolfin_assert(u.function_space());
+  dolfin_assert(u0.function_space());
+  if (*u.function_space() != *_receiving_space
+      || *u0.function_space() != *_assigning_space)
+  {
+    dolfin_error("InterpolationPlan.cpp",
+                 "interpolate function",
+                 "Functions are not in the function spaces of the plan");
+  }
+
+  // Gather dofs of the cells of all evaluations
+  dolfin_assert(u0.vector());
+  std::vector<double> coefficients(_evaluation_dofs.size());
+  if (!coefficients.empty())
+  {
+    u0.vector()->get_local(coefficients.data(), coefficients.size(),
+                           _evaluation_dofs.data());
+  }
+
+  // Evaluate points, for this process followed by the points sent
+  // to other processes
+  const std::size_t num_evaluations = _evaluation_dofs.size()/_space_dimension;
+  std::vector<double> values(num_evaluations*_value_size, 0.0);
+  for (std::size_t k = 0; k < num_evaluations; ++k)
+  {
+    const double* w = coefficients.data() + k*_space_dimension;
+    const double* phi = _basis_values.data() + k*_space_dimension*_value_size;
+    double* value = values.data() + k*_value_size;
+    for (std::size_t i = 0; i < _space_dimension; ++i)
+      for (std::size_t j = 0; j < _value_size; ++j)
+        value[j] += w[i]*phi[i*_value_size + j];
+  }
+
+  // Exchange values with neighbouring processes
+  std::vector<double> received_values;
+  if (_neighbors)
+  {
+    const std::vector<double>
+      send_values(values.begin() + _num_local_evaluations*_value_size,
+                  values.end());
+    std::vector<int> recv_offsets;
+    MPI::neighbor_all_to_all(*_neighbors, send_values, _send_offsets,
+                             received_values, recv_offsets);
+    dolfin_assert(received_values.size()
+                  == _received_points.size()*_value_size);
+  }
+
+  // Set values of the dofs at each point
+  dolfin_assert(u.vector());
+  std::vector<double> local_u_vector(u.vector()->local_size(), 0.0);
+  for (std::size_t k = 0; k < _local_points.size() + _received_points.size();
+       ++k)
+  {
+    std::size_t point;
+    const double* value;
+    if (k < _local_points.size())
+    {
+      point = _local_points[k];
+      value = values.data() + k*_value_size;
+    }
+    else
+    {
+      point = _received_points[k - _local_points.size()];
+      value = received_values.data() + (k - _local_points.size())*_value_size;
+    }
+
+    for (std::size_t i = _point_dof_offsets[point];
+         i < _point_dof_offsets[point + 1]; ++i)
+    {
+      dolfin_assert(_point_dofs[i] < local_u_vector.size());
+      local_u_vector[_point_dofs[i]] = value[_point_components[i]];
+    }
+  }
+
+  // Set and finalize
+  u.vector()->set_local(local_u_vector);
+  u.vector()->apply("insert");
+}
+//-----------------------------------------------------------------------------
+void InterpolationPlan::assemble(GenericMatrix& A) const
+{
+  Timer timer("Assemble interpolation matrix");
+
+  // Compute rows
+  std::vector<la_index> rows, columns;
+  std::vector<std::size_t> row_offsets;
+  std::vector<double> values;
+  _compute_rows(rows, row_offsets, columns, values);
+
+  const Mesh& mesh = *_receiving_space->mesh();
+  std::vector<const GenericDofMap*> dofmaps(2);
+  dofmaps[0] = _receiving_space->dofmap().get();
+  dofmaps[1] = _assigning_space->dofmap().get();
+
+  // Create layout for initialising matrix
+  std::shared_ptr<TensorLayout> tensor_layout = A.factory().create_layout(2);
+  dolfin_assert(tensor_layout);
+
+  std::vector<std::size_t> global_dimensions(2);
+  std::vector<std::pair<std::size_t, std::size_t> > local_range(2);
+  std::vector<const std::vector<std::size_t>* > local_to_global(2);
+  std::vector<const std::vector<int>* > off_process_owner(2);
+  const std::vector<std::size_t> block_sizes(2, 1);
+  for (std::size_t i = 0; i < 2; ++i)
+  {
+    global_dimensions[i] = dofmaps[i]->global_dimension();
+    local_range[i] = dofmaps[i]->ownership_range();
+    local_to_global[i] = &(dofmaps[i]->local_to_global_unowned());
+    off_process_owner[i] = &(dofmaps[i]->off_process_owner());
+  }
+  tensor_layout->init(mesh.mpi_comm(), global_dimensions, 1, local_range);
+
+  tensor_layout->local_to_global_map.resize(2);
+  for (std::size_t i = 0; i < 2; ++i)
+  {
+    const std::size_t local_size
+      = local_range[i].second - local_range[i].first
+      + dofmaps[i]->block_size*local_to_global[i]->size();
+    tensor_layout->local_to_global_map[i].resize(local_size);
+    for (std::size_t j = 0; j < local_size; ++j)
+      tensor_layout->local_to_global_map[i][j]
+        = dofmaps[i]->local_to_global_index(j);
+  }
+
+  // Build sparsity pattern from rows (all owned by this process)
+  if (tensor_layout->sparsity_pattern())
+  {
+    GenericSparsityPattern& pattern = *tensor_layout->sparsity_pattern();
+    pattern.init(mesh.mpi_comm(), global_dimensions, local_range,
+                 local_to_global, off_process_owner, block_sizes);
+
+    std::vector<la_index> row(1), row_columns;
+    std::vector<const std::vector<la_index>* > entries(2);
+    entries[0] = &row;
+    entries[1] = &row_columns;
+    for (std::size_t i = 0; i < rows.size(); ++i)
+    {
+      row[0] = rows[i];
+      row_columns.assign(columns.begin() + row_offsets[i],
+                         columns.begin() + row_offsets[i + 1]);
+      pattern.insert_global(entries);
+    }
+    pattern.apply();
+  }
+
+  // Initialise matrix and insert rows
+  A.init(*tensor_layout);
+  for (std::size_t i = 0; i < rows.size(); ++i)
+  {
+    A.set(values.data() + row_offsets[i], 1, &rows[i],
+          row_offsets[i + 1] - row_offsets[i],
+          columns.data() + row_offsets[i]);
+  }
+  A.apply("insert");
+}
+//-----------------------------------------------------------------------------
+void InterpolationPlan::_init_points(std::vector<double>& points)
+{
+  const FunctionSpace& V = *_receiving_space;
+  dolfin_assert(V.dofmap());
+
+  // Create map from coordinates to dofs sharing that coordinate
+  const std::map<std::vector<double>, std::vector<std::size_t>, lt_coordinate>
+    coords_to_dofs
+    = LagrangeInterpolator::tabulate_coordinates_to_dofs(*V.dofmap(),
+                                                         *V.mesh());
+
+  // Get a map from dofs to component number in mixed space
+  std::unordered_map<std::size_t, std::size_t> dof_component_map;
+  int component = -1;
+  LagrangeInterpolator::extract_dof_component_map(dof_component_map, V,
+                                                  &component);
+
+  // Store points with their dofs
+  _point_dof_offsets.assign(1, 0);
+  _point_dofs.clear();
+  _point_components.clear();
+  points.clear();
+  std::map<std::vector<double>, std::vector<std::size_t>,
+           lt_coordinate>::const_iterator map_it;
+  for (map_it = coords_to_dofs.begin(); map_it != coords_to_dofs.end();
+       ++map_it)
+  {
+    points.insert(points.end(), map_it->first.begin(), map_it->first.end());
+    for (std::size_t i = 0; i < map_it->second.size(); ++i)
+    {
+      const std::size_t dof = map_it->second[i];
+      _point_dofs.push_back(dof);
+      _point_components.push_back(dof_component_map[dof]);
+      dolfin_assert(_point_components.back() < _value_size);
+    }
+    _point_dof_offsets.push_back(_point_dofs.size());
+  }
+}
+//-----------------------------------------------------------------------------
+void InterpolationPlan::_init_evaluations(const std::vector<double>& points)
+{
+  const Mesh& mesh0 = *_assigning_space->mesh();
+  const std::size_t gdim = mesh0.geometry().dim();
+  const std::size_t num_points = points.size()/gdim;
+  const unsigned int not_found = std::numeric_limits<unsigned int>::max();
+  std::shared_ptr<BoundingBoxTree> tree = mesh0.bounding_box_tree();
+
+  // Locate points in the local part of the assigning mesh
+  std::vector<std::size_t> points_not_found;
+  for (std::size_t i = 0; i < num_points; ++i)
+  {
+    const Point point(gdim, &points[i*gdim]);
+    const unsigned int cell = tree->compute_first_entity_collision(point);
+    if (cell != not_found)
+    {
+      _add_evaluation(&points[i*gdim], cell);
+      _local_points.push_back(i);
+    }
+    else
+      points_not_found.push_back(i);
+  }
+  _num_local_evaluations = _local_points.size();
+
+  // Remaining points are searched for on other processes
+  const MPI_Comm mpi_comm = mesh0.mpi_comm();
+  const std::size_t num_processes = MPI::size(mpi_comm);
+  if (num_processes == 1)
+  {
+    _send_offsets.assign(1, 0);
+    _num_points_not_found = points_not_found.size();
+    return;
+  }
+  const std::size_t process_number = MPI::rank(mpi_comm);
+
+  // Communicate bounding boxes of the assigning mesh (empty if the
+  // local mesh is empty)
+  std::vector<double> x_min_max;
+  if (mesh0.num_cells() > 0)
+  {
+    x_min_max.resize(2*gdim);
+    std::fill(x_min_max.begin(), x_min_max.begin() + gdim,
+              std::numeric_limits<double>::max());
+    std::fill(x_min_max.begin() + gdim, x_min_max.end(),
+              -std::numeric_limits<double>::max());
+    const std::vector<double>& coordinates = mesh0.coordinates();
+    for (std::size_t v = 0; v < coordinates.size()/gdim; ++v)
+    {
+      for (std::size_t i = 0; i < gdim; ++i)
+      {
+        x_min_max[i] = std::min(x_min_max[i], coordinates[v*gdim + i]);
+        x_min_max[gdim + i]
+          = std::max(x_min_max[gdim + i], coordinates[v*gdim + i]);
+      }
+    }
+  }
+  std::vector<std::vector<double> > bounding_boxes;
+  MPI::all_gather(mpi_comm, x_min_max, bounding_boxes);
+
+  // Find processes which may own each remaining point
+  std::map<int, std::vector<std::size_t> > candidate_points;
+  std::vector<double> x(gdim);
+  for (std::size_t k = 0; k < points_not_found.size(); ++k)
+  {
+    const std::size_t i = points_not_found[k];
+    std::copy(points.begin() + i*gdim, points.begin() + (i + 1)*gdim,
+              x.begin());
+    for (std::size_t p = 0; p < num_processes; ++p)
+    {
+      if (p != process_number
+          && LagrangeInterpolator::in_bounding_box(x, bounding_boxes[p],
+                                                   1e-12))
+      {
+        candidate_points[p].push_back(i);
+      }
+    }
+  }
+
+  // Send points to the candidate processes
+  std::vector<int> candidates;
+  std::vector<std::vector<std::size_t> > requested_points;
+  for (auto it = candidate_points.begin(); it != candidate_points.end(); ++it)
+  {
+    candidates.push_back(it->first);
+    requested_points.push_back(it->second);
+  }
+  const MPINeighborComm requests(mpi_comm, candidates, false);
+  std::vector<std::vector<double> > send_points(requests.destinations().size());
+  std::vector<std::vector<std::size_t> >
+    destination_points(requests.destinations().size());
+  for (std::size_t d = 0; d < requests.destinations().size(); ++d)
+  {
+    const std::size_t c
+      = std::find(candidates.begin(), candidates.end(),
+                  requests.destinations()[d]) - candidates.begin();
+    destination_points[d] = requested_points[c];
+    for (std::size_t k = 0; k < destination_points[d].size(); ++k)
+    {
+      const std::size_t i = destination_points[d][k];
+      send_points[d].insert(send_points[d].end(), points.begin() + i*gdim,
+                            points.begin() + (i + 1)*gdim);
+    }
+  }
+  std::vector<std::vector<double> > received_points;
+  MPI::neighbor_all_to_all(requests, send_points, received_points);
+
+  // Locate received points, and reply which were found
+  std::vector<std::vector<unsigned int> >
+    received_cells(requests.sources().size());
+  std::vector<std::vector<int> > found(requests.sources().size());
+  for (std::size_t s = 0; s < requests.sources().size(); ++s)
+  {
+    for (std::size_t k = 0; k < received_points[s].size()/gdim; ++k)
+    {
+      const Point point(gdim, &received_points[s][k*gdim]);
+      const unsigned int cell = tree->compute_first_entity_collision(point);
+      received_cells[s].push_back(cell);
+      found[s].push_back(cell != not_found);
+    }
+  }
+  const MPINeighborComm replies(mpi_comm, requests.destinations(),
+                                requests.sources());
+  std::vector<std::vector<int> > found_by_destination;
+  MPI::neighbor_all_to_all(replies, found, found_by_destination);
+
+  // Let the lowest process which found a point evaluate it
+  std::vector<int> owner(num_points, num_processes);
+  for (std::size_t d = 0; d < requests.destinations().size(); ++d)
+  {
+    const int p = requests.destinations()[d];
+    for (std::size_t k = 0; k < destination_points[d].size(); ++k)
+    {
+      const std::size_t i = destination_points[d][k];
+      if (found_by_destination[d][k] && p < owner[i])
+        owner[i] = p;
+    }
+  }
+  std::vector<std::vector<int> > selected(requests.destinations().size());
+  std::vector<std::pair<int, std::vector<std::size_t> > > sources;
+  for (std::size_t d = 0; d < requests.destinations().size(); ++d)
+  {
+    const int p = requests.destinations()[d];
+    std::vector<std::size_t> evaluated_points;
+    for (std::size_t k = 0; k < destination_points[d].size(); ++k)
+    {
+      const std::size_t i = destination_points[d][k];
+      selected[d].push_back(owner[i] == p);
+      if (owner[i] == p)
+        evaluated_points.push_back(i);
+    }
+    if (!evaluated_points.empty())
+      sources.push_back(std::make_pair(p, evaluated_points));
+  }
+  for (std::size_t k = 0; k < points_not_found.size(); ++k)
+  {
+    if (owner[points_not_found[k]] == (int) num_processes)
+      ++_num_points_not_found;
+  }
+
+  // Tell the processes which of the points they found to evaluate
+  std::vector<std::vector<int> > selected_by_source;
+  MPI::neighbor_all_to_all(requests, selected, selected_by_source);
+
+  // Add evaluations of the selected points, for each destination
+  std::vector<int> destinations;
+  _send_offsets.assign(1, 0);
+  for (std::size_t s = 0; s < requests.sources().size(); ++s)
+  {
+    std::size_t num_selected = 0;
+    for (std::size_t k = 0; k < selected_by_source[s].size(); ++k)
+    {
+      if (selected_by_source[s][k])
+      {
+        _add_evaluation(&received_points[s][k*gdim], received_cells[s][k]);
+        ++num_selected;
+      }
+    }
+    if (num_selected > 0)
+    {
+      destinations.push_back(requests.sources()[s]);
+      _send_offsets.push_back(_send_offsets.back() + num_selected*_value_size);
+    }
+  }
+
+  // Store the points evaluated by each source
+  std::vector<int> source_processes;
+  for (std::size_t s = 0; s < sources.size(); ++s)
+  {
+    source_processes.push_back(sources[s].first);
+    _received_points.insert(_received_points.end(), sources[s].second.begin(),
+                            sources[s].second.end());
+  }
+
+  // Create neighbourhood for the exchange of values
+  _neighbors.reset(new MPINeighborComm(mpi_comm, source_processes,
+                                       destinations));
+}
+//-----------------------------------------------------------------------------
+void InterpolationPlan::_add_evaluation(const double* x,
+                                        std::size_t cell_index)
+{
+  const Mesh& mesh0 = *_assigning_space->mesh();
+  const FiniteElement& element0 = *_assigning_space->element();
+  const GenericDofMap& dofmap0 = *_assigning_space->dofmap();
+
+  // Get cell data
+  const Cell cell(mesh0, cell_index);
+  std::vector<double> vertex_coordinates;
+  cell.get_vertex_coordinates(vertex_coordinates);
+  ufc::cell ufc_cell;
+  cell.get_cell_data(ufc_cell);
+
+  // Store dofs of cell
+  const std::vector<la_index>& dofs = dofmap0.cell_dofs(cell_index);
+  dolfin_assert(dofs.size() == _space_dimension);
+  _evaluation_dofs.insert(_evaluation_dofs.end(), dofs.begin(), dofs.end());
+
+  // Evaluate basis functions at point
+  const std::size_t offset = _basis_values.size();
+  _basis_values.resize(offset + _space_dimension*_value_size);
+  element0.evaluate_basis_all(_basis_values.data() + offset, x,
+                              vertex_coordinates.data(),
+                              ufc_cell.orientation);
+}
+//-----------------------------------------------------------------------------
+void InterpolationPlan::_compute_rows(std::vector<la_index>& rows,
+                                      std::vector<std::size_t>& row_offsets,
+                                      std::vector<la_index>& columns,
+                                      std::vector<double>& values) const
+{
+  const GenericDofMap& dofmap = *_receiving_space->dofmap();
+  const GenericDofMap& dofmap0 = *_assigning_space->dofmap();
+
+  // Global dofs of the cells of all evaluations
+  std::vector<la_index> evaluation_columns(_evaluation_dofs.size());
+  for (std::size_t i = 0; i < _evaluation_dofs.size(); ++i)
+    evaluation_columns[i] = dofmap0.local_to_global_index(_evaluation_dofs[i]);
+
+  // Send columns and basis values of the points evaluated for other
+  // processes to their owners
+  std::vector<la_index> received_columns;
+  std::vector<double> received_basis_values;
+  if (_neighbors)
+  {
+    const std::size_t k0 = _num_local_evaluations;
+    std::vector<int> column_offsets(_send_offsets.size());
+    std::vector<int> basis_offsets(_send_offsets.size());
+    for (std::size_t d = 0; d < _send_offsets.size(); ++d)
+    {
+      column_offsets[d] = _send_offsets[d]/_value_size*_space_dimension;
+      basis_offsets[d] = _send_offsets[d]*_space_dimension;
+    }
+
+    const std::vector<la_index>
+      send_columns(evaluation_columns.begin() + k0*_space_dimension,
+                   evaluation_columns.end());
+    const std::vector<double>
+      send_basis_values(_basis_values.begin()
+                        + k0*_space_dimension*_value_size,
+                        _basis_values.end());
+    std::vector<int> recv_offsets;
+    MPI::neighbor_all_to_all(*_neighbors, send_columns, column_offsets,
+                             received_columns, recv_offsets);
+    MPI::neighbor_all_to_all(*_neighbors, send_basis_values, basis_offsets,
+                             received_basis_values, recv_offsets);
+  }
+  dolfin_assert(_evaluation_dofs.size()/_space_dimension
+                >= _local_points.size());
+  dolfin_assert(received_columns.size()
+                == _received_points.size()*_space_dimension);
+
+  // Compute row of each dof at each point, for the component of the
+  // dof
+  rows.clear();
+  row_offsets.assign(1, 0);
+  columns.clear();
+  values.clear();
+  for (std::size_t k = 0; k < _local_points.size() + _received_points.size();
+       ++k)
+  {
+    std::size_t point;
+    const la_index* cell_columns;
+    const double* phi;
+    if (k < _local_points.size())
+    {
+      point = _local_points[k];
+      cell_columns = evaluation_columns.data() + k*_space_dimension;
+      phi = _basis_values.data() + k*_space_dimension*_value_size;
+    }
+    else
+    {
+      const std::size_t l = k - _local_points.size();
+      point = _received_points[l];
+      cell_columns = received_columns.data() + l*_space_dimension;
+      phi = received_basis_values.data() + l*_space_dimension*_value_size;
+    }
+
+    for (std::size_t i = _point_dof_offsets[point];
+         i < _point_dof_offsets[point + 1]; ++i)
+    {
+      rows.push_back(dofmap.local_to_global_index(_point_dofs[i]));
+      for (std::size_t j = 0; j < _space_dimension; ++j)
+      {
+        const double w = phi[j*_value_size + _point_components[i]];
+        if (std::abs(w) > DOLFIN_EPS_LARGE)
+        {
+          columns.push_back(cell_columns[j]);
+          values.push_back(w);
+        }
+      }
+      row_offsets.push_back(columns.size());
+    }
+  }
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,170 @@
+// Copyright (C) 2015 The FEniCS Project
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2015-01-22
+// Last changed: 2015-01-22
+
+#ifndef __INTERPOLATION_PLAN_H
+#define __INTERPOLATION_PLAN_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <dolfin/common/types.h>
+
+namespace dolfin
+{
+
+  class Function;
+  class FunctionSpace;
+  class GenericMatrix;
+  class MPINeighborComm;
+
+  /// This class interpolates Functions between two fixed function
+  /// spaces on (possibly non-matching) meshes, in the same way as
+  /// LagrangeInterpolator::interpolate(Function&, const Function&),
+  /// but with all the work that depends only on the function spaces
+  /// done once, when the plan is created. The plan stores, for each
+  /// interpolation point of the receiving space (the coordinates of
+  /// its dofs), the cell of the assigning mesh which contains the
+  /// point, the process which owns that cell and the values of the
+  /// basis functions of the cell at the point. Each interpolation is
+  /// then a gather of the assigning dofs, a small dense evaluation
+  /// for each point and one exchange of values between neighbouring
+  /// processes.
+  ///
+  /// The plan may also assemble the interpolation operator as a
+  /// matrix, e.g. for transfer between multigrid levels or as an
+  /// observation operator, with the transpose giving its adjoint.
+  ///
+  /// As for LagrangeInterpolator, the receiving space must have
+  /// dofs which are point evaluations (Lagrange elements). Dofs at
+  /// points which lie outside the assigning mesh are set to zero.
+  ///
+  /// Creating the plan is collective.
+
+  class InterpolationPlan
+  {
+  public:
+
+    /// Create plan for interpolation of Functions in the assigning
+    /// space into Functions in the receiving space
+    ///
+    /// *Arguments*
+    ///     receiving_space (_FunctionSpace_)
+    ///         The function space interpolated into
+    ///     assigning_space (_FunctionSpace_)
+    ///         The function space interpolated from
+    InterpolationPlan(std::shared_ptr<const FunctionSpace> receiving_space,
+                      std::shared_ptr<const FunctionSpace> assigning_space);
+
+    /// Destructor
+    ~InterpolationPlan();
+
+    /// Interpolate function (collective)
+    ///
+    /// *Arguments*
+    ///     u  (_Function_)
+    ///         The resulting Function (in the receiving space)
+    ///     u0 (_Function_)
+    ///         The Function to be interpolated (in the assigning space)
+    void interpolate(Function& u, const Function& u0) const;
+
+    /// Assemble interpolation matrix (collective). Rows are dofs of
+    /// the receiving space and columns dofs of the assigning space,
+    /// so that A*u0.vector() is the interpolant of u0. Rows of dofs
+    /// at points outside the assigning mesh are empty.
+    ///
+    /// *Arguments*
+    ///     A (_GenericMatrix_)
+    ///         The interpolation matrix (must be empty)
+    void assemble(GenericMatrix& A) const;
+
+    /// Return number of interpolation points of the receiving space
+    /// on this process
+    std::size_t num_points() const
+    { return _point_dof_offsets.size() - 1; }
+
+    /// Return number of points evaluated on this process (for this
+    /// and other processes)
+    std::size_t num_evaluations() const
+    { return _evaluation_dofs.size()/_space_dimension; }
+
+    /// Return number of interpolation points on this process which
+    /// were not found in the assigning mesh
+    std::size_t num_points_not_found() const
+    { return _num_points_not_found; }
+
+  private:
+
+    // Compute points, and the dofs at each point with its component
+    void _init_points(std::vector<double>& points);
+
+    // Locate points in the assigning mesh and tabulate the dofs and
+    // basis functions of the cell containing each point
+    void _init_evaluations(const std::vector<double>& points);
+
+    // Add evaluation of point in cell of the assigning mesh
+    void _add_evaluation(const double* x, std::size_t cell_index);
+
+    // Compute the rows of the interpolation matrix for the dofs of
+    // this process, with global row and column indices (collective)
+    void _compute_rows(std::vector<la_index>& rows,
+                       std::vector<std::size_t>& row_offsets,
+                       std::vector<la_index>& columns,
+                       std::vector<double>& values) const;
+
+    // Function spaces
+    std::shared_ptr<const FunctionSpace> _receiving_space;
+    std::shared_ptr<const FunctionSpace> _assigning_space;
+
+    // Dimension of assigning element, and its value size
+    std::size_t _space_dimension;
+    std::size_t _value_size;
+
+    // Local dofs of the receiving space at each interpolation point,
+    // with the value component of each dof
+    std::vector<std::size_t> _point_dof_offsets;
+    std::vector<std::size_t> _point_dofs;
+    std::vector<std::size_t> _point_components;
+
+    // Evaluations on this process: local dofs of the assigning cell
+    // (space dimension per evaluation) and values of the basis
+    // functions (space dimension times value size per evaluation),
+    // for points of this process followed by the points of each
+    // destination process
+    std::vector<la_index> _evaluation_dofs;
+    std::vector<double> _basis_values;
+    std::size_t _num_local_evaluations;
+    std::vector<int> _send_offsets;
+
+    // Points (indices) of this process evaluated on this process,
+    // followed by those evaluated by each source process
+    std::vector<std::size_t> _local_points;
+    std::vector<std::size_t> _received_points;
+
+    // Neighbourhood for the exchange of values (null in serial)
+    std::unique_ptr<MPINeighborComm> _neighbors;
+
+    // Number of points not found in the assigning mesh
+    std::size_t _num_points_not_found;
+
+  };
+
+}
+
+#endif
@@ -17,7 +17,7 @@
 //
 //
 // First added:  2014-02-12
-// Last changed:
+// Last changed: 2015-01-22
 
 #ifndef __LAGRANGE_INTERPOLATOR_H
 #define __LAGRANGE_INTERPOLATOR_H
@@ -63,7 +63,8 @@ namespace dolfin
   class FunctionSpace;
 
   /// This class interpolates efficiently from a GenericFunction
-  /// to a Lagrange Function
+  /// to a Lagrange Function. For repeated interpolation between
+  /// Functions in the same function spaces, see InterpolationPlan.
 
   class LagrangeInterpolator
   {
@@ -89,12 +90,14 @@ namespace dolfin
 
   private:
 
+    friend class InterpolationPlan;
+
     // Create a map from coordinates to a list of dofs that share the coordinate
-    std::map<std::vector<double>, std::vector<std::size_t>, lt_coordinate >
+    static std::map<std::vector<double>, std::vector<std::size_t>, lt_coordinate >
       tabulate_coordinates_to_dofs(const GenericDofMap& dofmap, const Mesh& mesh);
 
     // Create a map from dof to its component index in Mixed Space
-    void extract_dof_component_map(std::unordered_map<std::size_t, std::size_t>&
+    static void extract_dof_component_map(std::unordered_map<std::size_t, std::size_t>&
       dof_component_map, const FunctionSpace& V, int* component);
 
     // Return true if point lies within bounding box
@@ -18,5 +18,6 @@
 #include <dolfin/function/FunctionAssigner.h>
 #include <dolfin/function/assign.h>
 #include <dolfin/function/LagrangeInterpolator.h>
+#include <dolfin/function/InterpolationPlan.h>
 
 #endif
@@ -19,17 +19,82 @@
 // Modified by Nuno Lopes, 2008.
 //
 // First added:  2005-12-02
-// Last changed: 2014-02-06
+// Last changed: 2015-01-22
 
+#include <vector>
 #include <dolfin/common/constants.h>
-#include <dolfin/common/MPI.h>
 #include <dolfin/common/Timer.h>
-#include <dolfin/mesh/MeshPartitioning.h>
-#include <dolfin/mesh/MeshEditor.h>
+#include "StructuredMeshBuilder.h"
 #include "BoxMesh.h"
 
 using namespace dolfin;
 
+namespace
+{
+  // Grid of nx x ny x nz boxes, each split into six tetrahedra
+  class BoxGrid : public StructuredMeshBuilder
+  {
+  public:
+
+    BoxGrid(double x0, double y0, double z0, double x1, double y1, double z1,
+            std::size_t nx, std::size_t ny, std::size_t nz)
+      : StructuredMeshBuilder({nx, ny, nz}), _x0(x0), _y0(y0), _z0(z0),
+        _x1(x1), _y1(y1), _z1(z1), _nx(nx), _ny(ny), _nz(nz) {}
+
+  protected:
+
+    std::size_t num_global_vertices() const
+    { return (_nx + 1)*(_ny + 1)*(_nz + 1); }
+
+    std::size_t num_box_cells() const
+    { return 6; }
+
+    void box_cells(const std::size_t* box, std::size_t* cell) const
+    {
+      const std::size_t v0 = box[2]*(_nx + 1)*(_ny + 1)
+        + box[1]*(_nx + 1) + box[0];
+      const std::size_t v1 = v0 + 1;
+      const std::size_t v2 = v0 + (_nx + 1);
+      const std::size_t v3 = v1 + (_nx + 1);
+      const std::size_t v4 = v0 + (_nx + 1)*(_ny + 1);
+      const std::size_t v5 = v1 + (_nx + 1)*(_ny + 1);
+      const std::size_t v6 = v2 + (_nx + 1)*(_ny + 1);
+      const std::size_t v7 = v3 + (_nx + 1)*(_ny + 1);
+
+      // Vertices are listed in increasing order (v0 < v1 < ... < v7)
+      cell[0]  = v0; cell[1]  = v1; cell[2]  = v3; cell[3]  = v7;
+      cell[4]  = v0; cell[5]  = v1; cell[6]  = v5; cell[7]  = v7;
+      cell[8]  = v0; cell[9]  = v4; cell[10] = v5; cell[11] = v7;
+      cell[12] = v0; cell[13] = v2; cell[14] = v3; cell[15] = v7;
+      cell[16] = v0; cell[17] = v4; cell[18] = v6; cell[19] = v7;
+      cell[20] = v0; cell[21] = v2; cell[22] = v6; cell[23] = v7;
+    }
+
+    void vertex_position(std::size_t v, std::size_t* X) const
+    {
+      X[0] = 2*(v % (_nx + 1));
+      X[1] = 2*((v/(_nx + 1)) % (_ny + 1));
+      X[2] = 2*(v/((_nx + 1)*(_ny + 1)));
+    }
+
+    void vertex_coordinates(std::size_t v, double* x) const
+    {
+      const std::size_t ix = v % (_nx + 1);
+      const std::size_t iy = (v/(_nx + 1)) % (_ny + 1);
+      const std::size_t iz = v/((_nx + 1)*(_ny + 1));
+      x[0] = _x0 + (static_cast<double>(ix))*(_x1 - _x0) / static_cast<double>(_nx);
+      x[1] = _y0 + (static_cast<double>(iy))*(_y1 - _y0) / static_cast<double>(_ny);
+      x[2] = _z0 + (static_cast<double>(iz))*(_z1 - _z0) / static_cast<double>(_nz);
+    }
+
+  private:
+
+    const double _x0, _y0, _z0, _x1, _y1, _z1;
+    const std::size_t _nx, _ny, _nz;
+
+  };
+}
+
 //-----------------------------------------------------------------------------
 BoxMesh::BoxMesh(double x0, double y0, double z0,
                  double x1, double y1, double z1,
@@ -54,20 +119,6 @@ void BoxMesh::build(double x0, double y0, double z0,
 {
   Timer timer("Generate Box mesh");
 
-  // Receive mesh according to parallel policy
-  if (MPI::is_receiver(this->mpi_comm()))
-  {
-    MeshPartitioning::build_distributed_mesh(*this);
-    return;
-  }
-
-  const double a = x0;
-  const double b = x1;
-  const double c = y0;
-  const double d = y1;
-  const double e = z0;
-  const double f = z1;
-
   if (std::abs(x0 - x1) < DOLFIN_EPS || std::abs(y0 - y1) < DOLFIN_EPS
       || std::abs(z0 - z1) < DOLFIN_EPS )
   {
@@ -85,74 +136,9 @@ void BoxMesh::build(double x0, double y0, double z0,
 
   rename("mesh", "Mesh of the cuboid (a,b) x (c,d) x (e,f)");
 
-  // Open mesh for editing
-  MeshEditor editor;
-  editor.open(*this, CellType::tetrahedron, 3, 3);
-
-  // Storage for vertex coordinates
-  std::vector<double> x(3);
-
-  // Create vertices
-  editor.init_vertices_global((nx + 1)*(ny + 1)*(nz + 1), (nx + 1)*(ny + 1)*(nz + 1));
-  std::size_t vertex = 0;
-  for (std::size_t iz = 0; iz <= nz; iz++)
-  {
-    x[2] = e + (static_cast<double>(iz))*(f-e) / static_cast<double>(nz);
-    for (std::size_t iy = 0; iy <= ny; iy++)
-    {
-      x[1] = c + (static_cast<double>(iy))*(d-c) / static_cast<double>(ny);
-      for (std::size_t ix = 0; ix <= nx; ix++)
-      {
-        x[0] = a + (static_cast<double>(ix))*(b-a) / static_cast<double>(nx);
-        editor.add_vertex(vertex, x);
-        vertex++;
-      }
-    }
-  }
-
-  // Create tetrahedra
-  editor.init_cells_global(6*nx*ny*nz, 6*nx*ny*nz);
-  std::size_t cell = 0;
-  std::vector<std::vector<std::size_t> > cells(6, std::vector<std::size_t>(4));
-  for (std::size_t iz = 0; iz < nz; iz++)
-  {
-    for (std::size_t iy = 0; iy < ny; iy++)
-    {
-      for (std::size_t ix = 0; ix < nx; ix++)
-      {
-        const std::size_t v0 = iz*(nx + 1)*(ny + 1) + iy*(nx + 1) + ix;
-        const std::size_t v1 = v0 + 1;
-        const std::size_t v2 = v0 + (nx + 1);
-        const std::size_t v3 = v1 + (nx + 1);
-        const std::size_t v4 = v0 + (nx + 1)*(ny + 1);
-        const std::size_t v5 = v1 + (nx + 1)*(ny + 1);
-        const std::size_t v6 = v2 + (nx + 1)*(ny + 1);
-        const std::size_t v7 = v3 + (nx + 1)*(ny + 1);
-
-        // Note that v0 < v1 < v2 < v3 < vmid.
-        cells[0][0] = v0; cells[0][1] = v1; cells[0][2] = v3; cells[0][3] = v7;
-        cells[1][0] = v0; cells[1][1] = v1; cells[1][2] = v7; cells[1][3] = v5;
-        cells[2][0] = v0; cells[2][1] = v5; cells[2][2] = v7; cells[2][3] = v4;
-        cells[3][0] = v0; cells[3][1] = v3; cells[3][2] = v2; cells[3][3] = v7;
-        cells[4][0] = v0; cells[4][1] = v6; cells[4][2] = v4; cells[4][3] = v7;
-        cells[5][0] = v0; cells[5][1] = v2; cells[5][2] = v6; cells[5][3] = v7;
-
-        // Add cells
-        std::vector<std::vector<std::size_t> >::const_iterator _cell;
-        for (_cell = cells.begin(); _cell != cells.end(); ++_cell)
-          editor.add_cell(cell++, *_cell);
-      }
-    }
-  }
-
-  // Close mesh editor
-  editor.close();
-
-  // Broadcast mesh according to parallel policy
-  if (MPI::is_broadcaster(this->mpi_comm()))
-  {
-    MeshPartitioning::build_distributed_mesh(*this);
-    return;
-  }
+  // Build mesh (in parallel, each process builds its own block of
+  // the mesh)
+  BoxGrid grid(x0, y0, z0, x1, y1, z1, nx, ny, nz);
+  grid.build(*this, CellType::tetrahedron);
 }
 //-----------------------------------------------------------------------------
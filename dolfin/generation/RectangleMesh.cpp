@@ -20,16 +20,126 @@
 // Modified by Kristian B. Oelgaard 2009.
 //
 // First added:  2005-12-02
-// Last changed: 2014-02-06
+// Last changed: 2015-01-22
 
 #include <dolfin/common/constants.h>
-#include <dolfin/common/MPI.h>
-#include <dolfin/mesh/MeshPartitioning.h>
-#include <dolfin/mesh/MeshEditor.h>
+#include "StructuredMeshBuilder.h"
 #include "RectangleMesh.h"
 
 using namespace dolfin;
 
+namespace
+{
+  // Grid of nx x ny rectangles, each split into two triangles (or
+  // four triangles around a midpoint vertex if crossed)
+  class RectangleGrid : public StructuredMeshBuilder
+  {
+  public:
+
+    RectangleGrid(double x0, double y0, double x1, double y1,
+                  std::size_t nx, std::size_t ny, std::string diagonal)
+      : StructuredMeshBuilder({nx, ny}), _x0(x0), _y0(y0), _x1(x1), _y1(y1),
+        _nx(nx), _ny(ny), _diagonal(diagonal) {}
+
+  protected:
+
+    std::size_t num_global_vertices() const
+    {
+      if (_diagonal == "crossed")
+        return (_nx + 1)*(_ny + 1) + _nx*_ny;
+      else
+        return (_nx + 1)*(_ny + 1);
+    }
+
+    std::size_t num_box_cells() const
+    { return _diagonal == "crossed" ? 4 : 2; }
+
+    void box_cells(const std::size_t* box, std::size_t* cell) const
+    {
+      const std::size_t ix = box[0];
+      const std::size_t iy = box[1];
+      const std::size_t v0 = iy*(_nx + 1) + ix;
+      const std::size_t v1 = v0 + 1;
+      const std::size_t v2 = v0 + (_nx + 1);
+      const std::size_t v3 = v1 + (_nx + 1);
+
+      if (_diagonal == "crossed")
+      {
+        // Note that v0 < v1 < v2 < v3 < vmid.
+        const std::size_t vmid = (_nx + 1)*(_ny + 1) + iy*_nx + ix;
+        cell[0] = v0; cell[1]  = v1; cell[2]  = vmid;
+        cell[3] = v0; cell[4]  = v2; cell[5]  = vmid;
+        cell[6] = v1; cell[7]  = v3; cell[8]  = vmid;
+        cell[9] = v2; cell[10] = v3; cell[11] = vmid;
+        return;
+      }
+
+      // Alternating diagonals start with "left" ("right/left") or
+      // "right" ("left/right") on even rows, and alternate between
+      // neighbouring rectangles within each row
+      bool left = (_diagonal == "left");
+      if (_diagonal == "right/left")
+        left = ((ix + iy) % 2 == 0);
+      else if (_diagonal == "left/right")
+        left = ((ix + iy) % 2 == 1);
+
+      if (left)
+      {
+        cell[0] = v0; cell[1] = v1; cell[2] = v2;
+        cell[3] = v1; cell[4] = v2; cell[5] = v3;
+      }
+      else
+      {
+        cell[0] = v0; cell[1] = v1; cell[2] = v3;
+        cell[3] = v0; cell[4] = v2; cell[5] = v3;
+      }
+    }
+
+    void vertex_position(std::size_t v, std::size_t* X) const
+    {
+      const std::size_t num_corners = (_nx + 1)*(_ny + 1);
+      if (v < num_corners)
+      {
+        X[0] = 2*(v % (_nx + 1));
+        X[1] = 2*(v/(_nx + 1));
+      }
+      else
+      {
+        // Midpoint vertex (crossed)
+        X[0] = 2*((v - num_corners) % _nx) + 1;
+        X[1] = 2*((v - num_corners)/_nx) + 1;
+      }
+    }
+
+    void vertex_coordinates(std::size_t v, double* x) const
+    {
+      const std::size_t num_corners = (_nx + 1)*(_ny + 1);
+      if (v < num_corners)
+      {
+        const std::size_t ix = v % (_nx + 1);
+        const std::size_t iy = v/(_nx + 1);
+        x[0] = _x0 + ((static_cast<double>(ix))*(_x1 - _x0)/static_cast<double>(_nx));
+        x[1] = _y0 + ((static_cast<double>(iy))*(_y1 - _y0)/static_cast<double>(_ny));
+      }
+      else
+      {
+        // Midpoint vertex (crossed)
+        const std::size_t ix = (v - num_corners) % _nx;
+        const std::size_t iy = (v - num_corners)/_nx;
+        x[0] = _x0 + (static_cast<double>(ix) + 0.5)*(_x1 - _x0)/ static_cast<double>(_nx);
+        x[1] = _y0 + (static_cast<double>(iy) + 0.5)*(_y1 - _y0)/ static_cast<double>(_ny);
+      }
+    }
+
+  private:
+
+    const double _x0, _y0, _x1, _y1;
+    const std::size_t _nx, _ny;
+    const std::string _diagonal;
+
+  };
+}
+
 //-----------------------------------------------------------------------------
 RectangleMesh::RectangleMesh(double x0, double y0, double x1, double y1,
                              std::size_t nx, std::size_t ny,
@@ -50,13 +160,6 @@ void RectangleMesh::build(double x0, double y0, double x1, double y1,
                           std::size_t nx, std::size_t ny,
                           std::string diagonal)
 {
-  // Receive mesh according to parallel policy
-  if (MPI::is_receiver(this->mpi_comm()))
-  {
-    MeshPartitioning::build_distributed_mesh(*this);
-    return;
-  }
-
   // Check options
   if (diagonal != "left" && diagonal != "right" && diagonal != "right/left"
           && diagonal != "left/right" && diagonal != "crossed")
@@ -66,11 +169,6 @@ void RectangleMesh::build(double x0, double y0, double x1, double y1,
                  "Unknown mesh diagonal definition: allowed options are \"left\", \"right\", \"left/right\", \"right/left\" and \"crossed\"");
   }
 
-  const double a = x0;
-  const double b = x1;
-  const double c = y0;
-  const double d = y1;
-
   if (std::abs(x0 - x1) < DOLFIN_EPS || std::abs(y0 - y1) < DOLFIN_EPS)
   {
     dolfin_error("Rectangle.cpp",
@@ -86,141 +184,10 @@ void RectangleMesh::build(double x0, double y0, double x1, double y1,
   }
 
   rename("mesh", "Mesh of the unit square (a,b) x (c,d)");
-  // Open mesh for editing
-  MeshEditor editor;
-  editor.open(*this, CellType::triangle, 2, 2);
-
-  // Create vertices and cells:
-  if (diagonal == "crossed")
-  {
-    editor.init_vertices_global((nx + 1)*(ny + 1) + nx*ny, (nx + 1)*(ny + 1) + nx*ny);
-    editor.init_cells_global(4*nx*ny, 4*nx*ny);
-  }
-  else
-  {
-    editor.init_vertices_global((nx + 1)*(ny + 1), (nx + 1)*(ny + 1));
-    editor.init_cells_global(2*nx*ny, 2*nx*ny);
-  }
-
-  // Storage for vertices
-  std::vector<double> x(2);
-
-  // Create main vertices:
-  std::size_t vertex = 0;
-  for (std::size_t iy = 0; iy <= ny; iy++)
-  {
-    x[1] = c + ((static_cast<double>(iy))*(d - c)/static_cast<double>(ny));
-    for (std::size_t ix = 0; ix <= nx; ix++)
-    {
-      x[0] = a + ((static_cast<double>(ix))*(b - a)/static_cast<double>(nx));
-      editor.add_vertex(vertex, x);
-      vertex++;
-    }
-  }
-
-  // Create midpoint vertices if the mesh type is crossed
-  if (diagonal == "crossed")
-  {
-    for (std::size_t iy = 0; iy < ny; iy++)
-    {
-      x[1] = c +(static_cast<double>(iy) + 0.5)*(d - c)/ static_cast<double>(ny);
-      for (std::size_t ix = 0; ix < nx; ix++)
-      {
-        x[0] = a + (static_cast<double>(ix) + 0.5)*(b - a)/ static_cast<double>(nx);
-        editor.add_vertex(vertex, x);
-        vertex++;
-      }
-    }
-  }
-
-  // Create triangles
-  std::size_t cell = 0;
-  if (diagonal == "crossed")
-  {
-    std::vector<std::vector<std::size_t> >
-      cells(4, std::vector<std::size_t>(3));
-    for (std::size_t iy = 0; iy < ny; iy++)
-    {
-      for (std::size_t ix = 0; ix < nx; ix++)
-      {
-        const std::size_t v0 = iy*(nx + 1) + ix;
-        const std::size_t v1 = v0 + 1;
-        const std::size_t v2 = v0 + (nx + 1);
-        const std::size_t v3 = v1 + (nx + 1);
-        const std::size_t vmid = (nx + 1)*(ny + 1) + iy*nx + ix;
 
-        // Note that v0 < v1 < v2 < v3 < vmid.
-        cells[0][0] = v0; cells[0][1] = v1; cells[0][2] = vmid;
-        cells[1][0] = v0; cells[1][1] = v2; cells[1][2] = vmid;
-        cells[2][0] = v1; cells[2][1] = v3; cells[2][2] = vmid;
-        cells[3][0] = v2; cells[3][1] = v3; cells[3][2] = vmid;
-
-        // Add cells
-        std::vector<std::vector<std::size_t> >::const_iterator _cell;
-        for (_cell = cells.begin(); _cell != cells.end(); ++_cell)
-          editor.add_cell(cell++, *_cell);
-      }
-    }
-  }
-  else if (diagonal == "left" || diagonal == "right" || diagonal == "right/left" || diagonal == "left/right")
-  {
-    std::string local_diagonal = diagonal;
-    std::vector<std::vector<std::size_t> >
-      cells(2, std::vector<std::size_t>(3));
-    for (std::size_t iy = 0; iy < ny; iy++)
-    {
-      // Set up alternating diagonal
-      if (diagonal == "right/left")
-      {
-        if (iy % 2)
-          local_diagonal = "right";
-        else
-          local_diagonal = "left";
-      }
-      if (diagonal == "left/right")
-      {
-        if (iy % 2)
-          local_diagonal = "left";
-        else
-          local_diagonal = "right";
-      }
-
-      for (std::size_t ix = 0; ix < nx; ix++)
-      {
-        const std::size_t v0 = iy*(nx + 1) + ix;
-        const std::size_t v1 = v0 + 1;
-        const std::size_t v2 = v0 + (nx + 1);
-        const std::size_t v3 = v1 + (nx + 1);
-        std::vector<std::size_t> cell_data;
-
-        if(local_diagonal == "left")
-        {
-          cells[0][0] = v0; cells[0][1] = v1; cells[0][2] = v2;
-          cells[1][0] = v1; cells[1][1] = v2; cells[1][2] = v3;
-          if (diagonal == "right/left" || diagonal == "left/right")
-            local_diagonal = "right";
-        }
-        else
-        {
-          cells[0][0] = v0; cells[0][1] = v1; cells[0][2] = v3;
-          cells[1][0] = v0; cells[1][1] = v2; cells[1][2] = v3;
-          if (diagonal == "right/left" || diagonal == "left/right")
-            local_diagonal = "left";
-        }
-        editor.add_cell(cell++, cells[0]);
-        editor.add_cell(cell++, cells[1]);
-      }
-    }
-  }
-
-  // Close mesh editor
-  editor.close();
-
-  // Broadcast mesh according to parallel policy
-  if (MPI::is_broadcaster(this->mpi_comm()))
-  {
-    MeshPartitioning::build_distributed_mesh(*this);
-    return;
-  }
+  // Build mesh (in parallel, each process builds its own block of
+  // the mesh)
+  RectangleGrid grid(x0, y0, x1, y1, nx, ny, diagonal);
+  grid.build(*this, CellType::triangle);
 }
 //-----------------------------------------------------------------------------
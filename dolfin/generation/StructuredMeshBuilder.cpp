@@ -0,0 +1,532 @@
+// Copyright (C) 2015 The FEniCS Project
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2015-01-22
+// Last changed: 2015-01-22
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <dolfin/common/MPI.h>
+#include <dolfin/log/log.h>
+#include <dolfin/mesh/DistributedMeshTools.h>
+#include <dolfin/mesh/Mesh.h>
+#include <dolfin/mesh/MeshEditor.h>
+#include <dolfin/mesh/MeshPartitioning.h>
+#include <dolfin/mesh/MeshTopology.h>
+#include <dolfin/parameter/GlobalParameters.h>
+#include "StructuredMeshBuilder.h"
+
+using namespace dolfin;
+
+//-----------------------------------------------------------------------------
+StructuredMeshBuilder::StructuredMeshBuilder(
+  const std::vector<std::size_t>& num_boxes)
+  : _dim(num_boxes.size()), _num_boxes(num_boxes)
+{
+  dolfin_assert(_dim >= 1 && _dim <= 3);
+  _num_boxes.resize(3, 1);
+}
+//-----------------------------------------------------------------------------
+void StructuredMeshBuilder::build(Mesh& mesh, CellType::Type cell_type)
+{
+  const std::size_t num_processes = MPI::size(mesh.mpi_comm());
+  const std::string partitioning
+    = parameters["structured_mesh_partitioning"];
+
+  // Build blocks directly on each process, unless the mesh
+  // partitioner has been requested, more than one layer of ghost
+  // cells is needed or the grid is too small to give each process a
+  // block
+  const std::string ghost_mode = parameters["ghost_mode"];
+  const std::size_t num_ghost_layers = parameters["ghost_layers"];
+  std::vector<std::size_t> process_grid;
+  if (num_processes > 1 && partitioning == "blocks"
+      && (ghost_mode == "none" || num_ghost_layers == 1)
+      && compute_process_grid(process_grid, num_processes))
+  {
+    build_blocks(mesh, cell_type, process_grid);
+  }
+  else
+    build_serial(mesh, cell_type);
+}
+//-----------------------------------------------------------------------------
+void StructuredMeshBuilder::build_serial(Mesh& mesh,
+                                         CellType::Type cell_type) const
+{
+  // Receive mesh according to parallel policy
+  if (MPI::is_receiver(mesh.mpi_comm()))
+  {
+    MeshPartitioning::build_distributed_mesh(mesh);
+    return;
+  }
+
+  const std::size_t num_vertices = num_global_vertices();
+  const std::size_t num_box_cells = this->num_box_cells();
+  const std::size_t num_cell_vertices = _dim + 1;
+  const std::size_t* n = _num_boxes.data();
+
+  // Open mesh for editing
+  MeshEditor editor;
+  editor.open(mesh, cell_type, _dim, _dim);
+
+  // Create vertices
+  std::vector<double> x(_dim*num_vertices);
+  for (std::size_t v = 0; v < num_vertices; ++v)
+    vertex_coordinates(v, &x[v*_dim]);
+  editor.set_vertices(x);
+
+  // Create cells, with vertices listed in increasing order so that
+  // the mesh need not be sorted on close
+  const std::size_t num_box_vertices = num_box_cells*num_cell_vertices;
+  std::vector<std::size_t> box_cells(num_box_vertices);
+  std::vector<unsigned int> cells(n[0]*n[1]*n[2]*num_box_vertices);
+  unsigned int* cell = cells.data();
+  std::size_t box[3];
+  for (box[2] = 0; box[2] < n[2]; ++box[2])
+  {
+    for (box[1] = 0; box[1] < n[1]; ++box[1])
+    {
+      for (box[0] = 0; box[0] < n[0]; ++box[0])
+      {
+        this->box_cells(box, box_cells.data());
+        for (std::size_t k = 0; k < num_box_cells; ++k)
+        {
+          std::sort(box_cells.begin() + k*num_cell_vertices,
+                    box_cells.begin() + (k + 1)*num_cell_vertices);
+        }
+        std::copy(box_cells.begin(), box_cells.end(), cell);
+        cell += num_box_vertices;
+      }
+    }
+  }
+  editor.set_cells(cells);
+
+  // Close mesh editor
+  editor.close();
+
+  // Broadcast mesh according to parallel policy
+  if (MPI::is_broadcaster(mesh.mpi_comm()))
+    MeshPartitioning::build_distributed_mesh(mesh);
+}
+//-----------------------------------------------------------------------------
+void StructuredMeshBuilder::build_blocks(Mesh& mesh,
+                                         CellType::Type cell_type,
+                              const std::vector<std::size_t>& process_grid)
+{
+  const unsigned int process_number = MPI::rank(mesh.mpi_comm());
+  const std::size_t num_box_cells = this->num_box_cells();
+  const std::size_t num_cell_vertices = _dim + 1;
+  const std::size_t num_box_vertices = num_box_cells*num_cell_vertices;
+  const std::size_t* n = _num_boxes.data();
+
+  // Number of vertices a cell must have in the (closed) block of a
+  // process to be a ghost cell on that process
+  const std::string ghost_mode = parameters["ghost_mode"];
+  std::size_t ghost_threshold = 0;
+  if (ghost_mode == "shared_vertex")
+    ghost_threshold = 1;
+  else if (ghost_mode == "shared_facet")
+    ghost_threshold = _dim;
+
+  // Compute blocks in each direction
+  _process_grid = process_grid;
+  _process_grid.resize(3, 1);
+  _block_offsets.resize(3);
+  _box_block.resize(3);
+  for (std::size_t d = 0; d < 3; ++d)
+  {
+    const std::size_t num_blocks = _process_grid[d];
+    _block_offsets[d].resize(num_blocks + 1);
+    _box_block[d].resize(n[d]);
+    for (std::size_t k = 0; k < num_blocks; ++k)
+    {
+      const std::pair<std::size_t, std::size_t> range
+        = MPI::compute_local_range(k, n[d], num_blocks);
+      _block_offsets[d][k] = range.first;
+      std::fill(_box_block[d].begin() + range.first,
+                _box_block[d].begin() + range.second, k);
+    }
+    _block_offsets[d][num_blocks] = n[d];
+  }
+
+  // Block of this process, and range of boxes holding its regular
+  // and ghost cells
+  const std::size_t block[3]
+    = {process_number % _process_grid[0],
+       (process_number/_process_grid[0]) % _process_grid[1],
+       process_number/(_process_grid[0]*_process_grid[1])};
+  std::size_t lo[3], hi[3], lo_ghost[3], hi_ghost[3];
+  for (std::size_t d = 0; d < 3; ++d)
+  {
+    lo[d] = _block_offsets[d][block[d]];
+    hi[d] = _block_offsets[d][block[d] + 1];
+    lo_ghost[d] = (ghost_threshold > 0 && lo[d] > 0) ? lo[d] - 1 : lo[d];
+    hi_ghost[d] = (ghost_threshold > 0 && hi[d] < n[d]) ? hi[d] + 1 : hi[d];
+  }
+
+  // Compute cells (global vertex indices), regular cells first
+  std::vector<std::size_t> regular_cells, ghost_cells;
+  std::vector<std::size_t> regular_cell_indices, ghost_cell_indices;
+  std::vector<unsigned int> ghost_owners;
+  std::map<unsigned int, std::set<unsigned int> > shared_cells;
+  std::vector<std::set<unsigned int> > ghost_sharing;
+  std::vector<std::size_t> box_cells(num_box_vertices);
+  std::vector<unsigned int> candidates;
+  std::set<unsigned int> processes;
+  std::size_t box[3];
+  for (box[2] = lo_ghost[2]; box[2] < hi_ghost[2]; ++box[2])
+  {
+    for (box[1] = lo_ghost[1]; box[1] < hi_ghost[1]; ++box[1])
+    {
+      for (box[0] = lo_ghost[0]; box[0] < hi_ghost[0]; ++box[0])
+      {
+        const unsigned int owner = box_process(box);
+        const std::size_t box_index = box[0] + n[0]*(box[1] + n[1]*box[2]);
+
+        this->box_cells(box, box_cells.data());
+        for (std::size_t k = 0; k < num_box_cells; ++k)
+        {
+          std::sort(box_cells.begin() + k*num_cell_vertices,
+                    box_cells.begin() + (k + 1)*num_cell_vertices);
+        }
+
+        if (owner == process_number)
+        {
+          // Only cells in boxes on the boundary of the block can be
+          // ghost cells on other processes
+          bool shared = false;
+          for (std::size_t d = 0; d < 3; ++d)
+          {
+            if (ghost_threshold > 0
+                && ((box[d] == lo[d] && lo[d] > 0)
+                    || (box[d] + 1 == hi[d] && hi[d] < n[d])))
+            {
+              shared = true;
+            }
+          }
+          if (shared)
+            neighbour_processes(candidates, box);
+
+          for (std::size_t k = 0; k < num_box_cells; ++k)
+          {
+            const std::size_t* cell = &box_cells[k*num_cell_vertices];
+            if (shared)
+            {
+              processes.clear();
+              cell_processes(processes, owner, candidates, cell,
+                             ghost_threshold);
+              processes.erase(process_number);
+              if (!processes.empty())
+                shared_cells[regular_cell_indices.size()] = processes;
+            }
+            regular_cell_indices.push_back(box_index*num_box_cells + k);
+            regular_cells.insert(regular_cells.end(), cell,
+                                 cell + num_cell_vertices);
+          }
+        }
+        else
+        {
+          bool have_candidates = false;
+          for (std::size_t k = 0; k < num_box_cells; ++k)
+          {
+            const std::size_t* cell = &box_cells[k*num_cell_vertices];
+            if (num_block_vertices(process_number, cell) < ghost_threshold)
+              continue;
+
+            if (!have_candidates)
+            {
+              neighbour_processes(candidates, box);
+              have_candidates = true;
+            }
+            processes.clear();
+            cell_processes(processes, owner, candidates, cell,
+                           ghost_threshold);
+            processes.erase(process_number);
+            ghost_sharing.push_back(processes);
+            ghost_owners.push_back(owner);
+            ghost_cell_indices.push_back(box_index*num_box_cells + k);
+            ghost_cells.insert(ghost_cells.end(), cell,
+                               cell + num_cell_vertices);
+          }
+        }
+      }
+    }
+  }
+
+  // Compute vertices (global indices), with vertices of regular
+  // cells first and the remaining vertices of ghost cells at the end
+  std::vector<std::size_t> vertex_indices(regular_cells);
+  std::sort(vertex_indices.begin(), vertex_indices.end());
+  vertex_indices.erase(std::unique(vertex_indices.begin(),
+                                   vertex_indices.end()),
+                       vertex_indices.end());
+  const std::size_t num_regular_vertices = vertex_indices.size();
+  std::vector<std::size_t> ghost_vertices(ghost_cells);
+  std::sort(ghost_vertices.begin(), ghost_vertices.end());
+  ghost_vertices.erase(std::unique(ghost_vertices.begin(),
+                                   ghost_vertices.end()),
+                       ghost_vertices.end());
+  ghost_vertices.erase(std::set_difference(ghost_vertices.begin(),
+                                           ghost_vertices.end(),
+                                           vertex_indices.begin(),
+                                           vertex_indices.end(),
+                                           ghost_vertices.begin()),
+                       ghost_vertices.end());
+  vertex_indices.insert(vertex_indices.end(), ghost_vertices.begin(),
+                        ghost_vertices.end());
+  const std::size_t num_local_vertices = vertex_indices.size();
+
+  std::unordered_map<std::size_t, unsigned int> vertex_global_to_local;
+  vertex_global_to_local.reserve(num_local_vertices);
+  for (std::size_t i = 0; i < num_local_vertices; ++i)
+    vertex_global_to_local[vertex_indices[i]] = i;
+
+  // Compute vertex coordinates
+  std::vector<double> x(_dim*num_local_vertices);
+  for (std::size_t i = 0; i < num_local_vertices; ++i)
+    vertex_coordinates(vertex_indices[i], &x[i*_dim]);
+
+  // Compute shared vertices: a vertex is stored on the processes
+  // storing any of the cells (in the boxes touching the vertex) that
+  // contain it
+  std::map<unsigned int, std::set<unsigned int> > shared_vertices;
+  const std::size_t reach = ghost_threshold > 0 ? 1 : 0;
+  for (std::size_t i = 0; i < num_local_vertices; ++i)
+  {
+    const std::size_t v = vertex_indices[i];
+    std::size_t X[3] = {0, 0, 0};
+    vertex_position(v, X);
+
+    // Compute range of boxes touching vertex, and skip vertices
+    // whose cells cannot be stored on other processes
+    std::size_t box0[3], box1[3];
+    bool local = true;
+    for (std::size_t d = 0; d < 3; ++d)
+    {
+      if (X[d] % 2 == 1)
+        box0[d] = box1[d] = X[d]/2;
+      else
+      {
+        box0[d] = X[d] > 0 ? X[d]/2 - 1 : 0;
+        box1[d] = std::min(X[d]/2, n[d] - 1);
+      }
+
+      const std::size_t b0 = box0[d] >= reach ? box0[d] - reach : 0;
+      const std::size_t b1 = std::min(box1[d] + reach, n[d] - 1);
+      if (_box_block[d][b0] != block[d] || _box_block[d][b1] != block[d])
+        local = false;
+    }
+    if (local)
+      continue;
+
+    processes.clear();
+    for (box[2] = box0[2]; box[2] <= box1[2]; ++box[2])
+    {
+      for (box[1] = box0[1]; box[1] <= box1[1]; ++box[1])
+      {
+        for (box[0] = box0[0]; box[0] <= box1[0]; ++box[0])
+        {
+          const unsigned int owner = box_process(box);
+          if (ghost_threshold > 0)
+            neighbour_processes(candidates, box);
+          this->box_cells(box, box_cells.data());
+          for (std::size_t k = 0; k < num_box_cells; ++k)
+          {
+            const std::size_t* cell = &box_cells[k*num_cell_vertices];
+            if (std::find(cell, cell + num_cell_vertices, v)
+                == cell + num_cell_vertices)
+            {
+              continue;
+            }
+            processes.insert(owner);
+            if (ghost_threshold > 0)
+            {
+              cell_processes(processes, owner, candidates, cell,
+                             ghost_threshold);
+            }
+          }
+        }
+      }
+    }
+    processes.erase(process_number);
+    if (!processes.empty())
+      shared_vertices[i] = processes;
+  }
+
+  // Compute cells (local vertex indices) and global cell indices
+  const std::size_t num_regular_cells = regular_cell_indices.size();
+  std::vector<unsigned int> cells(regular_cells.size() + ghost_cells.size());
+  for (std::size_t i = 0; i < regular_cells.size(); ++i)
+    cells[i] = vertex_global_to_local[regular_cells[i]];
+  for (std::size_t i = 0; i < ghost_cells.size(); ++i)
+  {
+    cells[regular_cells.size() + i]
+      = vertex_global_to_local[ghost_cells[i]];
+  }
+  std::vector<std::size_t> cell_indices(regular_cell_indices);
+  cell_indices.insert(cell_indices.end(), ghost_cell_indices.begin(),
+                      ghost_cell_indices.end());
+  for (std::size_t i = 0; i < ghost_sharing.size(); ++i)
+    shared_cells[num_regular_cells + i] = ghost_sharing[i];
+
+  // Build local mesh. Cell vertices are sorted by global index, so
+  // the mesh is ordered and need not be sorted on close.
+  MeshEditor editor;
+  editor.open(mesh, cell_type, _dim, _dim);
+  editor.set_vertices_global(x, vertex_indices, num_global_vertices());
+  editor.set_cells_global(cells, cell_indices,
+                          n[0]*n[1]*n[2]*num_box_cells);
+  editor.close();
+
+  // Set ghost cell ownership, ghost offsets and shared entities
+  MeshTopology& topology = mesh.topology();
+  topology.cell_owner() = ghost_owners;
+  topology.init_ghost(_dim, num_regular_cells);
+  topology.init_ghost(0, num_regular_vertices);
+  topology.shared_entities(_dim) = shared_cells;
+  topology.shared_entities(0) = shared_vertices;
+
+  // Initialise number of globally connected cells to each facet
+  DistributedMeshTools::init_facet_cell_connections(mesh);
+}
+//-----------------------------------------------------------------------------
+bool StructuredMeshBuilder::compute_process_grid(
+  std::vector<std::size_t>& process_grid, std::size_t num_processes) const
+{
+  const std::size_t* n = _num_boxes.data();
+
+  // Iterate over factorisations p0*p1*p2 = num_processes, keeping the
+  // one with the smallest interface area between blocks (directions
+  // beyond the dimension of the grid have a single box and hence
+  // one block)
+  bool found = false;
+  double min_area = 0.0;
+  for (std::size_t p0 = 1; p0 <= num_processes; ++p0)
+  {
+    if (num_processes % p0 != 0)
+      continue;
+    for (std::size_t p1 = 1; p1 <= num_processes/p0; ++p1)
+    {
+      if ((num_processes/p0) % p1 != 0)
+        continue;
+
+      const std::size_t p[3] = {p0, p1, num_processes/(p0*p1)};
+      if (p[0] > n[0] || p[1] > n[1] || p[2] > n[2])
+        continue;
+
+      double area = 0.0;
+      for (std::size_t d = 0; d < 3; ++d)
+      {
+        area += static_cast<double>(p[d] - 1)*static_cast<double>(n[0])
+          *static_cast<double>(n[1])*static_cast<double>(n[2])
+          /static_cast<double>(n[d]);
+      }
+
+      if (!found || area < min_area)
+      {
+        process_grid.assign(p, p + _dim);
+        min_area = area;
+        found = true;
+      }
+    }
+  }
+
+  return found;
+}
+//-----------------------------------------------------------------------------
+void StructuredMeshBuilder::cell_processes(std::set<unsigned int>& processes,
+                                unsigned int owner,
+                                const std::vector<unsigned int>& candidates,
+                                const std::size_t* cell_vertices,
+                                std::size_t ghost_threshold) const
+{
+  processes.insert(owner);
+  for (std::size_t i = 0; i < candidates.size(); ++i)
+  {
+    if (candidates[i] != owner
+        && num_block_vertices(candidates[i], cell_vertices) >= ghost_threshold)
+    {
+      processes.insert(candidates[i]);
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+void
+StructuredMeshBuilder::neighbour_processes(std::vector<unsigned int>& processes,
+                                           const std::size_t* box) const
+{
+  // Compute range of blocks containing the neighbours of the box in
+  // each direction
+  std::size_t b0[3], b1[3];
+  for (std::size_t d = 0; d < 3; ++d)
+  {
+    b0[d] = _box_block[d][box[d] > 0 ? box[d] - 1 : 0];
+    b1[d] = _box_block[d][std::min(box[d] + 1, _num_boxes[d] - 1)];
+  }
+
+  processes.clear();
+  for (std::size_t k2 = b0[2]; k2 <= b1[2]; ++k2)
+  {
+    for (std::size_t k1 = b0[1]; k1 <= b1[1]; ++k1)
+    {
+      for (std::size_t k0 = b0[0]; k0 <= b1[0]; ++k0)
+        processes.push_back(k0 + _process_grid[0]*(k1 + _process_grid[1]*k2));
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+std::size_t
+StructuredMeshBuilder::num_block_vertices(unsigned int process,
+                                   const std::size_t* cell_vertices) const
+{
+  // Range of vertex positions (in half boxes) in block of process
+  const std::size_t block[3]
+    = {process % _process_grid[0],
+       (process/_process_grid[0]) % _process_grid[1],
+       process/(_process_grid[0]*_process_grid[1])};
+
+  std::size_t count = 0;
+  for (std::size_t i = 0; i <= _dim; ++i)
+  {
+    std::size_t X[3] = {0, 0, 0};
+    vertex_position(cell_vertices[i], X);
+
+    bool inside = true;
+    for (std::size_t d = 0; d < _dim; ++d)
+    {
+      if (X[d] < 2*_block_offsets[d][block[d]]
+          || X[d] > 2*_block_offsets[d][block[d] + 1])
+      {
+        inside = false;
+      }
+    }
+    if (inside)
+      ++count;
+  }
+
+  return count;
+}
+//-----------------------------------------------------------------------------
+unsigned int StructuredMeshBuilder::box_process(const std::size_t* box) const
+{
+  return _box_block[0][box[0]]
+    + _process_grid[0]*(_box_block[1][box[1]]
+                        + _process_grid[1]*_box_block[2][box[2]]);
+}
+//-----------------------------------------------------------------------------
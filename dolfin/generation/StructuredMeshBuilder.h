@@ -0,0 +1,148 @@
+// Copyright (C) 2015 The FEniCS Project
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2015-01-22
+// Last changed: 2015-01-22
+
+#ifndef __STRUCTURED_MESH_BUILDER_H
+#define __STRUCTURED_MESH_BUILDER_H
+
+#include <cstddef>
+#include <set>
+#include <vector>
+#include <dolfin/mesh/CellType.h>
+
+namespace dolfin
+{
+
+  class Mesh;
+
+  /// This class builds simplicial meshes of a structured grid of
+  /// boxes (intervals, rectangles or hexahedra), each of which is
+  /// split into the same number of cells. It is used by the built-in
+  /// mesh generators (RectangleMesh, BoxMesh).
+  ///
+  /// In parallel, the boxes are split into a logical grid of blocks,
+  /// one per process, and each process generates its own cells,
+  /// ghost cells and shared vertices directly from index arithmetic.
+  /// No mesh is built in serial and no partitioner is called, so the
+  /// time spent per process does not grow with the number of
+  /// processes. The old behaviour (build on process 0 and distribute
+  /// using the mesh partitioner) is selected by setting the global
+  /// parameter "structured_mesh_partitioning" to "partitioner". It
+  /// is also used when more than one layer of ghost cells is
+  /// requested (global parameter "ghost_layers").
+  ///
+  /// A grid is described by the number of boxes in each direction
+  /// and the number of cells per box. Global cell indices follow the
+  /// boxes in lexicographic order (x fastest), with the cells of
+  /// each box numbered consecutively. Subclasses give the vertices of
+  /// the cells in each box as global vertex indices, the position of
+  /// each vertex in the grid and its coordinates.
+
+  class StructuredMeshBuilder
+  {
+  public:
+
+    /// Create builder for grid with given number of boxes in each
+    /// direction (the length gives the topological and geometric
+    /// dimension)
+    StructuredMeshBuilder(const std::vector<std::size_t>& num_boxes);
+
+    /// Destructor
+    virtual ~StructuredMeshBuilder() {}
+
+    /// Build mesh with given cell type
+    void build(Mesh& mesh, CellType::Type cell_type);
+
+  protected:
+
+    /// Return number of vertices in grid
+    virtual std::size_t num_global_vertices() const = 0;
+
+    /// Return number of cells in each box
+    virtual std::size_t num_box_cells() const = 0;
+
+    /// Compute global vertex indices of the cells in given box,
+    /// stored consecutively (cells need not be sorted)
+    virtual void box_cells(const std::size_t* box,
+                           std::size_t* cells) const = 0;
+
+    /// Compute position of vertex in units of half a box (corners of
+    /// boxes are even, midpoints of boxes odd)
+    virtual void vertex_position(std::size_t v, std::size_t* X) const = 0;
+
+    /// Compute coordinates of vertex
+    virtual void vertex_coordinates(std::size_t v, double* x) const = 0;
+
+  private:
+
+    // Build mesh on process 0 and distribute it using the mesh
+    // partitioner
+    void build_serial(Mesh& mesh, CellType::Type cell_type) const;
+
+    // Build local block of distributed mesh on a grid of processes
+    void build_blocks(Mesh& mesh, CellType::Type cell_type,
+                      const std::vector<std::size_t>& process_grid);
+
+    // Compute grid of processes (the factorisation of num_processes
+    // which minimises the area of the interfaces between blocks).
+    // Returns false if no grid has at least one box per block in
+    // each direction.
+    bool compute_process_grid(std::vector<std::size_t>& process_grid,
+                              std::size_t num_processes) const;
+
+    // Add processes which store a cell (as a regular or ghost
+    // cell), given the process that owns it, candidate processes and
+    // the number of cell vertices a process must have in its block
+    // to store the cell as a ghost
+    void cell_processes(std::set<unsigned int>& processes,
+                        unsigned int owner,
+                        const std::vector<unsigned int>& candidates,
+                        const std::size_t* cell_vertices,
+                        std::size_t ghost_threshold) const;
+
+    // Compute processes whose blocks contain or neighbour given box
+    void neighbour_processes(std::vector<unsigned int>& processes,
+                             const std::size_t* box) const;
+
+    // Count vertices in (closed) block of given process
+    std::size_t num_block_vertices(unsigned int process,
+                                   const std::size_t* cell_vertices) const;
+
+    // Return process owning box
+    unsigned int box_process(const std::size_t* box) const;
+
+    // Topological dimension
+    const std::size_t _dim;
+
+    // Number of boxes in each direction (padded to three directions)
+    std::vector<std::size_t> _num_boxes;
+
+    // Grid of processes and first box of each block in each
+    // direction (padded to three directions)
+    std::vector<std::size_t> _process_grid;
+    std::vector<std::vector<std::size_t> > _block_offsets;
+
+    // Block index of each box in each direction
+    std::vector<std::vector<std::size_t> > _box_block;
+
+  };
+
+}
+
+#endif
@@ -16,7 +16,7 @@
 // along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 //
 // First added:  2013-04-09
-// Last changed: 2014-05-12
+// Last changed: 2015-01-22
 
 #include <dolfin/common/NoDeleter.h>
 #include <dolfin/geometry/Point.h>
@@ -30,7 +30,8 @@
 using namespace dolfin;
 
 //-----------------------------------------------------------------------------
-BoundingBoxTree::BoundingBoxTree() : _mesh(0)
+BoundingBoxTree::BoundingBoxTree() : MemoryTracked("Bounding box trees"),
+                                     _mesh(0)
 {
   // Do nothing
 }
@@ -205,6 +206,11 @@ bool BoundingBoxTree::collides_entity(const Point& point) const
   return compute_first_entity_collision(point) != std::numeric_limits<unsigned int>::max();
 }
 //-----------------------------------------------------------------------------
+std::size_t BoundingBoxTree::memory_usage() const
+{
+  return sizeof(*this) + (_tree ? _tree->memory_usage() : 0);
+}
+//-----------------------------------------------------------------------------
 void BoundingBoxTree::_check_built() const
 {
   if (!_tree)
@@ -16,7 +16,7 @@
 // along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 //
 // First added:  2013-04-09
-// Last changed: 2014-05-12
+// Last changed: 2015-01-22
 
 #ifndef __BOUNDING_BOX_TREE_H
 #define __BOUNDING_BOX_TREE_H
@@ -24,6 +24,7 @@
 #include <limits>
 #include <vector>
 #include <memory>
+#include <dolfin/common/MemoryTracked.h>
 
 namespace dolfin
 {
@@ -37,7 +38,7 @@ namespace dolfin
   /// tree (AABB tree). Bounding box trees can be created from meshes
   /// and [other data structures, to be filled in].
 
-  class BoundingBoxTree
+  class BoundingBoxTree : public MemoryTracked
   {
   public:
 
@@ -244,6 +245,13 @@ namespace dolfin
     ///         True iff the point is inside the tree.
     bool collides_entity(const Point& point) const;
 
+    /// Return number of bytes used by the bounding box tree
+    ///
+    /// *Returns*
+    ///     std::size_t
+    ///         The number of bytes.
+    std::size_t memory_usage() const;
+
   private:
 
     // Check that tree has been built
@@ -16,7 +16,7 @@
 // along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 //
 // First added:  2013-05-02
-// Last changed: 2014-02-06
+// Last changed: 2015-01-22
 
 // Define a maximum dimension used for a local array in the recursive
 // build function. Speeds things up compared to allocating it in each
@@ -254,6 +254,16 @@ GenericBoundingBoxTree::compute_closest_point(const Point& point) const
 //-----------------------------------------------------------------------------
 // Implementation of protected functions
 //-----------------------------------------------------------------------------
+std::size_t GenericBoundingBoxTree::memory_usage() const
+{
+  std::size_t bytes = sizeof(*this)
+    + _bboxes.capacity()*sizeof(BBox)
+    + _bbox_coordinates.capacity()*sizeof(double);
+  if (_point_search_tree)
+    bytes += _point_search_tree->memory_usage();
+  return bytes;
+}
+//-----------------------------------------------------------------------------
 void GenericBoundingBoxTree::clear()
 {
   _tdim = 0;
@@ -16,7 +16,7 @@
 // along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 //
 // First added:  2013-04-23
-// Last changed: 2014-02-06
+// Last changed: 2015-01-22
 
 #ifndef __GENERIC_BOUNDING_BOX_TREE_H
 #define __GENERIC_BOUNDING_BOX_TREE_H
@@ -84,6 +84,10 @@ namespace dolfin
     /// Compute closest point and distance to _Point_
     std::pair<unsigned int, double> compute_closest_point(const Point& point) const;
 
+    /// Return number of bytes used by tree, including the point
+    /// search tree
+    std::size_t memory_usage() const;
+
   protected:
 
     // Bounding box data. Leaf nodes are indicated by setting child_0
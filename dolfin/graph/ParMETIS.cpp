@@ -19,7 +19,7 @@
 // Modified by Chris Richardson 2013
 //
 // First added:  2010-02-10
-// Last changed: 2014-01-09
+// Last changed: 2015-01-22
 
 #include <dolfin/log/dolfin_log.h>
 
@@ -73,6 +73,9 @@ namespace dolfin
     idx_t wgtflag;
     idx_t edgecut;
 
+    // Cell (graph node) weights
+    std::vector<idx_t> cell_weight;
+
   };
 }
 //-----------------------------------------------------------------------------
@@ -392,6 +395,17 @@ ParMETISDualGraph::ParMETISDualGraph(MPI_Comm mpi_comm,
   elmwgt = NULL;
   wgtflag = 0;
   edgecut = 0;
+
+  // Use cell weights if provided (wgtflag = 2 means weights on
+  // vertices of the dual graph only)
+  if (!mesh_data.cell_weight.empty())
+  {
+    dolfin_assert(mesh_data.cell_weight.size() == num_local_cells);
+    cell_weight.assign(mesh_data.cell_weight.begin(),
+                       mesh_data.cell_weight.end());
+    elmwgt = cell_weight.data();
+    wgtflag = 2;
+  }
 }
 //-----------------------------------------------------------------------------
 ParMETISDualGraph::~ParMETISDualGraph()
@@ -0,0 +1,337 @@
+// Copyright (C) 2015 The FEniCS Project
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2015-01-22
+// Last changed: 2015-01-22
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <set>
+#include <vector>
+
+#include <dolfin/common/MPI.h>
+#include <dolfin/common/Timer.h>
+#include <dolfin/log/log.h>
+#include <dolfin/mesh/LocalMeshData.h>
+#include "SFCPartition.h"
+
+using namespace dolfin;
+
+//-----------------------------------------------------------------------------
+void
+SFCPartition::compute_partition_hilbert(const MPI_Comm mpi_comm,
+                                      std::vector<std::size_t>& cell_partition,
+                                      const LocalMeshData& mesh_data)
+{
+  Timer timer("Partition mesh (Hilbert curve)");
+  compute_partition(mpi_comm, cell_partition, mesh_data, true);
+}
+//-----------------------------------------------------------------------------
+void
+SFCPartition::compute_partition_morton(const MPI_Comm mpi_comm,
+                                      std::vector<std::size_t>& cell_partition,
+                                      const LocalMeshData& mesh_data)
+{
+  Timer timer("Partition mesh (Morton curve)");
+  compute_partition(mpi_comm, cell_partition, mesh_data, false);
+}
+//-----------------------------------------------------------------------------
+void SFCPartition::compute_partition(const MPI_Comm mpi_comm,
+                                     std::vector<std::size_t>& cell_partition,
+                                     const LocalMeshData& mesh_data,
+                                     bool hilbert)
+{
+  const std::size_t num_processes = MPI::size(mpi_comm);
+  const std::size_t gdim = mesh_data.gdim;
+  const std::size_t num_local_cells = mesh_data.cell_vertices.shape()[0];
+
+  // Compute cell midpoints
+  std::vector<double> midpoints;
+  compute_midpoints(mpi_comm, mesh_data, midpoints);
+  dolfin_assert(midpoints.size() == gdim*num_local_cells);
+
+  // Compute global bounding box of midpoints
+  std::vector<double> x_min(gdim, std::numeric_limits<double>::max());
+  std::vector<double> x_max(gdim, -std::numeric_limits<double>::max());
+  for (std::size_t i = 0; i < num_local_cells; ++i)
+  {
+    for (std::size_t j = 0; j < gdim; ++j)
+    {
+      x_min[j] = std::min(x_min[j], midpoints[i*gdim + j]);
+      x_max[j] = std::max(x_max[j], midpoints[i*gdim + j]);
+    }
+  }
+  for (std::size_t j = 0; j < gdim; ++j)
+  {
+    x_min[j] = MPI::min(mpi_comm, x_min[j]);
+    x_max[j] = MPI::max(mpi_comm, x_max[j]);
+  }
+
+  // Number of bits per direction such that keys fit in a std::size_t
+  const std::size_t num_bits
+    = std::min((std::size_t) 31, (8*sizeof(std::size_t) - 1)/gdim);
+  const double num_intervals = (double) ((std::size_t) 1 << num_bits);
+
+  // Compute curve keys for local cells (key, local cell index)
+  std::vector<std::pair<std::size_t, std::size_t> > keys(num_local_cells);
+  std::vector<std::size_t> x(gdim);
+  for (std::size_t i = 0; i < num_local_cells; ++i)
+  {
+    for (std::size_t j = 0; j < gdim; ++j)
+    {
+      const double h = x_max[j] - x_min[j];
+      const double s = h > 0.0 ? (midpoints[i*gdim + j] - x_min[j])/h : 0.0;
+      x[j] = std::min((std::size_t) (s*num_intervals),
+                      ((std::size_t) 1 << num_bits) - 1);
+    }
+    keys[i] = std::make_pair(compute_key(x, num_bits, hilbert), i);
+  }
+  std::sort(keys.begin(), keys.end());
+
+  // Pick regularly spaced samples of the local keys and gather them
+  // on all processes
+  std::vector<std::size_t> samples;
+  if (num_local_cells > 0)
+  {
+    for (std::size_t p = 0; p < num_processes; ++p)
+      samples.push_back(keys[p*num_local_cells/num_processes].first);
+  }
+  std::vector<std::vector<std::size_t> > all_samples;
+  MPI::all_gather(mpi_comm, samples, all_samples);
+
+  // Select splitters dividing the key space into one bucket per
+  // process
+  std::vector<std::size_t> sorted_samples;
+  for (std::size_t p = 0; p < num_processes; ++p)
+  {
+    sorted_samples.insert(sorted_samples.end(), all_samples[p].begin(),
+                          all_samples[p].end());
+  }
+  std::sort(sorted_samples.begin(), sorted_samples.end());
+  std::vector<std::size_t> splitters;
+  for (std::size_t p = 1; p < num_processes && !sorted_samples.empty(); ++p)
+    splitters.push_back(sorted_samples[p*sorted_samples.size()/num_processes]);
+
+  // Send (key, local cell index, weight) to the process holding the
+  // bucket
+  std::vector<std::vector<std::size_t> > send_keys(num_processes);
+  for (std::size_t i = 0; i < num_local_cells; ++i)
+  {
+    const std::size_t key = keys[i].first;
+    const std::size_t cell = keys[i].second;
+    const std::size_t dest
+      = std::upper_bound(splitters.begin(), splitters.end(), key)
+      - splitters.begin();
+    const std::size_t weight
+      = mesh_data.cell_weight.empty() ? 1 : mesh_data.cell_weight[cell];
+    send_keys[dest].push_back(key);
+    send_keys[dest].push_back(cell);
+    send_keys[dest].push_back(weight);
+  }
+  std::vector<std::vector<std::size_t> > received_keys;
+  MPI::all_to_all(mpi_comm, send_keys, received_keys);
+
+  // Sort received keys (key, source process, source index, weight)
+  std::vector<std::array<std::size_t, 4> > bucket;
+  for (std::size_t p = 0; p < num_processes; ++p)
+  {
+    const std::vector<std::size_t>& data = received_keys[p];
+    dolfin_assert(data.size() % 3 == 0);
+    for (std::size_t i = 0; i < data.size(); i += 3)
+    {
+      const std::array<std::size_t, 4> entry = {{data[i], p, data[i + 1],
+                                                 data[i + 2]}};
+      bucket.push_back(entry);
+    }
+  }
+  std::sort(bucket.begin(), bucket.end());
+
+  // Cut globally sorted sequence into chunks of equal weight
+  std::size_t local_weight = 0;
+  for (std::size_t i = 0; i < bucket.size(); ++i)
+    local_weight += bucket[i][3];
+  const std::size_t offset = MPI::global_offset(mpi_comm, local_weight, true);
+  const std::size_t total_weight = MPI::sum(mpi_comm, local_weight);
+
+  std::vector<std::vector<std::size_t> > send_partition(num_processes);
+  std::size_t position = offset;
+  for (std::size_t i = 0; i < bucket.size(); ++i)
+  {
+    // Assign cell to the chunk holding the middle of its weight
+    const double mid = (double) position + 0.5*(double) bucket[i][3];
+    const std::size_t dest
+      = std::min((std::size_t) (mid*num_processes/total_weight),
+                 num_processes - 1);
+    position += bucket[i][3];
+
+    send_partition[bucket[i][1]].push_back(bucket[i][2]);
+    send_partition[bucket[i][1]].push_back(dest);
+  }
+  std::vector<std::vector<std::size_t> > received_partition;
+  MPI::all_to_all(mpi_comm, send_partition, received_partition);
+
+  // Copy destination of local cells
+  cell_partition.assign(num_local_cells, 0);
+  for (std::size_t p = 0; p < num_processes; ++p)
+  {
+    const std::vector<std::size_t>& data = received_partition[p];
+    for (std::size_t i = 0; i < data.size(); i += 2)
+    {
+      dolfin_assert(data[i] < num_local_cells);
+      cell_partition[data[i]] = data[i + 1];
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+void SFCPartition::compute_midpoints(const MPI_Comm mpi_comm,
+                                     const LocalMeshData& mesh_data,
+                                     std::vector<double>& midpoints)
+{
+  const std::size_t num_processes = MPI::size(mpi_comm);
+  const std::size_t gdim = mesh_data.gdim;
+  const std::size_t num_local_cells = mesh_data.cell_vertices.shape()[0];
+  const std::size_t num_vertices_per_cell = mesh_data.num_vertices_per_cell;
+  const std::size_t num_global_vertices = mesh_data.num_global_vertices;
+
+  // Vertex coordinates are distributed in blocks of global vertex
+  // indices, so request the coordinates of all vertices of local
+  // cells from the processes that hold them
+  std::set<std::size_t> required_vertices;
+  for (std::size_t i = 0; i < num_local_cells; ++i)
+  {
+    required_vertices.insert(mesh_data.cell_vertices[i].begin(),
+                             mesh_data.cell_vertices[i].end());
+  }
+  std::vector<std::vector<std::size_t> > send_indices(num_processes);
+  for (std::set<std::size_t>::const_iterator v = required_vertices.begin();
+       v != required_vertices.end(); ++v)
+  {
+    send_indices[MPI::index_owner(mpi_comm, *v, num_global_vertices)]
+      .push_back(*v);
+  }
+  std::vector<std::vector<std::size_t> > received_indices;
+  MPI::all_to_all(mpi_comm, send_indices, received_indices);
+
+  // Send back requested coordinates
+  const std::pair<std::size_t, std::size_t> local_range
+    = MPI::local_range(mpi_comm, num_global_vertices);
+  std::vector<std::vector<double> > send_coordinates(num_processes);
+  for (std::size_t p = 0; p < num_processes; ++p)
+  {
+    send_coordinates[p].reserve(gdim*received_indices[p].size());
+    for (std::size_t i = 0; i < received_indices[p].size(); ++i)
+    {
+      const std::size_t index = received_indices[p][i] - local_range.first;
+      dolfin_assert(index < mesh_data.vertex_coordinates.shape()[0]);
+      send_coordinates[p].insert(send_coordinates[p].end(),
+                                 mesh_data.vertex_coordinates[index].begin(),
+                                 mesh_data.vertex_coordinates[index].end());
+    }
+  }
+  std::vector<std::vector<double> > received_coordinates;
+  MPI::all_to_all(mpi_comm, send_coordinates, received_coordinates);
+
+  // Since vertices are owned in contiguous blocks, the concatenated
+  // requests are sorted by global vertex index
+  std::vector<std::size_t> vertex_indices;
+  std::vector<double> vertex_coordinates;
+  vertex_indices.reserve(required_vertices.size());
+  vertex_coordinates.reserve(gdim*required_vertices.size());
+  for (std::size_t p = 0; p < num_processes; ++p)
+  {
+    dolfin_assert(received_coordinates[p].size()
+                  == gdim*send_indices[p].size());
+    vertex_indices.insert(vertex_indices.end(), send_indices[p].begin(),
+                          send_indices[p].end());
+    vertex_coordinates.insert(vertex_coordinates.end(),
+                              received_coordinates[p].begin(),
+                              received_coordinates[p].end());
+  }
+
+  // Compute midpoints
+  midpoints.assign(gdim*num_local_cells, 0.0);
+  for (std::size_t i = 0; i < num_local_cells; ++i)
+  {
+    for (std::size_t k = 0; k < num_vertices_per_cell; ++k)
+    {
+      const std::size_t v
+        = std::lower_bound(vertex_indices.begin(), vertex_indices.end(),
+                           mesh_data.cell_vertices[i][k])
+        - vertex_indices.begin();
+      dolfin_assert(v < vertex_indices.size());
+      const double* x = &vertex_coordinates[v*gdim];
+      for (std::size_t j = 0; j < gdim; ++j)
+        midpoints[i*gdim + j] += x[j];
+    }
+    for (std::size_t j = 0; j < gdim; ++j)
+      midpoints[i*gdim + j] /= (double) num_vertices_per_cell;
+  }
+}
+//-----------------------------------------------------------------------------
+std::size_t SFCPartition::compute_key(std::vector<std::size_t>& x,
+                                      std::size_t num_bits, bool hilbert)
+{
+  const std::size_t n = x.size();
+  const std::size_t M = (std::size_t) 1 << (num_bits - 1);
+
+  // Transform coordinates to the 'transposed' Hilbert index
+  // (J. Skilling, Programming the Hilbert curve, AIP Conf. Proc. 707,
+  // 2004)
+  if (hilbert)
+  {
+    // Inverse undo
+    for (std::size_t Q = M; Q > 1; Q >>= 1)
+    {
+      const std::size_t P = Q - 1;
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        if (x[i] & Q)
+          x[0] ^= P;
+        else
+        {
+          const std::size_t t = (x[0] ^ x[i]) & P;
+          x[0] ^= t;
+          x[i] ^= t;
+        }
+      }
+    }
+
+    // Gray encode
+    for (std::size_t i = 1; i < n; ++i)
+      x[i] ^= x[i - 1];
+    std::size_t t = 0;
+    for (std::size_t Q = M; Q > 1; Q >>= 1)
+    {
+      if (x[n - 1] & Q)
+        t ^= Q - 1;
+    }
+    for (std::size_t i = 0; i < n; ++i)
+      x[i] ^= t;
+  }
+
+  // Interleave bits, most significant first
+  std::size_t key = 0;
+  for (std::size_t b = num_bits; b-- > 0;)
+  {
+    for (std::size_t i = 0; i < n; ++i)
+      key = (key << 1) | ((x[i] >> b) & 1);
+  }
+
+  return key;
+}
+//-----------------------------------------------------------------------------
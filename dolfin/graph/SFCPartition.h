@@ -0,0 +1,78 @@
+// Copyright (C) 2015 The FEniCS Project
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2015-01-22
+// Last changed: 2015-01-22
+
+#ifndef __DOLFIN_SFC_PARTITION_H
+#define __DOLFIN_SFC_PARTITION_H
+
+#include <cstddef>
+#include <vector>
+#include <dolfin/common/MPI.h>
+
+namespace dolfin
+{
+
+  class LocalMeshData;
+
+  /// This class partitions a mesh by sorting the cell midpoints
+  /// along a space-filling curve (Hilbert or Morton order) and
+  /// cutting the sorted sequence into chunks of equal weight. No
+  /// dual graph is built, which makes it much cheaper than graph
+  /// partitioning, at the cost of a (moderately) larger edge cut.
+
+  class SFCPartition
+  {
+
+  public:
+
+    /// Calculate partitioning by sorting cells along a Hilbert curve
+    static void compute_partition_hilbert(const MPI_Comm mpi_comm,
+                                      std::vector<std::size_t>& cell_partition,
+                                      const LocalMeshData& mesh_data);
+
+    /// Calculate partitioning by sorting cells along a Morton
+    /// (Z-order) curve
+    static void compute_partition_morton(const MPI_Comm mpi_comm,
+                                      std::vector<std::size_t>& cell_partition,
+                                      const LocalMeshData& mesh_data);
+
+    /// Compute key along a Hilbert (hilbert = true) or Morton curve
+    /// for a point with integer coordinates x (num_bits bits in each
+    /// direction). The coordinates are overwritten.
+    static std::size_t compute_key(std::vector<std::size_t>& x,
+                                   std::size_t num_bits, bool hilbert);
+
+  private:
+
+    // Compute partitioning using Hilbert (true) or Morton (false) keys
+    static void compute_partition(const MPI_Comm mpi_comm,
+                                  std::vector<std::size_t>& cell_partition,
+                                  const LocalMeshData& mesh_data,
+                                  bool hilbert);
+
+    // Compute midpoints of cells in local mesh data (fetching vertex
+    // coordinates from the processes that store them)
+    static void compute_midpoints(const MPI_Comm mpi_comm,
+                                  const LocalMeshData& mesh_data,
+                                  std::vector<double>& midpoints);
+
+  };
+}
+
+#endif
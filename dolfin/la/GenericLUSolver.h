@@ -18,12 +18,13 @@
 // Modified by Anders Logg 2011-2012
 //
 // First added:  2010-07-11
-// Last changed: 2012-08-20
+// Last changed: 2015-01-21
 
 #ifndef __GENERIC_LU_SOLVER_H
 #define __GENERIC_LU_SOLVER_H
 
 #include <memory>
+#include <vector>
 #include <dolfin/common/Variable.h>
 #include "GenericLinearSolver.h"
 
@@ -77,6 +78,47 @@ namespace dolfin
       return 0;
     }
 
+    /// Perform symbolic factorization (ordering and analysis of the
+    /// nonzero pattern) of the operator
+    virtual void symbolic_factorize()
+    {
+      dolfin_error("GenericLUSolver.h",
+                   "perform symbolic factorization",
+                   "Not supported by current linear algebra backend.");
+    }
+
+    /// Perform numeric factorization of the operator, re-using the
+    /// symbolic factorization if it has been computed. The operator
+    /// values may change between calls, but not its nonzero pattern.
+    virtual void numeric_factorize()
+    {
+      dolfin_error("GenericLUSolver.h",
+                   "perform numeric factorization",
+                   "Not supported by current linear algebra backend.");
+    }
+
+    /// Solve linear systems Ax_i = b_i for a set of right-hand sides
+    /// using the same factorization
+    virtual std::size_t solve(const std::vector<GenericVector*>& x,
+                              const std::vector<const GenericVector*>& b)
+    {
+      if (x.size() != b.size())
+      {
+        dolfin_error("GenericLUSolver.h",
+                     "solve linear systems with multiple right-hand sides",
+                     "Number of solution vectors (%d) does not match number "
+                     "of right-hand sides (%d)", x.size(), b.size());
+      }
+
+      std::size_t num_solves = 0;
+      for (std::size_t i = 0; i < b.size(); ++i)
+      {
+        dolfin_assert(x[i] && b[i]);
+        num_solves += solve(*x[i], *b[i]);
+      }
+      return num_solves;
+    }
+
   };
 
 }
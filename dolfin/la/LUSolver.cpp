@@ -18,7 +18,7 @@
 // Modified by Anders Logg 2011-2012
 //
 // First added:  2010-07-11
-// Last changed: 2012-08-20
+// Last changed: 2015-01-21
 
 #include <dolfin/parameter/GlobalParameters.h>
 #include <dolfin/common/NoDeleter.h>
@@ -96,6 +96,34 @@ std::size_t LUSolver::solve_transpose(const GenericLinearOperator& A,
   return solver->solve_transpose(A, x, b);
 }
 //-----------------------------------------------------------------------------
+std::size_t LUSolver::solve(const std::vector<GenericVector*>& x,
+                            const std::vector<const GenericVector*>& b)
+{
+  dolfin_assert(solver);
+
+  Timer timer("LU solver (multiple right-hand sides)");
+  solver->parameters.update(parameters);
+  return solver->solve(x, b);
+}
+//-----------------------------------------------------------------------------
+void LUSolver::symbolic_factorize()
+{
+  dolfin_assert(solver);
+
+  Timer timer("LU solver (symbolic factorization)");
+  solver->parameters.update(parameters);
+  solver->symbolic_factorize();
+}
+//-----------------------------------------------------------------------------
+void LUSolver::numeric_factorize()
+{
+  dolfin_assert(solver);
+
+  Timer timer("LU solver (numeric factorization)");
+  solver->parameters.update(parameters);
+  solver->numeric_factorize();
+}
+//-----------------------------------------------------------------------------
 void LUSolver::init(std::string method)
 {
   // Get default linear algebra factory
@@ -21,13 +21,14 @@
 // Modified by Kent-Andre Mardal 2008
 //
 // First added:  2007-07-03
-// Last changed: 2014-05-27
+// Last changed: 2015-01-21
 
 #ifndef __LU_SOLVER_H
 #define __LU_SOLVER_H
 
 #include <string>
 #include <memory>
+#include <vector>
 #include "GenericLUSolver.h"
 
 namespace dolfin
@@ -70,6 +71,21 @@ namespace dolfin
     std::size_t solve_transpose(const GenericLinearOperator& A,
                                 GenericVector& x, const GenericVector& b);
 
+    /// Solve linear systems Ax_i = b_i for a set of right-hand sides,
+    /// factorizing the operator once
+    std::size_t solve(const std::vector<GenericVector*>& x,
+                      const std::vector<const GenericVector*>& b);
+
+    /// Perform symbolic factorization (analysis of the nonzero
+    /// pattern) of the operator
+    void symbolic_factorize();
+
+    /// Perform numeric factorization of the operator, re-using the
+    /// symbolic factorization. Use this to refactorize a matrix whose
+    /// values have changed (e.g. by re-assembly) but whose nonzero
+    /// pattern has not.
+    void numeric_factorize();
+
     /// Default parameter values
     static Parameters default_parameters()
     {
@@ -102,7 +118,7 @@ namespace dolfin
     void init(std::string method);
 
     // Solver
-    std::shared_ptr<GenericLinearSolver> solver;
+    std::shared_ptr<GenericLUSolver> solver;
 
   };
 }
@@ -0,0 +1,506 @@
+// Copyright (C) 2015 The FEniCS Project
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2015-01-21
+// Last changed: 2015-01-22
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <dolfin/common/Array.h>
+#include <dolfin/common/constants.h>
+#include <dolfin/common/MPI.h>
+#include <dolfin/common/NoDeleter.h>
+#include <dolfin/common/Timer.h>
+#include <dolfin/log/log.h>
+#include <dolfin/parameter/GlobalParameters.h>
+#include "GenericMatrix.h"
+#include "GenericVector.h"
+#include "MixedPrecisionSolver.h"
+
+using namespace dolfin;
+
+namespace
+{
+  // Dot product of single precision vectors, accumulated in double
+  // precision
+  double dot(const std::vector<float>& x, const std::vector<float>& y,
+             int num_threads)
+  {
+    const int n = x.size();
+    double sum = 0.0;
+    #ifdef HAS_OPENMP
+    #pragma omp parallel for reduction(+:sum) schedule(static) \
+      num_threads(num_threads) if (num_threads > 1)
+    #endif
+    for (int i = 0; i < n; ++i)
+      sum += static_cast<double>(x[i])*y[i];
+    return sum;
+  }
+}
+
+//-----------------------------------------------------------------------------
+std::vector<std::pair<std::string, std::string> >
+MixedPrecisionSolver::methods()
+{
+  return { {"default",  "default inner Krylov method"},
+           {"cg",       "Conjugate gradient method"},
+           {"bicgstab", "Biconjugate gradient stabilized method"} };
+}
+//-----------------------------------------------------------------------------
+Parameters MixedPrecisionSolver::default_parameters()
+{
+  Parameters p("mixed_precision_solver");
+
+  // Refinement (double precision) parameters
+  p.add("relative_tolerance", 1.0e-10);
+  p.add("absolute_tolerance", 1.0e-15);
+  p.add("maximum_iterations", 50);
+  p.add("nonzero_initial_guess", false);
+  p.add("monitor_convergence", false);
+  p.add("report", true);
+  p.add("error_on_nonconvergence", true);
+
+  // Inner (single precision) solver parameters. Single precision
+  // cannot reduce the residual much further than 1e-6.
+  Parameters p_inner("inner_solver");
+  p_inner.add("relative_tolerance", 1.0e-4);
+  p_inner.add("maximum_iterations", 10000);
+  p.add(p_inner);
+
+  return p;
+}
+//-----------------------------------------------------------------------------
+MixedPrecisionSolver::MixedPrecisionSolver(std::string method)
+  : _method(method), _inner_iterations(0), _num_threads(1)
+{
+  // Check that method is available
+  if (method != "default" && method != "cg" && method != "bicgstab")
+  {
+    dolfin_error("MixedPrecisionSolver.cpp",
+                 "create mixed precision solver",
+                 "Unknown inner Krylov method \"%s\"", method.c_str());
+  }
+
+  // Set parameter values
+  parameters = default_parameters();
+}
+//-----------------------------------------------------------------------------
+MixedPrecisionSolver::MixedPrecisionSolver(
+  std::shared_ptr<const GenericLinearOperator> A, std::string method)
+  : _method(method), _inner_iterations(0), _num_threads(1)
+{
+  // Check that method is available
+  if (method != "default" && method != "cg" && method != "bicgstab")
+  {
+    dolfin_error("MixedPrecisionSolver.cpp",
+                 "create mixed precision solver",
+                 "Unknown inner Krylov method \"%s\"", method.c_str());
+  }
+
+  // Set parameter values
+  parameters = default_parameters();
+
+  // Set operator
+  set_operator(A);
+}
+//-----------------------------------------------------------------------------
+MixedPrecisionSolver::~MixedPrecisionSolver()
+{
+  // Do nothing
+}
+//-----------------------------------------------------------------------------
+void MixedPrecisionSolver::set_operator(
+  std::shared_ptr<const GenericLinearOperator> A)
+{
+  _matA = require_matrix(A);
+  dolfin_assert(_matA);
+
+  // Single precision copy is (re)built on next solve
+  _row_ptr.clear();
+  _columns.clear();
+  _values.clear();
+  _inverse_diagonal.clear();
+}
+//-----------------------------------------------------------------------------
+const GenericLinearOperator& MixedPrecisionSolver::get_operator() const
+{
+  if (!_matA)
+  {
+    dolfin_error("MixedPrecisionSolver.cpp",
+                 "access operator of mixed precision solver",
+                 "Operator has not been set");
+  }
+  return *_matA;
+}
+//-----------------------------------------------------------------------------
+std::size_t MixedPrecisionSolver::solve(const GenericLinearOperator& A,
+                                        GenericVector& x,
+                                        const GenericVector& b)
+{
+  std::shared_ptr<const GenericLinearOperator> Atmp(&A, NoDeleter());
+  set_operator(Atmp);
+  return solve(x, b);
+}
+//-----------------------------------------------------------------------------
+std::size_t MixedPrecisionSolver::solve(GenericVector& x,
+                                        const GenericVector& b)
+{
+  if (!_matA)
+  {
+    dolfin_error("MixedPrecisionSolver.cpp",
+                 "solve linear system with mixed precision solver",
+                 "Operator has not been set");
+  }
+
+  if (MPI::size(_matA->mpi_comm()) > 1)
+    not_working_in_parallel("Mixed precision iterative refinement");
+
+  // Check dimensions
+  const std::size_t N = _matA->size(0);
+  if (_matA->size(1) != N || b.size() != N)
+  {
+    dolfin_error("MixedPrecisionSolver.cpp",
+                 "solve linear system with mixed precision solver",
+                 "Non-matching dimensions for linear system (matrix has "
+                 "dimension %d x %d, right-hand side vector has dimension %d)",
+                 _matA->size(0), _matA->size(1), b.size());
+  }
+
+  Timer timer("Mixed precision solver");
+
+  // Build single precision copy of operator if required
+  if (_row_ptr.empty())
+    init_single_precision();
+
+  // Read parameters
+  const double rtol = parameters["relative_tolerance"];
+  const double atol = parameters["absolute_tolerance"];
+  const std::size_t max_it = parameters["maximum_iterations"];
+  const bool monitor_convergence = parameters["monitor_convergence"];
+  const bool report = parameters["report"];
+  const bool error_on_nonconvergence = parameters["error_on_nonconvergence"];
+  const bool nonzero_initial_guess = parameters["nonzero_initial_guess"];
+  const int num_threads = dolfin::parameters["num_threads"];
+  _num_threads = std::max(num_threads, 1);
+
+  // Initialise solution vector
+  if (x.empty())
+    _matA->init_vector(x, 1);
+  else if (!nonzero_initial_guess)
+    x.zero();
+
+  // Residual vector
+  std::shared_ptr<GenericVector> r = b.copy();
+
+  const double b_norm = b.norm("l2");
+  const double tolerance = std::max(rtol*b_norm, atol);
+
+  std::vector<double> r_values, dx;
+  std::vector<float> r_single(N), dx_single(N);
+
+  _inner_iterations = 0;
+  std::size_t iteration = 0;
+  bool converged = false;
+  while (true)
+  {
+    // Compute residual r = b - Ax in double precision
+    _matA->mult(x, *r);
+    *r *= -1.0;
+    r->axpy(1.0, b);
+    const double r_norm = r->norm("l2");
+
+    if (monitor_convergence)
+    {
+      info("Mixed precision refinement iteration %d: residual = %g "
+           "(%d inner iterations)", iteration, r_norm, _inner_iterations);
+    }
+
+    if (r_norm <= tolerance)
+    {
+      converged = true;
+      break;
+    }
+    if (iteration == max_it)
+      break;
+
+    // Scale residual to avoid loss of range in single precision
+    r->get_local(r_values);
+    const double scale = r->norm("linf");
+    for (std::size_t i = 0; i < N; ++i)
+      r_single[i] = r_values[i]/scale;
+
+    // Solve correction equation A dx = r in single precision
+    std::fill(dx_single.begin(), dx_single.end(), 0.0);
+    if (_method == "cg")
+      _inner_iterations += solve_cg(dx_single, r_single);
+    else
+      _inner_iterations += solve_bicgstab(dx_single, r_single);
+
+    // Update solution in double precision
+    dx.resize(N);
+    for (std::size_t i = 0; i < N; ++i)
+      dx[i] = scale*dx_single[i];
+    x.add_local(Array<double>(N, dx.data()));
+    x.apply("add");
+
+    ++iteration;
+  }
+
+  if (!converged)
+  {
+    if (error_on_nonconvergence)
+    {
+      dolfin_error("MixedPrecisionSolver.cpp",
+                   "solve linear system with mixed precision solver",
+                   "Iterative refinement did not converge in %d iterations",
+                   max_it);
+    }
+    else
+    {
+      warning("Mixed precision solver did not converge in %d refinement "
+              "iterations.", max_it);
+    }
+  }
+  else if (report)
+  {
+    info("Mixed precision solver converged in %d refinement iterations "
+         "(%d single precision %s iterations).", iteration,
+         _inner_iterations, _method == "cg" ? "CG" : "BiCGStab");
+  }
+
+  return iteration;
+}
+//-----------------------------------------------------------------------------
+std::size_t MixedPrecisionSolver::memory_usage() const
+{
+  return sizeof(unsigned int)*(_row_ptr.size() + _columns.size())
+    + sizeof(float)*(_values.size() + _inverse_diagonal.size());
+}
+//-----------------------------------------------------------------------------
+void MixedPrecisionSolver::init_single_precision()
+{
+  dolfin_assert(_matA);
+  Timer timer("Mixed precision solver init");
+
+  // Default inner method
+  if (_method == "default")
+    _method = "bicgstab";
+
+  const std::size_t N = _matA->size(0);
+  if (_matA->nnz() > std::numeric_limits<unsigned int>::max())
+  {
+    dolfin_error("MixedPrecisionSolver.cpp",
+                 "initialize mixed precision solver",
+                 "Number of nonzeros (%d) too large for single precision "
+                 "matrix copy", _matA->nnz());
+  }
+
+  _row_ptr.resize(N + 1);
+  _row_ptr[0] = 0;
+  _columns.clear();
+  _values.clear();
+  _columns.reserve(_matA->nnz());
+  _values.reserve(_matA->nnz());
+  _inverse_diagonal.resize(N);
+
+  // Copy matrix row by row, converting values to single precision
+  std::vector<std::size_t> columns;
+  std::vector<double> values;
+  for (std::size_t row = 0; row < N; ++row)
+  {
+    _matA->getrow(row, columns, values);
+    double diagonal = 0.0;
+    for (std::size_t k = 0; k < columns.size(); ++k)
+    {
+      _columns.push_back(columns[k]);
+      _values.push_back(values[k]);
+      if (columns[k] == row)
+        diagonal = values[k];
+    }
+    _row_ptr[row + 1] = _columns.size();
+
+    if (std::abs(diagonal) < DOLFIN_EPS)
+    {
+      dolfin_error("MixedPrecisionSolver.cpp",
+                   "initialize mixed precision solver",
+                   "Zero diagonal detected in row %d", row);
+    }
+    _inverse_diagonal[row] = 1.0/diagonal;
+  }
+}
+//-----------------------------------------------------------------------------
+void MixedPrecisionSolver::mult(const std::vector<float>& x,
+                                std::vector<float>& y) const
+{
+  const int N = _row_ptr.size() - 1;
+  #ifdef HAS_OPENMP
+  #pragma omp parallel for schedule(static) num_threads(_num_threads) \
+    if (_num_threads > 1)
+  #endif
+  for (int i = 0; i < N; ++i)
+  {
+    float sum = 0.0;
+    for (unsigned int k = _row_ptr[i]; k < _row_ptr[i + 1]; ++k)
+      sum += _values[k]*x[_columns[k]];
+    y[i] = sum;
+  }
+}
+//-----------------------------------------------------------------------------
+std::size_t MixedPrecisionSolver::solve_cg(std::vector<float>& x,
+                                           const std::vector<float>& b) const
+{
+  const double rtol = parameters("inner_solver")["relative_tolerance"];
+  const std::size_t max_it = parameters("inner_solver")["maximum_iterations"];
+
+  const int N = b.size();
+  const double b_norm = std::sqrt(dot(b, b, _num_threads));
+  if (b_norm == 0.0)
+    return 0;
+
+  // Initial guess is zero, so r = b
+  std::vector<float> r(b), z(N), p(N), q(N);
+  #ifdef HAS_OPENMP
+  #pragma omp parallel for schedule(static) num_threads(_num_threads) \
+    if (_num_threads > 1)
+  #endif
+  for (int i = 0; i < N; ++i)
+    z[i] = _inverse_diagonal[i]*r[i];
+  p = z;
+  double rz = dot(r, z, _num_threads);
+
+  std::size_t iteration = 0;
+  while (iteration < max_it)
+  {
+    ++iteration;
+
+    mult(p, q);
+    const float alpha = rz/dot(p, q, _num_threads);
+
+    #ifdef HAS_OPENMP
+    #pragma omp parallel for schedule(static) num_threads(_num_threads) \
+      if (_num_threads > 1)
+    #endif
+    for (int i = 0; i < N; ++i)
+    {
+      x[i] += alpha*p[i];
+      r[i] -= alpha*q[i];
+      z[i] = _inverse_diagonal[i]*r[i];
+    }
+
+    if (std::sqrt(dot(r, r, _num_threads)) < rtol*b_norm)
+      break;
+
+    const double rz_new = dot(r, z, _num_threads);
+    const float beta = rz_new/rz;
+    rz = rz_new;
+
+    #ifdef HAS_OPENMP
+    #pragma omp parallel for schedule(static) num_threads(_num_threads) \
+      if (_num_threads > 1)
+    #endif
+    for (int i = 0; i < N; ++i)
+      p[i] = z[i] + beta*p[i];
+  }
+
+  return iteration;
+}
+//-----------------------------------------------------------------------------
+std::size_t
+MixedPrecisionSolver::solve_bicgstab(std::vector<float>& x,
+                                     const std::vector<float>& b) const
+{
+  const double rtol = parameters("inner_solver")["relative_tolerance"];
+  const std::size_t max_it = parameters("inner_solver")["maximum_iterations"];
+
+  const int N = b.size();
+  const double b_norm = std::sqrt(dot(b, b, _num_threads));
+  if (b_norm == 0.0)
+    return 0;
+
+  // Initial guess is zero, so r = b
+  std::vector<float> r(b), r0(b), p(N, 0.0), v(N, 0.0), s(N), t(N);
+  std::vector<float> p_hat(N), s_hat(N);
+  double rho = 1.0, alpha = 1.0, omega = 1.0;
+
+  std::size_t iteration = 0;
+  while (iteration < max_it)
+  {
+    ++iteration;
+
+    const double rho_new = dot(r0, r, _num_threads);
+    if (rho_new == 0.0)
+      break;
+    const float beta = (rho_new/rho)*(alpha/omega);
+    rho = rho_new;
+
+    #ifdef HAS_OPENMP
+    #pragma omp parallel for schedule(static) num_threads(_num_threads) \
+      if (_num_threads > 1)
+    #endif
+    for (int i = 0; i < N; ++i)
+    {
+      p[i] = r[i] + beta*(p[i] - omega*v[i]);
+      p_hat[i] = _inverse_diagonal[i]*p[i];
+    }
+
+    mult(p_hat, v);
+    alpha = rho/dot(r0, v, _num_threads);
+
+    #ifdef HAS_OPENMP
+    #pragma omp parallel for schedule(static) num_threads(_num_threads) \
+      if (_num_threads > 1)
+    #endif
+    for (int i = 0; i < N; ++i)
+    {
+      s[i] = r[i] - alpha*v[i];
+      s_hat[i] = _inverse_diagonal[i]*s[i];
+    }
+
+    if (std::sqrt(dot(s, s, _num_threads)) < rtol*b_norm)
+    {
+      #ifdef HAS_OPENMP
+      #pragma omp parallel for schedule(static) num_threads(_num_threads) \
+        if (_num_threads > 1)
+      #endif
+      for (int i = 0; i < N; ++i)
+        x[i] += alpha*p_hat[i];
+      break;
+    }
+
+    mult(s_hat, t);
+    const double tt = dot(t, t, _num_threads);
+    omega = tt > 0.0 ? dot(t, s, _num_threads)/tt : 0.0;
+
+    #ifdef HAS_OPENMP
+    #pragma omp parallel for schedule(static) num_threads(_num_threads) \
+      if (_num_threads > 1)
+    #endif
+    for (int i = 0; i < N; ++i)
+    {
+      x[i] += alpha*p_hat[i] + omega*s_hat[i];
+      r[i] = s[i] - omega*t[i];
+    }
+
+    if (omega == 0.0 || std::sqrt(dot(r, r, _num_threads)) < rtol*b_norm)
+      break;
+  }
+
+  return iteration;
+}
+//-----------------------------------------------------------------------------
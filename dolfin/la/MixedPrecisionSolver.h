@@ -0,0 +1,135 @@
+// Copyright (C) 2015 The FEniCS Project
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2015-01-21
+// Last changed: 2015-01-22
+
+#ifndef __MIXED_PRECISION_SOLVER_H
+#define __MIXED_PRECISION_SOLVER_H
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "GenericLinearSolver.h"
+
+namespace dolfin
+{
+
+  // Forward declarations
+  class GenericLinearOperator;
+  class GenericMatrix;
+  class GenericVector;
+
+  /// This class implements a mixed-precision iterative refinement
+  /// solver for linear systems of the form Ax = b. A single precision
+  /// copy of the matrix is stored and used for (Jacobi preconditioned)
+  /// Krylov solves of the correction equation, while residuals are
+  /// computed in double precision using the original matrix. The
+  /// solution therefore converges to double precision accuracy while
+  /// the bulk of the work streams half as many bytes from memory.
+  ///
+  /// The solver works with any matrix backend (the single precision
+  /// copy is extracted row by row), but is limited to serial runs.
+
+  class MixedPrecisionSolver : public GenericLinearSolver
+  {
+  public:
+
+    /// Create solver with inner (single precision) Krylov method
+    /// "cg" or "bicgstab"
+    MixedPrecisionSolver(std::string method="default");
+
+    /// Create solver for given operator
+    MixedPrecisionSolver(std::shared_ptr<const GenericLinearOperator> A,
+                         std::string method="default");
+
+    /// Destructor
+    ~MixedPrecisionSolver();
+
+    /// Set operator (matrix)
+    void set_operator(std::shared_ptr<const GenericLinearOperator> A);
+
+    /// Return the operator (matrix)
+    const GenericLinearOperator& get_operator() const;
+
+    /// Solve linear system Ax = b and return number of refinement
+    /// steps
+    std::size_t solve(GenericVector& x, const GenericVector& b);
+
+    /// Solve linear system Ax = b and return number of refinement
+    /// steps
+    std::size_t solve(const GenericLinearOperator& A, GenericVector& x,
+                      const GenericVector& b);
+
+    /// Return total number of inner (single precision) iterations
+    /// performed by the last solve
+    std::size_t inner_iterations() const
+    { return _inner_iterations; }
+
+    /// Return memory (in bytes) used by the single precision copy of
+    /// the operator
+    std::size_t memory_usage() const;
+
+    /// Return a list of available inner solver methods
+    static std::vector<std::pair<std::string, std::string> > methods();
+
+    /// Default parameter values
+    static Parameters default_parameters();
+
+  private:
+
+    // Build single precision copy of operator
+    void init_single_precision();
+
+    // Compute y = Ax in single precision
+    void mult(const std::vector<float>& x, std::vector<float>& y) const;
+
+    // Solve Ax = b in single precision using Jacobi preconditioned CG
+    std::size_t solve_cg(std::vector<float>& x,
+                         const std::vector<float>& b) const;
+
+    // Solve Ax = b in single precision using Jacobi preconditioned
+    // BiCGStab
+    std::size_t solve_bicgstab(std::vector<float>& x,
+                               const std::vector<float>& b) const;
+
+    // Inner Krylov method
+    std::string _method;
+
+    // Operator (the matrix)
+    std::shared_ptr<const GenericMatrix> _matA;
+
+    // Single precision copy of operator (compressed row storage)
+    std::vector<unsigned int> _row_ptr;
+    std::vector<unsigned int> _columns;
+    std::vector<float> _values;
+
+    // Inverse of diagonal of operator (Jacobi preconditioner)
+    std::vector<float> _inverse_diagonal;
+
+    // Number of inner iterations in last solve
+    std::size_t _inner_iterations;
+
+    // Number of OpenMP threads for inner solves (at least one)
+    int _num_threads;
+
+  };
+
+}
+
+#endif
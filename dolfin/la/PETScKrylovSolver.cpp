@@ -20,7 +20,7 @@
 // Modified by Fredrik Valdmanis 2011
 //
 // First added:  2005-12-02
-// Last changed: 2014-07-09
+// Last changed: 2015-01-22
 
 #ifdef HAS_PETSC
 
@@ -52,7 +52,14 @@ const std::map<std::string, const KSPType> PETScKrylovSolver::_methods
     {"richardson", KSPRICHARDSON},
     {"bicgstab",   KSPBCGS},
     {"nash",       KSPNASH},
-    {"stcg",       KSPSTCG} };
+    {"stcg",       KSPSTCG},
+    #if PETSC_VERSION_MAJOR == 3 && PETSC_VERSION_MINOR > 3
+    {"pipecg",     KSPPIPECG},
+    {"pipecr",     KSPPIPECR},
+    {"groppcg",    KSPGROPPCG},
+    {"pgmres",     KSPPGMRES},
+    #endif
+    {"chebyshev",  KSPCHEBYSHEV} };
 
 // Mapping from method string to description
 const std::vector<std::pair<std::string, std::string> >
@@ -64,7 +71,14 @@ PETScKrylovSolver::_methods_descr
   {"minres",     "Minimal residual method"},
   {"tfqmr",      "Transpose-free quasi-minimal residual method"},
   {"richardson", "Richardson method"},
-  {"bicgstab",   "Biconjugate gradient stabilized method"} };
+  {"bicgstab",   "Biconjugate gradient stabilized method"},
+  #if PETSC_VERSION_MAJOR == 3 && PETSC_VERSION_MINOR > 3
+  {"pipecg",     "Pipelined conjugate gradient method"},
+  {"pipecr",     "Pipelined conjugate residual method"},
+  {"groppcg",    "Conjugate gradient method with overlapped reductions (Gropp)"},
+  {"pgmres",     "Pipelined generalized minimal residual method"},
+  #endif
+  {"chebyshev",  "Chebyshev iteration (no global reductions)"} };
 
 //-----------------------------------------------------------------------------
 std::vector<std::pair<std::string, std::string> >
@@ -98,6 +112,11 @@ Parameters PETScKrylovSolver::default_parameters()
   allowed_norm_types.insert("none");
   p.add("convergence_norm_type", allowed_norm_types);
 
+  // Lag the residual norm computation by one iteration so that its
+  // reduction can be merged with the inner products of the next
+  // iteration (supported by bicgstab)
+  p.add<bool>("lag_norm");
+
   // Control PETSc performance profiling
   p.add<bool>("profile");
 
@@ -627,14 +646,29 @@ void PETScKrylovSolver::set_petsc_ksp_options()
   ierr = KSPSetInitialGuessNonzero(_ksp, petsc_nonzero_guess);
   if (ierr != 0) petsc_error(ierr, __FILE__, "KSPSetInitialGuessNonzero");
 
-  // Monitor convergence
+  // Monitor convergence. The true residual monitor requires an extra
+  // matrix-vector product and a blocking reduction per iteration, so
+  // for methods that overlap their reductions with computation, the
+  // residual norm already computed (non-blocking) by the method is
+  // monitored instead.
   const bool monitor_convergence = parameters["monitor_convergence"];
   if (monitor_convergence)
   {
-    ierr = KSPMonitorSet(_ksp, KSPMonitorTrueResidualNorm, 0, 0);
+    if (has_pipelined_reductions())
+      ierr = KSPMonitorSet(_ksp, KSPMonitorDefault, 0, 0);
+    else
+      ierr = KSPMonitorSet(_ksp, KSPMonitorTrueResidualNorm, 0, 0);
     if (ierr != 0) petsc_error(ierr, __FILE__, "KSPMonitorSet");
   }
 
+  // Lag residual norm
+  if (parameters["lag_norm"].is_set())
+  {
+    const bool lag_norm = parameters["lag_norm"];
+    ierr = KSPSetLagNorm(_ksp, lag_norm ? PETSC_TRUE : PETSC_FALSE);
+    if (ierr != 0) petsc_error(ierr, __FILE__, "KSPSetLagNorm");
+  }
+
   // Set tolerances
   const int max_iterations = parameters["maximum_iterations"];
   ierr = KSPSetTolerances(_ksp,
@@ -645,6 +679,28 @@ void PETScKrylovSolver::set_petsc_ksp_options()
   if (ierr != 0) petsc_error(ierr, __FILE__, "KSPSetTolerances");
 }
 //-----------------------------------------------------------------------------
+bool PETScKrylovSolver::has_pipelined_reductions() const
+{
+  dolfin_assert(_ksp);
+
+  // Pipelined methods are not available in PETSc <= 3.3
+  #if PETSC_VERSION_MAJOR == 3 && PETSC_VERSION_MINOR <= 3
+  return false;
+  #else
+  KSPType ksp_type;
+  PetscErrorCode ierr = KSPGetType(_ksp, &ksp_type);
+  if (ierr != 0) petsc_error(ierr, __FILE__, "KSPGetType");
+
+  // Type may not be set yet (PETSc default is used)
+  if (!ksp_type)
+    return false;
+
+  const std::string type = ksp_type;
+  return type == KSPPIPECG || type == KSPPIPECR || type == KSPGROPPCG
+    || type == KSPPGMRES;
+  #endif
+}
+//-----------------------------------------------------------------------------
 void PETScKrylovSolver::write_report(int num_iterations,
                                      KSPConvergedReason reason)
 {
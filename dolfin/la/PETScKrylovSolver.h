@@ -21,7 +21,7 @@
 // Modified by Garth N. Wells 2005-2010
 //
 // First added:  2005-12-02
-// Last changed: 2014-07-09
+// Last changed: 2015-01-22
 
 #ifndef __DOLFIN_PETSC_KRYLOV_SOLVER_H
 #define __DOLFIN_PETSC_KRYLOV_SOLVER_H
@@ -154,6 +154,10 @@ namespace dolfin
     // Set options that affect KSP object
     void set_petsc_ksp_options();
 
+    // Return true if the KSP method overlaps its global reductions
+    // with computation (pipelined methods)
+    bool has_pipelined_reductions() const;
+
     // Report the number of iterations
     void write_report(int num_iterations, KSPConvergedReason reason);
 
@@ -20,7 +20,7 @@
 // Modified by Fredrik Valdmanis 2011
 //
 // First added:  2005
-// Last changed: 2011-11-11
+// Last changed: 2015-01-21
 
 #ifdef HAS_PETSC
 
@@ -331,6 +331,64 @@ std::string PETScLUSolver::str(bool verbose) const
   return s.str();
 }
 //-----------------------------------------------------------------------------
+void PETScLUSolver::symbolic_factorize()
+{
+  if (!_matA)
+  {
+    dolfin_error("PETScLUSolver.cpp",
+                 "perform symbolic factorization with PETSc LU solver",
+                 "Operator has not been set");
+  }
+
+  Timer timer("PETSc LU solver (symbolic factorization)");
+  dolfin_assert(_ksp);
+  PetscErrorCode ierr;
+
+  configure_ksp(_solver_package);
+
+  // Mark nonzero pattern as changed to force a full factorization
+  #if PETSC_VERSION_MAJOR == 3 && PETSC_VERSION_MINOR <= 4
+  ierr = KSPSetOperators(_ksp, _matA->mat(), _matA->mat(),
+                         DIFFERENT_NONZERO_PATTERN);
+  if (ierr != 0) petsc_error(ierr, __FILE__, "KSPSetOperators");
+  #else
+  ierr = KSPReset(_ksp);
+  if (ierr != 0) petsc_error(ierr, __FILE__, "KSPReset");
+  ierr = KSPSetOperators(_ksp, _matA->mat(), _matA->mat());
+  if (ierr != 0) petsc_error(ierr, __FILE__, "KSPSetOperators");
+  #endif
+
+  ierr = KSPSetUp(_ksp);
+  if (ierr != 0) petsc_error(ierr, __FILE__, "KSPSetUp");
+}
+//-----------------------------------------------------------------------------
+void PETScLUSolver::numeric_factorize()
+{
+  if (!_matA)
+  {
+    dolfin_error("PETScLUSolver.cpp",
+                 "perform numeric factorization with PETSc LU solver",
+                 "Operator has not been set");
+  }
+
+  Timer timer("PETSc LU solver (numeric factorization)");
+  dolfin_assert(_ksp);
+  PetscErrorCode ierr;
+
+  configure_ksp(_solver_package);
+
+  // Signal that only the matrix values have changed. PETSc >= 3.5
+  // detects this from the matrix state.
+  #if PETSC_VERSION_MAJOR == 3 && PETSC_VERSION_MINOR <= 4
+  ierr = KSPSetOperators(_ksp, _matA->mat(), _matA->mat(),
+                         SAME_NONZERO_PATTERN);
+  if (ierr != 0) petsc_error(ierr, __FILE__, "KSPSetOperators");
+  #endif
+
+  ierr = KSPSetUp(_ksp);
+  if (ierr != 0) petsc_error(ierr, __FILE__, "KSPSetUp");
+}
+//-----------------------------------------------------------------------------
 KSP PETScLUSolver::ksp() const
 {
   return _ksp;
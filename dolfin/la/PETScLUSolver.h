@@ -18,7 +18,7 @@
 // Modified by Garth N. Wells, 2009-2010.
 //
 // First added:  2005
-// Last changed: 2011-10-19
+// Last changed: 2015-01-22
 
 #ifndef __DOLFIN_PETSC_LU_SOLVER_H
 #define __DOLFIN_PETSC_LU_SOLVER_H
@@ -80,6 +80,9 @@ namespace dolfin
     std::size_t solve(const GenericLinearOperator& A, GenericVector& x,
                       const GenericVector& b);
 
+    /// Solve linear systems Ax_i = b_i for a set of right-hand sides
+    using GenericLUSolver::solve;
+
     /// Solve linear system Ax = b
     std::size_t solve(const PETScMatrix& A, PETScVector& x,
                       const PETScVector& b);
@@ -95,6 +98,16 @@ namespace dolfin
     std::size_t solve_transpose(const PETScMatrix& A, PETScVector& x,
                                 const PETScVector& b);
 
+    /// Perform symbolic factorization of the operator. PETSc computes
+    /// the symbolic and numeric factorizations together on the first
+    /// factorization, so this also performs the numeric factorization.
+    void symbolic_factorize();
+
+    /// Perform numeric factorization of the operator, re-using the
+    /// symbolic factorization. The operator values may have changed
+    /// since the last factorization, but not its nonzero pattern.
+    void numeric_factorize();
+
     /// Return informal string representation (pretty-print)
     std::string str(bool verbose) const;
 
@@ -49,6 +49,7 @@ const std::map<std::string, NormType> PETScMatrix::norm_types
 
 //-----------------------------------------------------------------------------
 PETScMatrix::PETScMatrix(bool use_gpu) : PETScBaseMatrix(NULL),
+                                         MemoryTracked("PETSc matrices"),
                                          _use_gpu(use_gpu)
 {
 #ifndef HAS_PETSC_CUSP
@@ -63,12 +64,15 @@ PETScMatrix::PETScMatrix(bool use_gpu) : PETScBaseMatrix(NULL),
   // Do nothing else
 }
 //-----------------------------------------------------------------------------
-PETScMatrix::PETScMatrix(Mat A) : PETScBaseMatrix(A), _use_gpu(false)
+PETScMatrix::PETScMatrix(Mat A) : PETScBaseMatrix(A),
+                                  MemoryTracked("PETSc matrices"),
+                                  _use_gpu(false)
 {
   // Do nothing (reference count to A is incremented in base class)
 }
 //-----------------------------------------------------------------------------
 PETScMatrix::PETScMatrix(const PETScMatrix& A) : PETScBaseMatrix(NULL),
+                                                 MemoryTracked(A),
                                                  _use_gpu(false)
 {
   if (A.mat())
@@ -755,6 +759,19 @@ void PETScMatrix::binary_dump(std::string file_name) const
   if (ierr != 0) petsc_error(ierr, __FILE__, "PetscViewerDestroy");
 }
 //-----------------------------------------------------------------------------
+std::size_t PETScMatrix::memory_usage() const
+{
+  std::size_t bytes = sizeof(*this);
+  if (_matA)
+  {
+    MatInfo info;
+    PetscErrorCode ierr = MatGetInfo(_matA, MAT_LOCAL, &info);
+    if (ierr != 0) petsc_error(ierr, __FILE__, "MatGetInfo");
+    bytes += static_cast<std::size_t>(info.memory);
+  }
+  return bytes;
+}
+//-----------------------------------------------------------------------------
 std::string PETScMatrix::str(bool verbose) const
 {
   if (!_matA)
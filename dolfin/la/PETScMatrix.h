@@ -22,7 +22,7 @@
 // Modified by Fredrik Valdmanis 2011
 //
 // First added:  2004-01-01
-// Last changed: 2012-08-22
+// Last changed: 2015-01-22
 
 #ifndef __PETSC_MATRIX_H
 #define __PETSC_MATRIX_H
@@ -35,6 +35,8 @@
 #include <petscmat.h>
 #include <petscsys.h>
 
+#include <dolfin/common/MemoryTracked.h>
+
 #include "GenericMatrix.h"
 #include "PETScBaseMatrix.h"
 
@@ -52,7 +54,8 @@ namespace dolfin
   /// access the PETSc Mat pointer using the function mat() and
   /// use the standard PETSc interface.
 
-  class PETScMatrix : public GenericMatrix, public PETScBaseMatrix
+  class PETScMatrix : public GenericMatrix, public PETScBaseMatrix,
+                      public MemoryTracked
   {
   public:
 
@@ -207,6 +210,10 @@ namespace dolfin
     /// Dump matrix to PETSc binary format
     void binary_dump(std::string file_name) const;
 
+    /// Return number of bytes allocated by PETSc for the local part
+    /// of the matrix
+    std::size_t memory_usage() const;
+
   private:
 
     // PETSc norm types
@@ -21,10 +21,11 @@
 // Modified by Fredrik Valdmanis 2011-2012
 //
 // First added:  2004
-// Last changed: 2012-08-22
+// Last changed: 2015-01-22
 
 #ifdef HAS_PETSC
 
+#include <algorithm>
 #include <cmath>
 #include <numeric>
 #include <dolfin/common/Timer.h>
@@ -32,6 +33,7 @@
 #include <dolfin/common/NoDeleter.h>
 #include <dolfin/common/Set.h>
 #include <dolfin/log/dolfin_log.h>
+#include <dolfin/parameter/GlobalParameters.h>
 #include "PETScVector.h"
 #include "uBLASVector.h"
 #include "PETScFactory.h"
@@ -40,6 +42,132 @@
 
 using namespace dolfin;
 
+#if defined(HAS_MPI) && MPI_VERSION >= 3
+#define DOLFIN_HAS_MPI_SHARED_MEMORY
+#endif
+
+#ifdef DOLFIN_HAS_MPI_SHARED_MEMORY
+namespace
+{
+  // Node-local communicator of a communicator, with the rank in it of
+  // each process of the communicator (MPI_UNDEFINED for processes on
+  // other nodes). It is cached on the communicator as an MPI
+  // attribute, so that it is created once per communicator. The
+  // ownership ranges of the last vector created on the communicator
+  // are also kept, since most vectors share their layout.
+  struct NodeCommunicator
+  {
+    NodeCommunicator(MPI_Comm comm)
+    {
+      MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, MPI::rank(comm),
+                          MPI_INFO_NULL, &node_comm);
+
+      const std::size_t num_processes = MPI::size(comm);
+      std::vector<int> comm_ranks(num_processes);
+      for (std::size_t p = 0; p < num_processes; ++p)
+        comm_ranks[p] = p;
+      node_ranks.resize(num_processes);
+      MPI_Group comm_group, node_group;
+      MPI_Comm_group(comm, &comm_group);
+      MPI_Comm_group(node_comm, &node_group);
+      MPI_Group_translate_ranks(comm_group, num_processes, comm_ranks.data(),
+                                node_group, node_ranks.data());
+      MPI_Group_free(&comm_group);
+      MPI_Group_free(&node_group);
+    }
+
+    ~NodeCommunicator()
+    {
+      int finalized = 0;
+      MPI_Finalized(&finalized);
+      if (!finalized)
+        MPI_Comm_free(&node_comm);
+    }
+
+    // Node-local communicator
+    MPI_Comm node_comm;
+
+    // Rank in node_comm of each process
+    std::vector<int> node_ranks;
+
+    // Start of the ownership range of each process, followed by the
+    // global size, for the last vector created on the communicator
+    std::vector<std::size_t> range_starts;
+  };
+
+  // MPI attribute key for cached node communicators
+  int node_communicator_keyval = MPI_KEYVAL_INVALID;
+
+  int delete_node_communicator(MPI_Comm comm, int keyval, void* attribute,
+                               void* extra_state)
+  {
+    delete static_cast<std::shared_ptr<NodeCommunicator>*>(attribute);
+    return MPI_SUCCESS;
+  }
+
+  // Return node communicator of communicator, creating it on first
+  // use (collective on first use)
+  std::shared_ptr<NodeCommunicator> node_communicator(MPI_Comm comm)
+  {
+    if (node_communicator_keyval == MPI_KEYVAL_INVALID)
+    {
+      MPI_Comm_create_keyval(MPI_COMM_NULL_COPY_FN, delete_node_communicator,
+                             &node_communicator_keyval, NULL);
+    }
+
+    void* attribute = NULL;
+    int found = 0;
+    MPI_Comm_get_attr(comm, node_communicator_keyval, &attribute, &found);
+    if (found)
+      return *static_cast<std::shared_ptr<NodeCommunicator>*>(attribute);
+
+    std::shared_ptr<NodeCommunicator>* node
+      = new std::shared_ptr<NodeCommunicator>(new NodeCommunicator(comm));
+    MPI_Comm_set_attr(comm, node_communicator_keyval, node);
+    return *node;
+  }
+
+  // Shared memory window, attached to the PETSc Vec so that the
+  // memory outlives every reference to the Vec
+  PetscErrorCode destroy_shared_window(void* ctx)
+  {
+    MPI_Win* window = static_cast<MPI_Win*>(ctx);
+    MPI_Win_unlock_all(*window);
+    MPI_Win_free(window);
+    delete window;
+    return 0;
+  }
+}
+#endif
+
+// Lookup data for a vector whose owned entries and off-node ghosts
+// live in an MPI-3 shared memory window. The local (DOLFIN) indices
+// of the vector are the owned entries followed by all ghosts, in
+// the order of ghost_indices, while the local form of the PETSc Vec
+// holds only the off-node ghosts. Access by local index therefore
+// goes through this data and not through the local form.
+struct PETScVector::SharedGhosts
+{
+  // Number of owned entries
+  std::size_t local_size;
+
+  // Pointer to the value of each ghost, either in the shared memory
+  // of an owner on the same node or in the local ghost storage of
+  // this process (for off-node ghosts)
+  std::vector<const PetscScalar*> ghost_values;
+
+  // Data required to re-create the vector layout when copying, and
+  // to map local indices of ghosts to global indices
+  std::vector<std::size_t> local_to_global_map;
+  std::vector<la_index> ghost_indices;
+
+  #ifdef DOLFIN_HAS_MPI_SHARED_MEMORY
+  // Node-local communicator and window (owned by the PETSc Vec)
+  std::shared_ptr<NodeCommunicator> node;
+  MPI_Win window;
+  #endif
+};
+
 const std::map<std::string, NormType> PETScVector::norm_types
 = { {"l1",   NORM_1}, {"l2",   NORM_2},  {"linf", NORM_INFINITY} };
 
@@ -74,7 +202,7 @@ PETScVector::PETScVector(MPI_Comm comm, std::size_t N, bool use_gpu)
 
   // Compute a local range
   const std::pair<std::size_t, std::size_t> range = MPI::local_range(comm, N);
-  _init(comm, range, local_to_global_map, ghost_indices);
+  _init(comm, range, local_to_global_map, ghost_indices, false);
 }
 //-----------------------------------------------------------------------------
 PETScVector::PETScVector(const GenericSparsityPattern& sparsity_pattern)
@@ -83,7 +211,7 @@ PETScVector::PETScVector(const GenericSparsityPattern& sparsity_pattern)
   std::vector<la_index> ghost_indices;
   std::vector<std::size_t> local_to_global_map;
   _init(sparsity_pattern.mpi_comm(), sparsity_pattern.local_range(0),
-        local_to_global_map, ghost_indices);
+        local_to_global_map, ghost_indices, false);
 }
 //-----------------------------------------------------------------------------
 PETScVector::PETScVector(Vec x): _x(x), _use_gpu(false)
@@ -96,9 +224,19 @@ PETScVector::PETScVector(const PETScVector& v) : _x(NULL), _use_gpu(false)
 {
   PetscErrorCode ierr;
 
-  // Create new vector
-  ierr = VecDuplicate(v._x, &_x);
-  if (ierr != 0) petsc_error(ierr, __FILE__, "VecDuplicate");
+  // Create new vector, with a new shared memory window if the entries
+  // of v are in shared memory
+  if (v._shared_ghosts)
+  {
+    _init(v.mpi_comm(), v.local_range(),
+          v._shared_ghosts->local_to_global_map,
+          v._shared_ghosts->ghost_indices, true);
+  }
+  else
+  {
+    ierr = VecDuplicate(v._x, &_x);
+    if (ierr != 0) petsc_error(ierr, __FILE__, "VecDuplicate");
+  }
 
   // Copy data
   ierr = VecCopy(v._x, _x);
@@ -180,7 +318,8 @@ void PETScVector::init(MPI_Comm comm,
                        const std::vector<la_index>& ghost_indices)
 {
   // Re-initialise vector
-  _init(comm, range, local_to_global_map, ghost_indices);
+  const bool shared_memory = parameters["petsc_shared_memory_ghosts"];
+  _init(comm, range, local_to_global_map, ghost_indices, shared_memory);
 }
 //-----------------------------------------------------------------------------
 void PETScVector::get_local(std::vector<double>& values) const
@@ -224,9 +363,7 @@ void PETScVector::set_local(const std::vector<double>& values)
   for (std::size_t i = 0; i < local_size; ++i)
     rows[i] += i;
 
-  PetscErrorCode ierr = VecSetValuesLocal(_x, local_size, rows.data(),
-                                          values.data(), INSERT_VALUES);
-  if (ierr != 0) petsc_error(ierr, __FILE__, "VecSetValues");
+  set_local(values.data(), local_size, rows.data());
 }
 //-----------------------------------------------------------------------------
 void PETScVector::add_local(const Array<double>& values)
@@ -248,9 +385,7 @@ void PETScVector::add_local(const Array<double>& values)
   for (std::size_t i = 0; i < local_size; ++i)
     rows[i] += i;
 
-  PetscErrorCode ierr = VecSetValuesLocal(_x, local_size, rows.data(),
-                                     values.data(), ADD_VALUES);
-  if (ierr != 0) petsc_error(ierr, __FILE__, "VecSetValuesLocal");
+  add_local(values.data(), local_size, rows.data());
 }
 //-----------------------------------------------------------------------------
 void PETScVector::get_local(double* block, std::size_t m,
@@ -262,6 +397,35 @@ void PETScVector::get_local(double* block, std::size_t m,
   dolfin_assert(_x);
   PetscErrorCode ierr;
 
+  // Entries in shared memory: read owned values from local array and
+  // ghost values in place (from the owner's memory when on-node)
+  if (_shared_ghosts)
+  {
+    const std::size_t local_size = _shared_ghosts->local_size;
+    const std::vector<const PetscScalar*>& ghost_values
+      = _shared_ghosts->ghost_values;
+
+    const PetscScalar* data;
+    ierr = VecGetArrayRead(_x, &data);
+    if (ierr != 0) petsc_error(ierr, __FILE__, "VecGetArrayRead");
+
+    for (std::size_t i = 0; i < m; ++i)
+    {
+      const std::size_t row = rows[i];
+      if (row < local_size)
+        block[i] = data[row];
+      else
+      {
+        dolfin_assert(row - local_size < ghost_values.size());
+        block[i] = *ghost_values[row - local_size];
+      }
+    }
+
+    ierr = VecRestoreArrayRead(_x, &data);
+    if (ierr != 0) petsc_error(ierr, __FILE__, "VecRestoreArrayRead");
+    return;
+  }
+
   Vec xg;
   ierr = VecGhostGetLocalForm(_x, &xg);
   if (ierr != 0) petsc_error(ierr, __FILE__, "VecGhostGetLocalForm");
@@ -320,6 +484,11 @@ void PETScVector::set_local(const double* block, std::size_t m,
   dolfin_assert(_x);
   if (m == 0)
     return;
+  if (_shared_ghosts)
+  {
+    _set_local_shared(block, m, rows, INSERT_VALUES);
+    return;
+  }
   PetscErrorCode ierr = VecSetValuesLocal(_x, m, rows, block, INSERT_VALUES);
   if (ierr != 0) petsc_error(ierr, __FILE__, "VecSetValuesLocal");
 }
@@ -340,6 +509,11 @@ void PETScVector::add_local(const double* block, std::size_t m,
   dolfin_assert(_x);
   if (m == 0)
     return;
+  if (_shared_ghosts)
+  {
+    _set_local_shared(block, m, rows, ADD_VALUES);
+    return;
+  }
   PetscErrorCode ierr = VecSetValuesLocal(_x, m, rows, block, ADD_VALUES);
   if (ierr != 0) petsc_error(ierr, __FILE__, "VecSetValuesLocal");
 }
@@ -474,6 +648,19 @@ void PETScVector::update_ghost_values()
   dolfin_assert(_x);
   PetscErrorCode ierr;
 
+  // On-node ghosts are read directly from the owner's memory; make
+  // sure all writes by processes on this node are visible before
+  // returning. Off-node ghosts are the ghosts of the PETSc Vec and
+  // are updated below.
+  #ifdef DOLFIN_HAS_MPI_SHARED_MEMORY
+  if (_shared_ghosts)
+  {
+    MPI_Win_sync(_shared_ghosts->window);
+    MPI_Barrier(_shared_ghosts->node->node_comm);
+    MPI_Win_sync(_shared_ghosts->window);
+  }
+  #endif
+
   #if PETSC_VERSION_MAJOR == 3 && PETSC_VERSION_MINOR <= 3
   if (dolfin::MPI::size(mpi_comm()) > 1)
   #endif
@@ -857,7 +1044,8 @@ void PETScVector::gather_on_zero(std::vector<double>& x) const
 void PETScVector::_init(MPI_Comm comm,
                         std::pair<std::size_t, std::size_t> range,
                         const std::vector<std::size_t>& local_to_global_map,
-                        const std::vector<la_index>& ghost_indices)
+                        const std::vector<la_index>& ghost_indices,
+                        bool shared_memory)
 {
   PetscErrorCode ierr;
   if (_x)
@@ -878,12 +1066,32 @@ void PETScVector::_init(MPI_Comm comm,
   const std::size_t local_size = range.second - range.first;
   dolfin_assert(range.second >= range.first);
 
+  // Create vector with entries in a node-local shared memory window
+  // or in private memory. Shared memory is only of use when the
+  // vector is distributed (GPU vectors are not).
+  _shared_ghosts.reset();
+  if (shared_memory && !_use_gpu && MPI::size(comm) > 1)
+  {
+    #ifdef DOLFIN_HAS_MPI_SHARED_MEMORY
+    _init_shared_memory(comm, range, ghost_indices);
+    _shared_ghosts->local_to_global_map = local_to_global_map;
+    #else
+    warning("Shared memory ghosted vectors require MPI-3. "
+            "Using private memory");
+    #endif
+  }
+
   // Copy ghost indices
-  ierr = VecCreateGhost(comm, local_size, PETSC_DECIDE,
-                        ghost_indices.size(), ghost_indices.data(), &_x);
-  if (ierr != 0) petsc_error(ierr, __FILE__, "VecCreateGhost");
+  if (!_x)
+  {
+    ierr = VecCreateGhost(comm, local_size, PETSC_DECIDE,
+                          ghost_indices.size(), ghost_indices.data(), &_x);
+    if (ierr != 0) petsc_error(ierr, __FILE__, "VecCreateGhost");
+  }
 
-  // Build global-to-local map for ghost indices
+  // Build global-to-local map for ghost indices (position of ghost
+  // after the owned entries in DOLFIN local numbering, which for
+  // vectors in shared memory includes on-node ghosts)
   ghost_global_to_local.clear();
   for (std::size_t i = 0; i < ghost_indices.size(); ++i)
   {
@@ -891,6 +1099,12 @@ void PETScVector::_init(MPI_Comm comm,
                                  std::size_t>(ghost_indices[i], i));
   }
 
+  // Vectors in shared memory are accessed by local index through
+  // _shared_ghosts; the local form of the Vec (owned entries and
+  // off-node ghosts) keeps the mapping set by VecCreateGhostWithArray
+  if (_shared_ghosts)
+    return;
+
   ISLocalToGlobalMapping petsc_local_to_global;
   std::vector<PetscInt> _map;
   if (!local_to_global_map.empty())
@@ -916,6 +1130,178 @@ void PETScVector::_init(MPI_Comm comm,
   ISLocalToGlobalMappingDestroy(&petsc_local_to_global);
 }
 //-----------------------------------------------------------------------------
+void
+PETScVector::_init_shared_memory(MPI_Comm comm,
+                                 std::pair<std::size_t, std::size_t> range,
+                                 const std::vector<la_index>& ghost_indices)
+{
+  #ifndef DOLFIN_HAS_MPI_SHARED_MEMORY
+  dolfin_error("PETScVector.cpp",
+               "create vector in shared memory",
+               "MPI-3 is required for shared memory windows");
+  #else
+  PetscErrorCode ierr;
+  const std::size_t local_size = range.second - range.first;
+
+  // Communicator for processes that can share memory with this one
+  // (cached on comm)
+  std::shared_ptr<NodeCommunicator> node = node_communicator(comm);
+  const MPI_Comm node_comm = node->node_comm;
+  const std::vector<int>& node_ranks = node->node_ranks;
+
+  // Start of ownership range of each process, reused from the last
+  // vector on comm if no process has a different range
+  const std::size_t num_processes = MPI::size(comm);
+  const std::size_t process_number = MPI::rank(comm);
+  std::vector<std::size_t>& range_starts = node->range_starts;
+  const std::size_t same_ranges
+    = (range_starts.size() == num_processes + 1
+       && range_starts[process_number] == range.first
+       && range_starts[process_number + 1] == range.second) ? 1 : 0;
+  if (MPI::min(comm, same_ranges) == 0)
+  {
+    MPI::all_gather(comm, range.first, range_starts);
+    range_starts.push_back(MPI::max(comm, range.second));
+  }
+
+  // Find owner of each ghost and collect ghosts owned off-node, which
+  // are still communicated by PETSc
+  std::vector<int> ghost_owners(ghost_indices.size());
+  std::vector<la_index> off_node_ghosts;
+  for (std::size_t i = 0; i < ghost_indices.size(); ++i)
+  {
+    const std::size_t index = ghost_indices[i];
+    const int owner = std::upper_bound(range_starts.begin(),
+                                       range_starts.end() - 1, index)
+      - range_starts.begin() - 1;
+    dolfin_assert(owner >= 0);
+    ghost_owners[i] = owner;
+    if (node_ranks[owner] == MPI_UNDEFINED)
+      off_node_ghosts.push_back(ghost_indices[i]);
+  }
+
+  // Allocate owned entries and off-node ghosts in shared memory. Let
+  // each process segment be placed in memory local to that process.
+  MPI_Info info;
+  MPI_Info_create(&info);
+  MPI_Info_set(info, const_cast<char*>("alloc_shared_noncontig"),
+               const_cast<char*>("true"));
+  const std::size_t num_entries = local_size + off_node_ghosts.size();
+  PetscScalar* base = NULL;
+  MPI_Win window;
+  MPI_Win_allocate_shared(num_entries*sizeof(PetscScalar),
+                          sizeof(PetscScalar), info, node_comm, &base,
+                          &window);
+  MPI_Info_free(&info);
+  std::fill(base, base + num_entries, 0.0);
+
+  // Open passive target access epoch for the lifetime of the window
+  MPI_Win_lock_all(MPI_MODE_NOCHECK, window);
+
+  // Create ghosted PETSc vector on shared memory
+  ierr = VecCreateGhostWithArray(comm, local_size, PETSC_DECIDE,
+                                 off_node_ghosts.size(),
+                                 off_node_ghosts.data(), base, &_x);
+  if (ierr != 0) petsc_error(ierr, __FILE__, "VecCreateGhostWithArray");
+
+  // Attach window to Vec so that it is freed with the Vec
+  PetscContainer container;
+  PetscContainerCreate(PETSC_COMM_SELF, &container);
+  PetscContainerSetPointer(container, new MPI_Win(window));
+  PetscContainerSetUserDestroy(container, destroy_shared_window);
+  PetscObjectCompose((PetscObject) _x, "dolfin_shared_window",
+                     (PetscObject) container);
+  PetscContainerDestroy(&container);
+
+  // Make initial values of all processes on node visible
+  MPI_Win_sync(window);
+  MPI_Barrier(node_comm);
+  MPI_Win_sync(window);
+
+  // Locate value of each ghost, in the segment of the owner if it is
+  // on this node and in the local ghost storage otherwise
+  _shared_ghosts.reset(new SharedGhosts);
+  _shared_ghosts->local_size = local_size;
+  _shared_ghosts->ghost_indices = ghost_indices;
+  _shared_ghosts->node = node;
+  _shared_ghosts->window = window;
+  std::vector<const PetscScalar*>& ghost_values
+    = _shared_ghosts->ghost_values;
+  ghost_values.resize(ghost_indices.size());
+  std::vector<PetscScalar*> segments(MPI::size(node_comm), NULL);
+  std::size_t off_node_position = local_size;
+  for (std::size_t i = 0; i < ghost_indices.size(); ++i)
+  {
+    const int owner = ghost_owners[i];
+    const int node_owner = node_ranks[owner];
+    if (node_owner == MPI_UNDEFINED)
+    {
+      ghost_values[i] = base + off_node_position++;
+      continue;
+    }
+
+    if (!segments[node_owner])
+    {
+      MPI_Aint segment_size;
+      int disp_unit;
+      MPI_Win_shared_query(window, node_owner, &segment_size, &disp_unit,
+                           &segments[node_owner]);
+    }
+    ghost_values[i]
+      = segments[node_owner] + (ghost_indices[i] - range_starts[owner]);
+  }
+  #endif
+}
+//-----------------------------------------------------------------------------
+void PETScVector::_set_local_shared(const double* block, std::size_t m,
+                                    const dolfin::la_index* rows,
+                                    InsertMode mode)
+{
+  dolfin_assert(_shared_ghosts);
+  const std::size_t local_size = _shared_ghosts->local_size;
+  const std::vector<std::size_t>& local_to_global_map
+    = _shared_ghosts->local_to_global_map;
+  const std::vector<la_index>& ghost_indices = _shared_ghosts->ghost_indices;
+
+  // Owned entries are set in the local array. Ghost entries are set
+  // by global index, and sent to their owner by apply().
+  PetscScalar* data;
+  PetscErrorCode ierr = VecGetArray(_x, &data);
+  if (ierr != 0) petsc_error(ierr, __FILE__, "VecGetArray");
+
+  std::vector<PetscInt> ghost_rows;
+  std::vector<PetscScalar> ghost_block;
+  for (std::size_t i = 0; i < m; ++i)
+  {
+    const std::size_t row = rows[i];
+    if (row < local_size)
+    {
+      if (mode == ADD_VALUES)
+        data[row] += block[i];
+      else
+        data[row] = block[i];
+    }
+    else
+    {
+      dolfin_assert(row - local_size < ghost_indices.size());
+      ghost_rows.push_back(local_to_global_map.empty()
+                           ? ghost_indices[row - local_size]
+                           : local_to_global_map[row]);
+      ghost_block.push_back(block[i]);
+    }
+  }
+
+  ierr = VecRestoreArray(_x, &data);
+  if (ierr != 0) petsc_error(ierr, __FILE__, "VecRestoreArray");
+
+  if (!ghost_rows.empty())
+  {
+    ierr = VecSetValues(_x, ghost_rows.size(), ghost_rows.data(),
+                        ghost_block.data(), mode);
+    if (ierr != 0) petsc_error(ierr, __FILE__, "VecSetValues");
+  }
+}
+//-----------------------------------------------------------------------------
 Vec PETScVector::vec() const
 {
   return _x;
@@ -22,7 +22,7 @@
 // Modified by Fredrik Valdmanis, 2011.
 //
 // First added:  2004-01-01
-// Last changed: 2011-09-29
+// Last changed: 2015-01-22
 
 #ifndef __PETSC_VECTOR_H
 #define __PETSC_VECTOR_H
@@ -56,6 +56,17 @@ namespace dolfin
   /// The interface is intentionally simple. For advanced usage,
   /// access the PETSc Vec pointer using the function vec() and
   /// use the standard PETSc interface.
+  ///
+  /// If the global parameter "petsc_shared_memory_ghosts" is set and
+  /// DOLFIN is built against an MPI-3 library, the entries of ghosted
+  /// vectors are allocated in a shared memory window spanning the
+  /// processes on each node. Ghost values owned by a process on the
+  /// same node are then read in place from the owner's memory, and
+  /// only ghosts owned by processes on other nodes are communicated
+  /// by update_ghost_values(). Local indices keep the usual layout
+  /// (owned entries followed by all ghosts) for the *_local
+  /// functions; the local form of the PETSc Vec holds only the owned
+  /// entries and the off-node ghosts.
 
   class PETScVector : public GenericVector, public PETScObject
   {
@@ -225,6 +236,7 @@ namespace dolfin
     /// Assignment operator
     virtual const PETScVector& operator= (double a);
 
+    /// Update ghost values from their owning processes (collective)
     virtual void update_ghost_values();
 
     //--- Special functions ---
@@ -245,10 +257,26 @@ namespace dolfin
 
   private:
 
-    // Initialise PETSc vector
+    // Lookup data for vectors with entries in shared memory
+    struct SharedGhosts;
+
+    // Initialise PETSc vector, optionally with entries in a
+    // node-local shared memory window
     void _init(MPI_Comm comm, std::pair<std::size_t, std::size_t> range,
                const std::vector<std::size_t>& local_to_global_map,
-               const std::vector<la_index>& ghost_indices);
+               const std::vector<la_index>& ghost_indices,
+               bool shared_memory);
+
+    // Create ghosted PETSc vector with entries allocated in a
+    // shared memory window (requires MPI-3)
+    void _init_shared_memory(MPI_Comm comm,
+                             std::pair<std::size_t, std::size_t> range,
+                             const std::vector<la_index>& ghost_indices);
+
+    // Set or add entries with given local indices (owned and ghost)
+    // of a vector with entries in shared memory
+    void _set_local_shared(const double* block, std::size_t m,
+                           const dolfin::la_index* rows, InsertMode mode);
 
     // Return true if vector is distributed
     bool distributed() const;
@@ -265,6 +293,10 @@ namespace dolfin
     // PETSc vector architecture
     const bool _use_gpu;
 
+    // Shared memory ghost data (NULL unless entries are in a shared
+    // memory window)
+    std::unique_ptr<SharedGhosts> _shared_ghosts;
+
   };
 
 }
@@ -20,7 +20,7 @@
 // Modified by Ola Skavhaug, 2009.
 //
 // First added:  2007-03-13
-// Last changed: 2014-11-26
+// Last changed: 2015-01-22
 
 #include <algorithm>
 
@@ -33,7 +33,8 @@ using namespace dolfin;
 
 //-----------------------------------------------------------------------------
 SparsityPattern::SparsityPattern(std::size_t primary_dim)
-  : GenericSparsityPattern(primary_dim), _mpi_comm(MPI_COMM_NULL)
+  : GenericSparsityPattern(primary_dim), MemoryTracked("Sparsity patterns"),
+    _mpi_comm(MPI_COMM_NULL)
 {
   // Do nothing
 }
@@ -46,7 +47,8 @@ SparsityPattern::SparsityPattern(
   const std::vector<const std::vector<int>* > off_process_owner,
   const std::vector<std::size_t>& block_sizes,
   std::size_t primary_dim)
-  : GenericSparsityPattern(primary_dim), _mpi_comm(MPI_COMM_NULL)
+  : GenericSparsityPattern(primary_dim), MemoryTracked("Sparsity patterns"),
+    _mpi_comm(MPI_COMM_NULL)
 {
   init(mpi_comm, dims, local_range, local_to_global, off_process_owner,
        block_sizes);
@@ -479,6 +481,25 @@ void SparsityPattern::apply()
   non_local.clear();
 }
 //-----------------------------------------------------------------------------
+std::size_t SparsityPattern::memory_usage() const
+{
+  std::size_t bytes = sizeof(*this)
+    + vector_memory_usage(_local_range)
+    + vector_memory_usage(non_local)
+    + vector_memory_usage(_local_to_global)
+    + vector_memory_usage(_off_process_owner)
+    + vector_memory_usage(_block_size);
+
+  // Rows of diagonal and off-diagonal blocks
+  bytes += (diagonal.capacity() + off_diagonal.capacity())*sizeof(set_type);
+  for (std::size_t i = 0; i < diagonal.size(); i++)
+    bytes += vector_memory_usage(diagonal[i].set());
+  for (std::size_t i = 0; i < off_diagonal.size(); i++)
+    bytes += vector_memory_usage(off_diagonal[i].set());
+
+  return bytes;
+}
+//-----------------------------------------------------------------------------
 std::string SparsityPattern::str(bool verbose) const
 {
   // Print each row
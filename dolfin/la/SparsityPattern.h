@@ -18,7 +18,7 @@
 // Modified by Anders Logg, 2007-2009.
 //
 // First added:  2007-03-13
-// Last changed: 2011-01-02
+// Last changed: 2015-01-22
 
 #ifndef __SPARSITY_PATTERN_H
 #define __SPARSITY_PATTERN_H
@@ -28,6 +28,7 @@
 #include <utility>
 #include <vector>
 
+#include "dolfin/common/MemoryTracked.h"
 #include "dolfin/common/Set.h"
 #include "dolfin/common/types.h"
 #include "GenericSparsityPattern.h"
@@ -38,7 +39,7 @@ namespace dolfin
   /// This class implements the GenericSparsityPattern interface.  It
   /// is used by most linear algebra backends.
 
-  class SparsityPattern : public GenericSparsityPattern
+  class SparsityPattern : public GenericSparsityPattern, public MemoryTracked
   {
 
     // NOTE: Do not change this typedef without performing careful
@@ -111,6 +112,9 @@ namespace dolfin
     MPI_Comm mpi_comm() const
     { return _mpi_comm; }
 
+    /// Return number of bytes used by sparsity pattern
+    std::size_t memory_usage() const;
+
     /// Return informal string representation (pretty-print)
     std::string str(bool verbose) const;
 
@@ -19,7 +19,7 @@
 // Modified by Dag Lindbo 2008
 //
 // First added:  2006-06-01
-// Last changed: 2012-08-20
+// Last changed: 2015-01-21
 
 
 #include <memory>
@@ -236,7 +236,9 @@ void UmfpackLUSolver::numeric_factorize()
   log(PROGRESS, "LU factorization of a matrix of size %d x %d (UMFPACK).",
       M, N);
 
-  dolfin_assert(symbolic);
+  // Perform symbolic factorization if required
+  if (!symbolic)
+    symbolic_factorize();
   numeric.reset();
 
   // Perform LU factorisation
@@ -267,14 +269,14 @@ std::size_t UmfpackLUSolver::solve_factorized(GenericVector& x,
   {
     dolfin_error("UmfpackLUSolver.cpp",
                  "solve linear system with UMFPACK LU solver",
-                 "Missing symbolic factorization, please call UmfpackLUSolver::factorize_symbolic()");
+                 "Missing symbolic factorization, please call UmfpackLUSolver::symbolic_factorize()");
   }
 
   if (!numeric)
   {
     dolfin_error("UmfpackLUSolver.cpp",
                  "solve linear system with UMFPACK LU solver",
-                 "Missing numeric factorization, please call UmfpackLUSolver::factorize_numeric()");
+                 "Missing numeric factorization, please call UmfpackLUSolver::numeric_factorize()");
   }
 
   // Get matrix data
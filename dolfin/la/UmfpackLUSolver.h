@@ -19,7 +19,7 @@
 // Modified by Dag Lindbo 2008
 //
 // First added:  2006-05-31
-// Last changed: 2012-08-20
+// Last changed: 2015-01-22
 
 #ifndef __UMFPACK_LU_SOLVER_H
 #define __UMFPACK_LU_SOLVER_H
@@ -70,17 +70,22 @@ namespace dolfin
     std::size_t solve(const GenericLinearOperator& A, GenericVector& x,
                       const GenericVector& b);
 
-    /// Default parameter values
-    static Parameters default_parameters();
+    /// Solve linear systems Ax_i = b_i for a set of right-hand sides
+    using GenericLUSolver::solve;
 
-  private:
-
-    // Perform symbolic factorisation
+    /// Perform symbolic factorisation (fill-reducing ordering and
+    /// analysis of the nonzero pattern)
     void symbolic_factorize();
 
-    // LU factorisation
+    /// Perform numeric LU factorisation, re-using the symbolic
+    /// factorisation (computed if not present)
     void numeric_factorize();
 
+    /// Default parameter values
+    static Parameters default_parameters();
+
+  private:
+
     // Solve factorized system (UMFPACK).
     std::size_t solve_factorized(GenericVector& x,
                                  const GenericVector& b) const;
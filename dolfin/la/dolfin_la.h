@@ -56,12 +56,15 @@
 #include <dolfin/la/uBLASPreconditioner.h>
 #include <dolfin/la/uBLASKrylovSolver.h>
 #include <dolfin/la/uBLASILUPreconditioner.h>
+#include <dolfin/la/uBLASJacobiPreconditioner.h>
+#include <dolfin/la/uBLASChebyshevPreconditioner.h>
 #include <dolfin/la/Vector.h>
 #include <dolfin/la/Matrix.h>
 #include <dolfin/la/Scalar.h>
 #include <dolfin/la/LinearSolver.h>
 #include <dolfin/la/KrylovSolver.h>
 #include <dolfin/la/LUSolver.h>
+#include <dolfin/la/MixedPrecisionSolver.h>
 #include <dolfin/la/solve.h>
 #include <dolfin/la/test_nullspace.h>
 #include <dolfin/la/BlockVector.h>
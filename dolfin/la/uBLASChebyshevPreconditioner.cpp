@@ -0,0 +1,228 @@
+// Copyright (C) 2015 The FEniCS Project
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2015-01-20
+// Last changed: 2015-01-22
+
+#include <algorithm>
+#include <cmath>
+
+#ifdef HAS_OPENMP
+#include <omp.h>
+#endif
+
+#include <dolfin/common/NoDeleter.h>
+#include <dolfin/common/constants.h>
+#include <dolfin/parameter/GlobalParameters.h>
+#include "uBLASLinearOperator.h"
+#include "uBLASSparseMatrix.h"
+#include "uBLASChebyshevPreconditioner.h"
+
+using namespace dolfin;
+
+//-----------------------------------------------------------------------------
+uBLASChebyshevPreconditioner::uBLASChebyshevPreconditioner(const Parameters& krylov_parameters)
+  : _degree(0), _lambda_min(0.0), _lambda_max(0.0),
+    _num_threads(0), parameters(krylov_parameters)
+{
+  // Do nothing
+}
+//-----------------------------------------------------------------------------
+uBLASChebyshevPreconditioner::~uBLASChebyshevPreconditioner()
+{
+  // Do nothing
+}
+//-----------------------------------------------------------------------------
+void uBLASChebyshevPreconditioner::init(const uBLASMatrix<ublas_sparse_matrix>& P)
+{
+  init(reference_to_no_delete_pointer(P));
+}
+//-----------------------------------------------------------------------------
+void uBLASChebyshevPreconditioner::init(
+  std::shared_ptr<const uBLASMatrix<ublas_sparse_matrix> > P)
+{
+  dolfin_assert(P);
+  _matA = P;
+  _op.reset();
+
+  // Compute inverse of diagonal
+  const ublas_sparse_matrix& A = _matA->mat();
+  const std::size_t size = A.size1();
+  _inverse_diagonal.resize(size, false);
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    double diagonal = 0.0;
+    for (std::size_t k = A.index1_data()[i]; k < A.index1_data()[i + 1]; ++k)
+    {
+      if (A.index2_data()[k] == i)
+        diagonal = A.value_data()[k];
+    }
+    if (std::abs(diagonal) < DOLFIN_EPS)
+    {
+      dolfin_error("uBLASChebyshevPreconditioner.cpp",
+                   "initialize uBLAS Chebyshev preconditioner",
+                   "Zero diagonal detected in row %d", i);
+    }
+    _inverse_diagonal[i] = 1.0/diagonal;
+  }
+
+  init_common(size);
+}
+//-----------------------------------------------------------------------------
+void uBLASChebyshevPreconditioner::init(const uBLASLinearOperator& P)
+{
+  init(reference_to_no_delete_pointer(P));
+}
+//-----------------------------------------------------------------------------
+void uBLASChebyshevPreconditioner::init(
+  std::shared_ptr<const uBLASLinearOperator> P)
+{
+  dolfin_assert(P);
+  _matA.reset();
+  _op = P;
+
+  // No scaling for matrix-free operators
+  const std::size_t size = P->size(0);
+  _inverse_diagonal.resize(size, false);
+  std::fill(_inverse_diagonal.begin(), _inverse_diagonal.end(), 1.0);
+
+  init_common(size);
+}
+//-----------------------------------------------------------------------------
+void uBLASChebyshevPreconditioner::init_common(std::size_t size)
+{
+  _degree = parameters("preconditioner")("chebyshev")["degree"];
+  const double ratio
+    = parameters("preconditioner")("chebyshev")["eigenvalue_ratio"];
+  const std::size_t num_iterations
+    = parameters("preconditioner")("chebyshev")["eigenvalue_iterations"];
+  _num_threads = dolfin::parameters["num_threads"];
+
+  if (_degree == 0)
+  {
+    dolfin_error("uBLASChebyshevPreconditioner.cpp",
+                 "initialize uBLAS Chebyshev preconditioner",
+                 "Polynomial degree must be positive");
+  }
+
+  _r.resize(size);
+  _d.resize(size);
+  _w.resize(size);
+  ublas_vector& r = _r.vec();
+  ublas_vector& w = _w.vec();
+
+  // Estimate largest eigenvalue of D^{-1}A by power iteration. The
+  // start vector is chosen to be unlikely to be orthogonal to the
+  // dominant eigenvector.
+  for (std::size_t i = 0; i < size; ++i)
+    r[i] = 1.0 + static_cast<double>(i % 7)/7.0;
+  r /= norm_2(r);
+  double lambda = 0.0;
+  for (std::size_t it = 0; it < num_iterations; ++it)
+  {
+    mult(_r, _w);
+    w = element_prod(_inverse_diagonal, w);
+    lambda = inner_prod(r, w);
+    const double w_norm = norm_2(w);
+    if (w_norm < DOLFIN_EPS)
+      break;
+    r = w/w_norm;
+  }
+
+  // Power iteration underestimates the largest eigenvalue, so add a
+  // safety margin
+  _lambda_max = 1.1*std::abs(lambda);
+  _lambda_min = _lambda_max/ratio;
+
+  if (_lambda_max < DOLFIN_EPS)
+  {
+    dolfin_error("uBLASChebyshevPreconditioner.cpp",
+                 "initialize uBLAS Chebyshev preconditioner",
+                 "Unable to estimate spectrum of operator");
+  }
+}
+//-----------------------------------------------------------------------------
+void uBLASChebyshevPreconditioner::solve(uBLASVector& x,
+                                         const uBLASVector& b) const
+{
+  ublas_vector& _x = x.vec();
+  const ublas_vector& _b = b.vec();
+  ublas_vector& r = _r.vec();
+  ublas_vector& d = _d.vec();
+  ublas_vector& w = _w.vec();
+  dolfin_assert(_b.size() == _inverse_diagonal.size());
+  dolfin_assert(_x.size() == _b.size());
+
+  // Chebyshev iteration for D^{-1}A with zero initial guess, see
+  // Y. Saad, "Iterative Methods for Sparse Linear Systems",
+  // Algorithm 12.1
+  const double theta = 0.5*(_lambda_max + _lambda_min);
+  const double delta = 0.5*(_lambda_max - _lambda_min);
+  const double sigma = theta/delta;
+  double rho = 1.0/sigma;
+
+  r.assign(_b);
+  noalias(d) = element_prod(_inverse_diagonal, r)/theta;
+  _x.assign(d);
+  for (std::size_t k = 1; k < _degree; ++k)
+  {
+    // r = r - A*d
+    mult(_d, _w);
+    noalias(r) -= w;
+
+    // d = rho_new*rho*d + (2*rho_new/delta)*D^{-1}r
+    const double rho_new = 1.0/(2.0*sigma - rho);
+    d *= rho_new*rho;
+    noalias(d) += (2.0*rho_new/delta)*element_prod(_inverse_diagonal, r);
+    noalias(_x) += d;
+
+    rho = rho_new;
+  }
+}
+//-----------------------------------------------------------------------------
+void uBLASChebyshevPreconditioner::mult(const uBLASVector& x,
+                                        uBLASVector& y) const
+{
+  if (_op)
+  {
+    _op->mult(x, y);
+    return;
+  }
+
+  dolfin_assert(_matA);
+  const ublas_sparse_matrix& A = _matA->mat();
+  const int size = A.size1();
+  const std::size_t* row_ptr = &A.index1_data()[0];
+  const std::size_t* cols = &A.index2_data()[0];
+  const double* values = &A.value_data()[0];
+  const double* xx = &(x.vec())[0];
+  double* yy = &(y.vec())[0];
+
+  #ifdef HAS_OPENMP
+  const int num_threads = std::max((int) _num_threads, 1);
+  #pragma omp parallel for schedule(static) num_threads(num_threads) \
+    if (_num_threads > 0)
+  #endif
+  for (int i = 0; i < size; ++i)
+  {
+    double sum = 0.0;
+    for (std::size_t k = row_ptr[i]; k < row_ptr[i + 1]; ++k)
+      sum += values[k]*xx[cols[k]];
+    yy[i] = sum;
+  }
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,116 @@
+// Copyright (C) 2015 The FEniCS Project
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2015-01-20
+// Last changed: 2015-01-22
+
+#ifndef __UBLAS_CHEBYSHEV_PRECONDITIONER_H
+#define __UBLAS_CHEBYSHEV_PRECONDITIONER_H
+
+#include <memory>
+#include "ublas.h"
+#include "uBLASPreconditioner.h"
+#include "uBLASMatrix.h"
+#include "uBLASVector.h"
+
+namespace dolfin
+{
+
+  template<typename Mat> class uBLASMatrix;
+  class uBLASLinearOperator;
+
+  /// This class implements a Chebyshev polynomial preconditioner
+  /// (smoother) for the uBLAS Krylov solver. Applying the
+  /// preconditioner performs a fixed number ("degree") of
+  /// Jacobi-scaled Chebyshev iterations with a zero initial guess,
+  /// and therefore only requires matrix-vector products. The upper
+  /// bound of the spectrum is estimated by power iteration, and the
+  /// lower bound is taken as the upper bound divided by
+  /// "eigenvalue_ratio". For a matrix-free operator, no diagonal
+  /// scaling is applied. Sparse matrix-vector products use OpenMP
+  /// threads when the global parameter "num_threads" is non-zero.
+
+  class uBLASChebyshevPreconditioner : public uBLASPreconditioner
+  {
+  public:
+
+    /// Constructor
+    uBLASChebyshevPreconditioner(const Parameters& krylov_parameters);
+
+    /// Destructor
+    ~uBLASChebyshevPreconditioner();
+
+    /// Initialise preconditioner (sparse matrix). The matrix must
+    /// outlive the preconditioner.
+    void init(const uBLASMatrix<ublas_sparse_matrix>& P);
+
+    /// Initialise preconditioner (sparse matrix, kept by the
+    /// preconditioner)
+    void init(std::shared_ptr<const uBLASMatrix<ublas_sparse_matrix> > P);
+
+    /// Initialise preconditioner (virtual matrix). The operator must
+    /// outlive the preconditioner.
+    void init(const uBLASLinearOperator& P);
+
+    /// Initialise preconditioner (virtual matrix, kept by the
+    /// preconditioner)
+    void init(std::shared_ptr<const uBLASLinearOperator> P);
+
+    /// Solve linear system Ax = b approximately
+    void solve(uBLASVector& x, const uBLASVector& b) const;
+
+    /// Return estimated bounds of the spectrum of the (scaled)
+    /// operator
+    std::pair<double, double> eigenvalue_bounds() const
+    { return std::make_pair(_lambda_min, _lambda_max); }
+
+  private:
+
+    // Read parameters and estimate spectrum
+    void init_common(std::size_t size);
+
+    // Compute y = Ax
+    void mult(const uBLASVector& x, uBLASVector& y) const;
+
+    // Sparse matrix (if initialised with a matrix)
+    std::shared_ptr<const uBLASMatrix<ublas_sparse_matrix> > _matA;
+
+    // Linear operator (if initialised with an operator)
+    std::shared_ptr<const uBLASLinearOperator> _op;
+
+    // Inverse of diagonal (scaling)
+    ublas_vector _inverse_diagonal;
+
+    // Polynomial degree
+    std::size_t _degree;
+
+    // Estimated bounds of the spectrum
+    double _lambda_min, _lambda_max;
+
+    // Number of threads
+    std::size_t _num_threads;
+
+    // Work vectors
+    mutable uBLASVector _r, _d, _w;
+
+    const Parameters& parameters;
+
+  };
+
+}
+
+#endif
@@ -18,9 +18,17 @@
 // Modified by Anders Logg, 2006-2010.
 //
 // First added:  2006-06-23
-// Last changed: 2010-08-31
+// Last changed: 2015-01-22
+
+#include <algorithm>
+#include <map>
+
+#ifdef HAS_OPENMP
+#include <omp.h>
+#endif
 
 #include <dolfin/common/constants.h>
+#include <dolfin/parameter/GlobalParameters.h>
 #include "uBLASVector.h"
 #include "uBLASSparseMatrix.h"
 #include "uBLASILUPreconditioner.h"
@@ -29,7 +37,7 @@ using namespace dolfin;
 
 //-----------------------------------------------------------------------------
 uBLASILUPreconditioner::uBLASILUPreconditioner(const Parameters& krylov_parameters)
-  : parameters(krylov_parameters)
+  : _num_threads(0), parameters(krylov_parameters)
 {
   // Do nothing
 }
@@ -43,15 +51,123 @@ void uBLASILUPreconditioner::init(const uBLASMatrix<ublas_sparse_matrix>& P)
 {
   ublas_sparse_matrix& _matM = M.mat();
 
+  // Copy matrix, adding fill-in entries for ILU(k) with k > 0
   const std::size_t size = P.size(0);
-  _matM.resize(size, size, false);
-  _matM.assign(P.mat());
+  const int fill_level = parameters("preconditioner")("ilu")["fill_level"];
+  if (fill_level > 0)
+    symbolic_factorization(P.mat(), fill_level);
+  else
+  {
+    _matM.resize(size, size, false);
+    _matM.assign(P.mat());
+  }
 
   // Add term to diagonal to avoid negative pivots
   const double zero_shift = parameters("preconditioner")["shift_nonzero"];
   if(zero_shift > 0.0)
     _matM.plus_assign( zero_shift*ublas::identity_matrix<double>(size) );
 
+  // Factorise
+  numeric_factorization();
+
+  // Build level schedule for the triangular solves
+  compute_levels();
+
+  // Number of threads for triangular solves
+  _num_threads = dolfin::parameters["num_threads"];
+}
+//-----------------------------------------------------------------------------
+void uBLASILUPreconditioner::symbolic_factorization(const ublas_sparse_matrix& P,
+                                                    std::size_t fill_level)
+{
+  // Compute the ILU(k) sparsity pattern using the level-of-fill
+  // algorithm, see Y. Saad, "Iterative Methods for Sparse Linear
+  // Systems", Section 10.3.3. Entries of P have level zero, and a
+  // fill entry (i, j) created by eliminating with row k has level
+  // lev(i, k) + lev(k, j) + 1. Entries with level > fill_level are
+  // dropped.
+
+  const std::size_t size = P.size1();
+
+  // Pattern and levels of the strictly upper part of each processed
+  // row (needed when eliminating later rows)
+  std::vector<std::vector<std::pair<std::size_t, std::size_t> > >
+    upper(size);
+
+  // Column pattern of each row of the factor
+  std::vector<std::vector<std::size_t> > pattern(size);
+  std::size_t nnz = 0;
+
+  std::map<std::size_t, std::size_t> row;
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    // Initialise row with pattern of P (level zero) and the diagonal
+    row.clear();
+    for (std::size_t k = P.index1_data()[i]; k < P.index1_data()[i + 1]; ++k)
+      row[P.index2_data()[k]] = 0;
+    row[i] = 0;
+
+    // Eliminate with previous rows, in increasing column order. New
+    // fill entries are inserted ahead of the iterator and are
+    // therefore also visited.
+    std::map<std::size_t, std::size_t>::iterator ik;
+    for (ik = row.begin(); ik != row.end() && ik->first < i; ++ik)
+    {
+      const std::size_t k = ik->first;
+      const std::size_t level_ik = ik->second;
+      std::vector<std::pair<std::size_t, std::size_t> >::const_iterator kj;
+      for (kj = upper[k].begin(); kj != upper[k].end(); ++kj)
+      {
+        const std::size_t level = level_ik + kj->second + 1;
+        if (level > fill_level)
+          continue;
+
+        std::map<std::size_t, std::size_t>::iterator ij = row.find(kj->first);
+        if (ij == row.end())
+          row.insert(std::make_pair(kj->first, level));
+        else
+          ij->second = std::min(ij->second, level);
+      }
+    }
+
+    // Store pattern of row, and levels of upper part
+    pattern[i].reserve(row.size());
+    std::map<std::size_t, std::size_t>::const_iterator ij;
+    for (ij = row.begin(); ij != row.end(); ++ij)
+    {
+      pattern[i].push_back(ij->first);
+      if (ij->first > i)
+        upper[i].push_back(*ij);
+    }
+    nnz += row.size();
+  }
+
+  // Create matrix with extended pattern and copy values from P
+  ublas_sparse_matrix& _matM = M.mat();
+  _matM.resize(size, size, false);
+  _matM.clear();
+  _matM.reserve(nnz, false);
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    std::size_t k = P.index1_data()[i];
+    const std::size_t k1 = P.index1_data()[i + 1];
+    std::vector<std::size_t>::const_iterator j;
+    for (j = pattern[i].begin(); j != pattern[i].end(); ++j)
+    {
+      while (k < k1 && P.index2_data()[k] < *j)
+        ++k;
+      const double value
+        = (k < k1 && P.index2_data()[k] == *j) ? P.value_data()[k] : 0.0;
+      _matM.push_back(i, *j, value);
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+void uBLASILUPreconditioner::numeric_factorization()
+{
+  ublas_sparse_matrix& _matM = M.mat();
+  const std::size_t size = _matM.size1();
+
   /*
   // Straightforward and very slow implementation. This is used for verification
   tic();
@@ -151,6 +267,57 @@ void uBLASILUPreconditioner::init(const uBLASMatrix<ublas_sparse_matrix>& P)
   } // k
 }
 //-----------------------------------------------------------------------------
+void uBLASILUPreconditioner::compute_levels()
+{
+  const ublas_sparse_matrix& _matM = M.mat();
+  const std::size_t size = _matM.size1();
+
+  // Row i of L can be eliminated once all rows it depends on are
+  // known, so its level is one more than the maximum level of those
+  // rows. Likewise for U, working from the last row.
+  std::vector<std::size_t> row_level(size, 0);
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    std::size_t level = 0;
+    for (std::size_t k = _matM.index1_data()[i]; k < diagonal[i]; ++k)
+      level = std::max(level, row_level[_matM.index2_data()[k]] + 1);
+    row_level[i] = level;
+  }
+  build_levels(row_level, _lower_level_offsets, _lower_level_rows);
+
+  std::fill(row_level.begin(), row_level.end(), 0);
+  for (std::size_t i = size; i-- > 0; )
+  {
+    std::size_t level = 0;
+    for (std::size_t k = diagonal[i] + 1; k < _matM.index1_data()[i + 1]; ++k)
+      level = std::max(level, row_level[_matM.index2_data()[k]] + 1);
+    row_level[i] = level;
+  }
+  build_levels(row_level, _upper_level_offsets, _upper_level_rows);
+}
+//-----------------------------------------------------------------------------
+void uBLASILUPreconditioner::build_levels(const std::vector<std::size_t>& row_level,
+                                          std::vector<std::size_t>& level_offsets,
+                                          std::vector<std::size_t>& level_rows)
+{
+  const std::size_t num_levels = row_level.empty() ? 0
+    : *std::max_element(row_level.begin(), row_level.end()) + 1;
+
+  // Count rows in each level
+  level_offsets.assign(num_levels + 1, 0);
+  for (std::size_t i = 0; i < row_level.size(); ++i)
+    ++level_offsets[row_level[i] + 1];
+  for (std::size_t l = 0; l < num_levels; ++l)
+    level_offsets[l + 1] += level_offsets[l];
+
+  // Insert rows (in increasing order within each level)
+  std::vector<std::size_t> position(level_offsets.begin(),
+                                    level_offsets.end() - 1);
+  level_rows.resize(row_level.size());
+  for (std::size_t i = 0; i < row_level.size(); ++i)
+    level_rows[position[row_level[i]]++] = i;
+}
+//-----------------------------------------------------------------------------
 void uBLASILUPreconditioner::solve(uBLASVector& x, const uBLASVector& b) const
 {
   // Get underlying uBLAS matrices and vectors
@@ -165,6 +332,56 @@ void uBLASILUPreconditioner::solve(uBLASVector& x, const uBLASVector& b) const
   // Solve in-place
   _x.assign(_b);
 
+  #ifdef HAS_OPENMP
+  if (_num_threads > 0)
+  {
+    const std::size_t* row_ptr = &_matM.index1_data()[0];
+    const std::size_t* cols = &_matM.index2_data()[0];
+    const double* values = &_matM.value_data()[0];
+    double* xx = &_x[0];
+    const int num_threads = _num_threads;
+
+    // Perform level-scheduled substitutions. Rows within a level are
+    // independent, and the implicit barrier at the end of each 'omp
+    // for' separates the levels.
+    #pragma omp parallel num_threads(num_threads)
+    {
+      const int num_lower_levels = _lower_level_offsets.size() - 1;
+      for (int l = 0; l < num_lower_levels; ++l)
+      {
+        const int r0 = _lower_level_offsets[l];
+        const int r1 = _lower_level_offsets[l + 1];
+        #pragma omp for schedule(static)
+        for (int r = r0; r < r1; ++r)
+        {
+          const std::size_t i = _lower_level_rows[r];
+          double sum = xx[i];
+          for (std::size_t k = row_ptr[i]; k < diagonal[i]; ++k)
+            sum -= values[k]*xx[cols[k]];
+          xx[i] = sum;
+        }
+      }
+
+      const int num_upper_levels = _upper_level_offsets.size() - 1;
+      for (int l = 0; l < num_upper_levels; ++l)
+      {
+        const int r0 = _upper_level_offsets[l];
+        const int r1 = _upper_level_offsets[l + 1];
+        #pragma omp for schedule(static)
+        for (int r = r0; r < r1; ++r)
+        {
+          const std::size_t i = _upper_level_rows[r];
+          double sum = xx[i];
+          for (std::size_t k = diagonal[i] + 1; k < row_ptr[i + 1]; ++k)
+            sum -= values[k]*xx[cols[k]];
+          xx[i] = sum/values[diagonal[i]];
+        }
+      }
+    }
+    return;
+  }
+  #endif
+
   // Perform substitutions for compressed row storage. This is the fastest.
   const std::size_t size = _matM.size1();
   for(std::size_t i =0; i < size; ++i)
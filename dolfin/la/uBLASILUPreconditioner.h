@@ -18,11 +18,12 @@
 // Modified by Anders Logg 2006.
 //
 // First added:  2006-06-23
-// Last changed: 2009-07-03
+// Last changed: 2015-01-20
 
 #ifndef __UBLAS_ILU_PRECONDITIONER_H
 #define __UBLAS_ILU_PRECONDITIONER_H
 
+#include <vector>
 #include "ublas.h"
 #include "uBLASPreconditioner.h"
 #include "uBLASMatrix.h"
@@ -33,8 +34,12 @@ namespace dolfin
   template<typename Mat> class uBLASMatrix;
   class uBLASVector;
 
-  /// This class implements an incomplete LU factorization (ILU)
-  /// preconditioner for the uBLAS Krylov solver.
+  /// This class implements an incomplete LU factorization (ILU(k))
+  /// preconditioner for the uBLAS Krylov solver. The level of fill
+  /// is set by the parameter "fill_level" of the "ilu" parameter
+  /// set. The triangular solves are level-scheduled, and are
+  /// executed with OpenMP threads when the global parameter
+  /// "num_threads" is non-zero.
 
   class uBLASILUPreconditioner : public uBLASPreconditioner
   {
@@ -54,12 +59,38 @@ namespace dolfin
 
   private:
 
+    // Copy P into M, extending the sparsity pattern with the ILU(k)
+    // fill entries
+    void symbolic_factorization(const ublas_sparse_matrix& P,
+                                std::size_t fill_level);
+
+    // Compute numeric ILU factorization of M in-place
+    void numeric_factorization();
+
+    // Group rows of the factors into levels that can be solved
+    // independently
+    void compute_levels();
+
+    // Build compressed level data (offsets, rows) from row levels
+    static void build_levels(const std::vector<std::size_t>& row_level,
+                             std::vector<std::size_t>& level_offsets,
+                             std::vector<std::size_t>& level_rows);
+
     // Preconditioner matrix (factorised)
     uBLASMatrix<ublas_sparse_matrix> M;
 
     // Diagonal
     std::vector<std::size_t> diagonal;
 
+    // Level schedule for forward (L) substitution
+    std::vector<std::size_t> _lower_level_offsets, _lower_level_rows;
+
+    // Level schedule for backward (U) substitution
+    std::vector<std::size_t> _upper_level_offsets, _upper_level_rows;
+
+    // Number of threads used in triangular solves
+    std::size_t _num_threads;
+
     const Parameters& parameters;
 
   };
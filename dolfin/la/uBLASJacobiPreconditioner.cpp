@@ -0,0 +1,188 @@
+// Copyright (C) 2015 The FEniCS Project
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2015-01-20
+// Last changed: 2015-01-22
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#ifdef HAS_OPENMP
+#include <omp.h>
+#endif
+
+#include <dolfin/common/constants.h>
+#include <dolfin/parameter/GlobalParameters.h>
+#include "uBLASVector.h"
+#include "uBLASSparseMatrix.h"
+#include "uBLASJacobiPreconditioner.h"
+
+using namespace dolfin;
+
+namespace
+{
+  // Invert dense n x n row-major matrix A in-place using Gauss-Jordan
+  // elimination with partial pivoting. Returns false if A is
+  // singular.
+  bool invert_block(double* A, std::size_t n)
+  {
+    std::vector<std::size_t> perm(n);
+    for (std::size_t i = 0; i < n; ++i)
+      perm[i] = i;
+
+    for (std::size_t k = 0; k < n; ++k)
+    {
+      // Find pivot
+      std::size_t p = k;
+      for (std::size_t i = k + 1; i < n; ++i)
+      {
+        if (std::abs(A[i*n + k]) > std::abs(A[p*n + k]))
+          p = i;
+      }
+      if (std::abs(A[p*n + k]) < DOLFIN_EPS)
+        return false;
+
+      // Swap rows
+      if (p != k)
+      {
+        for (std::size_t j = 0; j < n; ++j)
+          std::swap(A[k*n + j], A[p*n + j]);
+        std::swap(perm[k], perm[p]);
+      }
+
+      // Eliminate
+      const double pivot = 1.0/A[k*n + k];
+      A[k*n + k] = 1.0;
+      for (std::size_t j = 0; j < n; ++j)
+        A[k*n + j] *= pivot;
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        if (i == k)
+          continue;
+        const double factor = A[i*n + k];
+        A[i*n + k] = 0.0;
+        for (std::size_t j = 0; j < n; ++j)
+          A[i*n + j] -= factor*A[k*n + j];
+      }
+    }
+
+    // Undo column permutation
+    std::vector<double> row(n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      for (std::size_t j = 0; j < n; ++j)
+        row[perm[j]] = A[i*n + j];
+      for (std::size_t j = 0; j < n; ++j)
+        A[i*n + j] = row[j];
+    }
+
+    return true;
+  }
+}
+
+//-----------------------------------------------------------------------------
+uBLASJacobiPreconditioner::uBLASJacobiPreconditioner(const Parameters& krylov_parameters)
+  : _block_size(1), _num_threads(0), parameters(krylov_parameters)
+{
+  // Do nothing
+}
+//-----------------------------------------------------------------------------
+uBLASJacobiPreconditioner::~uBLASJacobiPreconditioner()
+{
+  // Do nothing
+}
+//-----------------------------------------------------------------------------
+void uBLASJacobiPreconditioner::init(const uBLASMatrix<ublas_sparse_matrix>& P)
+{
+  const ublas_sparse_matrix& A = P.mat();
+  const std::size_t size = A.size1();
+
+  // Use block size of matrix unless given
+  const std::size_t block_size
+    = parameters("preconditioner")("jacobi")["block_size"];
+  _block_size = block_size > 0 ? block_size : P.block_size();
+  _num_threads = dolfin::parameters["num_threads"];
+  const std::size_t bs = _block_size;
+
+  if (bs == 0 || size % bs != 0)
+  {
+    dolfin_error("uBLASJacobiPreconditioner.cpp",
+                 "initialize uBLAS Jacobi preconditioner",
+                 "Matrix size (%d) is not a multiple of the block size (%d)",
+                 size, bs);
+  }
+
+  // Extract diagonal blocks
+  const std::size_t num_blocks = size/bs;
+  _inverse_blocks.assign(num_blocks*bs*bs, 0.0);
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    const std::size_t block = i/bs;
+    const std::size_t offset = block*bs;
+    double* A_block = &_inverse_blocks[block*bs*bs];
+    for (std::size_t k = A.index1_data()[i]; k < A.index1_data()[i + 1]; ++k)
+    {
+      const std::size_t j = A.index2_data()[k];
+      if (j >= offset && j < offset + bs)
+        A_block[(i - offset)*bs + (j - offset)] = A.value_data()[k];
+    }
+  }
+
+  // Invert diagonal blocks
+  for (std::size_t block = 0; block < num_blocks; ++block)
+  {
+    if (!invert_block(&_inverse_blocks[block*bs*bs], bs))
+    {
+      dolfin_error("uBLASJacobiPreconditioner.cpp",
+                   "initialize uBLAS Jacobi preconditioner",
+                   "Singular diagonal block detected in row %d", block*bs);
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+void uBLASJacobiPreconditioner::solve(uBLASVector& x, const uBLASVector& b) const
+{
+  ublas_vector& _x = x.vec();
+  const ublas_vector& _b = b.vec();
+  dolfin_assert(_x.size() == _b.size());
+  dolfin_assert(_x.size()*_block_size == _inverse_blocks.size());
+
+  const int bs = _block_size;
+  const int num_blocks = _x.size()/bs;
+  double* xx = &_x[0];
+  const double* bb = &_b[0];
+  const double* inverse_blocks = &_inverse_blocks[0];
+
+  #ifdef HAS_OPENMP
+  const int num_threads = std::max((int) _num_threads, 1);
+  #pragma omp parallel for schedule(static) num_threads(num_threads) \
+    if (_num_threads > 0)
+  #endif
+  for (int block = 0; block < num_blocks; ++block)
+  {
+    const double* A_inv = inverse_blocks + block*bs*bs;
+    for (int i = 0; i < bs; ++i)
+    {
+      double sum = 0.0;
+      for (int j = 0; j < bs; ++j)
+        sum += A_inv[i*bs + j]*bb[block*bs + j];
+      xx[block*bs + i] = sum;
+    }
+  }
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,79 @@
+// Copyright (C) 2015 The FEniCS Project
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2015-01-20
+// Last changed: 2015-01-22
+
+#ifndef __UBLAS_JACOBI_PRECONDITIONER_H
+#define __UBLAS_JACOBI_PRECONDITIONER_H
+
+#include <vector>
+#include "ublas.h"
+#include "uBLASPreconditioner.h"
+#include "uBLASMatrix.h"
+
+namespace dolfin
+{
+
+  template<typename Mat> class uBLASMatrix;
+  class uBLASVector;
+
+  /// This class implements a (block) Jacobi preconditioner for the
+  /// uBLAS Krylov solver. The diagonal blocks of the matrix are
+  /// inverted exactly. The block size is set by the parameter
+  /// "block_size" of the "jacobi" parameter set. The default (0)
+  /// takes the block size of the matrix, which for assembled
+  /// matrices is the block size of the DofMap (e.g. 3 for 3D
+  /// elasticity with reordered dofs), so that each block couples
+  /// the components of a node. The preconditioner is applied using
+  /// OpenMP threads when the global parameter "num_threads" is
+  /// non-zero.
+
+  class uBLASJacobiPreconditioner : public uBLASPreconditioner
+  {
+  public:
+
+    /// Constructor
+    uBLASJacobiPreconditioner(const Parameters& krylov_parameters);
+
+    /// Destructor
+    ~uBLASJacobiPreconditioner();
+
+    /// Initialise preconditioner (sparse matrix)
+    void init(const uBLASMatrix<ublas_sparse_matrix>& P);
+
+    /// Solve linear system Ax = b approximately
+    void solve(uBLASVector& x, const uBLASVector& b) const;
+
+  private:
+
+    // Block size
+    std::size_t _block_size;
+
+    // Inverse of diagonal blocks (row-major, stored contiguously)
+    std::vector<double> _inverse_blocks;
+
+    // Number of threads
+    std::size_t _num_threads;
+
+    const Parameters& parameters;
+
+  };
+
+}
+
+#endif
@@ -18,11 +18,13 @@
 // Modified by Anders Logg 2006-2012
 //
 // First added:  2006-05-31
-// Last changed: 2012-05-07
+// Last changed: 2015-01-22
 
 #include <dolfin/common/NoDeleter.h>
 #include <dolfin/log/LogStream.h>
+#include "uBLASChebyshevPreconditioner.h"
 #include "uBLASILUPreconditioner.h"
+#include "uBLASJacobiPreconditioner.h"
 #include "uBLASDummyPreconditioner.h"
 #include "uBLASKrylovSolver.h"
 #include "KrylovSolver.h"
@@ -42,15 +44,31 @@ uBLASKrylovSolver::methods()
 std::vector<std::pair<std::string, std::string> >
 uBLASKrylovSolver::preconditioners()
 {
-  return { {"default", "default preconditioner"},
-           {"none",    "No preconditioner"},
-           {"ilu",     "Incomplete LU factorization"} };
+  return { {"default",   "default preconditioner"},
+           {"none",      "No preconditioner"},
+           {"ilu",       "Incomplete LU factorization"},
+           {"jacobi",    "(Block) Jacobi iteration"},
+           {"chebyshev", "Chebyshev polynomial smoother"} };
 }
 //-----------------------------------------------------------------------------
 Parameters uBLASKrylovSolver::default_parameters()
 {
   Parameters p(KrylovSolver::default_parameters());
   p.rename("ublas_krylov_solver");
+
+  // Block Jacobi parameters (block size 0 means the block size of
+  // the matrix, i.e. the DofMap block size)
+  Parameters p_pc_jacobi("jacobi");
+  p_pc_jacobi.add("block_size", 0);
+  p("preconditioner").add(p_pc_jacobi);
+
+  // Chebyshev parameters
+  Parameters p_pc_chebyshev("chebyshev");
+  p_pc_chebyshev.add("degree", 3);
+  p_pc_chebyshev.add("eigenvalue_ratio", 30.0);
+  p_pc_chebyshev.add("eigenvalue_iterations", 10);
+  p("preconditioner").add(p_pc_chebyshev);
+
   return p;
 }
 //-----------------------------------------------------------------------------
@@ -114,7 +132,7 @@ std::size_t uBLASKrylovSolver::solve(GenericVector& x, const GenericVector& b)
     return solve_krylov(*A,
                         as_type<uBLASVector>(x),
                         as_type<const uBLASVector>(b),
-                        *P);
+                        P);
   }
 
   // If that fails, try to use it as a uBLAS linear operator
@@ -131,7 +149,7 @@ std::size_t uBLASKrylovSolver::solve(GenericVector& x, const GenericVector& b)
     return solve_krylov(*A,
                         as_type<uBLASVector>(x),
                         as_type<const uBLASVector>(b),
-                        *P);
+                        P);
   }
 
   return 0;
@@ -153,6 +171,10 @@ void uBLASKrylovSolver::select_preconditioner(std::string preconditioner)
     _pc.reset(new uBLASDummyPreconditioner());
   else if (preconditioner == "ilu")
     _pc.reset(new uBLASILUPreconditioner(parameters));
+  else if (preconditioner == "jacobi")
+    _pc.reset(new uBLASJacobiPreconditioner(parameters));
+  else if (preconditioner == "chebyshev")
+    _pc.reset(new uBLASChebyshevPreconditioner(parameters));
   else if (preconditioner == "default")
     _pc.reset(new uBLASILUPreconditioner(parameters));
   else
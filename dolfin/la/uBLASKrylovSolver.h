@@ -18,7 +18,7 @@
 // Modified by Anders Logg 2006-2012
 //
 // First added:  2006-05-31
-// Last changed: 2012-08-20
+// Last changed: 2015-01-22
 
 #ifndef __UBLAS_KRYLOV_SOLVER_H
 #define __UBLAS_KRYLOV_SOLVER_H
@@ -108,7 +108,7 @@ namespace dolfin
       std::size_t solve_krylov(const MatA& A,
                                uBLASVector& x,
                                const uBLASVector& b,
-                               const MatP& P);
+                               std::shared_ptr<const MatP> P);
 
     /// Solve linear system Ax = b using CG
     template<typename Mat>
@@ -157,7 +157,7 @@ namespace dolfin
     std::size_t uBLASKrylovSolver::solve_krylov(const MatA& A,
                                                 uBLASVector& x,
                                                 const uBLASVector& b,
-                                                const MatP& P)
+                                                std::shared_ptr<const MatP> P)
   {
     // Check dimensions
     std::size_t M = A.size(0);
@@ -22,11 +22,12 @@
 // Modified by Dag Lindbo 2008
 //
 // First added:  2006-07-05
-// Last changed: 2012-08-20
+// Last changed: 2015-01-22
 
 #ifndef __UBLAS_MATRIX_H
 #define __UBLAS_MATRIX_H
 
+#include <algorithm>
 #include <sstream>
 #include <iomanip>
 #include <boost/tuple/tuple.hpp>
@@ -226,6 +227,12 @@ namespace dolfin
     Mat& mat()
     { return _matA; }
 
+    /// Return block size of matrix (the block size of the tensor
+    /// layout the matrix was initialised with, e.g. the DofMap
+    /// block size, or 1)
+    std::size_t block_size() const
+    { return _block_size; }
+
     /// Solve Ax = b out-of-place using uBLAS (A is not destroyed)
     void solve(uBLASVector& x, const uBLASVector& b) const;
 
@@ -258,27 +265,31 @@ namespace dolfin
     // uBLAS matrix object
     Mat _matA;
 
+    // Block size
+    std::size_t _block_size;
+
   };
 
   //---------------------------------------------------------------------------
   // Implementation of uBLASMatrix
   //---------------------------------------------------------------------------
   template <typename Mat>
-  uBLASMatrix<Mat>::uBLASMatrix() : GenericMatrix(), _matA(0, 0)
+  uBLASMatrix<Mat>::uBLASMatrix() : GenericMatrix(), _matA(0, 0),
+                                         _block_size(1)
   {
     // Do nothing
   }
   //---------------------------------------------------------------------------
   template <typename Mat>
   uBLASMatrix<Mat>::uBLASMatrix(std::size_t M, std::size_t N)
-    : GenericMatrix(), _matA(M, N)
+    : GenericMatrix(), _matA(M, N), _block_size(1)
   {
     // Do nothing
   }
   //---------------------------------------------------------------------------
   template <typename Mat>
   uBLASMatrix<Mat>::uBLASMatrix(const uBLASMatrix& A)
-    : GenericMatrix(), _matA(A._matA)
+    : GenericMatrix(), _matA(A._matA), _block_size(A._block_size)
   {
     // Do nothing
   }
@@ -614,6 +625,7 @@ namespace dolfin
       // Assume uBLAS take care of deleting an existing Matrix
       // using its assignment operator
       _matA = A.mat();
+      _block_size = A._block_size;
     }
     return *this;
   }
@@ -667,6 +679,7 @@ namespace dolfin
   {
     resize(tensor_layout.size(0), tensor_layout.size(1));
     _matA.clear();
+    _block_size = std::max(tensor_layout.block_size, (std::size_t) 1);
 
     // Get sparsity pattern
     dolfin_assert(tensor_layout.sparsity_pattern());
@@ -697,6 +710,7 @@ namespace dolfin
   {
     resize(tensor_layout.size(0), tensor_layout.size(1));
     _matA.clear();
+    _block_size = std::max(tensor_layout.block_size, (std::size_t) 1);
   }
   //---------------------------------------------------------------------------
   template <>
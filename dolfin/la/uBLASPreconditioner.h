@@ -18,11 +18,12 @@
 // Modified by Anders Logg 2006-2011
 //
 // First added:  2006-06-23
-// Last changed: 2011-11-11
+// Last changed: 2015-01-22
 
 #ifndef __UBLAS_PRECONDITIONER_H
 #define __UBLAS_PRECONDITIONER_H
 
+#include <memory>
 #include <dolfin/log/log.h>
 
 namespace dolfin
@@ -69,6 +70,16 @@ namespace dolfin
                    "No init() function for preconditioner uBLASLinearOperator");
     }
 
+    /// Initialise preconditioner (sparse matrix) with a matrix that
+    /// the preconditioner may keep
+    virtual void init(std::shared_ptr<const uBLASMatrix<ublas_sparse_matrix> > P)
+    { init(*P); }
+
+    /// Initialise preconditioner (virtual matrix) with an operator
+    /// that the preconditioner may keep
+    virtual void init(std::shared_ptr<const uBLASLinearOperator> P)
+    { init(*P); }
+
     /// Solve linear system (M^-1)Ax = y
     virtual void solve(uBLASVector& x, const uBLASVector& b) const = 0;
 
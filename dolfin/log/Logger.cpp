@@ -19,12 +19,15 @@
 // Modified by Garth N. Wells, 2011.
 //
 // First added:  2003-03-13
-// Last changed: 2013-11-15
+// Last changed: 2015-01-22
 
 
+#include <algorithm>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <numeric>
+#include <set>
 #include <sstream>
 #include <stdexcept>
 #include <string>
@@ -42,6 +45,7 @@
 
 #include <dolfin/common/constants.h>
 #include <dolfin/common/defines.h>
+#include <dolfin/common/MemoryTracked.h>
 #include <dolfin/common/MPI.h>
 #include <dolfin/parameter/GlobalParameters.h>
 #include "LogLevel.h"
@@ -49,8 +53,6 @@
 
 using namespace dolfin;
 
-typedef std::map<std::string, std::pair<std::size_t, double> >::iterator
-map_iterator;
 typedef std::map<std::string, std::pair<std::size_t, double> >::const_iterator
 const_map_iterator;
 
@@ -271,38 +273,179 @@ void Logger::register_timing(std::string task, double elapsed_time)
     elapsed_time = 0.0;
 
   // Print a message
-  std::stringstream line;
-  line << "Elapsed time: " << elapsed_time << " (" << task << ")";
-  log(line.str(), TRACE);
-
-  // Store values for summary
-  map_iterator it = _timings.find(task);
-  if (it == _timings.end())
-  {
-    std::pair<std::size_t, double> timing(1, elapsed_time);
-    _timings[task] = timing;
-  }
-  else
+  if (_log_level <= TRACE)
   {
-    it->second.first += 1;
-    it->second.second += elapsed_time;
+    std::stringstream line;
+    line << "Elapsed time: " << elapsed_time << " (" << task << ")";
+    log(line.str(), TRACE);
   }
+
+  // Store values for summary
+  _timing_registry.add(_timing_registry.task_id(task), elapsed_time);
 }
 //-----------------------------------------------------------------------------
 void Logger::list_timings(bool reset)
 {
-  // Check if timings are empty
-  if (_timings.empty())
+  const std::vector<TimingRegistry::Entry> entries
+    = _timing_registry.entries();
+  if (reset)
+  {
+    _timing_registry.clear();
+    _performance_counters.clear();
+  }
+
+  // Timings of each process, as lines of task path (task names
+  // separated by '\x1f') and inclusive time, gathered on process 0
+  const MPI_Comm comm = MPI_COMM_WORLD;
+  const std::size_t num_processes = MPI::size(comm);
+  std::vector<std::string> process_timings;
+  if (num_processes > 1)
+  {
+    std::stringstream local_timings;
+    local_timings << std::setprecision(17);
+    for (std::size_t i = 0; i < entries.size(); i++)
+    {
+      for (std::size_t j = 0; j < entries[i].path.size(); j++)
+        local_timings << (j > 0 ? "\x1f" : "") << entries[i].path[j];
+      local_timings << "\t" << entries[i].inclusive_time << "\n";
+    }
+    MPI::gather(comm, local_timings.str(), process_timings);
+    if (MPI::rank(comm) > 0)
+      return;
+  }
+
+  // Build the union of the call trees of all processes (in order of
+  // appearance, with children following their parents), with the
+  // inclusive time of each process (negative if missing)
+  std::vector<std::string> rows;
+  std::map<std::string, std::size_t> row_index;
+  std::map<std::string, std::vector<std::size_t> > children;
+  std::vector<std::vector<double> > times;
+  std::vector<const TimingRegistry::Entry*> local_entry;
+  for (std::size_t p = 0; p < num_processes; p++)
+  {
+    // Paths and times of process
+    std::vector<std::pair<std::string, double> > timings;
+    if (num_processes > 1)
+    {
+      std::istringstream lines(process_timings[p]);
+      std::string line;
+      while (std::getline(lines, line))
+      {
+        const std::size_t tab = line.rfind('\t');
+        timings.push_back(std::make_pair(line.substr(0, tab),
+                          boost::lexical_cast<double>(line.substr(tab + 1))));
+      }
+    }
+    else
+    {
+      for (std::size_t i = 0; i < entries.size(); i++)
+      {
+        std::string path;
+        for (std::size_t j = 0; j < entries[i].path.size(); j++)
+          path += (j > 0 ? "\x1f" : "") + entries[i].path[j];
+        timings.push_back(std::make_pair(path, entries[i].inclusive_time));
+      }
+    }
+
+    for (std::size_t i = 0; i < timings.size(); i++)
+    {
+      const std::string& path = timings[i].first;
+      std::map<std::string, std::size_t>::const_iterator it
+        = row_index.find(path);
+      std::size_t row;
+      if (it == row_index.end())
+      {
+        row = rows.size();
+        row_index[path] = row;
+        rows.push_back(path);
+        times.push_back(std::vector<double>(num_processes, -1.0));
+        local_entry.push_back(p == 0 ? &entries[i] : 0);
+
+        const std::size_t sep = path.rfind('\x1f');
+        children[sep == std::string::npos ? "" : path.substr(0, sep)]
+          .push_back(row);
+      }
+      else
+        row = it->second;
+      times[row][p] = timings[i].second;
+    }
+  }
+
+  if (rows.empty())
   {
     log("Timings: no timings to report.");
     return;
   }
-  else
+
+  // Fill table in depth-first order
+  Table table("Summary of timings");
+  std::vector<std::pair<std::string, std::size_t> > stack(1, std::make_pair("", 0));
+  std::set<std::string> labels;
+  while (!stack.empty())
   {
-    log("");
-    log(timings(reset).str(true));
+    const std::string parent = stack.back().first;
+    const std::size_t child = stack.back().second++;
+    const std::vector<std::size_t>& parent_children = children[parent];
+    if (child >= parent_children.size())
+    {
+      stack.pop_back();
+      continue;
+    }
+
+    const std::size_t row = parent_children[child];
+    const std::string& path = rows[row];
+    const std::size_t sep = path.rfind('\x1f');
+    const std::string name
+      = sep == std::string::npos ? path : path.substr(sep + 1);
+
+    // Indent task name by depth. Tasks with the same name at the
+    // same depth get distinct (invisible) trailing spaces, as table
+    // rows are identified by name.
+    std::string label = std::string(2*(stack.size() - 1), ' ') + name;
+    while (labels.count(label) > 0)
+      label += " ";
+    labels.insert(label);
+
+    const TimingRegistry::Entry* entry = local_entry[row];
+    if (entry)
+    {
+      table(label, "Reps") = entry->reps;
+      table(label, "Inclusive time") = entry->inclusive_time;
+      table(label, "Exclusive time") = entry->exclusive_time;
+    }
+    else
+    {
+      table(label, "Reps") = "-";
+      table(label, "Inclusive time") = "-";
+      table(label, "Exclusive time") = "-";
+    }
+
+    if (num_processes > 1)
+    {
+      double min = 0.0, max = 0.0, sum = 0.0;
+      std::size_t num = 0;
+      for (std::size_t p = 0; p < num_processes; p++)
+      {
+        const double t = times[row][p];
+        if (t < 0.0)
+          continue;
+        min = num == 0 ? t : std::min(min, t);
+        max = num == 0 ? t : std::max(max, t);
+        sum += t;
+        num++;
+      }
+      table(label, "Min") = min;
+      table(label, "Avg") = sum/num;
+      table(label, "Max") = max;
+    }
+
+    stack.push_back(std::make_pair(path, 0));
   }
 
+  log("");
+  log(table.str(true));
+
   // Print maximum memory usage if available
   if (_maximum_memory_usage >= 0)
   {
@@ -310,28 +453,65 @@ void Logger::list_timings(bool reset)
     s << "\nMaximum memory usage: " << _maximum_memory_usage << " MB";
     log(s.str());
   }
-
 }
 //-----------------------------------------------------------------------------
 Table Logger::timings(bool reset)
 {
+  // Sum timings of each task over the call tree
+  std::map<std::string, std::pair<std::size_t, double> > task_timings;
+  const std::vector<TimingRegistry::Entry> entries
+    = _timing_registry.entries();
+  for (std::size_t i = 0; i < entries.size(); i++)
+  {
+    std::pair<std::size_t, double>& timing
+      = task_timings[entries[i].path.back()];
+    timing.first += entries[i].reps;
+    timing.second += entries[i].inclusive_time;
+  }
+
   // Generate timing table
   Table table("Summary of timings");
-  for (const_map_iterator it = _timings.begin(); it != _timings.end(); ++it)
+  for (const_map_iterator it = task_timings.begin(); it != task_timings.end();
+       ++it)
   {
     const std::string task    = it->first;
     const std::size_t num_timings    = it->second.first;
     const double total_time   = it->second.second;
+    if (num_timings == 0)
+      continue;
     const double average_time = total_time / static_cast<double>(num_timings);
 
     table(task, "Average time") = average_time;
     table(task, "Total time")   = total_time;
     table(task, "Reps")         = num_timings;
+
+    // Add performance counts and derived metrics, with memory traffic
+    // estimated as one cache line per last level cache miss
+    PerformanceCounters::Counts counts;
+    if (_performance_counters.total(_timing_registry.task_id(task), counts))
+    {
+      const double cycles = counts[PerformanceCounters::cycles];
+      const double instructions = counts[PerformanceCounters::instructions];
+      const double misses = counts[PerformanceCounters::cache_misses];
+      for (std::size_t i = 0; i < PerformanceCounters::num_events; i++)
+      {
+        const PerformanceCounters::EventType event
+          = static_cast<PerformanceCounters::EventType>(i);
+        table(task, PerformanceCounters::event_name(event))
+          = static_cast<std::size_t>(counts[i]);
+      }
+      table(task, "IPC") = cycles > 0.0 ? instructions/cycles : 0.0;
+      table(task, "GB/s")
+        = total_time > 0.0 ? 64.0*misses/total_time/1e9 : 0.0;
+    }
   }
 
   // Clear timings
   if (reset)
-    _timings.clear();
+  {
+    _timing_registry.clear();
+    _performance_counters.clear();
+  }
 
   return table;
 }
@@ -339,8 +519,10 @@ Table Logger::timings(bool reset)
 double Logger::timing(std::string task, bool reset)
 {
   // Find timing
-  map_iterator it = _timings.find(task);
-  if (it == _timings.end())
+  const std::size_t task_id = _timing_registry.task_id(task);
+  const std::pair<std::size_t, double> timing
+    = _timing_registry.total(task_id);
+  if (timing.first == 0)
   {
     std::stringstream line;
     line << "No timings registered for task \"" << task << "\".";
@@ -350,16 +532,166 @@ double Logger::timing(std::string task, bool reset)
   }
 
   // Compute average
-  const std::size_t num_timings  = it->second.first;
-  const double total_time   = it->second.second;
+  const std::size_t num_timings  = timing.first;
+  const double total_time   = timing.second;
   const double average_time = total_time / static_cast<double>(num_timings);
 
   // Clear timing
-  _timings.erase(it);
+  _timing_registry.clear(task_id);
+  _performance_counters.clear(task_id);
 
   return average_time;
 }
 //-----------------------------------------------------------------------------
+void Logger::start_trace(std::size_t capacity)
+{
+  if (capacity == 0)
+  {
+    dolfin_error("Logger.cpp",
+                 "start trace",
+                 "Number of events per thread must be positive");
+  }
+
+  // Synchronize processes, so that times of events are comparable
+  const MPI_Comm comm = MPI_COMM_WORLD;
+  if (MPI::size(comm) > 1)
+    MPI::barrier(comm);
+  _trace_recorder.start(capacity);
+}
+//-----------------------------------------------------------------------------
+void Logger::stop_trace()
+{
+  _trace_recorder.stop();
+}
+//-----------------------------------------------------------------------------
+void Logger::write_trace(std::string filename)
+{
+  const MPI_Comm comm = MPI_COMM_WORLD;
+  const std::size_t process = MPI::rank(comm);
+  const std::size_t num_processes = MPI::size(comm);
+
+  // Report events lost since the buffers were full
+  const std::size_t num_dropped = _trace_recorder.num_dropped_events();
+  if (num_dropped > 0)
+  {
+    std::stringstream line;
+    line << "Trace of process " << process << " is missing the first "
+         << num_dropped << " events; increase the number of events "
+         << "per thread in start_trace.";
+    warning(line.str());
+  }
+
+  // Gather events of all processes on process 0
+  std::vector<std::string> events(1);
+  events[0] = _trace_recorder.json(_timing_registry, process);
+  if (num_processes > 1)
+  {
+    const std::string local_events = events[0];
+    MPI::gather(comm, local_events, events);
+    if (process > 0)
+      return;
+  }
+
+  std::ofstream file(filename.c_str());
+  if (!file.good())
+  {
+    dolfin_error("Logger.cpp",
+                 "write trace",
+                 "Unable to open file \"" + filename + "\" for writing");
+  }
+
+  file << "{\"traceEvents\":[\n";
+  for (std::size_t p = 0; p < events.size(); p++)
+    file << (p > 0 ? ",\n" : "") << events[p];
+  file << "\n],\n\"displayTimeUnit\":\"ms\"}\n";
+}
+//-----------------------------------------------------------------------------
+Table Logger::memory_summary()
+{
+  // Memory usage of this process, as lines of subsystem, number of
+  // objects and bytes
+  const std::map<std::string, std::pair<std::size_t, std::size_t> > usage
+    = MemoryTracked::memory_usage_by_subsystem();
+  std::stringstream local_usage;
+  std::map<std::string, std::pair<std::size_t, std::size_t> >::const_iterator
+    it;
+  for (it = usage.begin(); it != usage.end(); ++it)
+  {
+    local_usage << it->first << "\t" << it->second.first << "\t"
+                << it->second.second << "\n";
+  }
+
+  // Gather memory usage of all processes
+  const MPI_Comm comm = MPI_COMM_WORLD;
+  const std::size_t num_processes = MPI::size(comm);
+  const std::string local_lines = local_usage.str();
+  std::vector<std::vector<char> > process_usage(1);
+  process_usage[0].assign(local_lines.begin(), local_lines.end());
+  if (num_processes > 1)
+  {
+    const std::vector<char> local_chars = process_usage[0];
+    MPI::all_gather(comm, local_chars, process_usage);
+  }
+
+  // Number of objects and bytes of each subsystem (including the
+  // total) on each process
+  std::map<std::string, std::pair<std::size_t, std::vector<double> > >
+    subsystems;
+  for (std::size_t p = 0; p < num_processes; p++)
+  {
+    std::istringstream lines(std::string(process_usage[p].begin(),
+                                         process_usage[p].end()));
+    std::string subsystem;
+    std::size_t num_objects, bytes;
+    while (std::getline(lines, subsystem, '\t') && lines >> num_objects
+           && lines >> bytes && lines.ignore())
+    {
+      const std::string names[2] = {subsystem, "Total"};
+      for (std::size_t i = 0; i < 2; i++)
+      {
+        std::pair<std::size_t, std::vector<double> >& row
+          = subsystems[names[i]];
+        row.second.resize(num_processes, 0.0);
+        row.first += num_objects;
+        row.second[p] += static_cast<double>(bytes)/(1024.0*1024.0);
+      }
+    }
+  }
+
+  // Generate table, with the total last
+  Table table("Memory usage");
+  std::vector<std::string> rows;
+  for (std::map<std::string, std::pair<std::size_t, std::vector<double> > >
+         ::const_iterator row = subsystems.begin(); row != subsystems.end();
+       ++row)
+  {
+    if (row->first != "Total")
+      rows.push_back(row->first);
+  }
+  if (!subsystems.empty())
+    rows.push_back("Total");
+  for (std::size_t i = 0; i < rows.size(); i++)
+  {
+    const std::pair<std::size_t, std::vector<double> >& row
+      = subsystems[rows[i]];
+    table(rows[i], "Objects") = row.first;
+    if (num_processes > 1)
+    {
+      const double sum = std::accumulate(row.second.begin(),
+                                         row.second.end(), 0.0);
+      table(rows[i], "Min (MB)")
+        = *std::min_element(row.second.begin(), row.second.end());
+      table(rows[i], "Avg (MB)") = sum/static_cast<double>(num_processes);
+      table(rows[i], "Max (MB)")
+        = *std::max_element(row.second.begin(), row.second.end());
+    }
+    else
+      table(rows[i], "Memory (MB)") = row.second[0];
+  }
+
+  return table;
+}
+//-----------------------------------------------------------------------------
 void Logger::monitor_memory_usage()
 {
   #ifndef __linux__
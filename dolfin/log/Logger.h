@@ -20,7 +20,7 @@
 // Modified by Ola Skavhaug 2007, 2009
 //
 // First added:  2003-03-13
-// Last changed: 2013-01-07
+// Last changed: 2015-01-22
 
 #ifndef __LOGGER_H
 #define __LOGGER_H
@@ -31,6 +31,9 @@
 #include <string>
 #include "Table.h"
 #include "LogLevel.h"
+#include "PerformanceCounters.h"
+#include "TimingRegistry.h"
+#include "TraceRecorder.h"
 
 // Forward declarations
 namespace boost { class thread; }
@@ -103,22 +106,58 @@ namespace dolfin
     void register_timing(std::string task, double elapsed_time);
 
     /// Return a summary of timings and tasks as a Table, optionally
-    /// clearing stored timings
+    /// clearing stored timings. If performance counters have been
+    /// recorded for a task, its counts and the derived instructions
+    /// per cycle and memory bandwidth (estimated from the cache
+    /// misses) are included.
     Table timings(bool reset=false);
 
-    /// Print summary of timings and tasks, optionally clearing stored
-    /// timings
+    /// Print summary of timings and tasks as a tree of nested tasks
+    /// with inclusive and exclusive times, optionally clearing stored
+    /// timings. When running in parallel, this is collective and the
+    /// minimum, average and maximum inclusive times over all
+    /// processes are printed by process 0.
     void list_timings(bool reset=false);
 
     /// Return timing (average) for given task, optionally clearing
     /// timing for task
     double timing(std::string task, bool reset=false);
 
+    /// Return registry of timings (see Timer)
+    TimingRegistry& timing_registry()
+    { return _timing_registry; }
+
+    /// Start recording a timeline of timed tasks and progress
+    /// updates, keeping at most the given number of events per
+    /// thread (the most recent). This is collective, so that the
+    /// timelines of all processes start at the same time.
+    void start_trace(std::size_t capacity);
+
+    /// Stop recording the timeline
+    void stop_trace();
+
+    /// Write recorded timeline of all processes to file in the
+    /// Chrome trace event format (collective)
+    void write_trace(std::string filename);
+
+    /// Return recorder of timeline (see start_trace)
+    TraceRecorder& trace_recorder()
+    { return _trace_recorder; }
+
+    /// Return hardware performance counters of timed tasks (see
+    /// Timer)
+    PerformanceCounters& performance_counters()
+    { return _performance_counters; }
+
     /// Monitor memory usage. Call this function at the start of a
     /// program to continuously monitor the memory usage of the
     /// process.
     void monitor_memory_usage();
 
+    /// Return a summary of the memory usage of objects derived from
+    /// MemoryTracked for each subsystem (collective)
+    Table memory_summary();
+
     /// Helper function for reporting memory usage
     void _report_memory_usage(size_t num_mb);
 
@@ -146,8 +185,14 @@ namespace dolfin
     // Optional stream for logging
     std::ostream* logstream;
 
-    // List of timings for tasks, map from string to (num_timings, total_time)
-    std::map<std::string, std::pair<std::size_t, double> > _timings;
+    // Timings of tasks
+    TimingRegistry _timing_registry;
+
+    // Timeline of timed tasks
+    TraceRecorder _trace_recorder;
+
+    // Hardware performance counts of timed tasks
+    PerformanceCounters _performance_counters;
 
     // Thread used for monitoring memory usage
     std::unique_ptr<boost::thread> _thread_monitor_memory_usage;
@@ -0,0 +1,248 @@
+// Copyright (C) 2015 The FEniCS Project
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2015-01-22
+// Last changed: 2015-01-22
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "log.h"
+#include "PerformanceCounters.h"
+
+using namespace dolfin;
+
+namespace
+{
+  // Counters of the calling thread, and the object they belong to
+  thread_local const dolfin::PerformanceCounters* thread_owner = 0;
+  thread_local void* thread_counters = 0;
+}
+
+//-----------------------------------------------------------------------------
+PerformanceCounters::ThreadCounters::ThreadCounters() : opened(false)
+{
+  for (std::size_t i = 0; i < num_events; i++)
+    fd[i] = -1;
+}
+//-----------------------------------------------------------------------------
+PerformanceCounters::ThreadCounters::~ThreadCounters()
+{
+  #ifdef __linux__
+  for (std::size_t i = 0; i < num_events; i++)
+  {
+    if (fd[i] >= 0)
+      close(fd[i]);
+  }
+  #endif
+}
+//-----------------------------------------------------------------------------
+PerformanceCounters::PerformanceCounters() : _active(false),
+                                             _reported_failure(false)
+{
+  // Do nothing
+}
+//-----------------------------------------------------------------------------
+PerformanceCounters::~PerformanceCounters()
+{
+  // Do nothing
+}
+//-----------------------------------------------------------------------------
+void PerformanceCounters::set_active(bool active)
+{
+  _active = active;
+}
+//-----------------------------------------------------------------------------
+bool PerformanceCounters::read(Counts& counts)
+{
+  if (!active())
+    return false;
+
+  ThreadCounters& counters = _thread_counters();
+  if (!counters.opened && !_open(counters))
+    return false;
+
+  #ifdef __linux__
+  // Read all counters of the group at once (number of counters
+  // followed by the counts)
+  std::uint64_t values[num_events + 1];
+  if (::read(counters.fd[0], values, sizeof(values)) != sizeof(values))
+    return false;
+  for (std::size_t i = 0; i < num_events; i++)
+    counts[i] = values[i + 1];
+  return true;
+  #else
+  return false;
+  #endif
+}
+//-----------------------------------------------------------------------------
+void PerformanceCounters::add(std::size_t task, const Counts& start,
+                              const Counts& stop)
+{
+  ThreadCounters& counters = _thread_counters();
+  if (counters.reps.size() <= task)
+  {
+    counters.reps.resize(task + 1, 0);
+    counters.counts.resize((task + 1)*num_events, 0);
+  }
+
+  counters.reps[task] += 1;
+  for (std::size_t i = 0; i < num_events; i++)
+    counters.counts[task*num_events + i] += stop[i] - start[i];
+}
+//-----------------------------------------------------------------------------
+bool PerformanceCounters::total(std::size_t task, Counts& counts) const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  std::size_t reps = 0;
+  for (std::size_t i = 0; i < num_events; i++)
+    counts[i] = 0;
+  for (std::size_t t = 0; t < _threads.size(); t++)
+  {
+    const ThreadCounters& counters = *_threads[t];
+    if (task >= counters.reps.size())
+      continue;
+    reps += counters.reps[task];
+    for (std::size_t i = 0; i < num_events; i++)
+      counts[i] += counters.counts[task*num_events + i];
+  }
+
+  return reps > 0;
+}
+//-----------------------------------------------------------------------------
+void PerformanceCounters::clear()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  for (std::size_t t = 0; t < _threads.size(); t++)
+  {
+    std::fill(_threads[t]->counts.begin(), _threads[t]->counts.end(), 0);
+    std::fill(_threads[t]->reps.begin(), _threads[t]->reps.end(), 0);
+  }
+}
+//-----------------------------------------------------------------------------
+void PerformanceCounters::clear(std::size_t task)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  for (std::size_t t = 0; t < _threads.size(); t++)
+  {
+    ThreadCounters& counters = *_threads[t];
+    if (task >= counters.reps.size())
+      continue;
+    counters.reps[task] = 0;
+    for (std::size_t i = 0; i < num_events; i++)
+      counters.counts[task*num_events + i] = 0;
+  }
+}
+//-----------------------------------------------------------------------------
+std::string PerformanceCounters::event_name(EventType event)
+{
+  switch (event)
+  {
+  case cycles:
+    return "Cycles";
+  case instructions:
+    return "Instructions";
+  case cache_misses:
+    return "LLC misses";
+  default:
+    return "Unknown";
+  }
+}
+//-----------------------------------------------------------------------------
+PerformanceCounters::ThreadCounters& PerformanceCounters::_thread_counters()
+{
+  if (thread_owner == this)
+    return *static_cast<ThreadCounters*>(thread_counters);
+
+  // First use on this thread, so create its counters (opened on
+  // first read)
+  std::unique_ptr<ThreadCounters> counters(new ThreadCounters);
+  thread_owner = this;
+  thread_counters = counters.get();
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  _threads.push_back(std::move(counters));
+  return *_threads.back();
+}
+//-----------------------------------------------------------------------------
+bool PerformanceCounters::_open(ThreadCounters& counters)
+{
+  // Counters are only opened once per thread, also on failure
+  if (counters.fd[0] != -1)
+    return counters.opened;
+
+  #ifdef __linux__
+  const std::uint64_t configs[num_events]
+    = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+       PERF_COUNT_HW_CACHE_MISSES};
+
+  // Open counters of the calling thread on any CPU, as a group with
+  // the first counter as leader so that they are read together
+  bool success = true;
+  for (std::size_t i = 0; i < num_events; i++)
+  {
+    struct perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = configs[i];
+    attr.read_format = PERF_FORMAT_GROUP;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    counters.fd[i] = syscall(__NR_perf_event_open, &attr, 0, -1,
+                             i == 0 ? -1 : counters.fd[0], 0);
+    if (counters.fd[i] < 0)
+    {
+      success = false;
+      break;
+    }
+  }
+
+  // Report failure once, and keep the counters closed
+  if (!success)
+  {
+    for (std::size_t i = 0; i < num_events; i++)
+    {
+      if (counters.fd[i] >= 0)
+        close(counters.fd[i]);
+      counters.fd[i] = -2;
+    }
+    if (!_reported_failure.exchange(true))
+    {
+      warning("Unable to open hardware performance counters (perf_event); "
+              "check /proc/sys/kernel/perf_event_paranoid.");
+    }
+    return false;
+  }
+
+  counters.opened = true;
+  return true;
+  #else
+  counters.fd[0] = -2;
+  if (!_reported_failure.exchange(true))
+    warning("Hardware performance counters are only available on Linux.");
+  return false;
+  #endif
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,135 @@
+// Copyright (C) 2015 The FEniCS Project
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2015-01-22
+// Last changed: 2015-01-22
+
+#ifndef __PERFORMANCE_COUNTERS_H
+#define __PERFORMANCE_COUNTERS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace dolfin
+{
+
+  /// This class accumulates hardware performance counters (cycles,
+  /// instructions and last level cache misses) of timed tasks (see
+  /// Timer), when switched on (see set_performance_counters_active).
+  /// The counters are read from the Linux perf_event interface and
+  /// count events of the calling thread in user space only. On other
+  /// platforms, or when the counters cannot be opened (e.g. due to
+  /// the setting of /proc/sys/kernel/perf_event_paranoid or a
+  /// virtual machine without a performance monitoring unit), no
+  /// counts are recorded.
+  ///
+  /// Each thread opens its own counters and accumulates its counts
+  /// without locking. Counts of a task include the counts of tasks
+  /// nested in it.
+
+  class PerformanceCounters
+  {
+  public:
+
+    /// Hardware events which are counted
+    enum EventType { cycles, instructions, cache_misses, num_events };
+
+    /// Counts of the events
+    typedef std::uint64_t Counts[num_events];
+
+    /// Constructor
+    PerformanceCounters();
+
+    /// Destructor
+    ~PerformanceCounters();
+
+    /// Switch counting on or off
+    void set_active(bool active);
+
+    /// Return true iff counting is switched on
+    bool active() const
+    { return _active.load(std::memory_order_relaxed); }
+
+    /// Read the current counts of the calling thread, returning false
+    /// if counting is switched off or the counters are not available
+    bool read(Counts& counts);
+
+    /// Add the counts between two reads to task
+    void add(std::size_t task, const Counts& start, const Counts& stop);
+
+    /// Return counts of a task summed over all threads, and false if
+    /// no counts have been recorded for the task
+    bool total(std::size_t task, Counts& counts) const;
+
+    /// Clear counts of all tasks
+    void clear();
+
+    /// Clear counts of a task
+    void clear(std::size_t task);
+
+    /// Return name of event
+    static std::string event_name(EventType event);
+
+  private:
+
+    // Counters and counts of each task of a thread
+    struct ThreadCounters
+    {
+      ThreadCounters();
+      ~ThreadCounters();
+
+      // File descriptors of counters (the first is the group leader),
+      // negative if not opened
+      int fd[num_events];
+
+      // Whether the counters have been opened
+      bool opened;
+
+      // Counts of each task (indexed by task id) and number of reps
+      // with counts
+      std::vector<std::uint64_t> counts;
+      std::vector<std::size_t> reps;
+    };
+
+    // Return the counters of the calling thread
+    ThreadCounters& _thread_counters();
+
+    // Open the counters of a thread, returning false on failure
+    bool _open(ThreadCounters& counters);
+
+    // Whether counting is switched on
+    std::atomic<bool> _active;
+
+    // Whether a failure to open the counters has been reported
+    std::atomic<bool> _reported_failure;
+
+    // Counters of each thread which has read counters
+    std::vector<std::unique_ptr<ThreadCounters> > _threads;
+
+    // Mutex for the list of threads
+    mutable std::mutex _mutex;
+
+  };
+
+}
+
+#endif
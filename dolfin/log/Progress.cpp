@@ -21,10 +21,11 @@
 // Modified by Ola Skavhaug, 2009.
 //
 // First added:  2003-03-14
-// Last changed: 2011-11-14
+// Last changed: 2015-01-22
 
 #include <dolfin/common/constants.h>
 #include <dolfin/common/timing.h>
+#include <dolfin/common/Timer.h>
 #include "log.h"
 #include "LogManager.h"
 #include "Progress.h"
@@ -107,6 +108,11 @@ void Progress::update(double p)
     return;
   counter = 0;
 
+  // Record progress in timeline
+  TraceRecorder& recorder = LogManager::logger.trace_recorder();
+  if (recorder.active())
+    recorder.record_counter(Timer::task_id(_title), p);
+
   // Check if we have already finished
   if (finished)
     return;
@@ -0,0 +1,255 @@
+// Copyright (C) 2015 The FEniCS Project
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2015-01-22
+// Last changed: 2015-01-22
+
+#include <algorithm>
+#include "TimingRegistry.h"
+
+using namespace dolfin;
+
+namespace
+{
+  // Timings of the calling thread, and the registry they belong to
+  thread_local const dolfin::TimingRegistry* thread_registry = 0;
+  thread_local void* thread_timings = 0;
+}
+
+//-----------------------------------------------------------------------------
+TimingRegistry::TimingRegistry()
+{
+  // Do nothing
+}
+//-----------------------------------------------------------------------------
+TimingRegistry::~TimingRegistry()
+{
+  // Do nothing
+}
+//-----------------------------------------------------------------------------
+std::size_t TimingRegistry::task_id(const std::string& task)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  std::map<std::string, std::size_t>::const_iterator it = _task_ids.find(task);
+  if (it != _task_ids.end())
+    return it->second;
+
+  _task_ids[task] = _task_names.size();
+  _task_names.push_back(task);
+  return _task_names.size() - 1;
+}
+//-----------------------------------------------------------------------------
+std::string TimingRegistry::task_name(std::size_t task) const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _task_names[task];
+}
+//-----------------------------------------------------------------------------
+std::size_t TimingRegistry::start(std::size_t task)
+{
+  ThreadTimings& timings = _thread_timings();
+  std::lock_guard<std::mutex> lock(timings.mutex);
+  const std::size_t parent = timings.stack.empty() ? 0 : timings.stack.back();
+  const std::size_t node = _child(timings.nodes, parent, task);
+  timings.stack.push_back(node);
+  return node;
+}
+//-----------------------------------------------------------------------------
+void TimingRegistry::stop(std::size_t handle, double elapsed_time)
+{
+  ThreadTimings& timings = _thread_timings();
+  std::lock_guard<std::mutex> lock(timings.mutex);
+  Node& node = timings.nodes[handle];
+  node.reps += 1;
+  node.time += elapsed_time;
+
+  // Return to the task which was running when the task was started,
+  // also stopping tasks started later which are still running (if
+  // timers are not stopped in reverse order)
+  std::vector<std::size_t>::reverse_iterator it
+    = std::find(timings.stack.rbegin(), timings.stack.rend(), handle);
+  if (it != timings.stack.rend())
+    timings.stack.erase(it.base() - 1, timings.stack.end());
+}
+//-----------------------------------------------------------------------------
+void TimingRegistry::add(std::size_t task, double elapsed_time)
+{
+  stop(start(task), elapsed_time);
+}
+//-----------------------------------------------------------------------------
+std::vector<TimingRegistry::Entry> TimingRegistry::entries() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  // Merge trees of all threads
+  std::vector<Node> merged(1);
+  merged[0].task = 0;
+  merged[0].reps = 0;
+  merged[0].time = 0.0;
+  for (std::size_t i = 0; i < _threads.size(); i++)
+  {
+    std::lock_guard<std::mutex> thread_lock(_threads[i]->mutex);
+    _merge(merged, 0, _threads[i]->nodes, 0);
+  }
+
+  std::vector<Entry> entries;
+  std::vector<std::string> path;
+  _add_entries(entries, merged, 0, path);
+  return entries;
+}
+//-----------------------------------------------------------------------------
+std::pair<std::size_t, double> TimingRegistry::total(std::size_t task) const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  std::pair<std::size_t, double> total(0, 0.0);
+  for (std::size_t i = 0; i < _threads.size(); i++)
+  {
+    std::lock_guard<std::mutex> thread_lock(_threads[i]->mutex);
+    const std::vector<Node>& nodes = _threads[i]->nodes;
+    for (std::size_t j = 1; j < nodes.size(); j++)
+    {
+      if (nodes[j].task == task)
+      {
+        total.first += nodes[j].reps;
+        total.second += nodes[j].time;
+      }
+    }
+  }
+  return total;
+}
+//-----------------------------------------------------------------------------
+void TimingRegistry::clear()
+{
+  // Nodes are kept, as running timers refer to them, and nodes
+  // without timings are not reported
+  std::lock_guard<std::mutex> lock(_mutex);
+  for (std::size_t i = 0; i < _threads.size(); i++)
+  {
+    std::lock_guard<std::mutex> thread_lock(_threads[i]->mutex);
+    std::vector<Node>& nodes = _threads[i]->nodes;
+    for (std::size_t j = 0; j < nodes.size(); j++)
+    {
+      nodes[j].reps = 0;
+      nodes[j].time = 0.0;
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+void TimingRegistry::clear(std::size_t task)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  for (std::size_t i = 0; i < _threads.size(); i++)
+  {
+    std::lock_guard<std::mutex> thread_lock(_threads[i]->mutex);
+    std::vector<Node>& nodes = _threads[i]->nodes;
+    for (std::size_t j = 1; j < nodes.size(); j++)
+    {
+      if (nodes[j].task == task)
+      {
+        nodes[j].reps = 0;
+        nodes[j].time = 0.0;
+      }
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+TimingRegistry::ThreadTimings& TimingRegistry::_thread_timings()
+{
+  if (thread_registry == this)
+    return *static_cast<ThreadTimings*>(thread_timings);
+
+  // First task of this thread, so create its tree
+  std::unique_ptr<ThreadTimings> timings(new ThreadTimings);
+  timings->nodes.resize(1);
+  timings->nodes[0].task = 0;
+  timings->nodes[0].reps = 0;
+  timings->nodes[0].time = 0.0;
+
+  thread_registry = this;
+  thread_timings = timings.get();
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  _threads.push_back(std::move(timings));
+  return *_threads.back();
+}
+//-----------------------------------------------------------------------------
+std::size_t TimingRegistry::_child(std::vector<Node>& nodes, std::size_t node,
+                                   std::size_t task)
+{
+  const std::vector<std::size_t>& children = nodes[node].children;
+  for (std::size_t i = 0; i < children.size(); i++)
+  {
+    if (nodes[children[i]].task == task)
+      return children[i];
+  }
+
+  Node child;
+  child.task = task;
+  child.reps = 0;
+  child.time = 0.0;
+  nodes.push_back(child);
+  nodes[node].children.push_back(nodes.size() - 1);
+  return nodes.size() - 1;
+}
+//-----------------------------------------------------------------------------
+void TimingRegistry::_merge(std::vector<Node>& merged,
+                            std::size_t merged_node,
+                            const std::vector<Node>& nodes, std::size_t node)
+{
+  for (std::size_t i = 0; i < nodes[node].children.size(); i++)
+  {
+    const Node& child = nodes[nodes[node].children[i]];
+    const std::size_t merged_child = _child(merged, merged_node, child.task);
+    merged[merged_child].reps += child.reps;
+    merged[merged_child].time += child.time;
+    _merge(merged, merged_child, nodes, nodes[node].children[i]);
+  }
+}
+//-----------------------------------------------------------------------------
+void TimingRegistry::_add_entries(std::vector<Entry>& entries,
+                                  const std::vector<Node>& merged,
+                                  std::size_t node,
+                                  std::vector<std::string>& path) const
+{
+  for (std::size_t i = 0; i < merged[node].children.size(); i++)
+  {
+    const Node& child = merged[merged[node].children[i]];
+    path.push_back(_task_names[child.task]);
+
+    // Time of enclosed tasks
+    double enclosed_time = 0.0;
+    for (std::size_t j = 0; j < child.children.size(); j++)
+      enclosed_time += merged[child.children[j]].time;
+
+    Entry entry;
+    entry.path = path;
+    entry.reps = child.reps;
+    entry.inclusive_time = child.time;
+    entry.exclusive_time = std::max(child.time - enclosed_time, 0.0);
+    const std::size_t num_entries = entries.size();
+    entries.push_back(entry);
+    _add_entries(entries, merged, merged[node].children[i], path);
+
+    // Skip tasks without timings (cleared), unless they enclose tasks
+    // with timings
+    if (entry.reps == 0 && entries.size() == num_entries + 1)
+      entries.pop_back();
+
+    path.pop_back();
+  }
+}
+//-----------------------------------------------------------------------------
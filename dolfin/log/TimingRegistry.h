@@ -0,0 +1,163 @@
+// Copyright (C) 2015 The FEniCS Project
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2015-01-22
+// Last changed: 2015-01-22
+
+#ifndef __TIMING_REGISTRY_H
+#define __TIMING_REGISTRY_H
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace dolfin
+{
+
+  /// This class stores the timings of tasks registered by timers
+  /// (see Timer). Task names are interned, so that a timing is
+  /// identified by an integer task id. Timings are nested: a task
+  /// which is started while another task is running on the same
+  /// thread is stored as a child of the running task, giving a call
+  /// tree of tasks.
+  ///
+  /// Each thread stores its timings in a separate tree, guarded by
+  /// a mutex of its own (so that timers on different threads do not
+  /// contend), and the trees are merged when timings are
+  /// reported. Tasks started on threads other than the one which
+  /// started the enclosing task (e.g. in OpenMP regions) are
+  /// therefore stored at the top level, and the times of a task timed
+  /// on several threads are summed. Timings may be reported or
+  /// cleared while timers are running on other threads; tasks which
+  /// are still running are not included.
+
+  class TimingRegistry
+  {
+  public:
+
+    /// A task in the merged call tree (see entries)
+    struct Entry
+    {
+      /// Names of the enclosing tasks and of the task
+      std::vector<std::string> path;
+
+      /// Number of timings
+      std::size_t reps;
+
+      /// Total time, including enclosed tasks
+      double inclusive_time;
+
+      /// Total time, excluding enclosed tasks
+      double exclusive_time;
+    };
+
+    /// Constructor
+    TimingRegistry();
+
+    /// Destructor
+    ~TimingRegistry();
+
+    /// Return id of task with given name, registering the name if
+    /// it is new (thread-safe)
+    std::size_t task_id(const std::string& task);
+
+    /// Return name of task with given id
+    std::string task_name(std::size_t task) const;
+
+    /// Start task on the calling thread (below the running task) and
+    /// return a handle to be passed to stop
+    std::size_t start(std::size_t task);
+
+    /// Stop task started with given handle on the calling thread,
+    /// adding the elapsed time, and return to the task which was
+    /// running when it was started
+    void stop(std::size_t handle, double elapsed_time);
+
+    /// Add a timing of task, below the running task on the calling
+    /// thread
+    void add(std::size_t task, double elapsed_time);
+
+    /// Return the merged call tree of all threads in depth-first
+    /// order
+    std::vector<Entry> entries() const;
+
+    /// Return number of timings and total time of a task, summed over
+    /// all places in the call tree
+    std::pair<std::size_t, double> total(std::size_t task) const;
+
+    /// Clear timings of all tasks
+    void clear();
+
+    /// Clear timings of a task
+    void clear(std::size_t task);
+
+  private:
+
+    // A task in the call tree of a thread
+    struct Node
+    {
+      std::size_t task;
+      std::vector<std::size_t> children;
+      std::size_t reps;
+      double time;
+    };
+
+    // Timings of a thread. The first node is the root (no task), and
+    // the stack holds the running tasks. The nodes are modified by
+    // the thread and read by reports, under the mutex.
+    struct ThreadTimings
+    {
+      std::vector<Node> nodes;
+      std::vector<std::size_t> stack;
+      std::mutex mutex;
+    };
+
+    // Return the timings of the calling thread
+    ThreadTimings& _thread_timings();
+
+    // Return child node of a node for task, adding it if new
+    static std::size_t _child(std::vector<Node>& nodes, std::size_t node,
+                              std::size_t task);
+
+    // Merge subtree of a thread tree into merged tree
+    static void _merge(std::vector<Node>& merged, std::size_t merged_node,
+                       const std::vector<Node>& nodes, std::size_t node);
+
+    // Add subtree of merged tree to entries in depth-first order
+    void _add_entries(std::vector<Entry>& entries,
+                      const std::vector<Node>& merged, std::size_t node,
+                      std::vector<std::string>& path) const;
+
+    // Task names and ids
+    std::vector<std::string> _task_names;
+    std::map<std::string, std::size_t> _task_ids;
+
+    // Timings of each thread which has started a task
+    std::vector<std::unique_ptr<ThreadTimings> > _threads;
+
+    // Mutex for task names and the list of threads (taken before
+    // the mutex of a thread)
+    mutable std::mutex _mutex;
+
+  };
+
+}
+
+#endif
@@ -0,0 +1,207 @@
+// Copyright (C) 2015 The FEniCS Project
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2015-01-22
+// Last changed: 2015-01-22
+
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+#include "TimingRegistry.h"
+#include "TraceRecorder.h"
+
+using namespace dolfin;
+
+namespace
+{
+  // Events of the calling thread, and the recorder they belong to
+  thread_local const dolfin::TraceRecorder* thread_recorder = 0;
+  thread_local void* thread_events = 0;
+
+  // Monotonic wall time in seconds (same clock as Timer)
+  double monotonic_time()
+  {
+    return std::chrono::duration<double>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  // Write string as a JSON string
+  void write_json_string(std::ostream& out, const std::string& s)
+  {
+    out << '"';
+    for (std::size_t i = 0; i < s.size(); i++)
+    {
+      const char c = s[i];
+      if (c == '"' || c == '\\')
+        out << '\\' << c;
+      else if (static_cast<unsigned char>(c) < 0x20)
+      {
+        char escaped[8];
+        std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+        out << escaped;
+      }
+      else
+        out << c;
+    }
+    out << '"';
+  }
+}
+
+//-----------------------------------------------------------------------------
+TraceRecorder::TraceRecorder() : _active(false), _capacity(0),
+                                 _start_time(0.0)
+{
+  // Do nothing
+}
+//-----------------------------------------------------------------------------
+TraceRecorder::~TraceRecorder()
+{
+  // Do nothing
+}
+//-----------------------------------------------------------------------------
+void TraceRecorder::start(std::size_t capacity)
+{
+  _active = false;
+
+  // Discard recorded events, keeping the buffers (which are cached
+  // by their threads)
+  std::lock_guard<std::mutex> lock(_mutex);
+  _capacity = capacity;
+  for (std::size_t i = 0; i < _threads.size(); i++)
+  {
+    std::lock_guard<std::mutex> thread_lock(_threads[i]->mutex);
+    std::vector<Event>().swap(_threads[i]->events);
+    _threads[i]->next = 0;
+    _threads[i]->num_events = 0;
+  }
+
+  _start_time = monotonic_time();
+  _active = capacity > 0;
+}
+//-----------------------------------------------------------------------------
+void TraceRecorder::stop()
+{
+  _active = false;
+}
+//-----------------------------------------------------------------------------
+void TraceRecorder::record(std::size_t task, double start_time,
+                           double duration)
+{
+  if (!active())
+    return;
+
+  const Event event = {task, false, start_time - _start_time, duration};
+  _add(event);
+}
+//-----------------------------------------------------------------------------
+void TraceRecorder::record_counter(std::size_t task, double value)
+{
+  if (!active())
+    return;
+
+  const Event event = {task, true, monotonic_time() - _start_time, value};
+  _add(event);
+}
+//-----------------------------------------------------------------------------
+std::string TraceRecorder::json(const TimingRegistry& registry,
+                                std::size_t process) const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  std::stringstream out;
+  out.setf(std::ios::fixed);
+  out.precision(3);
+
+  // Name of process, for display
+  out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << process
+      << ",\"args\":{\"name\":\"Process " << process << "\"}}";
+
+  for (std::size_t thread = 0; thread < _threads.size(); thread++)
+  {
+    // Events of thread, oldest first (times in microseconds)
+    ThreadEvents& events = *_threads[thread];
+    std::lock_guard<std::mutex> thread_lock(events.mutex);
+    const std::size_t n = events.events.size();
+    const std::size_t first = (events.num_events > n) ? events.next : 0;
+    for (std::size_t i = 0; i < n; i++)
+    {
+      const Event& event = events.events[(first + i) % n];
+      out << ",\n{\"name\":";
+      write_json_string(out, registry.task_name(event.task));
+      out << ",\"pid\":" << process << ",\"tid\":" << thread
+          << ",\"ts\":" << 1e6*event.time;
+      if (event.counter)
+      {
+        out << ",\"ph\":\"C\",\"args\":{\"value\":" << event.value
+            << "}}";
+      }
+      else
+        out << ",\"ph\":\"X\",\"dur\":" << 1e6*event.value << "}";
+    }
+  }
+
+  return out.str();
+}
+//-----------------------------------------------------------------------------
+std::size_t TraceRecorder::num_dropped_events() const
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  std::size_t num_dropped = 0;
+  for (std::size_t i = 0; i < _threads.size(); i++)
+  {
+    std::lock_guard<std::mutex> thread_lock(_threads[i]->mutex);
+    num_dropped += _threads[i]->num_events - _threads[i]->events.size();
+  }
+  return num_dropped;
+}
+//-----------------------------------------------------------------------------
+TraceRecorder::ThreadEvents& TraceRecorder::_thread_events()
+{
+  if (thread_recorder == this)
+    return *static_cast<ThreadEvents*>(thread_events);
+
+  // First event of this thread, so create its buffer
+  std::unique_ptr<ThreadEvents> events(new ThreadEvents);
+  events->next = 0;
+  events->num_events = 0;
+
+  thread_recorder = this;
+  thread_events = events.get();
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  _threads.push_back(std::move(events));
+  return *_threads.back();
+}
+//-----------------------------------------------------------------------------
+void TraceRecorder::_add(const Event& event)
+{
+  // The buffer grows up to its capacity, after which the oldest
+  // event is overwritten. The capacity is read under the lock, as
+  // recording may be restarted (with another capacity) meanwhile.
+  ThreadEvents& events = _thread_events();
+  std::lock_guard<std::mutex> lock(events.mutex);
+  const std::size_t capacity = _capacity;
+  if (capacity == 0)
+    return;
+  if (events.events.size() < capacity)
+    events.events.push_back(event);
+  else
+    events.events[events.next % capacity] = event;
+  events.next = (events.next + 1) % capacity;
+  events.num_events += 1;
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,135 @@
+// Copyright (C) 2015 The FEniCS Project
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2015-01-22
+// Last changed: 2015-01-22
+
+#ifndef __TRACE_RECORDER_H
+#define __TRACE_RECORDER_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace dolfin
+{
+
+  class TimingRegistry;
+
+  /// This class records a timeline of events (timed tasks and
+  /// progress updates) when tracing is switched on (see start_trace),
+  /// for output in the Chrome trace event format (see write_trace).
+  ///
+  /// Each thread records its events into a separate ring buffer of
+  /// fixed capacity, guarded by a mutex of its own (so that threads
+  /// do not contend), and memory usage is bounded: when a buffer is
+  /// full, the oldest events of the thread are overwritten. When
+  /// tracing is switched off, recording an event costs a single
+  /// check.
+
+  class TraceRecorder
+  {
+  public:
+
+    /// Constructor
+    TraceRecorder();
+
+    /// Destructor
+    ~TraceRecorder();
+
+    /// Start recording, discarding previously recorded events and
+    /// keeping at most the given number of events per thread. Times
+    /// of events are measured from the time of this call.
+    void start(std::size_t capacity);
+
+    /// Stop recording (recorded events are kept)
+    void stop();
+
+    /// Return true iff events are being recorded
+    bool active() const
+    { return _active.load(std::memory_order_relaxed); }
+
+    /// Record the timing of a task on the calling thread, given its
+    /// (monotonic) start time and duration in seconds
+    void record(std::size_t task, double start_time, double duration);
+
+    /// Record the value of a counter (task) on the calling thread at
+    /// the current time
+    void record_counter(std::size_t task, double value);
+
+    /// Return recorded events in the Chrome trace event format (as
+    /// comma-separated JSON objects), with task names taken from the
+    /// given timing registry and given process id
+    std::string json(const TimingRegistry& registry,
+                     std::size_t process) const;
+
+    /// Return number of events overwritten since recording was
+    /// started
+    std::size_t num_dropped_events() const;
+
+  private:
+
+    // An event: timing of a task (duration) or counter value
+    struct Event
+    {
+      std::size_t task;
+      bool counter;
+      double time;
+      double value;
+    };
+
+    // Ring buffer of events of a thread. The oldest event is at
+    // position next when the buffer is full. The buffer is modified
+    // by the thread and read or reset by others, under the mutex.
+    struct ThreadEvents
+    {
+      std::vector<Event> events;
+      std::size_t next;
+      std::size_t num_events;
+      std::mutex mutex;
+    };
+
+    // Return the events of the calling thread
+    ThreadEvents& _thread_events();
+
+    // Add event to the ring buffer of the calling thread
+    void _add(const Event& event);
+
+    // Whether events are recorded
+    std::atomic<bool> _active;
+
+    // Maximum number of events per thread
+    std::atomic<std::size_t> _capacity;
+
+    // Time at which recording was started
+    std::atomic<double> _start_time;
+
+    // Events of each thread which has recorded an event
+    std::vector<std::unique_ptr<ThreadEvents> > _threads;
+
+    // Mutex for the list of threads (taken before the mutex of a
+    // thread)
+    mutable std::mutex _mutex;
+
+  };
+
+}
+
+#endif
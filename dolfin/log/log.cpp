@@ -21,7 +21,7 @@
 // Modified by Garth N. Wells 2009
 //
 // First added:  2003-03-13
-// Last changed: 2013-04-18
+// Last changed: 2015-01-22
 
 #include <cstdarg>
 #include <cstdlib>
@@ -36,6 +36,7 @@
 #include <dolfin/common/MPI.h>
 #include <dolfin/parameter/Parameters.h>
 #include "LogManager.h"
+#include "Table.h"
 #include "log.h"
 
 using namespace dolfin;
@@ -199,6 +200,11 @@ void dolfin::monitor_memory_usage()
   LogManager::logger.monitor_memory_usage();
 }
 //-----------------------------------------------------------------------------
+Table dolfin::memory_summary()
+{
+  return LogManager::logger.memory_summary();
+}
+//-----------------------------------------------------------------------------
 void dolfin::not_working_in_parallel(std::string what)
 {
   if (MPI::size(MPI_COMM_WORLD) > 1)
@@ -18,7 +18,7 @@
 // Modified by Ola Skavhaug 2007, 2009
 //
 // First added:  2003-03-13
-// Last changed: 2013-01-07
+// Last changed: 2015-01-22
 
 #ifndef __LOG_H
 #define __LOG_H
@@ -31,6 +31,7 @@ namespace dolfin
 
   class Variable;
   class Parameters;
+  class Table;
 
   /// The DOLFIN log system provides the following set of functions for
   /// uniform handling of log messages, warnings and errors. In addition,
@@ -130,6 +131,13 @@ namespace dolfin
   /// program to continuously monitor the memory usage of the process.
   void monitor_memory_usage();
 
+  /// Return a summary of the memory usage of mesh topology and
+  /// geometry, dof maps, sparsity patterns, bounding box trees and
+  /// PETSc matrices (all live objects derived from MemoryTracked) as
+  /// a Table. When running in parallel, this is collective and the
+  /// minimum, average and maximum over all processes are given.
+  Table memory_summary();
+
   /// Report that functionality has not (yet) been implemented to work
   /// in parallel
   void not_working_in_parallel(std::string what);
@@ -20,7 +20,7 @@
 // Modified by Jan Blechta 2013
 //
 // First added:  2006-06-05
-// Last changed: 2014-04-24
+// Last changed: 2015-01-22
 
 #ifndef __CELL_TYPE_H
 #define __CELL_TYPE_H
@@ -99,6 +99,13 @@ namespace dolfin
     virtual void refine_cell(Cell& cell, MeshEditor& editor,
                              std::size_t& current_cell) const = 0;
 
+    /// Refine cell uniformly and write the vertices of the new cells
+    /// (2^dim cells, flattened) to cells. The new vertex on edge e is
+    /// numbered num_vertices + e, where num_vertices is the number of
+    /// vertices of the unrefined mesh. This function does not modify
+    /// any mesh and may be called concurrently for different cells.
+    virtual void refine_cell(const Cell& cell, std::size_t* cells) const = 0;
+
     /// Compute (generalized) volume of mesh entity
     virtual double volume(const MeshEntity& entity) const = 0;
 
@@ -18,7 +18,7 @@
 // Modified by Anders Logg 2011
 //
 // First added:  2011-09-17
-// Last changed: 2014-07-02
+// Last changed: 2015-01-22
 
 #include <boost/multi_array.hpp>
 
@@ -125,10 +125,6 @@ std::size_t DistributedMeshTools::number_entities(
   // MPI communicator
   const MPI_Comm mpi_comm = mesh.mpi_comm();
 
-  // Get number of processes and process number
-  const std::size_t num_processes = MPI::size(mpi_comm);
-  const std::size_t process_number = MPI::rank(mpi_comm);
-
   // Initialize entities of dimension d locally
   mesh.init(d);
 
@@ -165,6 +161,10 @@ std::size_t DistributedMeshTools::number_entities(
   const std::map<unsigned int, std::set<unsigned int> >& shared_vertices_local
                             = mesh.topology().shared_entities(0);
 
+  // Neighbouring processes (sharing vertices), which are the only
+  // processes that can share entities
+  const MPINeighborComm neighbors(mpi_comm, compute_neighbor_processes(mesh));
+
   // Compute ownership of entities of dimension d ([entity vertices], data):
   //  [0]: owned and shared (will be numbered by this process, and number
   //       communicated to other processes)
@@ -172,7 +172,8 @@ std::size_t DistributedMeshTools::number_entities(
   //       communicated to this processes)
   std::array<std::map<Entity, EntityData>, 2> entity_ownership;
   std::vector<std::size_t> owned_entities;
-  compute_entity_ownership(mpi_comm, entities, shared_vertices_local,
+  compute_entity_ownership(mpi_comm, neighbors, entities,
+                           shared_vertices_local,
                            global_vertex_indices, d, owned_entities,
                            entity_ownership);
 
@@ -187,8 +188,7 @@ std::size_t DistributedMeshTools::number_entities(
 
   // Compute global number of entities and local process offset
   const std::pair<std::size_t, std::size_t> num_global_entities
-    = compute_num_global_entities(mpi_comm, num_local_entities, num_processes,
-                                  process_number);
+    = compute_num_global_entities(mpi_comm, num_local_entities);
 
   // Extract offset
   std::size_t offset = num_global_entities.second;
@@ -215,7 +215,8 @@ std::size_t DistributedMeshTools::number_entities(
 
   // Communicate indices for shared entities (owned by this process)
   // and get indices for shared but not owned entities
-  std::vector<std::vector<std::size_t> > send_values(num_processes);
+  std::vector<std::vector<std::size_t> >
+    send_values(neighbors.destinations().size());
   std::vector<std::size_t> destinations;
   for (it1 = owned_shared_entities.begin();
        it1 != owned_shared_entities.end(); ++it1)
@@ -238,7 +239,7 @@ std::size_t DistributedMeshTools::number_entities(
     {
       // Store interleaved: entity index, number of vertices, global
       // vertex indices
-      std::size_t p = entity_processes[j];
+      const std::size_t p = neighbors.destination_index(entity_processes[j]);
       send_values[p].push_back(global_entity_index);
       send_values[p].push_back(e.size());
       send_values[p].insert(send_values[p].end(), e.begin(), e.end());
@@ -247,19 +248,20 @@ std::size_t DistributedMeshTools::number_entities(
 
   // Send data
   std::vector<std::vector<std::size_t> > received_values;
-  MPI::all_to_all(mpi_comm, send_values, received_values);
+  MPI::neighbor_all_to_all(neighbors, send_values, received_values);
 
   // Fill in global entity indices received from lower ranked
   // processes
-  for (std::size_t p = 0; p < num_processes; ++p)
+  for (std::size_t n = 0; n < received_values.size(); ++n)
   {
-    for (std::size_t i = 0; i < received_values[p].size();)
+    const std::size_t p = neighbors.sources()[n];
+    for (std::size_t i = 0; i < received_values[n].size();)
     {
-      const std::size_t global_index = received_values[p][i++];
-      const std::size_t entity_size = received_values[p][i++];
+      const std::size_t global_index = received_values[n][i++];
+      const std::size_t entity_size = received_values[n][i++];
       Entity e;
       for (std::size_t j = 0; j < entity_size; ++j)
-        e.push_back(received_values[p][i++]);
+        e.push_back(received_values[n][i++]);
 
       // Access unowned entity data
       std::map<Entity, EntityData>::const_iterator recv_entity;
@@ -508,7 +510,6 @@ std::unordered_map<unsigned int, std::vector<std::pair<unsigned int, unsigned in
 {
   // MPI communicator
   const MPI_Comm mpi_comm = mesh.mpi_comm();
-  const unsigned int comm_size = MPI::size(mpi_comm);
 
   // Return empty set if running in serial
   if (MPI::size(mpi_comm) == 1)
@@ -530,12 +531,19 @@ std::unordered_map<unsigned int, std::vector<std::pair<unsigned int, unsigned in
   const std::vector<std::size_t>& global_indices_map
     = mesh.topology().global_indices(d);
 
-  // Global-to-local map for each process
-  std::unordered_map<std::size_t, std::unordered_map<std::size_t, std::size_t> > global_to_local;
+  // Neighbouring processes (sharing vertices). Since the sources and
+  // destinations are the same, data received from neighbour i is
+  // answered by sending to neighbour i.
+  const MPINeighborComm neighbors(mpi_comm, compute_neighbor_processes(mesh));
+  const std::size_t num_neighbors = neighbors.destinations().size();
+
+  // Global-to-local map for each neighbour
+  std::vector<std::unordered_map<std::size_t, std::size_t> >
+    global_to_local(num_neighbors);
 
   // Pack global indices for sending to sharing processes
-  std::vector<std::vector<std::size_t> > send_indices(comm_size);
-  std::vector<std::vector<std::size_t> > local_sent_indices(comm_size);
+  std::vector<std::vector<std::size_t> > send_indices(num_neighbors);
+  std::vector<std::vector<std::size_t> > local_sent_indices(num_neighbors);
   std::map<unsigned int, std::set<unsigned int> >::const_iterator shared_entity;
   for (shared_entity = shared_entities.begin();
        shared_entity != shared_entities.end(); ++shared_entity)
@@ -555,35 +563,33 @@ std::unordered_map<unsigned int, std::vector<std::pair<unsigned int, unsigned in
     for (dest = sharing_processes.begin(); dest != sharing_processes.end();
          ++dest)
     {
-      send_indices[*dest].push_back(global_index);
-      local_sent_indices[*dest].push_back(local_index);
-      global_to_local[*dest].insert(std::make_pair(global_index, local_index));
+      const std::size_t n = neighbors.destination_index(*dest);
+      send_indices[n].push_back(global_index);
+      local_sent_indices[n].push_back(local_index);
+      global_to_local[n].insert(std::make_pair(global_index, local_index));
     }
   }
 
   std::vector<std::vector<std::size_t> > recv_entities;
-  MPI::all_to_all(mpi_comm, send_indices, recv_entities);
+  MPI::neighbor_all_to_all(neighbors, send_indices, recv_entities);
 
   // Clear send data
   send_indices.clear();
-  send_indices.resize(comm_size);
+  send_indices.resize(num_neighbors);
 
   // Determine local entities indices for received global entity indices
   std::unordered_map<std::size_t, std::vector<std::size_t> >::const_iterator
     received_global_indices;
   for (std::size_t p = 0; p < recv_entities.size(); ++p)
   {
-    // Get process number of neighbour
+    // Get neighbour index of sending process
     const std::size_t sending_proc = p;
 
     if (recv_entities[p].size() > 0)
     {
       // Get global-to-local map for neighbour process
-      std::unordered_map<std::size_t, std::unordered_map<std::size_t, std::size_t> >::const_iterator
-        it = global_to_local.find(sending_proc);
-      dolfin_assert(it != global_to_local.end());
       const std::unordered_map<std::size_t, std::size_t>&
-        neighbour_global_to_local = it->second;
+        neighbour_global_to_local = global_to_local[sending_proc];
 
       // Build vector of local indices
       const std::vector<std::size_t>& global_indices_recv
@@ -604,7 +610,7 @@ std::unordered_map<unsigned int, std::vector<std::pair<unsigned int, unsigned in
     }
   }
 
-  MPI::all_to_all(mpi_comm, send_indices, recv_entities);
+  MPI::neighbor_all_to_all(neighbors, send_indices, recv_entities);
 
   // Build map
   std::unordered_map<unsigned int, std::vector<std::pair<unsigned int, unsigned int> > >
@@ -618,7 +624,7 @@ std::unordered_map<unsigned int, std::vector<std::pair<unsigned int, unsigned in
     if (recv_entities[p].size() > 0)
     {
       // Process that shares entities
-      const std::size_t proc = p;
+      const std::size_t proc = neighbors.sources()[p];
 
       // Local indices on sharing process
       const std::vector<std::size_t>& neighbour_local_indices
@@ -641,8 +647,21 @@ std::unordered_map<unsigned int, std::vector<std::pair<unsigned int, unsigned in
   return shared_local_indices_map;
 }
 //-----------------------------------------------------------------------------
+std::vector<int>
+DistributedMeshTools::compute_neighbor_processes(const Mesh& mesh)
+{
+  const std::map<unsigned int, std::set<unsigned int> >& shared_vertices
+    = mesh.topology().shared_entities(0);
+  std::set<int> neighbors;
+  for (auto v = shared_vertices.begin(); v != shared_vertices.end(); ++v)
+    neighbors.insert(v->second.begin(), v->second.end());
+
+  return std::vector<int>(neighbors.begin(), neighbors.end());
+}
+//-----------------------------------------------------------------------------
 void DistributedMeshTools::compute_entity_ownership(
   const MPI_Comm mpi_comm,
+  const MPINeighborComm& neighbors,
   const std::map<std::vector<std::size_t>, unsigned int>& entities,
   const std::map<unsigned int, std::set<unsigned int> >& shared_vertices_local,
   const std::vector<std::size_t>& global_vertex_indices,
@@ -677,7 +696,8 @@ void DistributedMeshTools::compute_entity_ownership(
   // ranked process for the entity in question, and is therefore
   // responsible for communicating values to the higher ranked
   // processes (if any).
-  compute_final_entity_ownership(mpi_comm, owned_entities, shared_entities);
+  compute_final_entity_ownership(mpi_comm, neighbors, owned_entities,
+                                 shared_entities);
 }
 //-----------------------------------------------------------------------------
 void DistributedMeshTools::compute_preliminary_entity_ownership(
@@ -767,6 +787,7 @@ void DistributedMeshTools::compute_preliminary_entity_ownership(
 //-----------------------------------------------------------------------------
 void DistributedMeshTools::compute_final_entity_ownership(
   const MPI_Comm mpi_comm,
+  const MPINeighborComm& neighbors,
   std::vector<std::size_t>& owned_entities,
   std::array<std::map<Entity, EntityData>, 2>& shared_entities)
 {
@@ -774,14 +795,14 @@ void DistributedMeshTools::compute_final_entity_ownership(
   std::map<Entity, EntityData>& owned_shared_entities = shared_entities[0];
   std::map<Entity, EntityData>& unowned_shared_entities = shared_entities[1];
 
-  // Get MPI number of processes and process number
-  const std::size_t num_processes = MPI::size(mpi_comm);
+  // Get MPI process number and number of neighbouring processes
   const std::size_t process_number = MPI::rank(mpi_comm);
+  const std::size_t num_neighbors = neighbors.destinations().size();
 
   // Communicate common entities, starting with the entities we think
   // are shared but not owned
   std::vector<std::vector<std::size_t> >
-    send_common_entity_values(num_processes);
+    send_common_entity_values(num_neighbors);
   for (std::map<Entity, EntityData>::const_iterator it
          = unowned_shared_entities.begin(); it != unowned_shared_entities.end();
        ++it)
@@ -795,7 +816,7 @@ void DistributedMeshTools::compute_final_entity_ownership(
     // Prepare data for sending
     for (std::size_t j = 0; j < entity_processes.size(); ++j)
     {
-      const std::size_t p = entity_processes[j];
+      const std::size_t p = neighbors.destination_index(entity_processes[j]);
       send_common_entity_values[p].push_back(entity.size());
       send_common_entity_values[p].insert(send_common_entity_values[p].end(),
                                           entity.begin(), entity.end());
@@ -817,8 +838,8 @@ void DistributedMeshTools::compute_final_entity_ownership(
     // Prepare data for sending
     for (std::size_t j = 0; j < entity_processes.size(); ++j)
     {
-      const unsigned int p = entity_processes[j];
-      dolfin_assert(process_number < p);
+      dolfin_assert(process_number < entity_processes[j]);
+      const std::size_t p = neighbors.destination_index(entity_processes[j]);
       send_common_entity_values[p].push_back(entity.size());
       send_common_entity_values[p].insert(send_common_entity_values[p].end(),
                                           entity.begin(), entity.end());
@@ -827,12 +848,13 @@ void DistributedMeshTools::compute_final_entity_ownership(
 
   // Communicate common entities
   std::vector<std::vector<std::size_t> > received_common_entity_values;
-  MPI::all_to_all(mpi_comm, send_common_entity_values,
-                  received_common_entity_values);
+  MPI::neighbor_all_to_all(neighbors, send_common_entity_values,
+                           received_common_entity_values);
 
-  // Check if entities received are really entities
-  std::vector<std::vector<std::size_t> > send_is_entity_values(num_processes);
-  for (std::size_t p = 0; p < num_processes; ++p)
+  // Check if entities received are really entities (the sources and
+  // destinations of the neighbourhood are the same)
+  std::vector<std::vector<std::size_t> > send_is_entity_values(num_neighbors);
+  for (std::size_t p = 0; p < num_neighbors; ++p)
   {
     for (std::size_t i = 0; i < received_common_entity_values[p].size();)
     {
@@ -862,11 +884,12 @@ void DistributedMeshTools::compute_final_entity_ownership(
 
   // Send data back (list of requested entities that are really entities)
   std::vector<std::vector<std::size_t> > received_is_entity_values;
-  MPI::all_to_all(mpi_comm, send_is_entity_values, received_is_entity_values);
+  MPI::neighbor_all_to_all(neighbors, send_is_entity_values,
+                           received_is_entity_values);
 
   // Create map from entities to processes where it is an entity
   std::map<Entity, std::vector<unsigned int> > entity_processes;
-  for (std::size_t p = 0; p < num_processes; ++p)
+  for (std::size_t p = 0; p < num_neighbors; ++p)
   {
     for (std::size_t i = 0; i < received_is_entity_values[p].size();)
     {
@@ -878,7 +901,7 @@ void DistributedMeshTools::compute_final_entity_ownership(
       if (is_entity == 1)
       {
         // Add entity since it is actually an entity for process p
-        entity_processes[entity].push_back(p);
+        entity_processes[entity].push_back(neighbors.sources()[p]);
       }
     }
   }
@@ -972,24 +995,13 @@ bool DistributedMeshTools::is_shared(const Entity& entity,
 //-----------------------------------------------------------------------------
 std::pair<std::size_t, std::size_t>
 DistributedMeshTools::compute_num_global_entities(const MPI_Comm mpi_comm,
-                                                  std::size_t num_local_entities,
-                                                  std::size_t num_processes,
-                                                  std::size_t process_number)
+                                                  std::size_t num_local_entities)
 {
-  // Communicate number of local entities
-  std::vector<std::size_t> num_entities_to_number;
-  MPI::all_gather(mpi_comm, num_local_entities, num_entities_to_number);
-
-  // Compute offset
+  // Compute offset and number of global entities (without gathering
+  // the number of local entities from all processes)
   const std::size_t offset
-    = std::accumulate(num_entities_to_number.begin(),
-                      num_entities_to_number.begin() + process_number,
-                      (std::size_t)0);
-
-  // Compute number of global entities
-  const std::size_t num_global = std::accumulate(num_entities_to_number.begin(),
-                                                 num_entities_to_number.end(),
-                                                 (std::size_t)0);
+    = MPI::global_offset(mpi_comm, num_local_entities, true);
+  const std::size_t num_global = MPI::sum(mpi_comm, num_local_entities);
 
   return std::make_pair(num_global, offset);
 }
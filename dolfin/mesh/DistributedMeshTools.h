@@ -16,7 +16,7 @@
 // along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 //
 // First added:  2011-09-17
-// Last changed: 2013-01-29
+// Last changed: 2015-01-22
 
 #ifndef __MESH_DISTRIBUTED_TOOLS_H
 #define __MESH_DISTRIBUTED_TOOLS_H
@@ -77,6 +77,11 @@ namespace dolfin
       std::vector<std::pair<unsigned int, unsigned int> > >
       compute_shared_entities(const Mesh& mesh, std::size_t d);
 
+    /// Return the processes which share vertices with this process,
+    /// in increasing order. These are the neighbours of the process
+    /// in the graph of shared mesh entities (see MPINeighborComm).
+    static std::vector<int> compute_neighbor_processes(const Mesh& mesh);
+
   private:
 
     // Data structure for a mesh entity (list of vertices, using
@@ -115,6 +120,7 @@ namespace dolfin
     //       and number communicated to this processes)
     static void compute_entity_ownership(
       const MPI_Comm mpi_comm,
+      const MPINeighborComm& neighbors,
       const std::map<std::vector<std::size_t>, unsigned int>& entities,
       const std::map<unsigned int, std::set<unsigned int> >& shared_vertices_local,
       const std::vector<std::size_t>& global_vertex_indices,
@@ -134,6 +140,7 @@ namespace dolfin
     // Communicate with other processes to finalise entity ownership
     static void
       compute_final_entity_ownership(const MPI_Comm mpi_comm,
+                                     const MPINeighborComm& neighbors,
                                      std::vector<std::size_t>& owned_entities,
                                      std::array<std::map<Entity,
                                      EntityData>, 2>& entity_ownership);
@@ -145,9 +152,7 @@ namespace dolfin
     // Compute and return (number of global entities, process offset)
     static std::pair<std::size_t, std::size_t>
       compute_num_global_entities(const MPI_Comm mpi_comm,
-                                  std::size_t num_local_entities,
-                                  std::size_t num_processes,
-                                  std::size_t process_number);
+                                  std::size_t num_local_entities);
 
   };
 
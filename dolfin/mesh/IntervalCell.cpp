@@ -21,7 +21,7 @@
 // Modified by August Johansson 2014
 //
 // First added:  2006-06-05
-// Last changed: 2014-05-22
+// Last changed: 2015-01-22
 
 #include <algorithm>
 #include <dolfin/log/log.h>
@@ -90,6 +90,21 @@ void IntervalCell::create_entities(std::vector<std::vector<unsigned int> >& e,
 //-----------------------------------------------------------------------------
 void IntervalCell::refine_cell(Cell& cell, MeshEditor& editor,
                                std::size_t& current_cell) const
+{
+  // Create the two new cells
+  std::vector<std::size_t> cells(4);
+  refine_cell(cell, cells.data());
+
+  // Add cells
+  std::vector<std::size_t> new_cell(2);
+  for (std::size_t i = 0; i < 2; ++i)
+  {
+    std::copy(cells.begin() + 2*i, cells.begin() + 2*(i + 1), new_cell.begin());
+    editor.add_cell(current_cell++, new_cell);
+  }
+}
+//-----------------------------------------------------------------------------
+void IntervalCell::refine_cell(const Cell& cell, std::size_t* cells) const
 {
   // Get vertices
   const unsigned int* v = cell.entities(0);
@@ -103,14 +118,9 @@ void IntervalCell::refine_cell(Cell& cell, MeshEditor& editor,
   const std::size_t v1 = v[1];
   const std::size_t e0 = offset + cell.index();
 
-  // Add the two new cells
-  std::vector<std::size_t> new_cell(2);
-
-  new_cell[0] = v0; new_cell[1] = e0;
-  editor.add_cell(current_cell++, new_cell);
-
-  new_cell[0] = e0; new_cell[1] = v1;
-  editor.add_cell(current_cell++, new_cell);
+  // Create the two new cells
+  cells[0] = v0; cells[1] = e0;
+  cells[2] = e0; cells[3] = v1;
 }
 //-----------------------------------------------------------------------------
 double IntervalCell::volume(const MeshEntity& interval) const
@@ -18,7 +18,7 @@
 // Modified by Kristoffer Selim 2008
 //
 // First added:  2006-06-05
-// Last changed: 2014-05-22
+// Last changed: 2015-01-22
 
 #ifndef __INTERVAL_CELL_H
 #define __INTERVAL_CELL_H
@@ -63,6 +63,9 @@ namespace dolfin
     /// Refine cell uniformly
     void refine_cell(Cell& cell, MeshEditor& editor, std::size_t& current_cell) const;
 
+    /// Refine cell uniformly (writing new cells to array)
+    void refine_cell(const Cell& cell, std::size_t* cells) const;
+
     /// Compute (generalized) volume (length) of interval
     double volume(const MeshEntity& interval) const;
 
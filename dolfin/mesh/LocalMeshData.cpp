@@ -18,7 +18,7 @@
 // Modified by Anders Logg 2008-2011
 //
 // First added:  2008-11-28
-// Last changed: 2012-11-24
+// Last changed: 2015-01-22
 
 #include <dolfin/common/MPI.h>
 #include <dolfin/common/Timer.h>
@@ -115,6 +115,7 @@ void LocalMeshData::clear()
   vertex_indices.clear();
   cell_vertices.resize(boost::extents[0][0]);
   global_cell_indices.clear();
+  cell_weight.clear();
   num_global_vertices = 0;
   num_global_cells = 0;
   gdim = 0;
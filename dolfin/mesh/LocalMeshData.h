@@ -18,7 +18,7 @@
 // Modified by Anders Logg, 2008-2009.
 //
 // First added:  2008-11-28
-// Last changed: 2013-02-18
+// Last changed: 2015-01-22
 //
 // Modified by Anders Logg, 2008-2009.
 // Modified by Kent-Andre Mardal, 2011.
@@ -105,6 +105,10 @@ namespace dolfin
     // Optional process owner for each cell in  global_cell_indices
     std::vector<std::size_t> cell_partition;
 
+    // Optional (integer) weight for each cell in global_cell_indices,
+    // used by the graph partitioner to balance the computational load
+    std::vector<std::size_t> cell_weight;
+
     // Global number of vertices
     std::size_t num_global_vertices;
 
@@ -18,10 +18,11 @@
 // Modified by Mikael Mortensen 2014
 //
 // First added:  2006-05-09
-// Last changed: 2014-01-09
+// Last changed: 2015-01-22
 
 #include <sstream>
 #include <boost/functional/hash.hpp>
+#include <dolfin/common/MemoryTracked.h>
 #include <dolfin/log/log.h>
 #include "MeshConnectivity.h"
 
@@ -144,6 +145,14 @@ std::size_t MeshConnectivity::hash() const
   return uhash(_connections);
 }
 //-----------------------------------------------------------------------------
+std::size_t MeshConnectivity::memory_usage() const
+{
+  return sizeof(*this)
+    + MemoryTracked::vector_memory_usage(_connections)
+    + MemoryTracked::vector_memory_usage(_num_global_connections)
+    + MemoryTracked::vector_memory_usage(index_to_position);
+}
+//-----------------------------------------------------------------------------
 std::string MeshConnectivity::str(bool verbose) const
 {
   std::stringstream s;
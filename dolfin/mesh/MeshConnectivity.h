@@ -16,7 +16,7 @@
 // along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 //
 // First added:  2006-05-09
-// Last changed: 2010-11-28
+// Last changed: 2015-01-22
 
 #ifndef __MESH_CONNECTIVITY_H
 #define __MESH_CONNECTIVITY_H
@@ -147,6 +147,9 @@ namespace dolfin
     /// Hash of connections
     std::size_t hash() const;
 
+    /// Return number of bytes used by connectivity
+    std::size_t memory_usage() const;
+
     /// Return informal string representation (pretty-print)
     std::string str(bool verbose) const;
 
@@ -154,7 +157,9 @@ namespace dolfin
 
     // Friends
     friend class BinaryFile;
+    friend class MeshEditor;
     friend class MeshRenumbering;
+    friend class MeshOrdering;
 
     // Dimensions (only used for pretty-printing)
     std::size_t _d0, _d1;
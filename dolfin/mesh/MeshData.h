@@ -19,7 +19,7 @@
 // Modified by Garth N. Wells, 2011.
 //
 // First added:  2008-05-19
-// Last changed: 2011-09-15
+// Last changed: 2015-01-22
 
 #ifndef __MESH_DATA_H
 #define __MESH_DATA_H
@@ -53,6 +53,13 @@ namespace dolfin
   ///
   ///   * "parent_vertex_indices" - _std::vector_ <std::size_t> of dimension 0
   ///
+  /// Refined meshes (used by multigrid transfer between levels, entries
+  /// without a parent are std::numeric_limits<std::size_t>::max())
+  ///
+  ///   * "parent_cell"   - _std::vector_ <std::size_t> of dimension D
+  ///   * "parent_vertex" - _std::vector_ <std::size_t> of dimension 0
+  ///   * "parent_edge"   - _std::vector_ <std::size_t> of dimension 0
+  ///
   /// Note to developers: use underscore in names in place of spaces.
 
   class MeshData : public Variable
@@ -154,6 +161,7 @@ namespace dolfin
 
     /// Friends
     friend class XMLMesh;
+    friend class MeshOrdering;
 
   private:
 
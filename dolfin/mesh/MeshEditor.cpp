@@ -18,8 +18,9 @@
 // Modified by Benjamin Kehlet, 2012
 //
 // First added:  2006-05-16
-// Last changed: 2014-02-06
+// Last changed: 2015-01-22
 
+#include <algorithm>
 #include <dolfin/log/log.h>
 #include <dolfin/geometry/Point.h>
 #include "Mesh.h"
@@ -262,6 +263,162 @@ void MeshEditor::add_cell(std::size_t local_index, std::size_t global_index,
   _mesh->_topology.set_global_index(_tdim, local_index, global_index);
 }
 //-----------------------------------------------------------------------------
+void MeshEditor::set_vertices(std::vector<double>& x)
+{
+  dolfin_assert(_gdim > 0);
+  std::vector<std::size_t> global_indices;
+  const std::size_t num_vertices = x.size()/_gdim;
+  set_vertices_global(x, global_indices, num_vertices);
+}
+//-----------------------------------------------------------------------------
+void MeshEditor::set_vertices_global(std::vector<double>& x,
+                                     std::vector<std::size_t>& global_indices,
+                                     std::size_t num_global_vertices)
+{
+  // Check if we are currently editing a mesh
+  if (!_mesh)
+  {
+    dolfin_error("MeshEditor.cpp",
+                 "set vertices in mesh editor",
+                 "No mesh opened, unable to edit");
+  }
+
+  // Check size of coordinate array
+  if (x.size() % _gdim != 0)
+  {
+    dolfin_error("MeshEditor.cpp",
+                 "set vertices in mesh editor",
+                 "Size of coordinate array (%d) is not a multiple of the geometric dimension (%d)",
+                 x.size(), _gdim);
+  }
+  const std::size_t num_vertices = x.size()/_gdim;
+
+  // Initialise topology, using local indices as global indices if
+  // none are given
+  MeshTopology& topology = _mesh->_topology;
+  topology.init(0, num_vertices, num_global_vertices);
+  topology.init_ghost(0, num_vertices);
+  if (global_indices.empty())
+  {
+    topology._global_indices[0].resize(num_vertices);
+    for (std::size_t i = 0; i < num_vertices; ++i)
+      topology._global_indices[0][i] = i;
+  }
+  else
+  {
+    if (global_indices.size() != num_vertices)
+    {
+      dolfin_error("MeshEditor.cpp",
+                   "set vertices in mesh editor",
+                   "Number of global indices (%d) does not match number of vertices (%d)",
+                   global_indices.size(), num_vertices);
+    }
+    topology._global_indices[0].swap(global_indices);
+    global_indices.clear();
+  }
+
+  // Swap coordinates into geometry
+  MeshGeometry& geometry = _mesh->_geometry;
+  geometry.clear();
+  geometry._dim = _gdim;
+  geometry.coordinates.swap(x);
+  x.clear();
+  geometry.position_to_local_index.resize(num_vertices);
+  geometry.local_index_to_position.resize(num_vertices);
+  for (std::size_t i = 0; i < num_vertices; ++i)
+  {
+    geometry.position_to_local_index[i] = i;
+    geometry.local_index_to_position[i] = i;
+  }
+
+  // Mark all vertices as added
+  _num_vertices = num_vertices;
+  next_vertex = num_vertices;
+}
+//-----------------------------------------------------------------------------
+void MeshEditor::set_cells(std::vector<unsigned int>& cells)
+{
+  dolfin_assert(_mesh);
+  std::vector<std::size_t> global_indices;
+  const std::size_t num_cells = cells.size()/_mesh->type().num_vertices(_tdim);
+  set_cells_global(cells, global_indices, num_cells);
+}
+//-----------------------------------------------------------------------------
+void MeshEditor::set_cells_global(std::vector<unsigned int>& cells,
+                                  std::vector<std::size_t>& global_indices,
+                                  std::size_t num_global_cells)
+{
+  // Check if we are currently editing a mesh
+  if (!_mesh)
+  {
+    dolfin_error("MeshEditor.cpp",
+                 "set cells in mesh editor",
+                 "No mesh opened, unable to edit");
+  }
+
+  // Check size of cell array
+  const std::size_t num_cell_vertices = _mesh->type().num_vertices(_tdim);
+  if (cells.size() % num_cell_vertices != 0)
+  {
+    dolfin_error("MeshEditor.cpp",
+                 "set cells in mesh editor",
+                 "Size of cell array (%d) is not a multiple of the number of cell vertices (%d)",
+                 cells.size(), num_cell_vertices);
+  }
+  const std::size_t num_cells = cells.size()/num_cell_vertices;
+
+  // Check vertices
+  if (!cells.empty())
+  {
+    const std::size_t max_vertex = *std::max_element(cells.begin(),
+                                                     cells.end());
+    if (max_vertex >= _num_vertices)
+    {
+      dolfin_error("MeshEditor.cpp",
+                   "set cells in mesh editor",
+                   "Vertex index (%d) out of range [0, %d)",
+                   max_vertex, _num_vertices);
+    }
+  }
+
+  // Initialise topology, using local indices as global indices if
+  // none are given
+  MeshTopology& topology = _mesh->_topology;
+  topology.init(_tdim, num_cells, num_global_cells);
+  topology.init_ghost(_tdim, num_cells);
+  if (global_indices.empty())
+  {
+    topology._global_indices[_tdim].resize(num_cells);
+    for (std::size_t i = 0; i < num_cells; ++i)
+      topology._global_indices[_tdim][i] = i;
+  }
+  else
+  {
+    if (global_indices.size() != num_cells)
+    {
+      dolfin_error("MeshEditor.cpp",
+                   "set cells in mesh editor",
+                   "Number of global indices (%d) does not match number of cells (%d)",
+                   global_indices.size(), num_cells);
+    }
+    topology._global_indices[_tdim].swap(global_indices);
+    global_indices.clear();
+  }
+
+  // Swap cell vertices into cell-vertex connectivity
+  MeshConnectivity& connectivity = topology(_tdim, 0);
+  connectivity.clear();
+  connectivity._connections.swap(cells);
+  cells.clear();
+  connectivity.index_to_position.resize(num_cells + 1);
+  for (std::size_t i = 0; i <= num_cells; ++i)
+    connectivity.index_to_position[i] = i*num_cell_vertices;
+
+  // Mark all cells as added
+  _num_cells = num_cells;
+  next_cell = num_cells;
+}
+//-----------------------------------------------------------------------------
 void MeshEditor::close(bool order)
 {
   // Order mesh if requested
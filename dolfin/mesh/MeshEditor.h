@@ -16,7 +16,7 @@
 // along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 //
 // First added:  2006-05-16
-// Last changed: 2014-02-06
+// Last changed: 2015-01-22
 
 #ifndef __MESH_EDITOR_H
 #define __MESH_EDITOR_H
@@ -295,6 +295,79 @@ namespace dolfin
     void add_cell(std::size_t local_index, std::size_t global_index,
                   const std::vector<std::size_t>& v);
 
+    /// Set coordinates of all vertices at once (serial version).
+    /// This replaces init_vertices and add_vertex. The coordinates
+    /// are swapped into the mesh without copying, and x is left
+    /// empty.
+    ///
+    /// *Arguments*
+    ///     x (std::vector<double>)
+    ///         Flattened vertex coordinates, with the coordinates of
+    ///         vertex i stored at x[i*gdim], ..., x[(i + 1)*gdim - 1].
+    ///
+    /// *Example*
+    ///     .. code-block:: c++
+    ///
+    ///         Mesh mesh;
+    ///         MeshEditor editor;
+    ///         editor.open(mesh, 2, 2);
+    ///         std::vector<double> x = {0.0, 0.0, 1.0, 0.0, 0.0, 1.0};
+    ///         editor.set_vertices(x);
+    ///
+    void set_vertices(std::vector<double>& x);
+
+    /// Set coordinates and global indices of all vertices at once
+    /// (distributed version). The coordinates and global indices are
+    /// swapped into the mesh without copying, and both arguments are
+    /// left empty.
+    ///
+    /// *Arguments*
+    ///     x (std::vector<double>)
+    ///         Flattened vertex coordinates.
+    ///     global_indices (std::vector<std::size_t>)
+    ///         Global index of each vertex on this process.
+    ///     num_global_vertices (std::size_t)
+    ///         The number of vertices in distributed mesh.
+    void set_vertices_global(std::vector<double>& x,
+                             std::vector<std::size_t>& global_indices,
+                             std::size_t num_global_vertices);
+
+    /// Set vertices of all cells at once (serial version). This
+    /// replaces init_cells and add_cell. The cell vertices are
+    /// swapped into the mesh without copying, and cells is left
+    /// empty. Vertices must be set before cells.
+    ///
+    /// *Arguments*
+    ///     cells (std::vector<unsigned int>)
+    ///         Flattened cell vertices (local vertex indices), with
+    ///         the vertices of cell i stored at
+    ///         cells[i*(tdim + 1)], ..., cells[(i + 1)*(tdim + 1) - 1].
+    ///
+    /// *Example*
+    ///     .. code-block:: c++
+    ///
+    ///         std::vector<unsigned int> cells = {0, 1, 2};
+    ///         editor.set_cells(cells);
+    ///         editor.close();
+    ///
+    void set_cells(std::vector<unsigned int>& cells);
+
+    /// Set vertices and global indices of all cells at once
+    /// (distributed version). The cell vertices and global indices
+    /// are swapped into the mesh without copying, and both arguments
+    /// are left empty.
+    ///
+    /// *Arguments*
+    ///     cells (std::vector<unsigned int>)
+    ///         Flattened cell vertices (local vertex indices).
+    ///     global_indices (std::vector<std::size_t>)
+    ///         Global index of each cell on this process.
+    ///     num_global_cells (std::size_t)
+    ///         The number of cells in distributed mesh.
+    void set_cells_global(std::vector<unsigned int>& cells,
+                          std::vector<std::size_t>& global_indices,
+                          std::size_t num_global_cells);
+
     /// Close mesh, finish editing, and order entities locally
     ///
     /// *Arguments*
@@ -19,7 +19,7 @@
 // Modified by Kristoffer Selim, 2008.
 //
 // First added:  2006-05-19
-// Last changed: 2010-04-29
+// Last changed: 2015-01-22
 
 #include <sstream>
 #include <boost/functional/hash.hpp>
@@ -30,12 +30,13 @@
 using namespace dolfin;
 
 //-----------------------------------------------------------------------------
-MeshGeometry::MeshGeometry() : _dim(0)
+MeshGeometry::MeshGeometry() : MemoryTracked("Mesh geometry"), _dim(0)
 {
   // Do nothing
 }
 //-----------------------------------------------------------------------------
-MeshGeometry::MeshGeometry(const MeshGeometry& geometry) : _dim(0)
+MeshGeometry::MeshGeometry(const MeshGeometry& geometry)
+  : MemoryTracked(geometry), _dim(0)
 {
   *this = geometry;
 }
@@ -118,6 +119,13 @@ std::size_t MeshGeometry::hash() const
   return local_hash;
 }
 //-----------------------------------------------------------------------------
+std::size_t MeshGeometry::memory_usage() const
+{
+  return sizeof(*this) + vector_memory_usage(coordinates)
+    + vector_memory_usage(position_to_local_index)
+    + vector_memory_usage(local_index_to_position);
+}
+//-----------------------------------------------------------------------------
 std::string MeshGeometry::str(bool verbose) const
 {
   std::stringstream s;
@@ -18,13 +18,14 @@
 // Modified by Garth N. Wells, 2008.
 //
 // First added:  2006-05-08
-// Last changed: 2010-11-29
+// Last changed: 2015-01-22
 
 #ifndef __MESH_GEOMETRY_H
 #define __MESH_GEOMETRY_H
 
 #include <string>
 #include <vector>
+#include <dolfin/common/MemoryTracked.h>
 #include <dolfin/geometry/Point.h>
 #include <dolfin/log/log.h>
 
@@ -37,7 +38,7 @@ namespace dolfin
 
   class Function;
 
-  class MeshGeometry
+  class MeshGeometry : public MemoryTracked
   {
   public:
 
@@ -123,6 +124,9 @@ namespace dolfin
     ///
     std::size_t hash() const;
 
+    /// Return number of bytes used by geometry
+    std::size_t memory_usage() const;
+
     /// Return informal string representation (pretty-print)
     std::string str(bool verbose) const;
 
@@ -130,6 +134,7 @@ namespace dolfin
 
     // Friends
     friend class BinaryFile;
+    friend class MeshEditor;
     friend class MeshRenumbering;
 
     // Euclidean dimension
@@ -16,14 +16,27 @@
 // along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 //
 // First added:  2007-01-30
-// Last changed: 2012-06-25
+// Last changed: 2015-01-22
 
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <set>
 #include <vector>
 #include <memory>
 #include <dolfin/common/NoDeleter.h>
+#include <dolfin/common/Timer.h>
+#include <dolfin/geometry/Point.h>
+#include <dolfin/graph/BoostGraphOrdering.h>
+#include <dolfin/graph/GraphBuilder.h>
+#include <dolfin/graph/SFCPartition.h>
 #include <dolfin/log/log.h>
 #include "Cell.h"
 #include "Mesh.h"
+#include "MeshConnectivity.h"
+#include "MeshData.h"
+#include "MeshDomains.h"
+#include "MeshEntityIterator.h"
 #include "MeshOrdering.h"
 
 using namespace dolfin;
@@ -78,3 +91,301 @@ bool MeshOrdering::ordered(const Mesh& mesh)
   return true;
 }
 //-----------------------------------------------------------------------------
+void MeshOrdering::reorder(Mesh& mesh, std::string method,
+                     std::vector<MeshFunction<std::size_t>*> mesh_functions)
+{
+  Timer timer("Reorder mesh entities");
+
+  // Compute and apply reordering
+  const std::vector<std::vector<std::size_t> > entity_map
+    = compute_reordering(mesh, method);
+  reorder(mesh, entity_map);
+
+  // Reorder mesh functions
+  for (std::size_t i = 0; i < mesh_functions.size(); ++i)
+  {
+    dolfin_assert(mesh_functions[i]);
+    reorder(*mesh_functions[i], entity_map);
+  }
+}
+//-----------------------------------------------------------------------------
+std::vector<std::vector<std::size_t> >
+MeshOrdering::compute_reordering(const Mesh& mesh, std::string method)
+{
+  const std::size_t D = mesh.topology().dim();
+  const std::size_t num_cells = mesh.num_cells();
+  const std::size_t num_owned_cells = mesh.topology().ghost_offset(D);
+  std::vector<std::vector<std::size_t> > entity_map(D + 1);
+  if (num_cells == 0)
+    return entity_map;
+
+  // Compute sort key for each cell
+  std::vector<std::size_t> cell_key(num_cells);
+  if (method == "hilbert")
+  {
+    // Compute bounding box of cell midpoints
+    const std::size_t gdim = mesh.geometry().dim();
+    std::vector<Point> midpoints(num_cells);
+    std::vector<double> x_min(gdim, std::numeric_limits<double>::max());
+    std::vector<double> x_max(gdim, -std::numeric_limits<double>::max());
+    for (CellIterator cell(mesh); !cell.end(); ++cell)
+    {
+      const Point p = cell->midpoint();
+      midpoints[cell->index()] = p;
+      for (std::size_t j = 0; j < gdim; ++j)
+      {
+        x_min[j] = std::min(x_min[j], p[j]);
+        x_max[j] = std::max(x_max[j], p[j]);
+      }
+    }
+
+    // Compute position along Hilbert curve
+    const std::size_t num_bits
+      = std::min((std::size_t) 31, (8*sizeof(std::size_t) - 1)/gdim);
+    const std::size_t max_coordinate = ((std::size_t) 1 << num_bits) - 1;
+    std::vector<std::size_t> x(gdim);
+    for (std::size_t i = 0; i < num_cells; ++i)
+    {
+      for (std::size_t j = 0; j < gdim; ++j)
+      {
+        const double h = x_max[j] - x_min[j];
+        const double s = h > 0.0 ? (midpoints[i][j] - x_min[j])/h : 0.0;
+        x[j] = std::min((std::size_t) (s*max_coordinate), max_coordinate);
+      }
+      cell_key[i] = SFCPartition::compute_key(x, num_bits, true);
+    }
+  }
+  else if (method == "rcm")
+  {
+    // Reverse Cuthill-McKee ordering of cells connected by vertices
+    const Graph graph = GraphBuilder::local_graph(mesh, D, 0);
+    const std::vector<int> map
+      = BoostGraphOrdering::compute_cuthill_mckee(graph, true);
+    std::copy(map.begin(), map.end(), cell_key.begin());
+  }
+  else
+  {
+    dolfin_error("MeshOrdering.cpp",
+                 "compute reordering of mesh",
+                 "Unknown reordering method \"%s\". Must be \"hilbert\" or \"rcm\"",
+                 method.c_str());
+  }
+
+  // Sort owned cells by key (ghost cells are not moved)
+  std::vector<std::pair<std::size_t, std::size_t> > sorted_cells;
+  sorted_cells.reserve(num_owned_cells);
+  for (std::size_t i = 0; i < num_owned_cells; ++i)
+    sorted_cells.push_back(std::make_pair(cell_key[i], i));
+  std::sort(sorted_cells.begin(), sorted_cells.end());
+
+  std::vector<std::size_t>& cell_map = entity_map[D];
+  cell_map.resize(num_cells);
+  std::vector<std::size_t> cells(num_cells);
+  for (std::size_t i = 0; i < num_owned_cells; ++i)
+  {
+    cell_map[sorted_cells[i].second] = i;
+    cells[i] = sorted_cells[i].second;
+  }
+  for (std::size_t i = num_owned_cells; i < num_cells; ++i)
+  {
+    cell_map[i] = i;
+    cells[i] = i;
+  }
+
+  // Number other entities in the order in which they are first
+  // reached from the (reordered) cells
+  for (std::size_t d = 0; d < D; ++d)
+  {
+    const std::size_t num_entities = mesh.num_entities(d);
+    const MeshConnectivity& connectivity = mesh.topology()(D, d);
+    if (num_entities == 0 || connectivity.empty())
+      continue;
+
+    const std::size_t num_owned_entities = mesh.topology().ghost_offset(d);
+    const std::size_t unnumbered = std::numeric_limits<std::size_t>::max();
+    std::vector<std::size_t>& map = entity_map[d];
+    map.assign(num_entities, unnumbered);
+    std::size_t current = 0;
+    for (std::size_t i = 0; i < num_cells; ++i)
+    {
+      const unsigned int* entities = connectivity(cells[i]);
+      for (std::size_t k = 0; k < connectivity.size(cells[i]); ++k)
+      {
+        const std::size_t e = entities[k];
+        if (e < num_owned_entities && map[e] == unnumbered)
+          map[e] = current++;
+      }
+    }
+
+    // Entities not attached to any cell keep their relative order,
+    // and ghost entities are not moved
+    for (std::size_t e = 0; e < num_owned_entities; ++e)
+    {
+      if (map[e] == unnumbered)
+        map[e] = current++;
+    }
+    dolfin_assert(current == num_owned_entities);
+    for (std::size_t e = num_owned_entities; e < num_entities; ++e)
+      map[e] = e;
+  }
+
+  return entity_map;
+}
+//-----------------------------------------------------------------------------
+void MeshOrdering::reorder(Mesh& mesh,
+                  const std::vector<std::vector<std::size_t> >& entity_map)
+{
+  const std::size_t D = mesh.topology().dim();
+  dolfin_assert(entity_map.size() == D + 1);
+  MeshTopology& topology = mesh._topology;
+
+  // Reorder vertex coordinates
+  const std::vector<std::size_t>& vertex_map = entity_map[0];
+  if (!vertex_map.empty())
+  {
+    MeshGeometry& geometry = mesh._geometry;
+    const std::size_t gdim = geometry.dim();
+    const std::size_t num_vertices = mesh.num_vertices();
+    dolfin_assert(vertex_map.size() == num_vertices);
+    std::vector<double> coordinates(gdim*num_vertices);
+    for (std::size_t i = 0; i < num_vertices; ++i)
+    {
+      std::copy(geometry.x(i), geometry.x(i) + gdim,
+                coordinates.begin() + gdim*vertex_map[i]);
+    }
+    std::vector<double> x(gdim);
+    for (std::size_t i = 0; i < num_vertices; ++i)
+    {
+      std::copy(coordinates.begin() + gdim*i,
+                coordinates.begin() + gdim*(i + 1), x.begin());
+      geometry.set(i, x);
+    }
+  }
+
+  // Renumber connectivity
+  for (std::size_t d0 = 0; d0 <= D; ++d0)
+  {
+    for (std::size_t d1 = 0; d1 <= D; ++d1)
+    {
+      MeshConnectivity& connectivity = topology(d0, d1);
+      if (!connectivity.empty())
+        renumber(connectivity, entity_map[d0], entity_map[d1]);
+    }
+  }
+
+  for (std::size_t d = 0; d <= D; ++d)
+  {
+    const std::vector<std::size_t>& map = entity_map[d];
+    if (map.empty())
+      continue;
+    dolfin_assert(map.size() == mesh.num_entities(d));
+
+    // Global indices move with the entities
+    if (topology.have_global_indices(d))
+    {
+      const std::vector<std::size_t> global_indices
+        = topology.global_indices(d);
+      for (std::size_t i = 0; i < map.size(); ++i)
+        topology.set_global_index(d, map[i], global_indices[i]);
+    }
+
+    // Shared entities
+    if (topology.have_shared_entities(d))
+    {
+      std::map<unsigned int, std::set<unsigned int> >& shared_entities
+        = topology.shared_entities(d);
+      std::map<unsigned int, std::set<unsigned int> > new_shared_entities;
+      std::map<unsigned int, std::set<unsigned int> >::const_iterator e;
+      for (e = shared_entities.begin(); e != shared_entities.end(); ++e)
+        new_shared_entities[map[e->first]] = e->second;
+      shared_entities.swap(new_shared_entities);
+    }
+
+    // Mesh domains
+    if (!mesh._domains.is_empty() && d <= mesh._domains.max_dim())
+    {
+      std::map<std::size_t, std::size_t>& markers
+        = mesh._domains.markers(d);
+      std::map<std::size_t, std::size_t> new_markers;
+      std::map<std::size_t, std::size_t>::const_iterator m;
+      for (m = markers.begin(); m != markers.end(); ++m)
+        new_markers[map[m->first]] = m->second;
+      markers.swap(new_markers);
+    }
+
+    // Mesh data arrays
+    if (d < mesh._data._arrays.size())
+    {
+      std::map<std::string, std::vector<std::size_t> >& arrays
+        = mesh._data._arrays[d];
+      std::map<std::string, std::vector<std::size_t> >::iterator a;
+      for (a = arrays.begin(); a != arrays.end(); ++a)
+      {
+        if (a->second.size() != map.size())
+          continue;
+        const std::vector<std::size_t> values = a->second;
+        for (std::size_t i = 0; i < map.size(); ++i)
+          a->second[map[i]] = values[i];
+      }
+    }
+  }
+
+  // Cell orientations
+  const std::vector<std::size_t>& cell_map = entity_map[D];
+  if (!cell_map.empty() && !mesh._cell_orientations.empty())
+  {
+    const std::vector<int> orientations = mesh._cell_orientations;
+    for (std::size_t i = 0; i < cell_map.size(); ++i)
+      mesh._cell_orientations[cell_map[i]] = orientations[i];
+  }
+
+  // Colorings refer to old entity numbers (recompute if needed) and
+  // the bounding box tree must be rebuilt
+  topology.coloring.clear();
+  mesh._tree.reset();
+}
+//-----------------------------------------------------------------------------
+void MeshOrdering::renumber(MeshConnectivity& connectivity,
+                            const std::vector<std::size_t>& map0,
+                            const std::vector<std::size_t>& map1)
+{
+  const std::size_t num_entities = connectivity.index_to_position.size() - 1;
+  dolfin_assert(map0.empty() || map0.size() == num_entities);
+
+  // Compute new offsets
+  std::vector<unsigned int> index_to_position(num_entities + 1, 0);
+  for (std::size_t e = 0; e < num_entities; ++e)
+  {
+    const std::size_t new_e = map0.empty() ? e : map0[e];
+    index_to_position[new_e + 1] = connectivity.size(e);
+  }
+  for (std::size_t e = 0; e < num_entities; ++e)
+    index_to_position[e + 1] += index_to_position[e];
+
+  // Copy (renumbered) connections
+  std::vector<unsigned int> connections(connectivity._connections.size());
+  for (std::size_t e = 0; e < num_entities; ++e)
+  {
+    const std::size_t new_e = map0.empty() ? e : map0[e];
+    const unsigned int* c = connectivity(e);
+    for (std::size_t k = 0; k < connectivity.size(e); ++k)
+    {
+      connections[index_to_position[new_e] + k]
+        = map1.empty() ? c[k] : map1[c[k]];
+    }
+  }
+
+  // Global number of connections
+  if (!connectivity._num_global_connections.empty() && !map0.empty())
+  {
+    std::vector<unsigned int>& num_global_connections
+      = connectivity._num_global_connections;
+    const std::vector<unsigned int> values = num_global_connections;
+    for (std::size_t e = 0; e < num_entities; ++e)
+      num_global_connections[map0[e]] = values[e];
+  }
+
+  connectivity._connections.swap(connections);
+  connectivity.index_to_position.swap(index_to_position);
+}
+//-----------------------------------------------------------------------------
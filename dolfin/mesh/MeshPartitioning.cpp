@@ -36,15 +36,18 @@
 #include <dolfin/graph/GraphBuilder.h>
 #include <dolfin/graph/ParMETIS.h>
 #include <dolfin/graph/SCOTCH.h>
+#include <dolfin/graph/SFCPartition.h>
 #include <dolfin/graph/ZoltanPartition.h>
 #include <dolfin/parameter/GlobalParameters.h>
 
+#include "Cell.h"
 #include "DistributedMeshTools.h"
 #include "Facet.h"
 #include "LocalMeshData.h"
 #include "Mesh.h"
 #include "MeshEditor.h"
 #include "MeshEntity.h"
+#include "MeshDomains.h"
 #include "MeshEntityIterator.h"
 #include "MeshFunction.h"
 #include "MeshTopology.h"
@@ -122,17 +125,6 @@ void MeshPartitioning::build_distributed_mesh(Mesh& mesh,
                   < MPI::size(mesh.mpi_comm()));
   }
 
-  const std::string ghost_mode = parameters["ghost_mode"];
-
-  if (ghost_procs.empty() && ghost_mode != "none")
-  {
-    // FIXME: need to generate ghost cell information here
-    // by doing a facet-matching operation "GraphBuilder" style
-    dolfin_error("MeshPartitioning.cpp",
-                 "build ghost mesh",
-                 "Ghost cell information not available");
-  }
-
   // Build mesh from local mesh data and provided cell partition
   build(mesh, local_data, cell_partition, ghost_procs);
 
@@ -148,11 +140,229 @@ void MeshPartitioning::build_distributed_mesh(Mesh& mesh,
   DistributedMeshTools::init_facet_cell_connections(mesh);
 }
 //-----------------------------------------------------------------------------
+void MeshPartitioning::rebalance(Mesh& mesh,
+                  const MeshFunction<double>& cell_weights,
+                  std::vector<MeshFunction<std::size_t>*> mesh_functions,
+                  std::vector<MeshValueCollection<std::size_t>*> value_collections)
+{
+  const MPI_Comm mpi_comm = mesh.mpi_comm();
+  if (MPI::size(mpi_comm) == 1)
+    return;
+
+  Timer timer("Rebalance mesh");
+
+  const std::size_t D = mesh.topology().dim();
+  if (cell_weights.dim() != D)
+  {
+    dolfin_error("MeshPartitioning.cpp",
+                 "rebalance mesh",
+                 "Cell weights must be defined on cells (dimension %d), not entities of dimension %d",
+                 D, cell_weights.dim());
+  }
+
+  const std::string ghost_mode = parameters["ghost_mode"];
+  if (ghost_mode != "none")
+  {
+    dolfin_error("MeshPartitioning.cpp",
+                 "rebalance mesh",
+                 "Rebalancing of meshes with ghost cells is not supported. Set parameter \"ghost_mode\" to \"none\"");
+  }
+
+  // Global numbering of vertices and cells
+  const std::size_t process_number = MPI::rank(mpi_comm);
+  const std::size_t num_processes = MPI::size(mpi_comm);
+  const std::vector<std::size_t>& global_vertex_indices
+    = mesh.topology().global_indices(0);
+  const std::vector<std::size_t>& global_cell_indices
+    = mesh.topology().global_indices(D);
+  const std::size_t num_owned_cells = mesh.topology().ghost_offset(D);
+
+  LocalMeshData local_data(mpi_comm);
+  local_data.gdim = mesh.geometry().dim();
+  local_data.tdim = D;
+  local_data.num_global_vertices = mesh.size_global(0);
+  local_data.num_global_cells = mesh.size_global(D);
+  local_data.num_vertices_per_cell = mesh.type().num_entities(0);
+
+  // Extract owned cells (global vertex indices and global cell index)
+  // and scale the cell weights to integers in [1, 1000]
+  double max_weight = 0.0;
+  for (std::size_t i = 0; i < num_owned_cells; ++i)
+    max_weight = std::max(max_weight, cell_weights[i]);
+  max_weight = MPI::max(mpi_comm, max_weight);
+  const double weight_scale = max_weight > 0.0 ? 999.0/max_weight : 0.0;
+
+  const std::size_t num_cell_vertices = local_data.num_vertices_per_cell;
+  local_data.cell_vertices.resize(boost::extents[num_owned_cells][num_cell_vertices]);
+  local_data.global_cell_indices.resize(num_owned_cells);
+  local_data.cell_weight.resize(num_owned_cells);
+  for (CellIterator cell(mesh); !cell.end(); ++cell)
+  {
+    const std::size_t i = cell->index();
+    if (i >= num_owned_cells)
+      continue;
+
+    local_data.global_cell_indices[i] = global_cell_indices[i];
+    for (std::size_t j = 0; j < num_cell_vertices; ++j)
+    {
+      local_data.cell_vertices[i][j]
+        = global_vertex_indices[cell->entities(0)[j]];
+    }
+
+    dolfin_assert(cell_weights[i] >= 0.0);
+    local_data.cell_weight[i]
+      = 1 + static_cast<std::size_t>(weight_scale*cell_weights[i] + 0.5);
+  }
+
+  // Send coordinates of owned vertices to the process that holds
+  // the block of global vertex indices they belong to (the lowest
+  // ranked sharing process owns a shared vertex)
+  const std::size_t gdim = local_data.gdim;
+  const std::map<unsigned int, std::set<unsigned int> >& shared_vertices
+    = mesh.topology().shared_entities(0);
+  std::vector<std::vector<std::size_t> > send_vertex_indices(num_processes);
+  std::vector<std::vector<double> > send_vertex_coordinates(num_processes);
+  for (VertexIterator v(mesh); !v.end(); ++v)
+  {
+    auto shared = shared_vertices.find(v->index());
+    if (shared != shared_vertices.end()
+        && *shared->second.begin() < process_number)
+    {
+      continue;
+    }
+
+    const std::size_t global_index = global_vertex_indices[v->index()];
+    const std::size_t dest
+      = MPI::index_owner(mpi_comm, global_index,
+                         local_data.num_global_vertices);
+    send_vertex_indices[dest].push_back(global_index);
+    send_vertex_coordinates[dest].insert(send_vertex_coordinates[dest].end(),
+                                         v->x(), v->x() + gdim);
+  }
+  std::vector<std::vector<std::size_t> > received_vertex_indices;
+  std::vector<std::vector<double> > received_vertex_coordinates;
+  MPI::all_to_all(mpi_comm, send_vertex_indices, received_vertex_indices);
+  MPI::all_to_all(mpi_comm, send_vertex_coordinates,
+                  received_vertex_coordinates);
+
+  const std::pair<std::size_t, std::size_t> vertex_range
+    = MPI::local_range(mpi_comm, local_data.num_global_vertices);
+  const std::size_t num_local_vertices = vertex_range.second - vertex_range.first;
+  local_data.vertex_coordinates.resize(boost::extents[num_local_vertices][gdim]);
+  local_data.vertex_indices.resize(num_local_vertices);
+  for (std::size_t i = 0; i < num_local_vertices; ++i)
+    local_data.vertex_indices[i] = vertex_range.first + i;
+  for (std::size_t p = 0; p < num_processes; ++p)
+  {
+    for (std::size_t i = 0; i < received_vertex_indices[p].size(); ++i)
+    {
+      const std::size_t local_index
+        = received_vertex_indices[p][i] - vertex_range.first;
+      dolfin_assert(local_index < num_local_vertices);
+      std::copy(received_vertex_coordinates[p].begin() + i*gdim,
+                received_vertex_coordinates[p].begin() + (i + 1)*gdim,
+                local_data.vertex_coordinates[local_index].begin());
+    }
+  }
+
+  // Store mesh domains as (global cell index, local entity index,
+  // value) so that they are rebuilt from local_data
+  const std::size_t max_domain_dim
+    = mesh.domains().is_empty() ? 0 : mesh.domains().max_dim() + 1;
+  for (std::size_t dim = 0; dim < max_domain_dim; ++dim)
+  {
+    const std::map<std::size_t, std::size_t>& markers
+      = mesh.domains().markers(dim);
+    if (markers.empty())
+      continue;
+
+    mesh.init(dim, D);
+    std::vector<std::pair<std::pair<std::size_t, std::size_t>, std::size_t> >&
+      data = local_data.domain_data[dim];
+    for (auto it = markers.begin(); it != markers.end(); ++it)
+    {
+      if (dim == D)
+      {
+        data.push_back(std::make_pair(std::make_pair(global_cell_indices[it->first], 0),
+                                      it->second));
+      }
+      else
+      {
+        const MeshEntity e(mesh, dim, it->first);
+        const Cell cell(mesh, e.entities(D)[0]);
+        data.push_back(std::make_pair(std::make_pair(global_cell_indices[cell.index()],
+                                                     cell.index(e)),
+                                      it->second));
+      }
+    }
+  }
+
+  // Convert mesh functions and mesh value collections to
+  // (global cell index, local entity index, value) data
+  typedef std::vector<std::pair<std::pair<std::size_t, std::size_t>,
+                                std::size_t> > ValueData;
+  std::vector<ValueData> function_data(mesh_functions.size());
+  for (std::size_t k = 0; k < mesh_functions.size(); ++k)
+  {
+    dolfin_assert(mesh_functions[k]);
+    const MeshValueCollection<std::size_t> mvc(*mesh_functions[k]);
+    const std::map<std::pair<std::size_t, std::size_t>, std::size_t>& values
+      = mvc.values();
+    for (auto it = values.begin(); it != values.end(); ++it)
+    {
+      function_data[k].push_back(std::make_pair(
+          std::make_pair(global_cell_indices[it->first.first], it->first.second),
+          it->second));
+    }
+  }
+  std::vector<ValueData> collection_data(value_collections.size());
+  for (std::size_t k = 0; k < value_collections.size(); ++k)
+  {
+    dolfin_assert(value_collections[k]);
+    const std::map<std::pair<std::size_t, std::size_t>, std::size_t>& values
+      = value_collections[k]->values();
+    for (auto it = values.begin(); it != values.end(); ++it)
+    {
+      collection_data[k].push_back(std::make_pair(
+          std::make_pair(global_cell_indices[it->first.first], it->first.second),
+          it->second));
+    }
+  }
+
+  // Compute new partition, starting from the current one
+  std::vector<std::size_t> cell_partition;
+  std::map<std::size_t, dolfin::Set<unsigned int> > ghost_procs;
+  ParMETIS::compute_partition(mpi_comm, cell_partition, ghost_procs,
+                              local_data, "adaptive_repartition");
+  const std::size_t num_moved = std::count_if(cell_partition.begin(),
+                                              cell_partition.end(),
+                          [process_number](std::size_t p)
+                          { return p != process_number; });
+  log(PROGRESS, "Rebalancing mesh: moving %d of %d cells from process %d.",
+      num_moved, num_owned_cells, process_number);
+
+  // Rebuild mesh in place
+  local_data.cell_partition = cell_partition;
+  mesh.domains().clear();
+  build_distributed_mesh(mesh, local_data);
+
+  // Rebuild mesh value collections and mesh functions
+  for (std::size_t k = 0; k < value_collections.size(); ++k)
+    build_mesh_value_collection(mesh, collection_data[k], *value_collections[k]);
+  for (std::size_t k = 0; k < mesh_functions.size(); ++k)
+  {
+    MeshValueCollection<std::size_t> mvc(mesh, mesh_functions[k]->dim());
+    build_mesh_value_collection(mesh, function_data[k], mvc);
+    *mesh_functions[k] = mvc;
+  }
+}
+//-----------------------------------------------------------------------------
 void MeshPartitioning::partition_cells(const MPI_Comm& mpi_comm,
       const LocalMeshData& mesh_data,
       std::vector<std::size_t>& cell_partition,
       std::map<std::size_t, dolfin::Set<unsigned int> >& ghost_procs)
 {
+  Timer timer("Compute cell partition");
 
   // Compute cell partition using partitioner from parameter system
   const std::string partitioner = parameters["mesh_partitioner"];
@@ -170,6 +380,10 @@ void MeshPartitioning::partition_cells(const MPI_Comm& mpi_comm,
     ZoltanPartition::compute_partition_phg(mpi_comm, cell_partition,
                                            mesh_data);
   }
+  else if (partitioner == "Hilbert")
+    SFCPartition::compute_partition_hilbert(mpi_comm, cell_partition, mesh_data);
+  else if (partitioner == "Morton")
+    SFCPartition::compute_partition_morton(mpi_comm, cell_partition, mesh_data);
   else
   {
     dolfin_error("MeshPartitioning.cpp",
@@ -197,17 +411,41 @@ void MeshPartitioning::build(Mesh& mesh, const LocalMeshData& mesh_data,
 
   new_mesh_data.num_global_vertices = mesh_data.num_global_vertices;
 
+  // Ghost layers are built here (rather than taken from the
+  // partitioner) when more than one layer is requested or the
+  // partitioner does not provide ghost cell information. Processes
+  // without cells on a partition boundary have no ghost cell
+  // information either, so decide collectively.
+  const std::string ghost_mode = parameters["ghost_mode"];
+  const std::size_t num_ghost_layers = parameters["ghost_layers"];
+  bool build_ghost_layers = false;
+  if (ghost_mode != "none")
+  {
+    const std::size_t no_ghost_info = ghost_procs.empty() ? 1 : 0;
+    build_ghost_layers = num_ghost_layers > 1
+      || MPI::max(mesh.mpi_comm(), no_ghost_info) == 1;
+  }
+
   // Keep tabs on ghost cell ownership
   std::map<unsigned int, std::set<unsigned int> > shared_cells;
   // Send cells to processes that need them
+  const std::map<std::size_t, dolfin::Set<unsigned int> > no_ghost_procs;
   const unsigned int num_regular_cells =
-    distribute_cells(mesh.mpi_comm(), mesh_data,
-                     cell_partition, ghost_procs,
+    distribute_cells(mesh.mpi_comm(), mesh_data, cell_partition,
+                     build_ghost_layers ? no_ghost_procs : ghost_procs,
                      shared_cells, new_mesh_data);
 
-  const std::string ghost_mode = parameters["ghost_mode"];
-
-  if (ghost_mode == "shared_vertex")
+  if (build_ghost_layers)
+  {
+    // Send/receive layers of cells connected by vertex or by facet
+    // to the regular cells
+    distribute_ghost_layers(mesh.mpi_comm(),
+                            num_regular_cells, num_ghost_layers,
+                            ghost_mode == "shared_facet",
+                            shared_cells,
+                            new_mesh_data);
+  }
+  else if (ghost_mode == "shared_vertex")
   {
     // Send/receive additional cells
     // defined by connectivity to the shared vertices.
@@ -613,6 +851,478 @@ void MeshPartitioning::distribute_cell_layer(MPI_Comm mpi_comm,
 
 }
 //-----------------------------------------------------------------------------
+namespace
+{
+  // Number the entities (vertices, or facets of simplices) of cells
+  // by their sorted global vertex indices, so that the local
+  // numbering follows the order of the global vertex indices on all
+  // processes. Returns the entity of each cell, the global vertices
+  // of each entity and the number of cells of each entity.
+  void number_cell_entities(
+    const boost::multi_array<std::size_t, 2>& cell_vertices,
+    std::size_t num_cells, std::size_t num_entity_vertices,
+    std::vector<std::size_t>& cell_entities,
+    std::vector<std::size_t>& entity_vertices,
+    std::vector<std::size_t>& entity_num_cells)
+  {
+    const std::size_t num_cell_vertices = cell_vertices.shape()[1];
+    const std::size_t m = num_entity_vertices;
+
+    // Entity i of a cell is vertex i, or the facet opposite vertex i
+    std::vector<std::size_t> keys(num_cells*num_cell_vertices*m);
+    for (std::size_t c = 0; c < num_cells; ++c)
+    {
+      for (std::size_t i = 0; i < num_cell_vertices; ++i)
+      {
+        std::size_t* key = keys.data() + (c*num_cell_vertices + i)*m;
+        if (m == 1)
+          key[0] = cell_vertices[c][i];
+        else
+        {
+          for (std::size_t j = 0; j < num_cell_vertices; ++j)
+            if (j != i)
+              *key++ = cell_vertices[c][j];
+          std::sort(key - m, key);
+        }
+      }
+    }
+
+    std::vector<std::size_t> order(num_cells*num_cell_vertices);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(),
+              [&keys, m](std::size_t a, std::size_t b)
+              {
+                return std::lexicographical_compare(
+                  keys.begin() + a*m, keys.begin() + (a + 1)*m,
+                  keys.begin() + b*m, keys.begin() + (b + 1)*m);
+              });
+
+    cell_entities.resize(order.size());
+    entity_vertices.clear();
+    entity_num_cells.clear();
+    for (std::size_t k = 0; k < order.size(); ++k)
+    {
+      auto key = keys.begin() + order[k]*m;
+      if (k == 0 || !std::equal(key, key + m, keys.begin() + order[k - 1]*m))
+      {
+        entity_vertices.insert(entity_vertices.end(), key, key + m);
+        entity_num_cells.push_back(0);
+      }
+      cell_entities[order[k]] = entity_num_cells.size() - 1;
+      ++entity_num_cells.back();
+    }
+  }
+  //---------------------------------------------------------------------------
+  // Sort (row, value) pairs, remove duplicates and store the values
+  // of each of num_rows rows in compressed form
+  void compress_pairs(std::vector<std::pair<std::size_t, unsigned int> >& pairs,
+                      std::size_t num_rows, std::vector<std::size_t>& offsets,
+                      std::vector<unsigned int>& values)
+  {
+    std::sort(pairs.begin(), pairs.end());
+    pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+    offsets.assign(num_rows + 1, 0);
+    values.resize(pairs.size());
+    for (std::size_t i = 0; i < pairs.size(); ++i)
+    {
+      ++offsets[pairs[i].first + 1];
+      values[i] = pairs[i].second;
+    }
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+  }
+}
+//-----------------------------------------------------------------------------
+void MeshPartitioning::distribute_ghost_layers(MPI_Comm mpi_comm,
+  unsigned int num_regular_cells, std::size_t num_layers,
+  bool facet_adjacency,
+  std::map<unsigned int, std::set<unsigned int> >& shared_cells,
+  LocalMeshData& new_mesh_data)
+{
+  Timer timer("Distribute ghost layers");
+
+  // The ghost cells of layer k on a process are the cells (owned by
+  // other processes) which share an entity (vertex or facet) with a
+  // cell of layer k - 1 on that process, layer 0 being the regular
+  // cells. For each entity of a regular cell, the owner computes
+  // the set of other processes which hold a cell of the entity up
+  // to the current layer, exchanging it with the other processes
+  // sharing the entity. The owner of a cell then sends it to all
+  // processes holding one of its entities.
+
+  const unsigned int mpi_rank = MPI::rank(mpi_comm);
+  const std::size_t num_cells = num_regular_cells;
+  dolfin_assert(new_mesh_data.cell_vertices.shape()[0] == num_cells);
+  boost::multi_array<std::size_t, 2>& cell_vertices
+    = new_mesh_data.cell_vertices;
+  const std::size_t num_cell_vertices = cell_vertices.shape()[1];
+  const std::size_t tdim = new_mesh_data.tdim;
+  if (num_cell_vertices != tdim + 1)
+  {
+    dolfin_error("MeshPartitioning.cpp",
+                 "distribute ghost layers",
+                 "Ghost layers are only supported for simplex meshes");
+  }
+
+  // Number facets, which are on the boundary of the local cells if
+  // they have only one local cell
+  std::vector<std::size_t> cell_facets, facet_vertices, facet_num_cells;
+  number_cell_entities(cell_vertices, num_cells, tdim,
+                       cell_facets, facet_vertices, facet_num_cells);
+
+  // Number entities connecting cells, and find those which may be
+  // shared with other processes
+  std::vector<std::size_t> cell_entities, entity_vertices, entity_num_cells;
+  std::vector<bool> boundary_entity;
+  if (facet_adjacency)
+  {
+    cell_entities.swap(cell_facets);
+    entity_vertices.swap(facet_vertices);
+    entity_num_cells.swap(facet_num_cells);
+    boundary_entity.resize(entity_num_cells.size());
+    for (std::size_t e = 0; e < entity_num_cells.size(); ++e)
+      boundary_entity[e] = (entity_num_cells[e] == 1);
+  }
+  else
+  {
+    number_cell_entities(cell_vertices, num_cells, 1,
+                         cell_entities, entity_vertices, entity_num_cells);
+    boundary_entity.resize(entity_num_cells.size(), false);
+    for (std::size_t f = 0; f < facet_num_cells.size(); ++f)
+    {
+      if (facet_num_cells[f] != 1)
+        continue;
+      for (std::size_t j = 0; j < tdim; ++j)
+      {
+        auto v = std::lower_bound(entity_vertices.begin(),
+                                  entity_vertices.end(),
+                                  facet_vertices[f*tdim + j]);
+        boundary_entity[v - entity_vertices.begin()] = true;
+      }
+    }
+  }
+  const std::size_t m = facet_adjacency ? tdim : 1;
+  const std::size_t num_entities = entity_num_cells.size();
+  std::vector<std::size_t>().swap(cell_facets);
+  std::vector<std::size_t>().swap(facet_vertices);
+  std::vector<std::size_t>().swap(facet_num_cells);
+
+  // Find the processes sharing each boundary entity by sending it
+  // to the process owning the index of its first vertex. This is the
+  // only communication not restricted to neighbouring processes.
+  std::vector<std::size_t> entity_sharing_offsets;
+  std::vector<unsigned int> entity_sharing;
+  {
+    Timer timer("Distribute ghost layers (find neighbours)");
+    const std::size_t mpi_size = MPI::size(mpi_comm);
+    std::vector<std::vector<std::size_t> > send_entities(mpi_size);
+    std::vector<std::vector<std::size_t> > sent_entities(mpi_size);
+    for (std::size_t e = 0; e < num_entities; ++e)
+    {
+      if (!boundary_entity[e])
+        continue;
+      const std::size_t* key = entity_vertices.data() + e*m;
+      const unsigned int dest
+        = MPI::index_owner(mpi_comm, key[0],
+                           new_mesh_data.num_global_vertices);
+      send_entities[dest].insert(send_entities[dest].end(), key, key + m);
+      sent_entities[dest].push_back(e);
+    }
+    std::vector<std::vector<std::size_t> > recv_entities;
+    MPI::all_to_all(mpi_comm, send_entities, recv_entities);
+
+    // Group received entities (as source process and position)
+    std::vector<std::pair<unsigned int, std::size_t> > received;
+    for (std::size_t p = 0; p < mpi_size; ++p)
+      for (std::size_t i = 0; i < recv_entities[p].size()/m; ++i)
+        received.push_back(std::make_pair(p, i));
+    auto key = [&recv_entities, m](const std::pair<unsigned int,
+                                   std::size_t>& r)
+      { return recv_entities[r.first].begin() + r.second*m; };
+    std::sort(received.begin(), received.end(),
+              [&key, m](const std::pair<unsigned int, std::size_t>& a,
+                        const std::pair<unsigned int, std::size_t>& b)
+              {
+                return std::lexicographical_compare(key(a), key(a) + m,
+                                                    key(b), key(b) + m);
+              });
+
+    // Send [position, num_processes, processes] back to each sharing
+    // process
+    for (std::size_t p = 0; p < mpi_size; ++p)
+      send_entities[p].clear();
+    for (std::size_t i = 0, j; i < received.size(); i = j)
+    {
+      for (j = i + 1; j < received.size()
+             && std::equal(key(received[i]), key(received[i]) + m,
+                           key(received[j])); ++j) {}
+      if (j - i == 1)
+        continue;
+      for (std::size_t k = i; k < j; ++k)
+      {
+        std::vector<std::size_t>& send = send_entities[received[k].first];
+        send.push_back(received[k].second);
+        send.push_back(j - i - 1);
+        for (std::size_t l = i; l < j; ++l)
+          if (l != k)
+            send.push_back(received[l].first);
+      }
+    }
+    MPI::all_to_all(mpi_comm, send_entities, recv_entities);
+
+    std::vector<std::pair<std::size_t, unsigned int> > pairs;
+    for (std::size_t p = 0; p < mpi_size; ++p)
+    {
+      const std::vector<std::size_t>& recv = recv_entities[p];
+      for (std::size_t i = 0; i < recv.size(); i += recv[i + 1] + 2)
+      {
+        const std::size_t e = sent_entities[p][recv[i]];
+        for (std::size_t j = 0; j < recv[i + 1]; ++j)
+          pairs.push_back(std::make_pair(e, recv[i + 2 + j]));
+      }
+    }
+    compress_pairs(pairs, num_entities, entity_sharing_offsets,
+                   entity_sharing);
+  }
+  std::vector<std::size_t>().swap(entity_vertices);
+
+  // Neighbouring processes (sharing an entity) and the entities
+  // shared with each of them, in increasing order (which is the same
+  // order on both processes)
+  std::vector<int> neighbors(entity_sharing.begin(), entity_sharing.end());
+  std::sort(neighbors.begin(), neighbors.end());
+  neighbors.erase(std::unique(neighbors.begin(), neighbors.end()),
+                  neighbors.end());
+  std::vector<std::size_t> neighbor_entity_offsets;
+  std::vector<unsigned int> neighbor_entities;
+  {
+    std::vector<std::pair<std::size_t, unsigned int> > pairs;
+    for (std::size_t e = 0; e < num_entities; ++e)
+      for (std::size_t i = entity_sharing_offsets[e];
+           i < entity_sharing_offsets[e + 1]; ++i)
+      {
+        const std::size_t n = std::lower_bound(neighbors.begin(),
+                                               neighbors.end(),
+                                               (int) entity_sharing[i])
+          - neighbors.begin();
+        pairs.push_back(std::make_pair(n, e));
+      }
+    compress_pairs(pairs, neighbors.size(), neighbor_entity_offsets,
+                   neighbor_entities);
+  }
+
+  const MPINeighborComm entity_neighbors(mpi_comm, neighbors);
+
+  // Other processes holding a cell of each entity (initially the
+  // processes sharing it), and processes to which each cell is sent
+  // (with the layer in which it is sent)
+  std::vector<std::size_t> holder_offsets(entity_sharing_offsets);
+  std::vector<unsigned int> holders(entity_sharing);
+  std::vector<std::size_t> dest_offsets(num_cells + 1, 0);
+  std::vector<unsigned int> dests, dest_layers;
+  std::vector<double> layer_time(num_layers), layer_memory(num_layers);
+  for (std::size_t layer = 1; layer <= num_layers; ++layer)
+  {
+    Timer layer_timer("Distribute ghost layers (compute layer)");
+
+    // Send each cell to all processes holding one of its entities
+    std::vector<std::size_t> new_dest_offsets(num_cells + 1, 0);
+    std::vector<unsigned int> new_dests, new_dest_layers, cell_dests;
+    for (std::size_t c = 0; c < num_cells; ++c)
+    {
+      cell_dests.clear();
+      for (std::size_t i = 0; i < num_cell_vertices; ++i)
+      {
+        const std::size_t e = cell_entities[c*num_cell_vertices + i];
+        cell_dests.insert(cell_dests.end(),
+                          holders.begin() + holder_offsets[e],
+                          holders.begin() + holder_offsets[e + 1]);
+      }
+      std::sort(cell_dests.begin(), cell_dests.end());
+      cell_dests.erase(std::unique(cell_dests.begin(), cell_dests.end()),
+                       cell_dests.end());
+
+      // Keep layer of previous destinations (which are a subset)
+      std::size_t j = dest_offsets[c];
+      for (auto p = cell_dests.begin(); p != cell_dests.end(); ++p)
+      {
+        new_dests.push_back(*p);
+        if (j < dest_offsets[c + 1] && dests[j] == *p)
+          new_dest_layers.push_back(dest_layers[j++]);
+        else
+          new_dest_layers.push_back(layer);
+      }
+      new_dest_offsets[c + 1] = new_dests.size();
+    }
+    dest_offsets.swap(new_dest_offsets);
+    dests.swap(new_dests);
+    dest_layers.swap(new_dest_layers);
+
+    if (layer < num_layers)
+    {
+      // Update holders of each entity from the destinations of its
+      // local cells, and then from the holders on the processes
+      // sharing the entity
+      std::vector<std::pair<std::size_t, unsigned int> > pairs;
+      for (std::size_t c = 0; c < num_cells; ++c)
+        for (std::size_t i = 0; i < num_cell_vertices; ++i)
+          for (std::size_t j = dest_offsets[c]; j < dest_offsets[c + 1]; ++j)
+            pairs.push_back(std::make_pair(cell_entities[c*num_cell_vertices + i],
+                                           dests[j]));
+
+      compress_pairs(pairs, num_entities, holder_offsets, holders);
+
+      // Exchange with neighbours as [num_holders, holders] for each
+      // shared entity
+      std::vector<unsigned int> send_data, recv_data;
+      std::vector<int> send_offsets(1, 0), recv_offsets;
+      for (std::size_t n = 0; n < neighbors.size(); ++n)
+      {
+        for (std::size_t i = neighbor_entity_offsets[n];
+             i < neighbor_entity_offsets[n + 1]; ++i)
+        {
+          const std::size_t e = neighbor_entities[i];
+          send_data.push_back(holder_offsets[e + 1] - holder_offsets[e]);
+          send_data.insert(send_data.end(),
+                           holders.begin() + holder_offsets[e],
+                           holders.begin() + holder_offsets[e + 1]);
+        }
+        send_offsets.push_back(send_data.size());
+      }
+      MPI::neighbor_all_to_all(entity_neighbors, send_data, send_offsets,
+                               recv_data, recv_offsets);
+      pairs.clear();
+      for (std::size_t e = 0; e < num_entities; ++e)
+        for (std::size_t j = holder_offsets[e]; j < holder_offsets[e + 1]; ++j)
+          pairs.push_back(std::make_pair(e, holders[j]));
+      for (std::size_t n = 0; n < neighbors.size(); ++n)
+      {
+        std::size_t k = recv_offsets[n];
+        for (std::size_t i = neighbor_entity_offsets[n];
+             i < neighbor_entity_offsets[n + 1]; ++i)
+        {
+          const std::size_t e = neighbor_entities[i];
+          const std::size_t num_holders = recv_data[k++];
+          for (std::size_t j = 0; j < num_holders; ++j, ++k)
+            if (recv_data[k] != mpi_rank)
+              pairs.push_back(std::make_pair(e, recv_data[k]));
+        }
+        dolfin_assert(k == (std::size_t) recv_offsets[n + 1]);
+      }
+      compress_pairs(pairs, num_entities, holder_offsets, holders);
+    }
+
+    layer_time[layer - 1] = layer_timer.stop();
+    layer_memory[layer - 1]
+      = (holder_offsets.size() + dest_offsets.size())*sizeof(std::size_t)
+      + (holders.size() + dests.size() + dest_layers.size())*sizeof(unsigned int);
+  }
+
+  // Send cells as [global index, layer, num_holders, holders,
+  // vertices] to their destinations
+  std::vector<int> cell_dests(dests.begin(), dests.end());
+  std::sort(cell_dests.begin(), cell_dests.end());
+  cell_dests.erase(std::unique(cell_dests.begin(), cell_dests.end()),
+                   cell_dests.end());
+  const MPINeighborComm cell_neighbors(mpi_comm, cell_dests, false);
+  const std::vector<int>& sources = cell_neighbors.sources();
+  const std::vector<int>& destinations = cell_neighbors.destinations();
+  const std::size_t outdegree = destinations.size();
+
+  std::vector<std::size_t> send_data, recv_data;
+  std::vector<int> send_offsets(outdegree + 1, 0), recv_offsets;
+  {
+    std::vector<std::pair<unsigned int, std::size_t> > dest_cells;
+    for (std::size_t c = 0; c < num_cells; ++c)
+      for (std::size_t j = dest_offsets[c]; j < dest_offsets[c + 1]; ++j)
+        dest_cells.push_back(std::make_pair(dests[j], c));
+    std::sort(dest_cells.begin(), dest_cells.end());
+    for (std::size_t n = 0; n < outdegree; ++n)
+    {
+      auto p = std::lower_bound(dest_cells.begin(), dest_cells.end(),
+                                std::make_pair((unsigned int) destinations[n],
+                                               (std::size_t) 0));
+      for (; p != dest_cells.end() && p->first == (unsigned int) destinations[n];
+           ++p)
+      {
+        const std::size_t c = p->second;
+        const std::size_t j0 = dest_offsets[c], j1 = dest_offsets[c + 1];
+        send_data.push_back(new_mesh_data.global_cell_indices[c]);
+        send_data.push_back(dest_layers[std::find(dests.begin() + j0,
+                                                  dests.begin() + j1,
+                                                  p->first) - dests.begin()]);
+        send_data.push_back(j1 - j0);
+        send_data.insert(send_data.end(), dests.begin() + j0,
+                         dests.begin() + j1);
+        send_data.insert(send_data.end(), cell_vertices[c].begin(),
+                         cell_vertices[c].end());
+      }
+      send_offsets[n + 1] = send_data.size();
+    }
+  }
+  MPI::neighbor_all_to_all(cell_neighbors, send_data, send_offsets,
+                           recv_data, recv_offsets);
+
+  // Processes sharing regular cells
+  for (std::size_t c = 0; c < num_cells; ++c)
+  {
+    if (dest_offsets[c] != dest_offsets[c + 1])
+    {
+      shared_cells[c] = std::set<unsigned int>(dests.begin() + dest_offsets[c],
+                                               dests.begin() + dest_offsets[c + 1]);
+    }
+  }
+
+  // Add ghost cells, ordered by layer and global index
+  std::vector<std::pair<std::pair<std::size_t, std::size_t>,
+                        std::pair<unsigned int, std::size_t> > > ghost_cells;
+  for (std::size_t n = 0; n < sources.size(); ++n)
+  {
+    for (std::size_t i = recv_offsets[n]; i < (std::size_t) recv_offsets[n + 1];
+         i += 3 + recv_data[i + 2] + num_cell_vertices)
+    {
+      ghost_cells.push_back(std::make_pair(
+          std::make_pair(recv_data[i + 1], recv_data[i]),
+          std::make_pair(sources[n], i)));
+    }
+  }
+  std::sort(ghost_cells.begin(), ghost_cells.end());
+
+  const std::size_t num_ghost_cells = ghost_cells.size();
+  cell_vertices.resize(boost::extents[num_cells + num_ghost_cells]
+                       [num_cell_vertices]);
+  new_mesh_data.global_cell_indices.resize(num_cells + num_ghost_cells);
+  new_mesh_data.cell_partition.resize(num_cells + num_ghost_cells);
+  std::vector<std::size_t> layer_num_cells(num_layers, 0);
+  for (std::size_t k = 0; k < num_ghost_cells; ++k)
+  {
+    const std::size_t c = num_cells + k;
+    const unsigned int owner = ghost_cells[k].second.first;
+    const std::size_t* data = recv_data.data() + ghost_cells[k].second.second;
+    const std::size_t num_holders = data[2];
+    ++layer_num_cells[data[1] - 1];
+
+    new_mesh_data.global_cell_indices[c] = data[0];
+    new_mesh_data.cell_partition[c] = owner;
+    std::set<unsigned int>& sharing = shared_cells[c];
+    sharing.insert(owner);
+    sharing.insert(data + 3, data + 3 + num_holders);
+    sharing.erase(mpi_rank);
+    std::copy(data + 3 + num_holders,
+              data + 3 + num_holders + num_cell_vertices,
+              cell_vertices[c].begin());
+  }
+
+  // Report size of layers (maximum over processes)
+  for (std::size_t layer = 0; layer < num_layers; ++layer)
+  {
+    log(TRACE, "Ghost layer %d: %d cells, %g s, %g MB (maximum per process)",
+        layer + 1, MPI::max(mpi_comm, layer_num_cells[layer]),
+        MPI::max(mpi_comm, layer_time[layer]),
+        MPI::max(mpi_comm, layer_memory[layer])/(1024.0*1024.0));
+  }
+}
+//-----------------------------------------------------------------------------
 unsigned int MeshPartitioning::distribute_cells(const MPI_Comm mpi_comm,
       const LocalMeshData& mesh_data,
       const std::vector<std::size_t>& cell_partition,
@@ -1100,7 +1810,7 @@ void MeshPartitioning::build_mesh_domains(Mesh& mesh,
       const std::size_t local_entity_index = it->first.second;
 
       if ( dim == D )
-        markers[0] = it->second;
+        markers[cell_index] = it->second;
       else
       {
         const Cell cell(mesh, cell_index);
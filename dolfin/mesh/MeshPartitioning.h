@@ -21,7 +21,7 @@
 // Modified by Chris Richardson, 2013
 //
 // First added:  2008-12-01
-// Last changed: 2014-06-20
+// Last changed: 2015-01-22
 
 #ifndef __MESH_PARTITIONING_H
 #define __MESH_PARTITIONING_H
@@ -73,6 +73,21 @@ namespace dolfin
     /// distributed across processes
     static void build_distributed_mesh(Mesh& mesh, const LocalMeshData& data);
 
+    /// Rebalance a distributed mesh using the given (non-negative)
+    /// cell weights, e.g. error indicators or measured assembly
+    /// cost. The new partition is computed incrementally from the
+    /// current one (ParMETIS adaptive repartitioning), so that only
+    /// a small number of cells are moved. The mesh is rebuilt in
+    /// place; mesh domains and the given mesh functions and mesh
+    /// value collections on the mesh are migrated with the cells.
+    /// Functions must be re-created (interpolated) on the rebalanced
+    /// mesh.
+    static void rebalance(Mesh& mesh, const MeshFunction<double>& cell_weights,
+      std::vector<MeshFunction<std::size_t>*> mesh_functions
+      = std::vector<MeshFunction<std::size_t>*>(),
+      std::vector<MeshValueCollection<std::size_t>*> value_collections
+      = std::vector<MeshValueCollection<std::size_t>*>());
+
     /// Build a MeshValueCollection based on LocalMeshValueCollection
     template<typename T>
       static void
@@ -102,6 +117,16 @@ namespace dolfin
       std::map<unsigned int, std::set<unsigned int> >& shared_cells,
       LocalMeshData& new_mesh_data);
 
+    // Distribute num_layers layers of ghost cells attached by vertex
+    // or by facet to the regular cells (new_mesh_data must hold only
+    // the regular cells), updating new_mesh_data and shared_cells.
+    // Ghost cells are ordered by layer.
+    static void distribute_ghost_layers(MPI_Comm mpi_comm,
+      unsigned int num_regular_cells, std::size_t num_layers,
+      bool facet_adjacency,
+      std::map<unsigned int, std::set<unsigned int> >& shared_cells,
+      LocalMeshData& new_mesh_data);
+
     // Reorder cells by Gibbs-Poole-Stockmeyer algorithm (via SCOTCH)
     static void reorder_cells_gps(MPI_Comm mpi_comm,
      unsigned int num_regular_cells,
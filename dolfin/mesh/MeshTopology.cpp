@@ -16,7 +16,7 @@
 // along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 //
 // First added:  2006-05-08
-// Last changed: 2014-07-02
+// Last changed: 2015-01-22
 
 #include <numeric>
 #include <sstream>
@@ -28,13 +28,14 @@
 using namespace dolfin;
 
 //-----------------------------------------------------------------------------
-MeshTopology::MeshTopology()
+MeshTopology::MeshTopology() : MemoryTracked("Mesh topology")
 {
   // Do nothing
 }
 //-----------------------------------------------------------------------------
 MeshTopology::MeshTopology(const MeshTopology& topology)
-  : coloring(topology.coloring), num_entities(topology.num_entities),
+  : MemoryTracked(topology), coloring(topology.coloring),
+    num_entities(topology.num_entities),
     ghost_offset_index(topology.ghost_offset_index),
     global_num_entities(topology.global_num_entities),
     _global_indices(topology._global_indices),
@@ -207,6 +208,56 @@ size_t MeshTopology::hash() const
   return (*this)(dim(), 0).hash();
 }
 //-----------------------------------------------------------------------------
+std::size_t MeshTopology::memory_usage() const
+{
+  // Approximate size of a node in a std::map or std::set, excluding
+  // the value
+  const std::size_t node_size = 4*sizeof(void*);
+
+  std::size_t bytes = sizeof(*this)
+    + vector_memory_usage(num_entities)
+    + vector_memory_usage(ghost_offset_index)
+    + vector_memory_usage(global_num_entities)
+    + vector_memory_usage(_global_indices)
+    + vector_memory_usage(_cell_owner);
+
+  // Shared entities
+  std::map<unsigned int, std::map<unsigned int, std::set<unsigned int> > >
+    ::const_iterator d;
+  for (d = _shared_entities.begin(); d != _shared_entities.end(); ++d)
+  {
+    bytes += node_size + sizeof(*d);
+    std::map<unsigned int, std::set<unsigned int> >::const_iterator e;
+    for (e = d->second.begin(); e != d->second.end(); ++e)
+    {
+      bytes += node_size + sizeof(*e)
+        + e->second.size()*(node_size + sizeof(unsigned int));
+    }
+  }
+
+  // Colorings
+  std::map<std::vector<std::size_t>, std::pair<std::vector<std::size_t>,
+    std::vector<std::vector<std::size_t> > > >::const_iterator c;
+  for (c = coloring.begin(); c != coloring.end(); ++c)
+  {
+    bytes += node_size + sizeof(*c) + vector_memory_usage(c->first)
+      + vector_memory_usage(c->second.first)
+      + vector_memory_usage(c->second.second);
+  }
+
+  // Connectivity
+  bytes += connectivity.capacity()*sizeof(std::vector<MeshConnectivity>);
+  for (std::size_t d0 = 0; d0 < connectivity.size(); d0++)
+  {
+    bytes += (connectivity[d0].capacity() - connectivity[d0].size())
+      *sizeof(MeshConnectivity);
+    for (std::size_t d1 = 0; d1 < connectivity[d0].size(); d1++)
+      bytes += connectivity[d0][d1].memory_usage();
+  }
+
+  return bytes;
+}
+//-----------------------------------------------------------------------------
 std::string MeshTopology::str(bool verbose) const
 {
   const std::size_t _dim = num_entities.size() - 1;
@@ -16,7 +16,7 @@
 // along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 //
 // First added:  2006-05-08
-// Last changed: 2014-07-02
+// Last changed: 2015-01-22
 
 #ifndef __MESH_TOPOLOGY_H
 #define __MESH_TOPOLOGY_H
@@ -24,6 +24,7 @@
 #include <map>
 #include <utility>
 #include <vector>
+#include <dolfin/common/MemoryTracked.h>
 #include "MeshConnectivity.h"
 
 namespace dolfin
@@ -40,7 +41,7 @@ namespace dolfin
   /// i), where dim is the topological dimension and i is the index of
   /// the entity within that topological dimension.
 
-  class MeshTopology
+  class MeshTopology : public MemoryTracked
   {
   public:
 
@@ -152,6 +153,10 @@ namespace dolfin
     /// Return hash based on the hash of cell-vertex connectivity
     size_t hash() const;
 
+    /// Return number of bytes used by topology, including
+    /// connectivity
+    std::size_t memory_usage() const;
+
     /// Return informal string representation (pretty-print)
     std::string str(bool verbose) const;
 
@@ -173,6 +178,7 @@ namespace dolfin
 
     // Friends
     friend class BinaryFile;
+    friend class MeshEditor;
 
     // Number of mesh entities for each topological dimension
     std::vector<unsigned int> num_entities;
@@ -20,7 +20,7 @@
 // Modified by August Johansson 2014
 //
 // First added:  2007-12-12
-// Last changed: 2014-02-13
+// Last changed: 2015-01-22
 
 #include <dolfin/log/log.h>
 #include "Cell.h"
@@ -93,6 +93,13 @@ void PointCell::refine_cell(Cell& cell, MeshEditor& editor,
                "Refinement of a point cell is not defined");
 }
 //-----------------------------------------------------------------------------
+void PointCell::refine_cell(const Cell& cell, std::size_t* cells) const
+{
+  dolfin_error("PointCell.cpp",
+               "refine cell",
+               "Refinement of a point cell is not defined");
+}
+//-----------------------------------------------------------------------------
 double PointCell::volume(const MeshEntity& triangle) const
 {
   dolfin_error("PointCell.cpp",
@@ -19,7 +19,7 @@
 // Modified by Kristoffer Selim 2008
 //
 // First added:  2007-12-12
-// Last changed: 2014-01-06
+// Last changed: 2015-01-22
 
 #ifndef __POINT_CELL_H
 #define __POINT_CELL_H
@@ -63,6 +63,9 @@ namespace dolfin
     void refine_cell(Cell& cell, MeshEditor& editor,
                      std::size_t& current_cell) const;
 
+    /// Refine cell uniformly (writing new cells to array)
+    void refine_cell(const Cell& cell, std::size_t* cells) const;
+
     /// Compute (generalized) volume (area) of triangle
     double volume(const MeshEntity& triangle) const;
 
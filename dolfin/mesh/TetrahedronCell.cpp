@@ -22,11 +22,12 @@
 // Modified by August Johansson 2014
 //
 // First added:  2006-06-05
-// Last changed: 2014-02-13
+// Last changed: 2015-01-22
 
 #include <algorithm>
 #include <dolfin/log/log.h>
 #include "Cell.h"
+#include "Edge.h"
 #include "Facet.h"
 #include "MeshEditor.h"
 #include "MeshGeometry.h"
@@ -142,6 +143,21 @@ TetrahedronCell::create_entities(std::vector<std::vector<unsigned int> >& e,
 //-----------------------------------------------------------------------------
 void TetrahedronCell::refine_cell(Cell& cell, MeshEditor& editor,
                                   std::size_t& current_cell) const
+{
+  // Create eight new cells
+  std::vector<std::size_t> cells(32);
+  refine_cell(cell, cells.data());
+
+  // Add cells
+  std::vector<std::size_t> new_cell(4);
+  for (std::size_t i = 0; i < 8; ++i)
+  {
+    std::copy(cells.begin() + 4*i, cells.begin() + 4*(i + 1), new_cell.begin());
+    editor.add_cell(current_cell++, new_cell);
+  }
+}
+//-----------------------------------------------------------------------------
+void TetrahedronCell::refine_cell(const Cell& cell, std::size_t* cells) const
 {
   // Get vertices and edges
   const unsigned int* v = cell.entities(0);
@@ -168,53 +184,45 @@ void TetrahedronCell::refine_cell(Cell& cell, MeshEditor& editor,
   // to make the partition in a way that does not make the aspect
   // ratio worse in each refinement. We do this by cutting the middle
   // octahedron along the shortest of three possible paths.
-  dolfin_assert(editor._mesh);
-  const Point p0 = editor._mesh->geometry().point(e0);
-  const Point p1 = editor._mesh->geometry().point(e1);
-  const Point p2 = editor._mesh->geometry().point(e2);
-  const Point p3 = editor._mesh->geometry().point(e3);
-  const Point p4 = editor._mesh->geometry().point(e4);
-  const Point p5 = editor._mesh->geometry().point(e5);
+  const Mesh& mesh = cell.mesh();
+  const Point p0 = Edge(mesh, e0 - offset).midpoint();
+  const Point p1 = Edge(mesh, e1 - offset).midpoint();
+  const Point p2 = Edge(mesh, e2 - offset).midpoint();
+  const Point p3 = Edge(mesh, e3 - offset).midpoint();
+  const Point p4 = Edge(mesh, e4 - offset).midpoint();
+  const Point p5 = Edge(mesh, e5 - offset).midpoint();
   const double d05 = p0.distance(p5);
   const double d14 = p1.distance(p4);
   const double d23 = p2.distance(p3);
 
-  // Data structure to hold cells
-  std::vector<std::vector<std::size_t> > cells(8, std::vector<std::size_t>(4));
-
   // First create the 4 congruent tetrahedra at the corners
-  cells[0][0] = v0; cells[0][1] = e3; cells[0][2] = e4; cells[0][3] = e5;
-  cells[1][0] = v1; cells[1][1] = e1; cells[1][2] = e2; cells[1][3] = e5;
-  cells[2][0] = v2; cells[2][1] = e0; cells[2][2] = e2; cells[2][3] = e4;
-  cells[3][0] = v3; cells[3][1] = e0; cells[3][2] = e1; cells[3][3] = e3;
+  cells[0] = v0; cells[1] = e3; cells[2] = e4; cells[3] = e5;
+  cells[4] = v1; cells[5] = e1; cells[6] = e2; cells[7] = e5;
+  cells[8] = v2; cells[9] = e0; cells[10] = e2; cells[11] = e4;
+  cells[12] = v3; cells[13] = e0; cells[14] = e1; cells[15] = e3;
 
   // Then divide the remaining octahedron into 4 tetrahedra
   if (d05 <= d14 && d14 <= d23)
   {
-    cells[4][0] = e0; cells[4][1] = e1; cells[4][2] = e2; cells[4][3] = e5;
-    cells[5][0] = e0; cells[5][1] = e1; cells[5][2] = e3; cells[5][3] = e5;
-    cells[6][0] = e0; cells[6][1] = e2; cells[6][2] = e4; cells[6][3] = e5;
-    cells[7][0] = e0; cells[7][1] = e3; cells[7][2] = e4; cells[7][3] = e5;
+    cells[16] = e0; cells[17] = e1; cells[18] = e2; cells[19] = e5;
+    cells[20] = e0; cells[21] = e1; cells[22] = e3; cells[23] = e5;
+    cells[24] = e0; cells[25] = e2; cells[26] = e4; cells[27] = e5;
+    cells[28] = e0; cells[29] = e3; cells[30] = e4; cells[31] = e5;
   }
   else if (d14 <= d23)
   {
-    cells[4][0] = e0; cells[4][1] = e1; cells[4][2] = e2; cells[4][3] = e4;
-    cells[5][0] = e0; cells[5][1] = e1; cells[5][2] = e3; cells[5][3] = e4;
-    cells[6][0] = e1; cells[6][1] = e2; cells[6][2] = e4; cells[6][3] = e5;
-    cells[7][0] = e1; cells[7][1] = e3; cells[7][2] = e4; cells[7][3] = e5;
+    cells[16] = e0; cells[17] = e1; cells[18] = e2; cells[19] = e4;
+    cells[20] = e0; cells[21] = e1; cells[22] = e3; cells[23] = e4;
+    cells[24] = e1; cells[25] = e2; cells[26] = e4; cells[27] = e5;
+    cells[28] = e1; cells[29] = e3; cells[30] = e4; cells[31] = e5;
   }
   else
   {
-    cells[4][0] = e0; cells[4][1] = e1; cells[4][2] = e2; cells[4][3] = e3;
-    cells[5][0] = e0; cells[5][1] = e2; cells[5][2] = e3; cells[5][3] = e4;
-    cells[6][0] = e1; cells[6][1] = e2; cells[6][2] = e3; cells[6][3] = e5;
-    cells[7][0] = e2; cells[7][1] = e3; cells[7][2] = e4; cells[7][3] = e5;
+    cells[16] = e0; cells[17] = e1; cells[18] = e2; cells[19] = e3;
+    cells[20] = e0; cells[21] = e2; cells[22] = e3; cells[23] = e4;
+    cells[24] = e1; cells[25] = e2; cells[26] = e3; cells[27] = e5;
+    cells[28] = e2; cells[29] = e3; cells[30] = e4; cells[31] = e5;
   }
-
-  // Add cells
-  std::vector<std::vector<std::size_t> >::const_iterator _cell;
-  for (_cell = cells.begin(); _cell != cells.end(); ++_cell)
-    editor.add_cell(current_cell++, *_cell);
 }
 //-----------------------------------------------------------------------------
 void TetrahedronCell::refine_cellIrregular(Cell& cell, MeshEditor& editor,
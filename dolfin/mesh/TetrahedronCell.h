@@ -20,7 +20,7 @@
 // Modified by Kristoffer Selim, 2008.
 //
 // First added:  2006-06-05
-// Last changed: 2014-01-31
+// Last changed: 2015-01-22
 
 #ifndef __TETRAHEDRON_CELL_H
 #define __TETRAHEDRON_CELL_H
@@ -62,6 +62,9 @@ namespace dolfin
     void refine_cell(Cell& cell, MeshEditor& editor,
                      std::size_t& current_cell) const;
 
+    /// Refine cell uniformly (writing new cells to array)
+    void refine_cell(const Cell& cell, std::size_t* cells) const;
+
     /// Irregular refinement of cell
     void refine_cellIrregular(Cell& cell, MeshEditor& editor,
                               std::size_t& current_cell, std::size_t refinement_rule,
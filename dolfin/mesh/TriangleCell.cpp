@@ -23,7 +23,7 @@
 // Modified by August Johansson 2014
 //
 // First added:  2006-06-05
-// Last changed: 2014-05-22
+// Last changed: 2015-01-22
 
 #include <algorithm>
 #include <dolfin/log/log.h>
@@ -111,6 +111,21 @@ void TriangleCell::create_entities(std::vector<std::vector<unsigned int> >& e,
 //-----------------------------------------------------------------------------
 void TriangleCell::refine_cell(Cell& cell, MeshEditor& editor,
                                std::size_t& current_cell) const
+{
+  // Create four new cells
+  std::vector<std::size_t> cells(12);
+  refine_cell(cell, cells.data());
+
+  // Add cells
+  std::vector<std::size_t> new_cell(3);
+  for (std::size_t i = 0; i < 4; ++i)
+  {
+    std::copy(cells.begin() + 3*i, cells.begin() + 3*(i + 1), new_cell.begin());
+    editor.add_cell(current_cell++, new_cell);
+  }
+}
+//-----------------------------------------------------------------------------
+void TriangleCell::refine_cell(const Cell& cell, std::size_t* cells) const
 {
   // Get vertices and edges
   const unsigned int* v = cell.entities(0);
@@ -130,16 +145,10 @@ void TriangleCell::refine_cell(Cell& cell, MeshEditor& editor,
   const std::size_t e2 = offset + e[find_edge(2, cell)];
 
   // Create four new cells
-  std::vector<std::vector<std::size_t> > cells(4, std::vector<std::size_t>(3));
-  cells[0][0] = v0; cells[0][1] = e2; cells[0][2] = e1;
-  cells[1][0] = v1; cells[1][1] = e0; cells[1][2] = e2;
-  cells[2][0] = v2; cells[2][1] = e1; cells[2][2] = e0;
-  cells[3][0] = e0; cells[3][1] = e1; cells[3][2] = e2;
-
-  // Add cells
-  std::vector<std::vector<std::size_t> >::const_iterator _cell;
-  for (_cell = cells.begin(); _cell != cells.end(); ++_cell)
-    editor.add_cell(current_cell++, *_cell);
+  cells[0] = v0; cells[1]  = e2; cells[2]  = e1;
+  cells[3] = v1; cells[4]  = e0; cells[5]  = e2;
+  cells[6] = v2; cells[7]  = e1; cells[8]  = e0;
+  cells[9] = e0; cells[10] = e1; cells[11] = e2;
 }
 //-----------------------------------------------------------------------------
 double TriangleCell::volume(const MeshEntity& triangle) const
@@ -19,7 +19,7 @@
 // Modified by Jan Blechta 2013
 //
 // First added:  2006-06-05
-// Last changed: 2014-05-22
+// Last changed: 2015-01-22
 
 #ifndef __TRIANGLE_CELL_H
 #define __TRIANGLE_CELL_H
@@ -60,6 +60,9 @@ namespace dolfin
     void refine_cell(Cell& cell, MeshEditor& editor,
                      std::size_t& current_cell) const;
 
+    /// Refine cell uniformly (writing new cells to array)
+    void refine_cell(const Cell& cell, std::size_t* cells) const;
+
     /// Compute (generalized) volume (area) of triangle
     double volume(const MeshEntity& triangle) const;
 
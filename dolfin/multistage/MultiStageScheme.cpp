@@ -16,7 +16,7 @@
 // along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 //
 // First added:  2013-02-15
-// Last changed: 2014-10-13
+// Last changed: 2015-01-22
 
 #include <sstream>
 #include <memory>
@@ -40,7 +40,7 @@ MultiStageScheme::MultiStageScheme(
     const std::string name,
     const std::string human_form) : 
   Variable(name, ""), _stage_forms(stage_forms), _last_stage(last_stage), 
-  _stage_solutions(stage_solutions), _u(u), _t(t), _dt(dt), 
+  _error_order(0), _stage_solutions(stage_solutions), _u(u), _t(t), _dt(dt), 
   _dt_stage_offset(dt_stage_offset), _jacobian_indices(jacobian_indices), 
   _order(order), _implicit(false), _human_form(human_form)
 {
@@ -61,13 +61,37 @@ MultiStageScheme::MultiStageScheme(
     const std::string human_form,
     std::vector<const DirichletBC* > bcs) :
   Variable(name, ""), _stage_forms(stage_forms), _last_stage(last_stage), 
-  _stage_solutions(stage_solutions), _u(u), _t(t), _dt(dt), 
+  _error_order(0), _stage_solutions(stage_solutions), _u(u), _t(t), _dt(dt), 
   _dt_stage_offset(dt_stage_offset), _jacobian_indices(jacobian_indices), 
   _order(order), _implicit(false), _human_form(human_form), _bcs(bcs)
 {
   _check_arguments();
 }
 //-----------------------------------------------------------------------------
+MultiStageScheme::MultiStageScheme(
+    std::vector<std::vector<std::shared_ptr<const Form> > > stage_forms,
+    std::shared_ptr<const Form> last_stage,
+    std::vector<std::shared_ptr<Function> > stage_solutions,
+    std::shared_ptr<Function> u,
+    std::shared_ptr<Constant> t,
+    std::shared_ptr<Constant> dt,
+    std::vector<double> dt_stage_offset,
+    std::vector<int> jacobian_indices,
+    unsigned int order,
+    const std::string name,
+    const std::string human_form,
+    std::vector<const DirichletBC* > bcs,
+    std::shared_ptr<const Form> error_stage,
+    unsigned int error_order) :
+  Variable(name, ""), _stage_forms(stage_forms), _last_stage(last_stage),
+  _error_stage(error_stage), _error_order(error_order),
+  _stage_solutions(stage_solutions), _u(u), _t(t), _dt(dt),
+  _dt_stage_offset(dt_stage_offset), _jacobian_indices(jacobian_indices),
+  _order(order), _implicit(false), _human_form(human_form), _bcs(bcs)
+{
+  _check_arguments();
+}
+//-----------------------------------------------------------------------------
 std::vector<std::vector<std::shared_ptr<const Form> > >&
 MultiStageScheme::stage_forms()
 {
@@ -79,6 +103,21 @@ std::shared_ptr<const Form> MultiStageScheme::last_stage()
   return _last_stage;
 }
 //-----------------------------------------------------------------------------
+std::shared_ptr<const Form> MultiStageScheme::error_stage()
+{
+  return _error_stage;
+}
+//-----------------------------------------------------------------------------
+unsigned int MultiStageScheme::error_order() const
+{
+  return _error_order;
+}
+//-----------------------------------------------------------------------------
+bool MultiStageScheme::has_error_estimate() const
+{
+  return static_cast<bool>(_error_stage);
+}
+//-----------------------------------------------------------------------------
 std::vector<std::shared_ptr<Function> >& MultiStageScheme::stage_solutions()
 {
   return _stage_solutions;
@@ -191,6 +230,33 @@ void MultiStageScheme::_check_arguments()
 		 "Expecting all solutions to be in the same FunctionSpace");
   }
 
+  // Check error stage is a linear form in the solution space
+  if (_error_stage)
+  {
+    if (_error_stage->rank() != 1)
+    {
+      dolfin_error("MultiStageScheme.cpp",
+		   "construct MultiStageScheme",
+		   "Expecting the error stage to be a linear form (not rank %d)",
+		   _error_stage->rank());
+    }
+
+    if (!_u->in(*_error_stage->function_space(0)))
+    {
+      dolfin_error("MultiStageScheme.cpp",
+		   "construct MultiStageScheme",
+		   "Expecting the solution to be a member of the test space "
+		   "of the error stage");
+    }
+
+    if (_error_order == 0)
+    {
+      dolfin_error("MultiStageScheme.cpp",
+		   "construct MultiStageScheme",
+		   "Expecting a positive order of the error estimate");
+    }
+  }
+
   // Check number of passed stage forms
   for (unsigned int i=0; i < _stage_forms.size();i++)
   {
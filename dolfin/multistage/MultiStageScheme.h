@@ -16,7 +16,7 @@
 // along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 //
 // First added:  2013-02-15
-// Last changed: 2014-03-05
+// Last changed: 2015-01-22
 
 #ifndef __BUTCHERSCHEME_H
 #define __BUTCHERSCHEME_H
@@ -72,12 +72,41 @@ namespace dolfin
 		  const std::string human_form,
 		  std::vector<const DirichletBC* > bcs);
 
+    /// Constructor with Boundary conditions and an embedded error
+    /// estimate. The error stage is a linear form, like the last
+    /// stage, giving the difference between the solution of the
+    /// scheme and of an embedded scheme of order error_order.
+    MultiStageScheme(std::vector<std::vector<std::shared_ptr<const Form> > > stage_forms,
+		  std::shared_ptr<const Form> last_stage,
+		  std::vector<std::shared_ptr<Function> > stage_solutions,
+		  std::shared_ptr<Function> u,
+		  std::shared_ptr<Constant> t,
+		  std::shared_ptr<Constant> dt,
+		  std::vector<double> dt_stage_offset,
+		  std::vector<int> jacobian_indices,
+		  unsigned int order,
+		  const std::string name,
+		  const std::string human_form,
+		  std::vector<const DirichletBC* > bcs,
+		  std::shared_ptr<const Form> error_stage,
+		  unsigned int error_order);
+
     /// Return the stages
     std::vector<std::vector<std::shared_ptr<const Form> > >& stage_forms();
 
     /// Return the last stage
     std::shared_ptr<const Form> last_stage();
 
+    /// Return the error stage (empty if the scheme has no error
+    /// estimate)
+    std::shared_ptr<const Form> error_stage();
+
+    /// Return the order of the embedded scheme of the error estimate
+    unsigned int error_order() const;
+
+    /// Return true if the scheme has an embedded error estimate
+    bool has_error_estimate() const;
+
     /// Return stage solutions
     std::vector<std::shared_ptr<Function> >& stage_solutions();
 
@@ -126,6 +155,12 @@ namespace dolfin
     // A linear combination of solutions for the last stage
     std::shared_ptr<const Form> _last_stage;
 
+    // A linear combination of solutions for the error estimate
+    std::shared_ptr<const Form> _error_stage;
+
+    // The order of the embedded scheme
+    unsigned int _error_order;
+
     // Solutions for the different stages
     std::vector<std::shared_ptr<Function> > _stage_solutions;
 
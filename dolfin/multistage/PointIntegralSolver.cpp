@@ -16,13 +16,19 @@
 // along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 //
 // First added:  2013-02-15
-// Last changed: 2014-10-14
+// Last changed: 2015-01-22
 
 #include <cmath>
 #include <algorithm>
+#include <exception>
 #include <memory>
 
+#ifdef HAS_OPENMP
+#include <omp.h>
+#endif
+
 #include <dolfin/log/log.h>
+#include <dolfin/common/MPI.h>
 #include <dolfin/common/Timer.h>
 #include <dolfin/parameter/GlobalParameters.h>
 #include <dolfin/mesh/Mesh.h>
@@ -42,6 +48,59 @@
 
 using namespace dolfin;
 
+//-----------------------------------------------------------------------------
+PointIntegralSolver::Scratch::Scratch(MultiStageScheme& scheme,
+                                      std::size_t system_size,
+                                      std::size_t num_jacobians)
+  : t(0.0), dt(0.0), y0(system_size), error(system_size), u(system_size),
+    u0(system_size), residual(system_size), dx(system_size),
+    jacobians(num_jacobians, std::vector<double>(system_size*system_size)),
+    recompute_jacobian(num_jacobians, true), jacobian_dt(num_jacobians, 0.0),
+    eta(1.0), num_jacobian_computations(0), squared_error(0.0),
+    num_accepted_local_steps(0), num_rejected_local_steps(0)
+{
+  // Create UFC objects for the stage forms and the last stage form
+  std::vector<std::vector<std::shared_ptr<const Form> > >& stage_forms
+    = scheme.stage_forms();
+  ufcs.resize(stage_forms.size());
+  for (std::size_t stage = 0; stage < stage_forms.size(); stage++)
+  {
+    for (std::size_t i = 0; i < stage_forms[stage].size(); i++)
+      ufcs[stage].push_back(std::make_shared<UFC>(*stage_forms[stage][i]));
+  }
+  last_stage_ufc = std::make_shared<UFC>(*scheme.last_stage());
+  if (scheme.has_error_estimate())
+    error_stage_ufc = std::make_shared<UFC>(*scheme.error_stage());
+}
+//-----------------------------------------------------------------------------
+PointIntegralSolver::Scratch::~Scratch()
+{
+  // Do nothing
+}
+//-----------------------------------------------------------------------------
+PointIntegralSolver::ParameterHandles::ParameterHandles(
+  const Parameters& parameters)
+  : reset_stage_solutions(parameters, "reset_stage_solutions"),
+    reset_each_step(parameters, "newton_solver.reset_each_step"),
+    report_vertex(parameters, "newton_solver.report_vertex"),
+    kappa(parameters, "newton_solver.kappa"),
+    rtol(parameters, "newton_solver.relative_tolerance"),
+    atol(parameters, "newton_solver.absolute_tolerance"),
+    max_iterations(parameters, "newton_solver.maximum_iterations"),
+    max_relative_previous_residual(
+      parameters, "newton_solver.max_relative_previous_residual"),
+    relaxation(parameters, "newton_solver.relaxation_parameter"),
+    report(parameters, "newton_solver.report"),
+    verbose_report(parameters, "newton_solver.verbose_report"),
+    always_recompute_jacobian(parameters,
+                              "newton_solver.always_recompute_jacobian"),
+    recompute_jacobian_each_solve(
+      parameters, "newton_solver.recompute_jacobian_each_solve"),
+    eta_0(parameters, "newton_solver.eta_0"),
+    num_threads(dolfin::parameters, "num_threads")
+{
+  // Do nothing (parameters are looked up when first accessed)
+}
 //-----------------------------------------------------------------------------
 PointIntegralSolver::PointIntegralSolver(std::shared_ptr<MultiStageScheme> scheme) :
   Variable("PointIntegralSolver", "unnamed"), _scheme(scheme),
@@ -50,13 +109,15 @@ PointIntegralSolver::PointIntegralSolver(std::shared_ptr<MultiStageScheme> schem
   _system_size(_dofmap.num_entity_dofs(0)),
   _dof_offset(_mesh.type().num_entities(0)),
   _num_stages(_scheme->stage_forms().size()),
-  _local_to_local_dofs(_system_size),
-  _vertex_map(), _local_to_global_dofs(_system_size),
-  _local_stage_solutions(_scheme->stage_solutions().size()),
-  _u0(_system_size), _residual(_system_size), _y(_system_size),
-  _dx(_system_size),
-  _ufcs(), _coefficient_index(), _recompute_jacobian(),
-  _jacobians(), _eta(1.0), _num_jacobian_computations(0)
+  _local_to_local_dofs(_dof_offset, std::vector<std::size_t>(_system_size)),
+  _vertex_map(), _owned_vertices(), _vertex_dofs(),
+  _stage_values(_num_stages), _solution_values(), _initial_values(),
+  _vertex_dt(), _stage_coefficients(), _last_stage_coefficients(),
+  _error_stage_coefficients(), _coefficient_index(), _num_jacobians(0),
+  _scratch(), _parameter_handles(parameters),
+  _num_jacobian_computations(0), _num_accepted_steps(0),
+  _num_rejected_steps(0), _num_accepted_local_steps(0),
+  _num_rejected_local_steps(0)
 {
   Timer construct_pis("Construct PointIntegralSolver");
 
@@ -74,10 +135,13 @@ PointIntegralSolver::~PointIntegralSolver()
 //-----------------------------------------------------------------------------
 void PointIntegralSolver::reset_newton_solver()
 {
-  _eta = parameters("newton_solver")["eta_0"];
-
-  for (unsigned int i=0; i < _recompute_jacobian.size(); i++)
-    _recompute_jacobian[i] = true;
+  const double eta_0 = _parameter_handles.eta_0;
+  for (std::size_t i = 0; i < _scratch.size(); i++)
+  {
+    _scratch[i]->eta = eta_0;
+    std::fill(_scratch[i]->recompute_jacobian.begin(),
+              _scratch[i]->recompute_jacobian.end(), true);
+  }
 }
 //-----------------------------------------------------------------------------
 void PointIntegralSolver::reset_stage_solutions()
@@ -89,188 +153,539 @@ void PointIntegralSolver::reset_stage_solutions()
     *_scheme->stage_solutions()[stage]->vector() = 0.0;
 
     // Reset local stage solutions
-    for (unsigned int row=0; row < _system_size; row++)
-      _local_stage_solutions[stage][row] = 0.0;
+    std::fill(_stage_values[stage].begin(), _stage_values[stage].end(), 0.0);
   }
 }
 //-----------------------------------------------------------------------------
 void PointIntegralSolver::step(double dt)
 {
-  const bool reset_stage_solutions_ = parameters["reset_stage_solutions"];
-  const bool reset_newton_solver_
-    = parameters("newton_solver")["reset_each_step"];
+  dolfin_assert(dt > 0.0);
+
+  // Time at start of timestep
+  const double t0 = *_scheme->t();
+
+  _begin_step(dt);
+  _step(dt, false, false);
+  _end_step();
+
+  // Update time
+  *_scheme->t() = t0 + dt;
+}
+//-----------------------------------------------------------------------------
+double PointIntegralSolver::step_interval_adaptive(double t0, double t1,
+                                                   double dt)
+{
+  if (dt <= 0.0)
+  {
+    dolfin_error("PointIntegralSolver.cpp",
+		 "stepping PointIntegralSolver",
+		 "Expecting a positive dt");
+  }
+
+  if (t0 >= t1)
+  {
+    dolfin_error("PointIntegralSolver.cpp",
+		 "stepping PointIntegralSolver",
+		 "Expecting t0 to be smaller than t1");
+  }
+
+  if (!_scheme->has_error_estimate())
+  {
+    dolfin_error("PointIntegralSolver.cpp",
+		 "stepping PointIntegralSolver with adaptive time step",
+		 "Expecting a MultiStageScheme with an embedded error estimate");
+  }
+
+  // Set start time
+  *_scheme->t() = t0;
+
+  // Step each vertex through the interval with its own time steps
+  if (parameters["local_time_stepping"])
+  {
+    _begin_step(t1 - t0);
+    _step(t1 - t0, true, true);
+    _end_step();
+    *_scheme->t() = t1;
+    return dt;
+  }
+
+  const TimeStepController controller(parameters("time_step_controller"),
+                                      _scheme->order(),
+                                      _scheme->error_order());
+  double t = t0;
+  while (true)
+  {
+    // Take the rest of the interval if it is (nearly) within reach,
+    // to avoid a tiny last step
+    const bool last_step = t + 1.01*dt >= t1;
+    const double step_dt = last_step ? t1 - t : dt;
+
+    _begin_step(step_dt);
+    const double error = _step(step_dt, true, false);
+    const double next_dt = controller.next_dt(step_dt, error);
+
+    if (controller.accept(error))
+    {
+      _end_step();
+      _num_accepted_steps++;
+      if (last_step)
+      {
+        *_scheme->t() = t1;
+
+        // A step shortened to end at t1 says little about the next
+        return std::max(dt, next_dt);
+      }
+
+      t += step_dt;
+      *_scheme->t() = t;
+    }
+    else
+      _num_rejected_steps++;
+
+    dt = next_dt;
+  }
+}
+//-----------------------------------------------------------------------------
+void PointIntegralSolver::_begin_step(double dt)
+{
+  const ParameterHandles& p = _parameter_handles;
+  const bool reset_stage_solutions_ = p.reset_stage_solutions;
+
+  // Create scratch data for each thread
+  const int num_threads = p.num_threads;
+  _init_scratch(std::max(num_threads, 1));
 
   // Check for reseting stage solutions
   if (reset_stage_solutions_)
     reset_stage_solutions();
 
   // Check for reseting newtonsolver for each time step
-  if (reset_newton_solver_)
+  if (p.reset_each_step)
     reset_newton_solver();
 
-  Timer t_step("PointIntegralSolver::step");
-
-  dolfin_assert(dt > 0.0);
+  // Read Newton solver parameters (not accessed from the threads)
+  _newton_parameters.report_vertex = p.report_vertex;
+  _newton_parameters.kappa = p.kappa;
+  _newton_parameters.rtol = p.rtol;
+  _newton_parameters.atol = p.atol;
+  _newton_parameters.max_iterations = p.max_iterations;
+  _newton_parameters.max_relative_previous_residual
+    = p.max_relative_previous_residual;
+  _newton_parameters.relaxation = p.relaxation;
+  _newton_parameters.report = p.report;
+  _newton_parameters.verbose_report = p.verbose_report;
+  _newton_parameters.always_recompute_jacobian = p.always_recompute_jacobian;
+  _newton_parameters.recompute_jacobian_each_solve
+    = p.recompute_jacobian_each_solve;
+  _newton_parameters.eta_0 = p.eta_0;
 
   // Update time constant of scheme
   *_scheme->dt() = dt;
 
+  // Get stage solutions of the owned vertices from the previous step
+  // (used as initial guess for implicit stages)
+  if (!reset_stage_solutions_)
+  {
+    for (unsigned int stage = 0; stage < _num_stages; stage++)
+    {
+      _scheme->stage_solutions()[stage]->vector()->get_local(
+        _stage_values[stage].data(), _vertex_dofs.size(),
+        _vertex_dofs.data());
+    }
+  }
+
+  // Get solution of the owned vertices
+  _scheme->solution()->vector()->get_local(_initial_values.data(),
+                                           _vertex_dofs.size(),
+                                           _vertex_dofs.data());
+}
+//-----------------------------------------------------------------------------
+double PointIntegralSolver::_step(double dt, bool estimate_error,
+                                  bool local_time_stepping)
+{
+  Timer t_step("PointIntegralSolver::step");
+
   // Time at start of timestep
   const double t0 = *_scheme->t();
 
-  // Get ownership range
-  const dolfin::la_index local_dof_size = _dofmap.ownership_range().second
-    - _dofmap.ownership_range().first;
-
-  // Iterate over vertices
-  ufc::cell ufc_cell;
-  std::vector<double> vertex_coordinates;
-  for (std::size_t vert_ind = 0; vert_ind < _mesh.num_vertices(); ++vert_ind)
+  // Create time step controller (only reads parameters when created,
+  // so it may be shared by the threads)
+  std::shared_ptr<const TimeStepController> controller;
+  if (estimate_error)
   {
-    // Cell containing vertex
-    const Cell cell(_mesh, _vertex_map[vert_ind].first);
-    cell.get_vertex_coordinates(vertex_coordinates);
-    cell.get_cell_data(ufc_cell);
-
-    // Get all dofs for cell
-    // FIXME: Should we include logics about empty dofmaps?
-    const std::vector<dolfin::la_index>& cell_dofs
-      = _dofmap.cell_dofs(cell.index());
-
-    // Tabulate local-local dofmap
-    _dofmap.tabulate_entity_dofs(_local_to_local_dofs, 0,
-				 _vertex_map[vert_ind].second);
+    controller = std::make_shared<TimeStepController>(
+      parameters("time_step_controller"), _scheme->order(),
+      _scheme->error_order());
+  }
 
-    // Fill local to global dof map and check that the dof is owned
-    bool owns_all_dofs = true;
-    for (unsigned int row = 0; row < _system_size; row++)
+  // Restrict the coefficients which are not set for each vertex
+  // before the threads are started, as restriction may access shared
+  // data (ghosted vectors, Python Expressions)
+  Scratch& scratch0 = *_scratch[0];
+  for (unsigned int stage = 0; stage < _num_stages; stage++)
+  {
+    for (std::size_t i = 0; i < _stage_coefficients[stage].size(); i++)
     {
-      _local_to_global_dofs[row] = cell_dofs[_local_to_local_dofs[row]];
-      if (_local_to_global_dofs[row] >= local_dof_size)
-      {
-	owns_all_dofs = false;
-	break;
-      }
+      _restrict_vertex_coefficients(*scratch0.ufcs[stage][i],
+                                    _stage_coefficients[stage][i]);
     }
+  }
+  _restrict_vertex_coefficients(*scratch0.last_stage_ufc,
+                                _last_stage_coefficients);
+  if (estimate_error)
+  {
+    _restrict_vertex_coefficients(*scratch0.error_stage_ufc,
+                                  _error_stage_coefficients);
+  }
 
-    // If not owning all dofs
-    if (!owns_all_dofs)
-      continue;
-
-    // Iterate over stage forms
-    for (unsigned int stage = 0; stage < _num_stages; stage++)
+  // Step the owned vertices. The vertices are independent, and each
+  // thread writes only to the solution values of its own vertices
+  // and to its own scratch data.
+  const int num_owned_vertices = _owned_vertices.size();
+  std::exception_ptr exception;
+  #ifdef HAS_OPENMP
+  const int num_threads = _parameter_handles.num_threads;
+  #pragma omp parallel for schedule(static) \
+    num_threads(std::max(num_threads, 1)) if (num_threads > 0)
+  #endif
+  for (int vertex = 0; vertex < num_owned_vertices; ++vertex)
+  {
+    #ifdef HAS_OPENMP
+    Scratch& scratch = *_scratch[omp_get_thread_num()];
+    #else
+    Scratch& scratch = *_scratch[0];
+    #endif
+
+    // Start values of the vertex
+    scratch.t = t0;
+    scratch.dt = dt;
+    std::copy(_initial_values.begin() + vertex*_system_size,
+              _initial_values.begin() + (vertex + 1)*_system_size,
+              scratch.y0.begin());
+
+    // Exceptions must not leave the parallel region, so keep the
+    // first and throw it after the loop
+    try
     {
-      // Update cell
-      // TODO: Pass suitable bool vector here to avoid tabulating all
-      // coefficient dofs:
-      _ufcs[stage][0]->update(cell, vertex_coordinates, ufc_cell);
-      //some_integral.enabled_coefficients());
-
-      // Check if we have an explicit stage (only 1 form)
-      if (_ufcs[stage].size() == 1)
-      {
-        _solve_explicit_stage(vert_ind, stage, ufc_cell, vertex_coordinates);
-      }
-      // or an implicit stage (2 forms)
+      if (local_time_stepping)
+        _step_vertex_local(vertex, scratch, *controller);
       else
+        scratch.squared_error += _step_vertex(vertex, scratch,
+                                              controller.get());
+    }
+    catch (...)
+    {
+      #ifdef HAS_OPENMP
+      #pragma omp critical (point_integral_solver_exception)
+      #endif
       {
-        _solve_implicit_stage(vert_ind, stage, cell, ufc_cell,
-                              vertex_coordinates);
+        if (!exception)
+          exception = std::current_exception();
       }
     }
+  }
 
-    Timer t_last_stage("Last stage: tabulate_tensor");
+  double squared_error = 0.0;
+  for (std::size_t i = 0; i < _scratch.size(); i++)
+  {
+    Scratch& scratch = *_scratch[i];
+    _num_jacobian_computations += scratch.num_jacobian_computations;
+    _num_accepted_local_steps += scratch.num_accepted_local_steps;
+    _num_rejected_local_steps += scratch.num_rejected_local_steps;
+    squared_error += scratch.squared_error;
+    scratch.num_jacobian_computations = 0;
+    scratch.num_accepted_local_steps = 0;
+    scratch.num_rejected_local_steps = 0;
+    scratch.squared_error = 0.0;
+  }
 
-    // Last stage point integral
-    const ufc::point_integral& integral
-      = *_last_stage_ufc->default_point_integral;
+  if (exception)
+    std::rethrow_exception(exception);
 
-    // Update coefficients for last stage
-    // TODO: Pass suitable bool vector here to avoid tabulating all
-    // coefficient dofs:
-    _last_stage_ufc->update(cell, vertex_coordinates, ufc_cell);
-    //integral.enabled_coefficients());
+  if (!estimate_error || local_time_stepping)
+    return 0.0;
 
-    // Tabulate cell tensor
-    integral.tabulate_tensor(_last_stage_ufc->A.data(), _last_stage_ufc->w(),
-			     vertex_coordinates.data(),
-			     _vertex_map[vert_ind].second,
-                             ufc_cell.orientation);
+  // Root mean square of the scaled error over all processes
+  const MPI_Comm comm = _mesh.mpi_comm();
+  squared_error = MPI::sum(comm, squared_error);
+  const std::size_t num_values = MPI::sum(comm, _vertex_dofs.size());
+  return num_values > 0 ? std::sqrt(squared_error/num_values) : 0.0;
+}
+//-----------------------------------------------------------------------------
+void PointIntegralSolver::_end_step()
+{
+  // Put stage solutions and solution into global vectors
+  for (unsigned int stage = 0; stage < _num_stages; stage++)
+  {
+    GenericVector& x = *_scheme->stage_solutions()[stage]->vector();
+    x.set_local(_stage_values[stage].data(), _vertex_dofs.size(),
+                _vertex_dofs.data());
+    x.apply("insert");
+  }
+
+  GenericVector& u = *_scheme->solution()->vector();
+  u.set_local(_solution_values.data(), _vertex_dofs.size(),
+              _vertex_dofs.data());
+  u.apply("insert");
+}
+//-----------------------------------------------------------------------------
+double PointIntegralSolver::_step_vertex(std::size_t vertex, Scratch& scratch,
+                                         const TimeStepController* controller)
+{
+  // Cell containing vertex
+  const std::size_t vert_ind = _owned_vertices[vertex];
+  const Cell cell(_mesh, _vertex_map[vert_ind].first);
+  const unsigned int local_vert = _vertex_map[vert_ind].second;
+  cell.get_vertex_coordinates(scratch.vertex_coordinates);
+  cell.get_cell_data(scratch.ufc_cell);
+
+  // Iterate over stage forms
+  for (unsigned int stage = 0; stage < _num_stages; stage++)
+  {
+    // Update coefficients
+    UFC& ufc = *scratch.ufcs[stage][0];
+    _update_vertex_coefficients(ufc, _stage_coefficients[stage][0], vertex,
+                                local_vert, scratch);
+
+    // Check if we have an explicit stage (only 1 form)
+    if (scratch.ufcs[stage].size() == 1)
+      _solve_explicit_stage(vertex, stage, scratch);
+    // or an implicit stage (2 forms)
+    else
+      _solve_implicit_stage(vertex, stage, cell, scratch);
+  }
+
+  // Last stage point integral
+  UFC& ufc = *scratch.last_stage_ufc;
+  const ufc::point_integral& integral = *ufc.default_point_integral;
+
+  // Update coefficients for last stage
+  _update_vertex_coefficients(ufc, _last_stage_coefficients, vertex,
+                              local_vert, scratch);
+
+  // Tabulate cell tensor
+  integral.tabulate_tensor(ufc.A.data(), ufc.w(),
+                           scratch.vertex_coordinates.data(), local_vert,
+                           scratch.ufc_cell.orientation);
+
+  // Update solution with a tabulation of the last stage
+  const std::vector<std::size_t>& local_dofs = _local_to_local_dofs[local_vert];
+  double* y = _solution_values.data() + vertex*_system_size;
+  for (unsigned int row = 0; row < _system_size; row++)
+    y[row] = ufc.A[local_dofs[row]];
+
+  if (!controller)
+    return 0.0;
+
+  // Error stage point integral
+  UFC& error_ufc = *scratch.error_stage_ufc;
+  _update_vertex_coefficients(error_ufc, _error_stage_coefficients, vertex,
+                              local_vert, scratch);
+  error_ufc.default_point_integral->tabulate_tensor(
+    error_ufc.A.data(), error_ufc.w(), scratch.vertex_coordinates.data(),
+    local_vert, scratch.ufc_cell.orientation);
+  for (unsigned int row = 0; row < _system_size; row++)
+    scratch.error[row] = error_ufc.A[local_dofs[row]];
+
+  return controller->squared_error(scratch.error.data(), scratch.y0.data(), y,
+                                   _system_size);
+}
+//-----------------------------------------------------------------------------
+void PointIntegralSolver::_step_vertex_local(std::size_t vertex,
+                                             Scratch& scratch,
+                                             const TimeStepController& controller)
+{
+  const double t1 = scratch.t + scratch.dt;
+  const double* y = _solution_values.data() + vertex*_system_size;
+
+  // Start with the time step from the previous interval
+  double dt = _vertex_dt[vertex] > 0.0 ? _vertex_dt[vertex] : scratch.dt;
+  bool last_step = false;
+  while (!last_step)
+  {
+    // Take the rest of the interval if it is (nearly) within reach,
+    // to avoid a tiny last step
+    last_step = scratch.t + 1.01*dt >= t1;
+    scratch.dt = last_step ? t1 - scratch.t : dt;
+
+    const double error
+      = std::sqrt(_step_vertex(vertex, scratch, &controller)/_system_size);
+    const double next_dt = controller.next_dt(scratch.dt, error);
+
+    if (controller.accept(error))
+    {
+      scratch.num_accepted_local_steps++;
+      scratch.t += scratch.dt;
+      std::copy(y, y + _system_size, scratch.y0.begin());
+
+      // A step shortened to end at t1 says little about the next
+      dt = last_step ? std::max(dt, next_dt) : next_dt;
+    }
+    else
+    {
+      scratch.num_rejected_local_steps++;
+      last_step = false;
+      dt = next_dt;
+    }
+  }
+
+  _vertex_dt[vertex] = dt;
+}
+//-----------------------------------------------------------------------------
+void PointIntegralSolver::_update_vertex_coefficients(UFC& ufc,
+  const VertexCoefficients& coefficients, std::size_t vertex,
+  unsigned int local_vert, const Scratch& scratch) const
+{
+  // Coefficients restricted before the vertices are stepped
+  const double* values
+    = coefficients.values.data() + vertex*coefficients.num_values;
+  for (std::size_t i = 0; i < coefficients.restricted.size(); i++)
+  {
+    const std::size_t n = coefficients.restricted[i].second;
+    std::copy(values, values + n, ufc.w()[coefficients.restricted[i].first]);
+    values += n;
+  }
 
-    // Update solution with a tabulation of the last stage
+  // The stage solutions computed in this step are not yet in the
+  // global vectors, and the solution, time and time step differ
+  // between vertices with local time stepping, so set the values at
+  // the vertex
+  const std::vector<std::size_t>& local_dofs = _local_to_local_dofs[local_vert];
+  for (std::size_t i = 0; i < coefficients.functions.size(); i++)
+  {
+    const unsigned int stage = coefficients.functions[i].second;
+    double* w = ufc.w()[coefficients.functions[i].first];
+    const double* u = stage < _num_stages
+      ? _stage_values[stage].data() + vertex*_system_size
+      : scratch.y0.data();
     for (unsigned int row = 0; row < _system_size; row++)
-      _y[row] = _last_stage_ufc->A[_local_to_local_dofs[row]];
+      w[local_dofs[row]] = u[row];
+  }
+
+  // The time and time step are scalar Constants (a single value)
+  for (std::size_t i = 0; i < coefficients.time.size(); i++)
+    ufc.w()[coefficients.time[i]][0] = scratch.t;
+  for (std::size_t i = 0; i < coefficients.dt.size(); i++)
+    ufc.w()[coefficients.dt[i]][0] = scratch.dt;
+}
+//-----------------------------------------------------------------------------
+PointIntegralSolver::VertexCoefficients
+PointIntegralSolver::_vertex_coefficients(const Form& form) const
+{
+  const std::vector<std::shared_ptr<Function> >& stage_solutions
+    = _scheme->stage_solutions();
 
-    // Update global solution with last stage
-    _scheme->solution()->vector()->set_local(_y.data(),
-                                             _local_to_global_dofs.size(),
-                                             _local_to_global_dofs.data());
+  VertexCoefficients coefficients;
+  for (std::size_t j = 0; j < form.num_coefficients(); j++)
+  {
+    const std::size_t id = form.coefficients()[j]->id();
+    for (unsigned int s = 0; s < stage_solutions.size(); s++)
+    {
+      if (id == stage_solutions[s]->id())
+        coefficients.functions.push_back(std::make_pair(j, s));
+    }
+
+    if (id == _scheme->solution()->id())
+      coefficients.functions.push_back(std::make_pair(j, _num_stages));
+    else if (id == _scheme->t()->id())
+      coefficients.time.push_back(j);
+    else if (id == _scheme->dt()->id())
+      coefficients.dt.push_back(j);
   }
 
-  for (unsigned int stage=0; stage<_num_stages; stage++)
-    _scheme->stage_solutions()[stage]->vector()->apply("insert");
+  // Other coefficients are restricted
+  coefficients.enabled.assign(form.num_coefficients(), true);
+  for (std::size_t i = 0; i < coefficients.functions.size(); i++)
+    coefficients.enabled[coefficients.functions[i].first] = false;
+  for (std::size_t i = 0; i < coefficients.time.size(); i++)
+    coefficients.enabled[coefficients.time[i]] = false;
+  for (std::size_t i = 0; i < coefficients.dt.size(); i++)
+    coefficients.enabled[coefficients.dt[i]] = false;
+
+  coefficients.num_values = 0;
+  for (std::size_t j = 0; j < form.num_coefficients(); j++)
+  {
+    if (!coefficients.enabled[j])
+      continue;
+    std::unique_ptr<ufc::finite_element>
+      element(form.ufc_form()->create_finite_element(form.rank() + j));
+    coefficients.restricted.push_back(
+      std::make_pair(j, element->space_dimension()));
+    coefficients.num_values += element->space_dimension();
+  }
 
-  _scheme->solution()->vector()->apply("insert");
+  return coefficients;
+}
+//-----------------------------------------------------------------------------
+void PointIntegralSolver::_restrict_vertex_coefficients(UFC& ufc,
+                                      VertexCoefficients& coefficients)
+{
+  if (coefficients.restricted.empty())
+    return;
 
-  // Update time
-  *_scheme->t() = t0 + dt;
+  const std::size_t num_owned_vertices = _owned_vertices.size();
+  coefficients.values.resize(num_owned_vertices*coefficients.num_values);
+  std::vector<double> vertex_coordinates;
+  ufc::cell ufc_cell;
+  for (std::size_t vertex = 0; vertex < num_owned_vertices; vertex++)
+  {
+    const Cell cell(_mesh, _vertex_map[_owned_vertices[vertex]].first);
+    cell.get_vertex_coordinates(vertex_coordinates);
+    cell.get_cell_data(ufc_cell);
+    ufc.update(cell, vertex_coordinates, ufc_cell, coefficients.enabled);
+
+    double* values
+      = coefficients.values.data() + vertex*coefficients.num_values;
+    for (std::size_t i = 0; i < coefficients.restricted.size(); i++)
+    {
+      const double* w = ufc.w()[coefficients.restricted[i].first];
+      const std::size_t n = coefficients.restricted[i].second;
+      std::copy(w, w + n, values);
+      values += n;
+    }
+  }
 }
 //-----------------------------------------------------------------------------
-void PointIntegralSolver::_solve_explicit_stage(std::size_t vert_ind,
+void PointIntegralSolver::_solve_explicit_stage(std::size_t vertex,
                                                 unsigned int stage,
-                                                const ufc::cell& ufc_cell,
-                                                const std::vector<double>& vertex_coordinates)
+                                                Scratch& scratch)
 {
-  Timer t_expl("Explicit stage");
-
   // Local vertex ind
-  const unsigned int local_vert = _vertex_map[vert_ind].second;
+  const unsigned int local_vert
+    = _vertex_map[_owned_vertices[vertex]].second;
 
   // Point integral
-  const ufc::point_integral& integral
-    = *_ufcs[stage][0]->default_point_integral;
+  UFC& ufc = *scratch.ufcs[stage][0];
+  const ufc::point_integral& integral = *ufc.default_point_integral;
 
   // Tabulate cell tensor
-  Timer t_expl_tt("Explicit stage: tabulate_tensor");
-  integral.tabulate_tensor(_ufcs[stage][0]->A.data(), _ufcs[stage][0]->w(),
-			   vertex_coordinates.data(), local_vert,
-                           ufc_cell.orientation);
-  t_expl_tt.stop();
+  integral.tabulate_tensor(ufc.A.data(), ufc.w(),
+			   scratch.vertex_coordinates.data(), local_vert,
+                           scratch.ufc_cell.orientation);
 
   // Extract vertex dofs from tabulated tensor and put them into the
   // local stage solution vector
-  // Extract vertex dofs from tabulated tensor
+  const std::vector<std::size_t>& local_dofs = _local_to_local_dofs[local_vert];
+  double* u = _stage_values[stage].data() + vertex*_system_size;
   for (unsigned int row = 0; row < _system_size; row++)
-  {
-    _local_stage_solutions[stage][row]
-      = _ufcs[stage][0]->A[_local_to_local_dofs[row]];
-  }
-
-
-  // FIXME: This below is dodgy and will sooner or later break in parallel (GNW)
-  // Put solution back into global stage solution vector
-  // NOTE: This so an UFC.update (coefficient restriction) would just
-  // work
-  _scheme->stage_solutions()[stage]->vector()->set_local(
-    _local_stage_solutions[stage].data(), _system_size,
-    _local_to_global_dofs.data());
+    u[row] = ufc.A[local_dofs[row]];
 }
 //-----------------------------------------------------------------------------
-void PointIntegralSolver::_solve_implicit_stage(std::size_t vert_ind,
+void PointIntegralSolver::_solve_implicit_stage(std::size_t vertex,
                                                 unsigned int stage,
                                                 const Cell& cell,
-                                                const ufc::cell& ufc_cell,
-                                                const std::vector<double>& vertex_coordinates)
+                                                Scratch& scratch)
 {
-  Timer t_impl("Implicit stage");
+  static const std::size_t task
+    = Timer::task_id("PointIntegralSolver: implicit stage");
+  Timer t_implicit(task);
 
   // Do a simplified newton solve
-  _simplified_newton_solve(vert_ind, stage, cell, ufc_cell, vertex_coordinates);
+  _simplified_newton_solve(vertex, stage, cell, scratch);
 
-  // Put solution back into global stage solution vector
-  _scheme->stage_solutions()[stage]->vector()->set_local(_local_stage_solutions[stage].data(),
-                                                         _system_size,
-                                                         _local_to_global_dofs.data());
+  // Put solution into local stage solution vector
+  std::copy(scratch.u.begin(), scratch.u.end(),
+            _stage_values[stage].begin() + vertex*_system_size);
 }
 //-----------------------------------------------------------------------------
 void PointIntegralSolver::step_interval(double t0, double t1, double dt)
@@ -307,21 +722,25 @@ void PointIntegralSolver::step_interval(double t0, double t1, double dt)
 //-----------------------------------------------------------------------------
 void PointIntegralSolver::_compute_jacobian(std::vector<double>& jac,
 					    const std::vector<double>& u,
-					    unsigned int local_vert,
-					    UFC& loc_ufc, const Cell& cell,
-					    const ufc::cell& ufc_cell,
-					    int coefficient_index,
-					    const std::vector<double>& vertex_coordinates)
+					    std::size_t vertex,
+					    unsigned int stage,
+					    const Cell& cell,
+					    Scratch& scratch) const
 {
+  static const std::size_t task
+    = Timer::task_id("PointIntegralSolver: compute jacobian");
+  Timer t_jacobian(task);
+
+  UFC& loc_ufc = *scratch.ufcs[stage][1];
   const ufc::point_integral& J_integral = *loc_ufc.default_point_integral;
+  const int coefficient_index = _coefficient_index[stage].size() == 2 ?
+    _coefficient_index[stage][1] : -1;
+  const unsigned int local_vert
+    = _vertex_map[_owned_vertices[vertex]].second;
+  const std::vector<std::size_t>& local_dofs = _local_to_local_dofs[local_vert];
 
-  //Timer _timer_compute_jac("Implicit stage: Compute jacobian");
-  //Timer t_impl_update("Update_cell");
-  // TODO: Pass suitable bool vector here to avoid tabulating all
-  // coefficient dofs:
-  loc_ufc.update(cell, vertex_coordinates, ufc_cell);
-  //J_integral.enabled_coefficients());
-  //t_impl_update.stop();
+  _update_vertex_coefficients(loc_ufc, _stage_coefficients[stage][1], vertex,
+                              local_vert, scratch);
 
   // If there is a solution coefficient in the Jacobian form
   if (coefficient_index > 0)
@@ -329,37 +748,33 @@ void PointIntegralSolver::_compute_jacobian(std::vector<double>& jac,
     // Put solution back into restricted coefficients before tabulate
     // new jacobian
     for (unsigned int row = 0; row < _system_size; row++)
-      loc_ufc.w()[coefficient_index][_local_to_local_dofs[row]] = u[row];
+      loc_ufc.w()[coefficient_index][local_dofs[row]] = u[row];
   }
 
   // Tabulate Jacobian
-  Timer t_impl_tt_jac("Implicit stage: tabulate_tensor (J)");
   J_integral.tabulate_tensor(loc_ufc.A.data(), loc_ufc.w(),
-			     vertex_coordinates.data(),
+			     scratch.vertex_coordinates.data(),
 			     local_vert,
-                             ufc_cell.orientation);
-  t_impl_tt_jac.stop();
+                             scratch.ufc_cell.orientation);
 
   // Extract vertex dofs from tabulated tensor
-  //Timer t_impl_update_jac("Implicit stage: update_jac");
   for (unsigned int row = 0; row < _system_size; row++)
   {
     for (unsigned int col = 0; col < _system_size; col++)
     {
-      jac[row*_system_size + col] = loc_ufc.A[_local_to_local_dofs[row]*
+      jac[row*_system_size + col] = loc_ufc.A[local_dofs[row]*
 					      _dof_offset*_system_size +
-					      _local_to_local_dofs[col]];
+					      local_dofs[col]];
     }
   }
-  //t_impl_update_jac.stop();
 
   // LU factorize Jacobian
-  //Timer lu_factorize("Implicit stage: LU factorize");
   _lu_factorize(jac);
-  _num_jacobian_computations += 1;
+  scratch.jacobian_dt[_scheme->jacobian_index(stage)] = scratch.dt;
+  scratch.num_jacobian_computations += 1;
 }
 //-----------------------------------------------------------------------------
-void PointIntegralSolver::_lu_factorize(std::vector<double>& A)
+void PointIntegralSolver::_lu_factorize(std::vector<double>& A) const
 {
   // Local variables
   double sum;
@@ -471,47 +886,40 @@ void PointIntegralSolver::_init()
   std::vector<std::vector<std::shared_ptr<const Form> > >& stage_forms
     = _scheme->stage_forms();
 
-  // Init local stage solutions
-  for (unsigned int stage = 0; stage < _num_stages; stage++)
-    _local_stage_solutions[stage].resize(_system_size);
-
-  // Init coefficient index and ufcs
+  // Init coefficient index
   _coefficient_index.resize(stage_forms.size());
-  _ufcs.resize(stage_forms.size());
 
-  // Initiate jacobian matrices
+  // Count the number of distinct jacobians
   if (_scheme->implicit())
   {
-    // First count the number of distinct jacobians
     int max_jacobian_index = 0;
     for (unsigned int stage = 0; stage < _num_stages; stage++)
     {
       max_jacobian_index = std::max(_scheme->jacobian_index(stage),
 				    max_jacobian_index);
     }
-
-    // Create memory for jacobians
-    _jacobians.resize(max_jacobian_index+1);
-    for (int i=0; i<=max_jacobian_index; i++)
-      _jacobians[i].resize(_system_size*_system_size);
-    _recompute_jacobian.resize(max_jacobian_index+1, true);
+    _num_jacobians = max_jacobian_index + 1;
   }
 
-  // Create last stage UFC form
-  _last_stage_ufc = std::make_shared<UFC>(*_scheme->last_stage());
+  // Find the coefficients of the stage forms, the last stage form and
+  // the error stage form which are set for each vertex
+  _stage_coefficients.resize(stage_forms.size());
+  for (unsigned int stage = 0; stage < stage_forms.size(); stage++)
+  {
+    for (std::size_t i = 0; i < stage_forms[stage].size(); i++)
+      _stage_coefficients[stage].push_back(
+        _vertex_coefficients(*stage_forms[stage][i]));
+  }
+  _last_stage_coefficients = _vertex_coefficients(*_scheme->last_stage());
+  if (_scheme->has_error_estimate())
+    _error_stage_coefficients = _vertex_coefficients(*_scheme->error_stage());
 
   // Iterate over stages and collect information
   for (unsigned int stage = 0; stage < stage_forms.size(); stage++)
   {
-    // Create a UFC object for first form
-    _ufcs[stage].push_back(std::make_shared<UFC>(*stage_forms[stage][0]));
-
     //  If implicit stage
     if (stage_forms[stage].size()==2)
     {
-      // Create a UFC object for second form
-      _ufcs[stage].push_back(std::make_shared<UFC>(*stage_forms[stage][1]));
-
       // Find coefficient index for each of the two implicit forms
       for (unsigned int i = 0; i < 2; i++)
       {
@@ -540,6 +948,9 @@ void PointIntegralSolver::_init()
     }
   }
 
+  // Create scratch data (UFC objects) for one thread
+  _init_scratch(1);
+
   // Build vertex map
   _vertex_map.resize(_mesh.num_vertices());
 
@@ -589,39 +1000,100 @@ void PointIntegralSolver::_init()
       }
     }
   }
+
+  // Tabulate local-local dofmap for each local vertex
+  for (unsigned int local_vert = 0; local_vert < _dof_offset; local_vert++)
+  {
+    _dofmap.tabulate_entity_dofs(_local_to_local_dofs[local_vert], 0,
+                                 local_vert);
+  }
+
+  // Get ownership range
+  const dolfin::la_index local_dof_size = _dofmap.ownership_range().second
+    - _dofmap.ownership_range().first;
+
+  // Collect the vertices which own all their dofs, and their dofs
+  for (std::size_t vert_ind = 0; vert_ind < _mesh.num_vertices(); ++vert_ind)
+  {
+    // Get all dofs for cell
+    // FIXME: Should we include logics about empty dofmaps?
+    const std::vector<dolfin::la_index>& cell_dofs
+      = _dofmap.cell_dofs(_vertex_map[vert_ind].first);
+    const std::vector<std::size_t>& local_dofs
+      = _local_to_local_dofs[_vertex_map[vert_ind].second];
+
+    // Check that the dofs are owned
+    bool owns_all_dofs = true;
+    for (unsigned int row = 0; row < _system_size; row++)
+    {
+      if (cell_dofs[local_dofs[row]] >= local_dof_size)
+      {
+	owns_all_dofs = false;
+	break;
+      }
+    }
+
+    // If owning all dofs
+    if (owns_all_dofs)
+    {
+      _owned_vertices.push_back(vert_ind);
+      for (unsigned int row = 0; row < _system_size; row++)
+        _vertex_dofs.push_back(cell_dofs[local_dofs[row]]);
+    }
+  }
+
+  // Init local stage solutions and solution
+  for (unsigned int stage = 0; stage < _num_stages; stage++)
+    _stage_values[stage].resize(_vertex_dofs.size(), 0.0);
+  _solution_values.resize(_vertex_dofs.size());
+  _initial_values.resize(_vertex_dofs.size());
+  _vertex_dt.resize(_owned_vertices.size(), 0.0);
+}
+//-----------------------------------------------------------------------------
+void PointIntegralSolver::_init_scratch(std::size_t num_threads)
+{
+  if (_scratch.size() == num_threads)
+    return;
+
+  _scratch.clear();
+  for (std::size_t i = 0; i < num_threads; i++)
+  {
+    _scratch.push_back(std::make_shared<Scratch>(*_scheme, _system_size,
+                                                 _num_jacobians));
+  }
 }
 //-----------------------------------------------------------------------------
 void PointIntegralSolver::_simplified_newton_solve(
-			      std::size_t vert_ind, unsigned int stage,
-			      const Cell& cell,
-			      const ufc::cell& ufc_cell,
-			      const std::vector<double>& vertex_coordinates)
+			      std::size_t vertex, unsigned int stage,
+			      const Cell& cell, Scratch& scratch)
 {
-  //Timer _timer_newton_solve("Implicit stage: Newton solve");
-  const Parameters& newton_solver_params = parameters("newton_solver");
-  const size_t report_vertex = newton_solver_params["report_vertex"];
-  const double kappa = newton_solver_params["kappa"];
-  const double rtol = newton_solver_params["relative_tolerance"];
-  const double atol = newton_solver_params["absolute_tolerance"];
-  std::size_t max_iterations = newton_solver_params["maximum_iterations"];
+  const NewtonParameters& params = _newton_parameters;
+  const size_t report_vertex = params.report_vertex;
+  const double kappa = params.kappa;
+  const double rtol = params.rtol;
+  const double atol = params.atol;
+  std::size_t max_iterations = params.max_iterations;
   const double max_relative_previous_residual
-    = newton_solver_params["max_relative_previous_residual"];
-  const double relaxation = newton_solver_params["relaxation_parameter"];
-  const bool report = newton_solver_params["report"];
-  const bool verbose_report = newton_solver_params["verbose_report"];
-  bool always_recompute_jacobian
-    = newton_solver_params["always_recompute_jacobian"];
+    = params.max_relative_previous_residual;
+  const double relaxation = params.relaxation;
+  const bool report = params.report;
+  const bool verbose_report = params.verbose_report;
+  bool always_recompute_jacobian = params.always_recompute_jacobian;
+  const std::size_t vert_ind = _owned_vertices[vertex];
   const unsigned int local_vert = _vertex_map[vert_ind].second;
-  UFC& loc_ufc_F = *_ufcs[stage][0];
-  UFC& loc_ufc_J = *_ufcs[stage][1];
+  const std::vector<std::size_t>& local_dofs = _local_to_local_dofs[local_vert];
+  UFC& loc_ufc_F = *scratch.ufcs[stage][0];
   const int coefficient_index_F = _coefficient_index[stage][0];
-  const int coefficient_index_J = _coefficient_index[stage].size()==2 ?
-    _coefficient_index[stage][1] : -1;
   const unsigned int jac_index = _scheme->jacobian_index(stage);
-  std::vector<double>& jac = _jacobians[jac_index];
+  std::vector<double>& jac = scratch.jacobians[jac_index];
+  double& eta = scratch.eta;
 
-  if (newton_solver_params["recompute_jacobian_each_solve"])
-    _recompute_jacobian[jac_index] = true;
+  // Recompute jacobian if asked to, or if the time step has changed
+  if (params.recompute_jacobian_each_solve
+      || scratch.jacobian_dt[jac_index] != scratch.dt)
+  {
+    scratch.recompute_jacobian[jac_index] = true;
+  }
 
   bool newton_solve_restared = false;
   unsigned int newton_iterations = 0;
@@ -632,32 +1104,30 @@ void PointIntegralSolver::_simplified_newton_solve(
   const ufc::point_integral& F_integral = *loc_ufc_F.default_point_integral;
 
   // Local solution
-  std::vector<double>& u = _local_stage_solutions[stage];
+  std::vector<double>& u = scratch.u;
 
   // Update with previous local solution and make a backup of solution
   // to be used in a potential restarting of newton solver
   for (unsigned int row=0; row < _system_size; row++)
   {
-    _u0[row] = u[row]
-      = loc_ufc_F.w()[coefficient_index_F][_local_to_local_dofs[row]];
+    scratch.u0[row] = u[row]
+      = loc_ufc_F.w()[coefficient_index_F][local_dofs[row]];
   }
 
   do
   {
     // Tabulate residual
-    Timer t_impl_tt_F("Implicit stage: tabulate_tensor (F)");
     F_integral.tabulate_tensor(loc_ufc_F.A.data(), loc_ufc_F.w(),
-			       vertex_coordinates.data(),
+			       scratch.vertex_coordinates.data(),
 			       local_vert,
-                               ufc_cell.orientation);
-    t_impl_tt_F.stop();
+                               scratch.ufc_cell.orientation);
 
     // Extract vertex dofs from tabulated tensor, together with the old stage
     // solution
     for (unsigned int row=0; row < _system_size; row++)
-      _residual[row] = loc_ufc_F.A[_local_to_local_dofs[row]];
+      scratch.residual[row] = loc_ufc_F.A[local_dofs[row]];
 
-    residual = _norm(_residual);
+    residual = _norm(scratch.residual);
     if (newton_iterations == 0)
       initial_residual = residual;//std::max(residual, DOLFIN_EPS);
 
@@ -670,16 +1140,15 @@ void PointIntegralSolver::_simplified_newton_solve(
       break;
 
     // Should we recompute jacobian
-    if (_recompute_jacobian[jac_index] || always_recompute_jacobian)
+    if (scratch.recompute_jacobian[jac_index] || always_recompute_jacobian)
     {
-      _compute_jacobian(jac, u, local_vert, loc_ufc_J, cell, ufc_cell,
-    			coefficient_index_J, vertex_coordinates);
-      _recompute_jacobian[jac_index] = false;
+      _compute_jacobian(jac, u, vertex, stage, cell, scratch);
+      scratch.recompute_jacobian[jac_index] = false;
     }
 
     // Perform linear solve By forward backward substitution
     //Timer forward_backward_substitution("Implicit stage: fb substitution");
-    _forward_backward_subst(jac, _residual, _dx);
+    _forward_backward_subst(jac, scratch.residual, scratch.dx);
     //forward_backward_substitution.stop();
 
     // Newton_Iterations == 0
@@ -689,8 +1158,8 @@ void PointIntegralSolver::_simplified_newton_solve(
       // the one from previous step and increase it slightly. This is
       // important for linear problems which only should require 1
       // iteration to converge.
-      _eta = _eta > DOLFIN_EPS ? _eta : DOLFIN_EPS;
-      _eta = std::pow(_eta, 0.8);
+      eta = eta > DOLFIN_EPS ? eta : DOLFIN_EPS;
+      eta = std::pow(eta, 0.8);
     }
     // 2nd time around
     else
@@ -735,12 +1204,12 @@ void PointIntegralSolver::_simplified_newton_solve(
 	  // Reset solution
 	  for (unsigned int row=0; row < _system_size; row++)
           {
-	    loc_ufc_F.w()[coefficient_index_F][_local_to_local_dofs[row]]
-              = u[row] = _u0[row];
+	    loc_ufc_F.w()[coefficient_index_F][local_dofs[row]]
+              = u[row] = scratch.u0[row];
           }
 
 	  // Update variables
-	  _eta = parameters("newton_solver")["eta_0"];
+	  eta = params.eta_0;
 	  newton_iterations = 0;
 	  relative_previous_residual = prev_residual = initial_residual
             = relative_residual = 1.0;
@@ -764,7 +1233,7 @@ void PointIntegralSolver::_simplified_newton_solve(
 	       newton_iterations, vert_ind, relative_previous_residual,
 	       relative_residual, residual);
         }
-	_recompute_jacobian[jac_index] = true;
+	scratch.recompute_jacobian[jac_index] = true;
       }
       else
       {
@@ -777,7 +1246,7 @@ void PointIntegralSolver::_simplified_newton_solve(
 	       relative_residual, residual);
         }
 	// Update eta
-	_eta = relative_previous_residual/(1.0 - relative_previous_residual);
+	eta = relative_previous_residual/(1.0 - relative_previous_residual);
       }
     }
 
@@ -797,20 +1266,20 @@ void PointIntegralSolver::_simplified_newton_solve(
     // Update solution
     if (std::abs(1.0 - relaxation) < DOLFIN_EPS)
       for (unsigned int i=0; i < u.size(); i++)
-	u[i] -= _dx[i];
+	u[i] -= scratch.dx[i];
     else
       for (unsigned int i=0; i < u.size(); i++)
-	u[i] -= relaxation*_dx[i];
+	u[i] -= relaxation*scratch.dx[i];
 
     // Put solution back into restricted coefficients before tabulate
     // new residual
     for (unsigned int row=0; row < _system_size; row++)
-      loc_ufc_F.w()[coefficient_index_F][_local_to_local_dofs[row]] = u[row];
+      loc_ufc_F.w()[coefficient_index_F][local_dofs[row]] = u[row];
 
     prev_residual = residual;
     newton_iterations++;
 
-  } while(_eta*relative_residual >= kappa*rtol);
+  } while(eta*relative_residual >= kappa*rtol);
 
   if ((report && vert_ind == report_vertex) || verbose_report)
   {
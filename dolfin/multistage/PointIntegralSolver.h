@@ -16,17 +16,21 @@
 // along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 //
 // First added:  2013-02-15
-// Last changed: 2014-10-01
+// Last changed: 2015-01-22
 
 #ifndef __POINTINTEGRALSOLVER_H
 #define __POINTINTEGRALSOLVER_H
 
 #include <memory>
 #include <set>
+#include <utility>
 #include <vector>
+#include <ufc.h>
 
 #include <dolfin/common/Variable.h>
 #include <dolfin/fem/Assembler.h>
+#include <dolfin/parameter/ParameterHandle.h>
+#include "TimeStepController.h"
 
 namespace dolfin
 {
@@ -35,8 +39,25 @@ namespace dolfin
   /// which only includes Point integrals with piecewise linear test
   /// functions. Such problems are disconnected at the vertices and
   /// can therefore be solved locally.
+  ///
+  /// The vertices are stepped in parallel (using the global
+  /// parameter "num_threads"), each thread with its own UFC objects
+  /// and Newton solver data. The stage solutions of the owned
+  /// vertices are kept in contiguous arrays, one for each stage, and
+  /// are written to the stage solution vectors once for each step.
+  ///
+  /// Schemes with an embedded error estimate may be stepped with an
+  /// adaptive time step (see step_interval_adaptive). By default the
+  /// global time step is adapted to the error over all vertices. With
+  /// the parameter "local_time_stepping" each vertex is instead
+  /// sub-stepped with its own time step, which is kept between
+  /// calls. Time-dependent coefficients which are not the time and
+  /// time step Constants of the scheme (e.g. Expressions with a time
+  /// parameter) are then evaluated at the start of the interval.
 
   // Forward declarations
+  class Cell;
+  class Form;
   class MultiStageScheme;
   class UFC;
 
@@ -58,6 +79,11 @@ namespace dolfin
     /// Step solver an interval using dt as time step
     void step_interval(double t0, double t1, double dt);
 
+    /// Step solver an interval with an adaptive time step, starting
+    /// with dt, and return the time step proposed for the next
+    /// step. Requires a scheme with an embedded error estimate.
+    double step_interval_adaptive(double t0, double t1, double dt);
+
     /// Return the MultiStageScheme
     std::shared_ptr<MultiStageScheme> scheme() const
     { return _scheme; }
@@ -68,6 +94,7 @@ namespace dolfin
       Parameters p("point_integral_solver");
 
       p.add("reset_stage_solutions", true);
+      p.add("local_time_stepping", false);
 
       // Set parameters for NewtonSolver
       Parameters pn("newton_solver");
@@ -89,21 +116,42 @@ namespace dolfin
 
       p.add(pn);
 
+      // Set parameters for adaptive time stepping
+      p.add(TimeStepController::default_parameters());
+
       return p;
     }
 
-    // Reset newton solver
+    /// Reset newton solver
     void reset_newton_solver();
 
-    // Reset stage solutions
+    /// Reset stage solutions
     void reset_stage_solutions();
 
-    // Return number of computations of jacobian
+    /// Return number of computations of jacobian
     std::size_t num_jacobian_computations() const
     {
       return _num_jacobian_computations;
     }
 
+    /// Return number of accepted adaptive (global) time steps
+    std::size_t num_accepted_steps() const
+    { return _num_accepted_steps; }
+
+    /// Return number of rejected adaptive (global) time steps
+    std::size_t num_rejected_steps() const
+    { return _num_rejected_steps; }
+
+    /// Return number of accepted local time steps, summed over the
+    /// vertices of this process
+    std::size_t num_accepted_local_steps() const
+    { return _num_accepted_local_steps; }
+
+    /// Return number of rejected local time steps, summed over the
+    /// vertices of this process
+    std::size_t num_rejected_local_steps() const
+    { return _num_rejected_local_steps; }
+
   private:
 
     // Convergence criteria for simplified Newton solver
@@ -117,8 +165,124 @@ namespace dolfin
 
     };
 
+    // Newton solver parameters, read once for each step
+    struct NewtonParameters
+    {
+      std::size_t report_vertex;
+      double kappa;
+      double rtol;
+      double atol;
+      std::size_t max_iterations;
+      double max_relative_previous_residual;
+      double relaxation;
+      bool report;
+      bool verbose_report;
+      bool always_recompute_jacobian;
+      bool recompute_jacobian_each_solve;
+      double eta_0;
+    };
+
+    // Handles to the parameters read for each step
+    struct ParameterHandles
+    {
+      ParameterHandles(const Parameters& parameters);
+
+      ParameterHandle<bool> reset_stage_solutions;
+      ParameterHandle<bool> reset_each_step;
+      ParameterHandle<std::size_t> report_vertex;
+      ParameterHandle<double> kappa;
+      ParameterHandle<double> rtol;
+      ParameterHandle<double> atol;
+      ParameterHandle<std::size_t> max_iterations;
+      ParameterHandle<double> max_relative_previous_residual;
+      ParameterHandle<double> relaxation;
+      ParameterHandle<bool> report;
+      ParameterHandle<bool> verbose_report;
+      ParameterHandle<bool> always_recompute_jacobian;
+      ParameterHandle<bool> recompute_jacobian_each_solve;
+      ParameterHandle<double> eta_0;
+      ParameterHandle<int> num_threads;
+    };
+
+    // Coefficients of a form which are set for each vertex: stage
+    // solutions or the solution (coefficient index, stage, where the
+    // solution is given by the number of stages), and the time and
+    // time step Constants of the scheme (coefficient indices). The
+    // other coefficients (coefficient index, space dimension) are
+    // restricted to the cell of each owned vertex before the
+    // vertices are stepped, with values stored by vertex, so that
+    // the threads do not access the coefficients.
+    struct VertexCoefficients
+    {
+      std::vector<std::pair<std::size_t, unsigned int> > functions;
+      std::vector<std::size_t> time;
+      std::vector<std::size_t> dt;
+      std::vector<std::pair<std::size_t, std::size_t> > restricted;
+      std::vector<bool> enabled;
+      std::size_t num_values;
+      std::vector<double> values;
+    };
+
+    // Data for stepping vertices, one for each thread
+    class Scratch
+    {
+    public:
+      Scratch(MultiStageScheme& scheme, std::size_t system_size,
+              std::size_t num_jacobians);
+      ~Scratch();
+
+      // UFC objects for each stage form, for the last stage form and
+      // for the error stage form (if any)
+      std::vector<std::vector<std::shared_ptr<UFC> > > ufcs;
+      std::shared_ptr<UFC> last_stage_ufc;
+      std::shared_ptr<UFC> error_stage_ufc;
+
+      // Time, time step and solution at start of the step of the
+      // current vertex
+      double t;
+      double dt;
+      std::vector<double> y0;
+
+      // Error estimate of the current vertex
+      std::vector<double> error;
+
+      // Cell data
+      ufc::cell ufc_cell;
+      std::vector<double> vertex_coordinates;
+
+      // Local solutions
+      std::vector<double> u;
+      std::vector<double> u0;
+      std::vector<double> residual;
+      std::vector<double> dx;
+
+      // Jacobians/LU factorized jacobians matrices
+      std::vector<std::vector<double> > jacobians;
+
+      // Flag which is set to false once the jacobian has been computed
+      std::vector<bool> recompute_jacobian;
+
+      // Time step for which the jacobians were computed
+      std::vector<double> jacobian_dt;
+
+      // Variable used in the estimation of the error of the newton
+      // iteration for the first iteration (important for linear
+      // problems!)
+      double eta;
+
+      // Number of computations of Jacobian since last step
+      std::size_t num_jacobian_computations;
+
+      // Sum of squared scaled errors since last step
+      double squared_error;
+
+      // Number of accepted and rejected local steps since last step
+      std::size_t num_accepted_local_steps;
+      std::size_t num_rejected_local_steps;
+    };
+
     // In-place LU factorization of jacobian matrix
-    void _lu_factorize(std::vector<double>& A);
+    void _lu_factorize(std::vector<double>& A) const;
 
     // Forward backward substitution, assume that mat is already
     // in place LU factorized
@@ -129,10 +293,8 @@ namespace dolfin
     // Compute jacobian using passed UFC form
     void _compute_jacobian(std::vector<double>& jac,
                            const std::vector<double>& u,
-			   unsigned int local_vert, UFC& loc_ufc,
-			   const Cell& cell, const ufc::cell& ufc_cell,
-			   int coefficient_index,
-			   const std::vector<double>& vertex_coordinates);
+			   std::size_t vertex, unsigned int stage,
+			   const Cell& cell, Scratch& scratch) const;
 
     // Compute the norm of a vector
     double _norm(const std::vector<double>& vec) const;
@@ -145,20 +307,60 @@ namespace dolfin
     // vertex and initialize UFC data for each form
     void _init();
 
+    // Create scratch data for each thread (if not already created)
+    void _init_scratch(std::size_t num_threads);
+
+    // Read parameters, prepare scratch data and gather stage
+    // solutions and solution of the owned vertices before a step
+    void _begin_step(double dt);
+
+    // Step all owned vertices, each from the time of the scheme with
+    // time step dt (global time stepping) or through the interval
+    // (t, t + dt) with its own time steps (local time stepping), and
+    // return the root mean square scaled error (if estimated)
+    double _step(double dt, bool estimate_error, bool local_time_stepping);
+
+    // Put stage solutions and solution into global vectors
+    void _end_step();
+
+    // Solve all stages and the last stage for an owned vertex, from
+    // the start values in the scratch data, and return the sum of the
+    // squared scaled errors if a controller is given
+    double _step_vertex(std::size_t vertex, Scratch& scratch,
+                        const TimeStepController* controller);
+
+    // Step an owned vertex through the interval (t, t + dt) of the
+    // scratch data with adaptive local time steps
+    void _step_vertex_local(std::size_t vertex, Scratch& scratch,
+                            const TimeStepController& controller);
+
+    // Put the (local) stage solutions, solution, time and time step of
+    // a vertex into the coefficients of a form
+    void _update_vertex_coefficients(UFC& ufc,
+                                     const VertexCoefficients& coefficients,
+                                     std::size_t vertex,
+                                     unsigned int local_vert,
+                                     const Scratch& scratch) const;
+
+    // Find the coefficients of a form which are set for each vertex
+    VertexCoefficients _vertex_coefficients(const Form& form) const;
+
+    // Restrict the coefficients of a form which are not set for each
+    // vertex to the cell of each owned vertex (not thread-safe)
+    void _restrict_vertex_coefficients(UFC& ufc,
+                                       VertexCoefficients& coefficients);
+
     // Solve an explicit stage
-    void _solve_explicit_stage(std::size_t vert_ind, unsigned int stage,
-                               const ufc::cell& ufc_cell,
-			       const std::vector<double>& vertex_coordinates);
+    void _solve_explicit_stage(std::size_t vertex, unsigned int stage,
+                               Scratch& scratch);
 
     // Solve an implicit stage
-    void _solve_implicit_stage(std::size_t vert_ind, unsigned int stage,
-			       const Cell& cell, const ufc::cell& ufc_cell,
-			       const std::vector<double>& vertex_coordinates);
+    void _solve_implicit_stage(std::size_t vertex, unsigned int stage,
+			       const Cell& cell, Scratch& scratch);
 
     void
-      _simplified_newton_solve(std::size_t vert_ind, unsigned int stage,
-                               const Cell& cell, const ufc::cell& ufc_cell,
-                               const std::vector<double>& vertex_coordinates);
+      _simplified_newton_solve(std::size_t vertex, unsigned int stage,
+                               const Cell& cell, Scratch& scratch);
 
     // The MultiStageScheme
     std::shared_ptr<MultiStageScheme> _scheme;
@@ -179,49 +381,64 @@ namespace dolfin
     // Number of stages
     const unsigned int _num_stages;
 
-    // Local to local dofs to be used in tabulate entity dofs
-    std::vector<std::size_t> _local_to_local_dofs;
+    // Local to local dofs for each local vertex of a cell, to be used
+    // in tabulate entity dofs
+    std::vector<std::vector<std::size_t> > _local_to_local_dofs;
 
     // Vertex map between vertices, cells and corresponding local
     // vertex
     std::vector<std::pair<std::size_t, unsigned int> > _vertex_map;
 
-    // Local to global dofs used when solution is fanned out to global
-    // vector
-    std::vector<dolfin::la_index> _local_to_global_dofs;
+    // Vertices which own all their dofs (the vertices which are
+    // stepped by this process)
+    std::vector<std::size_t> _owned_vertices;
+
+    // Local dofs of the owned vertices (_system_size for each
+    // vertex), used when solutions are fanned out to global vectors
+    std::vector<dolfin::la_index> _vertex_dofs;
 
-    // Local stage solutions
-    std::vector<std::vector<double> > _local_stage_solutions;
+    // Stage solutions of the owned vertices, for each stage
+    std::vector<std::vector<double> > _stage_values;
 
-    // Local solutions
-    std::vector<double> _u0;
-    std::vector<double> _residual;
-    std::vector<double> _y;
-    std::vector<double> _dx;
+    // Solutions of the owned vertices (from the last stage)
+    std::vector<double> _solution_values;
 
-    // UFC objects, one for each form
-    std::vector<std::vector<std::shared_ptr<UFC> > > _ufcs;
+    // Solutions of the owned vertices at the start of the step
+    std::vector<double> _initial_values;
 
-    // UFC objects for the last form
-    std::shared_ptr<UFC> _last_stage_ufc;
+    // Local time steps of the owned vertices (zero before the first
+    // local step)
+    std::vector<double> _vertex_dt;
+
+    // Coefficients of the stage forms, the last stage form and the
+    // error stage form which are set for each vertex
+    std::vector<std::vector<VertexCoefficients> > _stage_coefficients;
+    VertexCoefficients _last_stage_coefficients;
+    VertexCoefficients _error_stage_coefficients;
 
     // Solution coefficient index in form
     std::vector<std::vector<int> > _coefficient_index;
 
-    // Flag which is set to false once the jacobian has been computed
-    std::vector<bool> _recompute_jacobian;
+    // Number of distinct jacobians
+    std::size_t _num_jacobians;
 
-    // Jacobians/LU factorized jacobians matrices
-    std::vector<std::vector<double> > _jacobians;
+    // Scratch data for each thread
+    std::vector<std::shared_ptr<Scratch> > _scratch;
 
-    // Variable used in the estimation of the error of the newton
-    // iteration for the first iteration (important for linear
-    // problems!)
-    double _eta;
+    // Handles to parameters, and Newton solver parameters for the
+    // current step
+    ParameterHandles _parameter_handles;
+    NewtonParameters _newton_parameters;
 
     // Number of computations of Jacobian
     std::size_t _num_jacobian_computations;
 
+    // Number of accepted and rejected adaptive steps
+    std::size_t _num_accepted_steps;
+    std::size_t _num_rejected_steps;
+    std::size_t _num_accepted_local_steps;
+    std::size_t _num_rejected_local_steps;
+
   };
 
 }
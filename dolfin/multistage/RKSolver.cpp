@@ -16,11 +16,14 @@
 // along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 //
 // First added:  2013-02-15
-// Last changed: 2014-03-05
+// Last changed: 2015-01-22
 
+#include <algorithm>
 #include <cmath>
+#include <vector>
 
 #include <dolfin/log/log.h>
+#include <dolfin/common/MPI.h>
 #include <dolfin/function/Function.h>
 #include <dolfin/function/Constant.h>
 #include <dolfin/la/GenericVector.h>
@@ -35,21 +38,38 @@ using namespace dolfin;
 
 //-----------------------------------------------------------------------------
 RKSolver::RKSolver(std::shared_ptr<MultiStageScheme> scheme) :
-  _scheme(scheme), _tmp(scheme->solution()->vector()->copy())
+  Variable("RKSolver", "unnamed"), _scheme(scheme),
+  _tmp(scheme->solution()->vector()->copy()), _num_accepted_steps(0),
+  _num_rejected_steps(0)
 {
-  // Do nothing
+  // Set parameters
+  parameters = default_parameters();
+
+  if (_scheme->has_error_estimate())
+    _error_estimate = _tmp->copy();
 }
 //-----------------------------------------------------------------------------
 void RKSolver::step(double dt)
 {
   dolfin_assert(dt > 0.0);
 
-  // Update time constant of scheme
-  *_scheme->dt() = dt;
-
   // Time at start of timestep
   const double t0 = *_scheme->t();
 
+  _compute_stages(dt);
+
+  // Update solution with last stage
+  *_scheme->solution()->vector() = *_tmp;
+
+  // Update time
+  *_scheme->t() = t0 + dt;
+}
+//-----------------------------------------------------------------------------
+void RKSolver::_compute_stages(double dt)
+{
+  // Update time constant of scheme
+  *_scheme->dt() = dt;
+
   // Get scheme data
   std::vector<std::vector<std::shared_ptr<const Form> > >& stage_forms
     =  _scheme->stage_forms();
@@ -91,15 +111,91 @@ void RKSolver::step(double dt)
     }
   }
 
-  // Update solution with last stage
-  GenericVector& solution_vector = *_scheme->solution()->vector();
-
   // Do the last stage (just an assemble)
   _assembler.assemble(*_tmp, *_scheme->last_stage());
-  solution_vector = *_tmp;
+}
+//-----------------------------------------------------------------------------
+double RKSolver::_error(const TimeStepController& controller)
+{
+  // Assemble error estimate
+  _assembler.assemble(*_error_estimate, *_scheme->error_stage());
+
+  // Sum squared scaled errors of the local values
+  std::vector<double> e, u0, u1;
+  _error_estimate->get_local(e);
+  _scheme->solution()->vector()->get_local(u0);
+  _tmp->get_local(u1);
+  double squared_error = 0.0;
+  if (!e.empty())
+    squared_error = controller.squared_error(e.data(), u0.data(), u1.data(),
+                                             e.size());
+
+  // Root mean square over all processes
+  squared_error = MPI::sum(_tmp->mpi_comm(), squared_error);
+  return std::sqrt(squared_error/_tmp->size());
+}
+//-----------------------------------------------------------------------------
+double RKSolver::step_interval_adaptive(double t0, double t1, double dt)
+{
+  if (dt <= 0.0)
+  {
+    dolfin_error("RKSolver.cpp",
+		 "stepping RKSolver",
+		 "Expecting a positive dt");
+  }
 
-  // Update time
-  *_scheme->t() = t0 + dt;
+  if (t0 >= t1)
+  {
+    dolfin_error("RKSolver.cpp",
+		 "stepping RKSolver",
+		 "Expecting t0 to be smaller than t1");
+  }
+
+  if (!_scheme->has_error_estimate())
+  {
+    dolfin_error("RKSolver.cpp",
+		 "stepping RKSolver with adaptive time step",
+		 "Expecting a MultiStageScheme with an embedded error estimate");
+  }
+
+  const TimeStepController controller(parameters("time_step_controller"),
+                                      _scheme->order(),
+                                      _scheme->error_order());
+
+  // Set start time
+  *_scheme->t() = t0;
+  double t = t0;
+  while (true)
+  {
+    // Take the rest of the interval if it is (nearly) within reach,
+    // to avoid a tiny last step
+    const bool last_step = t + 1.01*dt >= t1;
+    const double step_dt = last_step ? t1 - t : dt;
+
+    _compute_stages(step_dt);
+    const double error = _error(controller);
+    const double next_dt = controller.next_dt(step_dt, error);
+
+    if (controller.accept(error))
+    {
+      *_scheme->solution()->vector() = *_tmp;
+      _num_accepted_steps++;
+      if (last_step)
+      {
+        *_scheme->t() = t1;
+
+        // A step shortened to end at t1 says little about the next
+        return std::max(dt, next_dt);
+      }
+
+      t += step_dt;
+      *_scheme->t() = t;
+    }
+    else
+      _num_rejected_steps++;
+
+    dt = next_dt;
+  }
 }
 //-----------------------------------------------------------------------------
 void RKSolver::step_interval(double t0, double t1, double dt)
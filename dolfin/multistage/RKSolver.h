@@ -16,7 +16,7 @@
 // along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 //
 // First added:  2013-02-15
-// Last changed: 2014-03-05
+// Last changed: 2015-01-22
 
 #ifndef __RKSOLVER_H
 #define __RKSOLVER_H
@@ -24,19 +24,23 @@
 #include <vector>
 #include <memory>
 
+#include <dolfin/common/Variable.h>
 #include <dolfin/function/FunctionAXPY.h>
 #include <dolfin/fem/Assembler.h>
 #include <dolfin/la/GenericVector.h>
+#include "TimeStepController.h"
 
 namespace dolfin
 {
 
-  /// This class is a time integrator for general Runge Kutta problems
+  /// This class is a time integrator for general Runge Kutta
+  /// problems. Schemes with an embedded error estimate may be stepped
+  /// with an adaptive time step (see step_interval_adaptive).
 
   // Forward declarations
   class MultiStageScheme;
 
-  class RKSolver
+  class RKSolver : public Variable
   {
   public:
 
@@ -50,12 +54,39 @@ namespace dolfin
     /// Step solver an interval using dt as time step
     void step_interval(double t0, double t1, double dt);
 
+    /// Step solver an interval with an adaptive time step, starting
+    /// with dt, and return the time step proposed for the next
+    /// step. Requires a scheme with an embedded error estimate.
+    double step_interval_adaptive(double t0, double t1, double dt);
+
     /// Return the MultiStageScheme
     std::shared_ptr<MultiStageScheme> scheme() const 
     {return _scheme;}
 
+    /// Return number of accepted adaptive time steps
+    std::size_t num_accepted_steps() const
+    { return _num_accepted_steps; }
+
+    /// Return number of rejected adaptive time steps
+    std::size_t num_rejected_steps() const
+    { return _num_rejected_steps; }
+
+    /// Default parameter values
+    static Parameters default_parameters()
+    {
+      Parameters p("rk_solver");
+      p.add(TimeStepController::default_parameters());
+      return p;
+    }
+
   private:
 
+    // Solve the stages and put the new solution into _tmp
+    void _compute_stages(double dt);
+
+    // Return the root mean square scaled error of the new solution
+    double _error(const TimeStepController& controller);
+
     // The MultiStageScheme
     std::shared_ptr<MultiStageScheme> _scheme;
 
@@ -63,9 +94,16 @@ namespace dolfin
     // FIXME: Add this as a Function called previous step or something
     std::shared_ptr<GenericVector> _tmp;
 
+    // Error estimate (if the scheme has one)
+    std::shared_ptr<GenericVector> _error_estimate;
+
     // Assembler for explicit stages
     Assembler _assembler;
 
+    // Number of accepted and rejected adaptive steps
+    std::size_t _num_accepted_steps;
+    std::size_t _num_rejected_steps;
+
   };
 
 }
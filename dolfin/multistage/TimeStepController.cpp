@@ -0,0 +1,89 @@
+// Copyright (C) 2015 The FEniCS Project
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2015-01-22
+// Last changed: 2015-01-22
+
+#include <algorithm>
+#include <cmath>
+
+#include <dolfin/log/log.h>
+#include "TimeStepController.h"
+
+using namespace dolfin;
+
+//-----------------------------------------------------------------------------
+TimeStepController::TimeStepController(const Parameters& parameters,
+                                       unsigned int order,
+                                       unsigned int error_order)
+{
+  _rtol = parameters["relative_tolerance"];
+  _atol = parameters["absolute_tolerance"];
+  _safety = parameters["safety_factor"];
+  _min_factor = parameters["minimum_factor"];
+  _max_factor = parameters["maximum_factor"];
+  _min_dt = parameters["minimum_time_step"];
+
+  if (_rtol == 0.0 && _atol == 0.0)
+  {
+    dolfin_error("TimeStepController.cpp",
+                 "create time step controller",
+                 "Expecting a positive relative or absolute tolerance");
+  }
+
+  _exponent = 1.0/(std::min(order, error_order) + 1.0);
+}
+//-----------------------------------------------------------------------------
+double TimeStepController::squared_error(const double* e, const double* u0,
+                                         const double* u1,
+                                         std::size_t n) const
+{
+  double sum = 0.0;
+  for (std::size_t i = 0; i < n; i++)
+  {
+    const double scale
+      = _atol + _rtol*std::max(std::abs(u0[i]), std::abs(u1[i]));
+    sum += (e[i]/scale)*(e[i]/scale);
+  }
+  return sum;
+}
+//-----------------------------------------------------------------------------
+double TimeStepController::next_dt(double dt, double error) const
+{
+  // Change time step by the factor which would have given the
+  // tolerance (with safety factor), within limits
+  double factor = _max_factor;
+  if (error > 0.0)
+    factor = _safety*std::pow(error, -_exponent);
+  factor = std::min(_max_factor, std::max(_min_factor, factor));
+
+  // Do not increase time step after a rejected step
+  if (error > 1.0)
+    factor = std::min(factor, 1.0);
+
+  const double new_dt = factor*dt;
+  if (new_dt < _min_dt)
+  {
+    dolfin_error("TimeStepController.cpp",
+                 "adapt time step",
+                 "Time step %g is smaller than the minimum time step %g",
+                 new_dt, _min_dt);
+  }
+
+  return new_dt;
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,100 @@
+// Copyright (C) 2015 The FEniCS Project
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2015-01-22
+// Last changed: 2015-01-22
+
+#ifndef __TIME_STEP_CONTROLLER_H
+#define __TIME_STEP_CONTROLLER_H
+
+#include <cstddef>
+#include <dolfin/parameter/Parameters.h>
+
+namespace dolfin
+{
+
+  /// This class implements time step control for multi-stage
+  /// schemes with an embedded error estimate e. The error of a step
+  /// from u0 to u1 is measured in the scaled root mean square norm
+  ///
+  ///   err = sqrt(1/n sum_i (e_i/(atol + rtol*max(|u0_i|, |u1_i|)))^2)
+  ///
+  /// and a step is accepted if err <= 1. The next time step (or the
+  /// time step of the next attempt) is
+  ///
+  ///   dt*min(max_factor, max(min_factor, safety*err^(-1/(q + 1))))
+  ///
+  /// where q is the lower of the orders of the scheme and of the
+  /// embedded scheme.
+
+  class TimeStepController
+  {
+  public:
+
+    /// Create controller for a scheme of given order with an
+    /// embedded scheme of given order
+    TimeStepController(const Parameters& parameters, unsigned int order,
+                       unsigned int error_order);
+
+    /// Default parameter values
+    static Parameters default_parameters()
+    {
+      Parameters p("time_step_controller");
+
+      p.add("relative_tolerance", 1e-6, 0.0, 1.0);
+      p.add("absolute_tolerance", 1e-8, 0.0, 1.0);
+      p.add("safety_factor", 0.9, 0.0, 1.0);
+      p.add("minimum_factor", 0.2, 0.0, 1.0);
+      p.add("maximum_factor", 5.0, 1.0, 1000.0);
+      p.add("minimum_time_step", 1e-12);
+
+      return p;
+    }
+
+    /// Return the sum of the squared scaled errors of n values with
+    /// error estimates e for a step from u0 to u1
+    double squared_error(const double* e, const double* u0, const double* u1,
+                         std::size_t n) const;
+
+    /// Return true if a step with the given (scaled) error is
+    /// accepted
+    bool accept(double error) const
+    { return error <= 1.0; }
+
+    /// Return the time step for the next step after a step of size
+    /// dt with the given (scaled) error
+    double next_dt(double dt, double error) const;
+
+  private:
+
+    // Tolerances
+    double _rtol, _atol;
+
+    // Limits of change in time step
+    double _safety, _min_factor, _max_factor;
+
+    // Smallest time step before giving up
+    double _min_dt;
+
+    // Exponent of the error in the time step update
+    double _exponent;
+
+  };
+
+}
+
+#endif
@@ -6,5 +6,6 @@
 #include <dolfin/multistage/MultiStageScheme.h>
 #include <dolfin/multistage/RKSolver.h>
 #include <dolfin/multistage/PointIntegralSolver.h>
+#include <dolfin/multistage/TimeStepController.h>
 
 #endif
@@ -18,7 +18,7 @@
 // Modified by Fredrik Valdmanis, 2011
 //
 // First added:  2009-07-02
-// Last changed: 2013-06-21
+// Last changed: 2015-01-22
 
 #ifndef __GLOBAL_PARAMETERS_H
 #define __GLOBAL_PARAMETERS_H
@@ -90,6 +90,17 @@ namespace dolfin
       p.add("ghost_mode", "none",
             {"shared_facet", "shared_vertex", "none"});
 
+      // Number of layers of ghost cells (if ghost_mode is not "none")
+      p.add("ghost_layers", 1, 1, 100);
+
+      // Distribution of built-in structured meshes (RectangleMesh,
+      // BoxMesh): generate a block of the mesh on each process, or
+      // build on process 0 and distribute using the mesh partitioner.
+      // With "blocks" (the default), "mesh_partitioner" does not
+      // apply to these meshes.
+      p.add("structured_mesh_partitioning", "blocks",
+            {"blocks", "partitioner"});
+
       // Mesh ordering via SCOTCH and GPS
       p.add("reorder_cells_gps", false);
       p.add("reorder_vertices_gps", false);
@@ -102,7 +113,8 @@ namespace dolfin
         #endif
       #endif
       p.add("mesh_partitioner", default_mesh_partitioner,
-            {"ParMETIS", "SCOTCH", "Zoltan_RCB", "Zoltan_PHG", "None"});
+            {"ParMETIS", "SCOTCH", "Zoltan_RCB", "Zoltan_PHG", "Hilbert",
+             "Morton", "None"});
 
       // Approaches to partitioning (following Zoltan syntax)
       // but applies to both Zoltan PHG and ParMETIS
@@ -140,6 +152,10 @@ namespace dolfin
       allowed_backends.insert("PETSc");
       default_backend = "PETSc";
       p.add("use_petsc_signal_handler", false);
+
+      // Allocate ghosted PETSc vectors in node-local shared memory
+      // (requires MPI-3)
+      p.add("petsc_shared_memory_ghosts", false);
       #endif
       #ifdef HAS_PETSC_CUSP
       allowed_backends.insert("PETScCusp");
@@ -19,7 +19,7 @@
 // Modified by Joachim B Haga 2012
 //
 // First added:  2009-05-08
-// Last changed: 2012-09-11
+// Last changed: 2015-01-22
 
 #include <sstream>
 #include <dolfin/log/log.h>
@@ -68,11 +68,6 @@ std::size_t Parameter::access_count() const
   return _access_count;
 }
 //-----------------------------------------------------------------------------
-std::size_t Parameter::change_count() const
-{
-  return _change_count;
-}
-//-----------------------------------------------------------------------------
 void Parameter::set_range(int min_value, int max_value)
 {
   dolfin_error("Parameter.cpp",
@@ -18,7 +18,7 @@
 // Modified by Joachim B Haga 2012
 //
 // First added:  2009-05-08
-// Last changed: 2012-09-11
+// Last changed: 2015-01-22
 
 #ifndef __PARAMETER_H
 #define __PARAMETER_H
@@ -58,7 +58,8 @@ namespace dolfin
     std::size_t access_count() const;
 
     /// Return change count (number of times parameter has been changed)
-    std::size_t change_count() const;
+    std::size_t change_count() const
+    { return _change_count; }
 
     /// Set range for int-valued parameter
     virtual void set_range(int min_value, int max_value);
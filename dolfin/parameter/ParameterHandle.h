@@ -0,0 +1,145 @@
+// Copyright (C) 2015 The FEniCS Project
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2015-01-22
+// Last changed: 2015-01-22
+
+#ifndef __PARAMETER_HANDLE_H
+#define __PARAMETER_HANDLE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <dolfin/log/log.h>
+#include "Parameter.h"
+#include "Parameters.h"
+
+namespace dolfin
+{
+
+  /// This class provides fast, typed access to a parameter for use in
+  /// hot code paths. The parameter is looked up by key when its value
+  /// is first accessed, and the pointer to the parameter and its value
+  /// are cached. The cached value is refreshed when the parameter
+  /// changes (see Parameter::change_count) and the lookup is repeated
+  /// when parameters are removed or parameter sets are reassigned
+  /// anywhere (see Parameters::structure_version), so that the handle
+  /// always returns the current value. Values accessed through handles
+  /// are not included in the access count of the parameter.
+  ///
+  /// Parameters in nested parameter sets are given by keys separated
+  /// by '.':
+  ///
+  ///   ParameterHandle<double> rtol(parameters,
+  ///                                "newton_solver.relative_tolerance");
+  ///   double r = rtol;
+  ///
+  /// The parameter set must outlive the handle. A handle may not be
+  /// accessed from several threads at the same time.
+
+  template <typename T>
+  class ParameterHandle
+  {
+  public:
+
+    /// Create handle to parameter with given key in parameter set
+    ParameterHandle(const Parameters& parameters, std::string key)
+      : _parameters(parameters), _key(key), _parameter(0),
+        _structure_version(0), _change_count(0), _value()
+    {
+      // Split key into keys of nested parameter sets and parameter
+      std::size_t start = 0;
+      std::size_t end = key.find('.');
+      while (end != std::string::npos)
+      {
+        _path.push_back(key.substr(start, end - start));
+        start = end + 1;
+        end = key.find('.', start);
+      }
+      _name = key.substr(start);
+    }
+
+    /// Return value of parameter
+    const T& value() const
+    {
+      if (!_parameter
+          || _structure_version != Parameters::structure_version()
+          || _change_count != _parameter->change_count())
+      {
+        _update();
+      }
+      return _value;
+    }
+
+    /// Cast to value of parameter
+    operator const T& () const
+    { return value(); }
+
+    /// Return key of parameter (relative to parameter set)
+    std::string key() const
+    { return _key; }
+
+  private:
+
+    // Look up parameter and read its value
+    void _update() const
+    {
+      if (!_parameter || _structure_version != Parameters::structure_version())
+      {
+        const Parameters* parameters = &_parameters;
+        for (std::size_t i = 0; i < _path.size(); i++)
+        {
+          parameters = parameters->find_parameter_set(_path[i]);
+          if (!parameters)
+            break;
+        }
+        _parameter = parameters ? parameters->find_parameter(_name) : 0;
+        if (!_parameter)
+        {
+          dolfin_error("ParameterHandle.h",
+                       "access parameter",
+                       "Parameter \"%s.%s\" not defined",
+                       _parameters.name().c_str(), _key.c_str());
+        }
+        _structure_version = Parameters::structure_version();
+      }
+
+      _change_count = _parameter->change_count();
+      _value = static_cast<T>(*_parameter);
+    }
+
+    // Parameter set
+    const Parameters& _parameters;
+
+    // Full key, keys of nested parameter sets and key of parameter
+    std::string _key;
+    std::vector<std::string> _path;
+    std::string _name;
+
+    // Cached parameter, and versions for which it is valid
+    mutable const Parameter* _parameter;
+    mutable std::size_t _structure_version;
+    mutable std::size_t _change_count;
+
+    // Cached value
+    mutable T _value;
+
+  };
+
+}
+
+#endif
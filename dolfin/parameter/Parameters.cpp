@@ -19,7 +19,7 @@
 // Modified by Garth N. Wells, 2009
 //
 // First added:  2009-05-08
-// Last changed: 2012-10-26
+// Last changed: 2015-01-22
 
 #include <sstream>
 #include <stdio.h>
@@ -73,6 +73,9 @@ void Parameters::rename(std::string key)
 //-----------------------------------------------------------------------------
 void Parameters::clear()
 {
+  // Invalidate cached pointers to parameters
+  _structure_version++;
+
   // Delete parameters
   for (parameter_iterator it = _parameters.begin(); it != _parameters.end();
        ++it)
@@ -250,6 +253,9 @@ void Parameters::remove(std::string key)
                  this->name().c_str(), key.c_str());
   }
 
+  // Invalidate cached pointers to parameters
+  _structure_version++;
+
   // Delete objects (safe to delete both even if only one is nonzero)
   delete find_parameter(key);
   delete find_parameter_set(key);
@@ -645,6 +651,8 @@ Parameters* Parameters::find_parameter_set(std::string key) const
   return p->second;
 }
 //-----------------------------------------------------------------------------
+std::atomic<std::size_t> Parameters::_structure_version(1);
+//-----------------------------------------------------------------------------
 namespace dolfin
 {
   Parameters empty_parameters("empty");
@@ -19,11 +19,12 @@
 // Modified by Garth N. Wells, 2009
 //
 // First added:  2009-05-08
-// Last changed: 2011-10-24
+// Last changed: 2015-01-22
 
 #ifndef __PARAMETERS_H
 #define __PARAMETERS_H
 
+#include <atomic>
 #include <set>
 #include <map>
 #include <vector>
@@ -216,6 +217,13 @@ namespace dolfin
     /// Return informal string representation (pretty-print)
     std::string str(bool verbose) const;
 
+    /// Return version of the structure of all parameter sets, which
+    /// is increased whenever parameters or parameter sets are removed
+    /// (e.g. by clear or assignment), so that pointers returned by
+    /// find_parameter may be cached (see ParameterHandle)
+    static std::size_t structure_version()
+    { return _structure_version.load(std::memory_order_relaxed); }
+
     // Return pointer to parameter for given key and 0 if not found
     Parameter* find_parameter(std::string key) const;
 
@@ -253,6 +261,9 @@ namespace dolfin
     // Map from key to parameter sets
     std::map<std::string, Parameters*> _parameter_sets;
 
+    // Version of the structure of all parameter sets
+    static std::atomic<std::size_t> _structure_version;
+
   };
 
   // Specialised templated for unset parameters
@@ -0,0 +1,796 @@
+// Copyright (C) 2015 The FEniCS Project
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2015-01-22
+// Last changed: 2015-01-22
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <dolfin/common/Array.h>
+#include <dolfin/common/MPI.h>
+#include <dolfin/common/Timer.h>
+#include <dolfin/fem/FiniteElement.h>
+#include <dolfin/fem/GenericDofMap.h>
+#include <dolfin/function/Function.h>
+#include <dolfin/function/FunctionSpace.h>
+#include <dolfin/geometry/Point.h>
+#include <dolfin/la/GenericVector.h>
+#include <dolfin/log/log.h>
+#include <dolfin/mesh/Cell.h>
+#include <dolfin/mesh/Edge.h>
+#include <dolfin/mesh/Facet.h>
+#include <dolfin/mesh/LocalMeshData.h>
+#include <dolfin/mesh/Mesh.h>
+#include <dolfin/mesh/MeshEditor.h>
+#include <dolfin/mesh/MeshFunction.h>
+#include <dolfin/mesh/MeshPartitioning.h>
+#include <dolfin/mesh/MeshQuality.h>
+#include <dolfin/mesh/Vertex.h>
+#include <dolfin/parameter/GlobalParameters.h>
+#include "ParallelCoarsening.h"
+
+using namespace dolfin;
+
+namespace
+{
+  // Compute signed volume and radius ratio (geometric dimension
+  // times inradius over circumradius) of triangle or tetrahedron
+  // with given vertex coordinates
+  double radius_ratio(const double* const* x, std::size_t tdim,
+                      double& volume)
+  {
+    if (tdim == 2)
+    {
+      volume = 0.5*((x[1][0] - x[0][0])*(x[2][1] - x[0][1])
+                    - (x[1][1] - x[0][1])*(x[2][0] - x[0][0]));
+      const double a = std::hypot(x[1][0] - x[2][0], x[1][1] - x[2][1]);
+      const double b = std::hypot(x[0][0] - x[2][0], x[0][1] - x[2][1]);
+      const double c = std::hypot(x[0][0] - x[1][0], x[0][1] - x[1][1]);
+      if (volume == 0.0)
+        return 0.0;
+      return 16.0*volume*volume/((a + b + c)*a*b*c);
+    }
+
+    // Edge vectors and lengths
+    double e[4][4][3];
+    double l[4][4];
+    for (std::size_t i = 0; i < 4; ++i)
+    {
+      for (std::size_t j = 0; j < 4; ++j)
+      {
+        for (std::size_t k = 0; k < 3; ++k)
+          e[i][j][k] = x[j][k] - x[i][k];
+        l[i][j] = std::sqrt(e[i][j][0]*e[i][j][0] + e[i][j][1]*e[i][j][1]
+                            + e[i][j][2]*e[i][j][2]);
+      }
+    }
+    volume = (e[0][1][0]*(e[0][2][1]*e[0][3][2] - e[0][2][2]*e[0][3][1])
+              - e[0][1][1]*(e[0][2][0]*e[0][3][2] - e[0][2][2]*e[0][3][0])
+              + e[0][1][2]*(e[0][2][0]*e[0][3][1] - e[0][2][1]*e[0][3][0]))/6.0;
+    if (volume == 0.0)
+      return 0.0;
+
+    // Sum of face areas
+    const std::size_t faces[4][3] = {{1, 2, 3}, {0, 2, 3}, {0, 1, 3},
+                                     {0, 1, 2}};
+    double area = 0.0;
+    for (std::size_t f = 0; f < 4; ++f)
+    {
+      const double* u = e[faces[f][0]][faces[f][1]];
+      const double* v = e[faces[f][0]][faces[f][2]];
+      const double n0 = u[1]*v[2] - u[2]*v[1];
+      const double n1 = u[2]*v[0] - u[0]*v[2];
+      const double n2 = u[0]*v[1] - u[1]*v[0];
+      area += 0.5*std::sqrt(n0*n0 + n1*n1 + n2*n2);
+    }
+
+    // Inradius and circumradius
+    const double V = std::abs(volume);
+    const double r = 3.0*V/area;
+    const double la = l[0][1]*l[2][3];
+    const double lb = l[0][2]*l[1][3];
+    const double lc = l[0][3]*l[1][2];
+    const double s = (la + lb + lc)*(la + lb - lc)*(la - lb + lc)
+      *(-la + lb + lc);
+    const double R = std::sqrt(std::max(s, 0.0))/(24.0*V);
+    return 3.0*r/R;
+  }
+
+  // Function which evaluates a function on the original mesh at
+  // points in a cell of the coarsened mesh, by searching the parent
+  // cell and the cells around its vertices
+  class ParentFunction : public ufc::function
+  {
+  public:
+
+    ParentFunction(const Function& function)
+      : _function(function), _mesh(*function.function_space()->mesh()),
+        _value_size(function.value_size())
+    {
+      _mesh.init(0, _mesh.topology().dim());
+    }
+
+    void set_parent(std::size_t parent)
+    {
+      _cells.clear();
+      const Cell cell(_mesh, parent);
+      _cells.push_back(parent);
+      for (VertexIterator v(cell); !v.end(); ++v)
+        for (CellIterator c(*v); !c.end(); ++c)
+          if (c->index() != parent)
+            _cells.push_back(c->index());
+    }
+
+    void evaluate(double* values, const double* coordinates,
+                  const ufc::cell& c) const
+    {
+      // Find closest cell (containing point if distance is zero)
+      const std::size_t gdim = _mesh.geometry().dim();
+      const Point point(gdim, coordinates);
+      std::size_t closest = _cells[0];
+      double min_distance = std::numeric_limits<double>::max();
+      for (std::size_t i = 0; i < _cells.size(); ++i)
+      {
+        const double distance = Cell(_mesh, _cells[i]).distance(point);
+        if (distance < min_distance)
+        {
+          min_distance = distance;
+          closest = _cells[i];
+        }
+        if (distance == 0.0)
+          break;
+      }
+
+      const Cell cell(_mesh, closest);
+      cell.get_cell_data(_ufc_cell);
+      Array<double> _values(_value_size, values);
+      const Array<double> x(gdim, const_cast<double*>(coordinates));
+      _function.eval(_values, x, cell, _ufc_cell);
+    }
+
+  private:
+
+    const Function& _function;
+    const Mesh& _mesh;
+    const std::size_t _value_size;
+
+    // Candidate cells
+    std::vector<std::size_t> _cells;
+
+    mutable ufc::cell _ufc_cell;
+
+  };
+}
+
+//-----------------------------------------------------------------------------
+void ParallelCoarsening::coarsen(Mesh& new_mesh, const Mesh& mesh,
+                                 const MeshFunction<bool>& cell_markers,
+                                 double min_quality)
+{
+  Timer timer("Parallel coarsening");
+
+  const std::size_t tdim = mesh.topology().dim();
+  if (mesh.type().cell_type() != CellType::triangle
+      && mesh.type().cell_type() != CellType::tetrahedron)
+  {
+    dolfin_error("ParallelCoarsening.cpp",
+                 "coarsen mesh",
+                 "Only triangle and tetrahedron meshes are supported");
+  }
+  if (mesh.geometry().dim() != tdim)
+  {
+    dolfin_error("ParallelCoarsening.cpp",
+                 "coarsen mesh",
+                 "Geometric dimension (%d) must equal topological dimension (%d)",
+                 mesh.geometry().dim(), tdim);
+  }
+  if (cell_markers.dim() != tdim)
+  {
+    dolfin_error("ParallelCoarsening.cpp",
+                 "coarsen mesh",
+                 "Markers must be defined on cells (dimension %d), not entities of dimension %d",
+                 tdim, cell_markers.dim());
+  }
+  const std::string ghost_mode = parameters["ghost_mode"];
+  if (mesh.topology().ghost_offset(tdim) != mesh.num_cells()
+      || (MPI::size(mesh.mpi_comm()) > 1 && ghost_mode != "none"))
+  {
+    dolfin_error("ParallelCoarsening.cpp",
+                 "coarsen mesh",
+                 "Coarsening of meshes with ghost cells is not supported. Set parameter \"ghost_mode\" to \"none\"");
+  }
+
+  std::vector<std::size_t> targets;
+  compute_collapses(targets, mesh, cell_markers, min_quality);
+  select_collapses(targets, mesh);
+  build(new_mesh, mesh, targets);
+}
+//-----------------------------------------------------------------------------
+void ParallelCoarsening::transfer(Function& new_function,
+                                  const Function& function)
+{
+  dolfin_assert(new_function.function_space());
+  const FunctionSpace& V = *new_function.function_space();
+  const Mesh& new_mesh = *V.mesh();
+  const std::size_t tdim = new_mesh.topology().dim();
+
+  if (!new_mesh.data().exists("parent_cell", tdim)
+      || new_mesh.data().array("parent_cell", tdim).size()
+         != new_mesh.num_cells())
+  {
+    dolfin_error("ParallelCoarsening.cpp",
+                 "transfer function to coarsened mesh",
+                 "Mesh has no parent cell data (it must be created by ParallelCoarsening)");
+  }
+  if (new_function.value_size() != function.value_size())
+  {
+    dolfin_error("ParallelCoarsening.cpp",
+                 "transfer function to coarsened mesh",
+                 "Value size of function (%d) does not match value size of function space (%d)",
+                 function.value_size(), new_function.value_size());
+  }
+  const std::vector<std::size_t>& parent_cell
+    = new_mesh.data().array("parent_cell", tdim);
+
+  const FiniteElement& element = *V.element();
+  const GenericDofMap& dofmap = *V.dofmap();
+  GenericVector& x = *new_function.vector();
+  x.zero();
+
+  // Evaluate dofs of each cell from the function on the original
+  // mesh near the parent cell
+  ParentFunction f(function);
+  std::vector<double> cell_coefficients(dofmap.max_cell_dimension());
+  std::vector<double> vertex_coordinates;
+  ufc::cell ufc_cell;
+  for (CellIterator cell(new_mesh); !cell.end(); ++cell)
+  {
+    dolfin_assert(parent_cell[cell->index()]
+                  < function.function_space()->mesh()->num_cells());
+    f.set_parent(parent_cell[cell->index()]);
+
+    cell->get_vertex_coordinates(vertex_coordinates);
+    cell->get_cell_data(ufc_cell);
+    element.evaluate_dofs(cell_coefficients.data(), f,
+                          vertex_coordinates.data(), ufc_cell.orientation,
+                          ufc_cell);
+
+    const std::vector<dolfin::la_index>& cell_dofs
+      = dofmap.cell_dofs(cell->index());
+    x.set_local(cell_coefficients.data(), dofmap.cell_dimension(cell->index()),
+                cell_dofs.data());
+  }
+  x.apply("insert");
+}
+//-----------------------------------------------------------------------------
+void ParallelCoarsening::compute_collapses(std::vector<std::size_t>& targets,
+                                   const Mesh& mesh,
+                                   const MeshFunction<bool>& cell_markers,
+                                   double min_quality)
+{
+  const MPI_Comm mpi_comm = mesh.mpi_comm();
+  const std::size_t num_processes = MPI::size(mpi_comm);
+  const std::size_t tdim = mesh.topology().dim();
+  const std::size_t num_vertices = mesh.num_vertices();
+  const std::size_t none = std::numeric_limits<std::size_t>::max();
+
+  // Never make the worst cell of the mesh worse than it is
+  const double quality_bound
+    = std::min(min_quality, MeshQuality::radius_ratio_min_max(mesh).first);
+
+  mesh.init(1);
+  mesh.init(0, 1);
+  mesh.init(0, tdim);
+  mesh.init(tdim - 1);
+  mesh.init(tdim - 1, tdim);
+
+  // A vertex may be removed if all its cells are marked and it is
+  // not on the boundary
+  std::vector<bool> candidate(num_vertices, true);
+  for (CellIterator cell(mesh); !cell.end(); ++cell)
+  {
+    if (!cell_markers[*cell])
+      for (VertexIterator v(*cell); !v.end(); ++v)
+        candidate[v->index()] = false;
+  }
+  for (FacetIterator facet(mesh); !facet.end(); ++facet)
+  {
+    if (facet->exterior())
+      for (VertexIterator v(*facet); !v.end(); ++v)
+        candidate[v->index()] = false;
+  }
+  reduce_shared_flags(mesh, candidate, true);
+
+  // Compute quality of local cells after collapsing each candidate
+  // vertex v onto each neighbour w (negative if a cell is inverted)
+  std::vector<std::vector<std::pair<std::size_t, double> > >
+    qualities(num_vertices);
+  std::vector<const double*> x(tdim + 1);
+  for (VertexIterator v(mesh); !v.end(); ++v)
+  {
+    if (!candidate[v->index()])
+      continue;
+
+    for (EdgeIterator e(*v); !e.end(); ++e)
+    {
+      const unsigned int* edge_vertices = e->entities(0);
+      const std::size_t w = edge_vertices[0] == v->index()
+        ? edge_vertices[1] : edge_vertices[0];
+
+      double quality = 1.0;
+      for (CellIterator cell(*v); !cell.end(); ++cell)
+      {
+        const unsigned int* cell_vertices = cell->entities(0);
+        if (std::find(cell_vertices, cell_vertices + tdim + 1, w)
+            != cell_vertices + tdim + 1)
+        {
+          continue;
+        }
+
+        double old_volume = 0.0;
+        double new_volume = 0.0;
+        for (std::size_t i = 0; i <= tdim; ++i)
+          x[i] = mesh.geometry().x(cell_vertices[i]);
+        radius_ratio(x.data(), tdim, old_volume);
+        for (std::size_t i = 0; i <= tdim; ++i)
+          if (cell_vertices[i] == v->index())
+            x[i] = mesh.geometry().x(w);
+        const double q = radius_ratio(x.data(), tdim, new_volume);
+        if (old_volume*new_volume <= 0.0)
+          quality = -1.0;
+        else
+          quality = std::min(quality, q);
+      }
+      qualities[v->index()].push_back(std::make_pair(w, quality));
+    }
+  }
+
+  // Send qualities of shared candidates to the other processes
+  // sharing them, as (vertex, neighbour) global indices and quality
+  const std::vector<std::size_t>& global_indices
+    = mesh.topology().global_indices(0);
+  const std::map<unsigned int, std::set<unsigned int> >& shared_vertices
+    = mesh.topology().shared_entities(0);
+  std::unordered_map<std::size_t, std::size_t> global_to_local;
+  for (auto it = shared_vertices.begin(); it != shared_vertices.end(); ++it)
+    global_to_local[global_indices[it->first]] = it->first;
+
+  std::vector<std::vector<std::size_t> > send_indices(num_processes);
+  std::vector<std::vector<double> > send_qualities(num_processes);
+  for (auto it = shared_vertices.begin(); it != shared_vertices.end(); ++it)
+  {
+    const std::size_t v = it->first;
+    if (!candidate[v])
+      continue;
+    for (auto p = it->second.begin(); p != it->second.end(); ++p)
+    {
+      for (auto q = qualities[v].begin(); q != qualities[v].end(); ++q)
+      {
+        send_indices[*p].push_back(global_indices[v]);
+        send_indices[*p].push_back(global_indices[q->first]);
+        send_qualities[*p].push_back(q->second);
+      }
+    }
+  }
+  std::vector<std::vector<std::size_t> > received_indices;
+  std::vector<std::vector<double> > received_qualities;
+  MPI::all_to_all(mpi_comm, send_indices, received_indices);
+  MPI::all_to_all(mpi_comm, send_qualities, received_qualities);
+
+  // Count processes reporting each collapse of a shared vertex, and
+  // take the worst quality
+  std::vector<std::vector<std::size_t> > num_reports(num_vertices);
+  for (std::size_t v = 0; v < num_vertices; ++v)
+    num_reports[v].assign(qualities[v].size(), 1);
+  for (std::size_t p = 0; p < num_processes; ++p)
+  {
+    for (std::size_t i = 0; i < received_qualities[p].size(); ++i)
+    {
+      auto v = global_to_local.find(received_indices[p][2*i]);
+      auto w = global_to_local.find(received_indices[p][2*i + 1]);
+      if (v == global_to_local.end() || w == global_to_local.end())
+        continue;
+      std::vector<std::pair<std::size_t, double> >& q = qualities[v->second];
+      for (std::size_t j = 0; j < q.size(); ++j)
+      {
+        if (q[j].first == w->second)
+        {
+          q[j].second = std::min(q[j].second, received_qualities[p][i]);
+          ++num_reports[v->second][j];
+        }
+      }
+    }
+  }
+
+  // Choose the collapse giving the best cells, among those which
+  // all processes sharing the vertex can perform
+  targets.assign(num_vertices, none);
+  for (std::size_t v = 0; v < num_vertices; ++v)
+  {
+    if (!candidate[v])
+      continue;
+
+    auto shared = shared_vertices.find(v);
+    const std::size_t num_sharing = shared == shared_vertices.end()
+      ? 1 : shared->second.size() + 1;
+
+    double best_quality = 0.0;
+    for (std::size_t j = 0; j < qualities[v].size(); ++j)
+    {
+      const std::size_t w = qualities[v][j].first;
+      const double q = qualities[v][j].second;
+      if (num_reports[v][j] != num_sharing || q < quality_bound)
+        continue;
+
+      if (targets[v] == none || q > best_quality
+          || (q == best_quality
+              && global_indices[w] < global_indices[targets[v]]))
+      {
+        best_quality = q;
+        targets[v] = w;
+      }
+    }
+  }
+}
+//-----------------------------------------------------------------------------
+void ParallelCoarsening::select_collapses(std::vector<std::size_t>& targets,
+                                          const Mesh& mesh)
+{
+  const std::size_t num_vertices = mesh.num_vertices();
+  const std::size_t none = std::numeric_limits<std::size_t>::max();
+  const std::vector<std::size_t>& global_indices
+    = mesh.topology().global_indices(0);
+
+  // Order collapses by edge length (and global vertex index), which
+  // is the same on all processes
+  std::vector<std::pair<double, std::size_t> > keys(num_vertices);
+  std::vector<bool> active(num_vertices, false);
+  for (std::size_t v = 0; v < num_vertices; ++v)
+  {
+    if (targets[v] == none)
+      continue;
+    active[v] = true;
+    keys[v] = std::make_pair(Vertex(mesh, v).point().distance(
+                               Vertex(mesh, targets[v]).point()),
+                             global_indices[v]);
+  }
+
+  // Select vertices whose key is smaller than the keys of all active
+  // neighbours, and deactivate their neighbours, until no active
+  // vertices remain
+  std::vector<bool> selected(num_vertices, false);
+  while (true)
+  {
+    std::vector<bool> minimum(active);
+    for (std::size_t v = 0; v < num_vertices; ++v)
+    {
+      if (!active[v])
+        continue;
+      for (EdgeIterator e(Vertex(mesh, v)); !e.end(); ++e)
+      {
+        const unsigned int* edge_vertices = e->entities(0);
+        const std::size_t u
+          = edge_vertices[0] == v ? edge_vertices[1] : edge_vertices[0];
+        if (active[u] && keys[u] < keys[v])
+        {
+          minimum[v] = false;
+          break;
+        }
+      }
+    }
+    reduce_shared_flags(mesh, minimum, true);
+
+    std::vector<bool> blocked(num_vertices, false);
+    for (std::size_t v = 0; v < num_vertices; ++v)
+    {
+      if (!minimum[v])
+        continue;
+      selected[v] = true;
+      active[v] = false;
+      for (EdgeIterator e(Vertex(mesh, v)); !e.end(); ++e)
+      {
+        const unsigned int* edge_vertices = e->entities(0);
+        const std::size_t u
+          = edge_vertices[0] == v ? edge_vertices[1] : edge_vertices[0];
+        blocked[u] = true;
+      }
+    }
+    reduce_shared_flags(mesh, blocked, false);
+
+    std::size_t num_active = 0;
+    for (std::size_t v = 0; v < num_vertices; ++v)
+    {
+      if (blocked[v])
+        active[v] = false;
+      if (active[v])
+        ++num_active;
+    }
+    if (MPI::sum(mesh.mpi_comm(), num_active) == 0)
+      break;
+  }
+
+  for (std::size_t v = 0; v < num_vertices; ++v)
+    if (!selected[v])
+      targets[v] = none;
+}
+//-----------------------------------------------------------------------------
+void ParallelCoarsening::build(Mesh& new_mesh, const Mesh& mesh,
+                               const std::vector<std::size_t>& targets)
+{
+  const MPI_Comm mpi_comm = mesh.mpi_comm();
+  const std::size_t process_number = MPI::rank(mpi_comm);
+  const std::size_t num_processes = MPI::size(mpi_comm);
+  const std::size_t tdim = mesh.topology().dim();
+  const std::size_t gdim = mesh.geometry().dim();
+  const std::size_t num_vertices = mesh.num_vertices();
+  const std::size_t num_cell_vertices = tdim + 1;
+  const std::size_t none = std::numeric_limits<std::size_t>::max();
+
+  // Cells which remain, with collapsed vertices replaced (as local
+  // vertex indices of the original mesh)
+  std::vector<std::size_t> parent_cell;
+  std::vector<std::size_t> cell_vertices;
+  for (CellIterator cell(mesh); !cell.end(); ++cell)
+  {
+    const unsigned int* v = cell->entities(0);
+    bool collapsed = false;
+    for (std::size_t i = 0; i < num_cell_vertices; ++i)
+    {
+      const std::size_t w = targets[v[i]];
+      if (w != none
+          && std::find(v, v + num_cell_vertices, w) != v + num_cell_vertices)
+      {
+        collapsed = true;
+      }
+    }
+    if (collapsed)
+      continue;
+
+    parent_cell.push_back(cell->index());
+    for (std::size_t i = 0; i < num_cell_vertices; ++i)
+      cell_vertices.push_back(targets[v[i]] == none ? v[i] : targets[v[i]]);
+  }
+  const std::size_t num_cells = parent_cell.size();
+
+  if (num_processes == 1)
+  {
+    // Number remaining vertices in order
+    std::vector<std::size_t> parent_vertex;
+    std::vector<unsigned int> new_index(num_vertices);
+    std::vector<double> x;
+    for (std::size_t v = 0; v < num_vertices; ++v)
+    {
+      if (targets[v] != none)
+        continue;
+      new_index[v] = parent_vertex.size();
+      parent_vertex.push_back(v);
+      x.insert(x.end(), mesh.geometry().x(v), mesh.geometry().x(v) + gdim);
+    }
+    std::vector<unsigned int> cells(cell_vertices.size());
+    for (std::size_t i = 0; i < cell_vertices.size(); ++i)
+      cells[i] = new_index[cell_vertices[i]];
+
+    MeshEditor editor;
+    editor.open(new_mesh, tdim, gdim);
+    editor.set_vertices(x);
+    editor.set_cells(cells);
+    editor.close();
+
+    new_mesh.data().create_array("parent_cell", tdim) = parent_cell;
+    new_mesh.data().create_array("parent_vertex", 0) = parent_vertex;
+    return;
+  }
+
+  // Number remaining vertices owned by this process (the lowest
+  // ranked sharing process owns a shared vertex) and send numbers of
+  // shared vertices to the other sharing processes
+  const std::vector<std::size_t>& global_indices
+    = mesh.topology().global_indices(0);
+  const std::map<unsigned int, std::set<unsigned int> >& shared_vertices
+    = mesh.topology().shared_entities(0);
+  std::vector<bool> owned(num_vertices, true);
+  for (auto it = shared_vertices.begin(); it != shared_vertices.end(); ++it)
+    owned[it->first] = *it->second.begin() > process_number;
+
+  std::size_t num_owned = 0;
+  for (std::size_t v = 0; v < num_vertices; ++v)
+    if (owned[v] && targets[v] == none)
+      ++num_owned;
+  const std::size_t vertex_offset
+    = MPI::global_offset(mpi_comm, num_owned, true);
+  const std::size_t num_global_vertices = MPI::sum(mpi_comm, num_owned);
+
+  std::vector<std::size_t> new_global_index(num_vertices, none);
+  std::size_t n = vertex_offset;
+  for (std::size_t v = 0; v < num_vertices; ++v)
+    if (owned[v] && targets[v] == none)
+      new_global_index[v] = n++;
+
+  std::vector<std::vector<std::size_t> > send_indices(num_processes);
+  for (auto it = shared_vertices.begin(); it != shared_vertices.end(); ++it)
+  {
+    const std::size_t v = it->first;
+    if (!owned[v] || targets[v] != none)
+      continue;
+    for (auto p = it->second.begin(); p != it->second.end(); ++p)
+    {
+      send_indices[*p].push_back(global_indices[v]);
+      send_indices[*p].push_back(new_global_index[v]);
+    }
+  }
+  std::vector<std::vector<std::size_t> > received_indices;
+  MPI::all_to_all(mpi_comm, send_indices, received_indices);
+
+  std::unordered_map<std::size_t, std::size_t> global_to_local;
+  for (auto it = shared_vertices.begin(); it != shared_vertices.end(); ++it)
+    global_to_local[global_indices[it->first]] = it->first;
+  for (std::size_t p = 0; p < num_processes; ++p)
+  {
+    for (std::size_t i = 0; i < received_indices[p].size(); i += 2)
+    {
+      auto v = global_to_local.find(received_indices[p][i]);
+      dolfin_assert(v != global_to_local.end());
+      new_global_index[v->second] = received_indices[p][i + 1];
+    }
+  }
+
+  // Create local mesh data, keeping cells on this process
+  LocalMeshData local_data(mpi_comm);
+  local_data.gdim = gdim;
+  local_data.tdim = tdim;
+  local_data.num_global_vertices = num_global_vertices;
+  local_data.num_global_cells = MPI::sum(mpi_comm, num_cells);
+  local_data.num_vertices_per_cell = num_cell_vertices;
+
+  const std::size_t cell_offset = MPI::global_offset(mpi_comm, num_cells,
+                                                     true);
+  local_data.cell_vertices.resize(boost::extents[num_cells][num_cell_vertices]);
+  local_data.global_cell_indices.resize(num_cells);
+  for (std::size_t i = 0; i < num_cells; ++i)
+  {
+    local_data.global_cell_indices[i] = cell_offset + i;
+    for (std::size_t j = 0; j < num_cell_vertices; ++j)
+    {
+      local_data.cell_vertices[i][j]
+        = new_global_index[cell_vertices[i*num_cell_vertices + j]];
+      dolfin_assert(local_data.cell_vertices[i][j] != none);
+    }
+  }
+  local_data.cell_partition.assign(num_cells, process_number);
+
+  // Send coordinates of owned vertices to the process that holds
+  // the block of global vertex indices they belong to
+  std::vector<std::vector<std::size_t> > send_vertex_indices(num_processes);
+  std::vector<std::vector<double> > send_vertex_coordinates(num_processes);
+  for (std::size_t v = 0; v < num_vertices; ++v)
+  {
+    if (!owned[v] || targets[v] != none)
+      continue;
+    const std::size_t dest = MPI::index_owner(mpi_comm, new_global_index[v],
+                                              num_global_vertices);
+    send_vertex_indices[dest].push_back(new_global_index[v]);
+    send_vertex_coordinates[dest].insert(send_vertex_coordinates[dest].end(),
+                                         mesh.geometry().x(v),
+                                         mesh.geometry().x(v) + gdim);
+  }
+  std::vector<std::vector<std::size_t> > received_vertex_indices;
+  std::vector<std::vector<double> > received_vertex_coordinates;
+  MPI::all_to_all(mpi_comm, send_vertex_indices, received_vertex_indices);
+  MPI::all_to_all(mpi_comm, send_vertex_coordinates,
+                  received_vertex_coordinates);
+
+  const std::pair<std::size_t, std::size_t> vertex_range
+    = MPI::local_range(mpi_comm, num_global_vertices);
+  const std::size_t num_local_vertices
+    = vertex_range.second - vertex_range.first;
+  local_data.vertex_coordinates.resize(boost::extents[num_local_vertices][gdim]);
+  local_data.vertex_indices.resize(num_local_vertices);
+  for (std::size_t i = 0; i < num_local_vertices; ++i)
+    local_data.vertex_indices[i] = vertex_range.first + i;
+  for (std::size_t p = 0; p < num_processes; ++p)
+  {
+    for (std::size_t i = 0; i < received_vertex_indices[p].size(); ++i)
+    {
+      const std::size_t local_index
+        = received_vertex_indices[p][i] - vertex_range.first;
+      dolfin_assert(local_index < num_local_vertices);
+      std::copy(received_vertex_coordinates[p].begin() + i*gdim,
+                received_vertex_coordinates[p].begin() + (i + 1)*gdim,
+                local_data.vertex_coordinates[local_index].begin());
+    }
+  }
+
+  MeshPartitioning::build_distributed_mesh(new_mesh, local_data);
+
+  // Attach parent cells and vertices, found from the global indices
+  // of the new mesh
+  std::unordered_map<std::size_t, std::size_t> new_global_to_local;
+  for (std::size_t v = 0; v < num_vertices; ++v)
+    if (new_global_index[v] != none)
+      new_global_to_local[new_global_index[v]] = v;
+
+  const std::vector<std::size_t>& new_cell_indices
+    = new_mesh.topology().global_indices(tdim);
+  std::vector<std::size_t>& new_parent_cell
+    = new_mesh.data().create_array("parent_cell", tdim);
+  new_parent_cell.resize(new_mesh.num_cells());
+  for (std::size_t c = 0; c < new_mesh.num_cells(); ++c)
+  {
+    dolfin_assert(new_cell_indices[c] >= cell_offset
+                  && new_cell_indices[c] < cell_offset + num_cells);
+    new_parent_cell[c] = parent_cell[new_cell_indices[c] - cell_offset];
+  }
+
+  const std::vector<std::size_t>& new_vertex_indices
+    = new_mesh.topology().global_indices(0);
+  std::vector<std::size_t>& new_parent_vertex
+    = new_mesh.data().create_array("parent_vertex", 0);
+  new_parent_vertex.resize(new_mesh.num_vertices());
+  for (std::size_t v = 0; v < new_mesh.num_vertices(); ++v)
+  {
+    auto it = new_global_to_local.find(new_vertex_indices[v]);
+    dolfin_assert(it != new_global_to_local.end());
+    new_parent_vertex[v] = it->second;
+  }
+}
+//-----------------------------------------------------------------------------
+void ParallelCoarsening::reduce_shared_flags(const Mesh& mesh,
+                                             std::vector<bool>& flags,
+                                             bool all)
+{
+  const MPI_Comm mpi_comm = mesh.mpi_comm();
+  const std::size_t num_processes = MPI::size(mpi_comm);
+  if (num_processes == 1)
+    return;
+
+  // Send global indices of shared vertices whose flag differs from
+  // the neutral value of the operation
+  const std::vector<std::size_t>& global_indices
+    = mesh.topology().global_indices(0);
+  const std::map<unsigned int, std::set<unsigned int> >& shared_vertices
+    = mesh.topology().shared_entities(0);
+  std::vector<std::vector<std::size_t> > send_indices(num_processes);
+  std::unordered_map<std::size_t, std::size_t> global_to_local;
+  for (auto it = shared_vertices.begin(); it != shared_vertices.end(); ++it)
+  {
+    global_to_local[global_indices[it->first]] = it->first;
+    if (flags[it->first] != all)
+      for (auto p = it->second.begin(); p != it->second.end(); ++p)
+        send_indices[*p].push_back(global_indices[it->first]);
+  }
+
+  std::vector<std::vector<std::size_t> > received_indices;
+  MPI::all_to_all(mpi_comm, send_indices, received_indices);
+  for (std::size_t p = 0; p < num_processes; ++p)
+  {
+    for (auto i = received_indices[p].begin();
+         i != received_indices[p].end(); ++i)
+    {
+      auto v = global_to_local.find(*i);
+      dolfin_assert(v != global_to_local.end());
+      flags[v->second] = !all;
+    }
+  }
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,106 @@
+// Copyright (C) 2015 The FEniCS Project
+//
+// This file is part of DOLFIN.
+//
+// DOLFIN is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// DOLFIN is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+//
+// First added:  2015-01-22
+// Last changed: 2015-01-22
+
+#ifndef __PARALLEL_COARSENING_H
+#define __PARALLEL_COARSENING_H
+
+#include <cstddef>
+#include <vector>
+
+namespace dolfin
+{
+
+  // Forward declarations
+  class Function;
+  class Mesh;
+  template<typename T> class MeshFunction;
+
+  /// This class implements coarsening of (distributed) simplicial
+  /// meshes by edge collapse.
+  ///
+  /// A vertex may be removed if all cells around it are marked (on
+  /// all processes sharing it) and it does not lie on the boundary.
+  /// It is removed by collapsing one of its edges onto the other
+  /// vertex of the edge, which is chosen to maximise the quality
+  /// (radius ratio) of the resulting cells. A collapse is rejected
+  /// if it inverts a cell or produces a cell of radius ratio below
+  /// the given minimum quality, or below the worst cell of the
+  /// original mesh if that is lower (see MeshQuality). Each call
+  /// removes an independent set of vertices (no two in the same
+  /// cell), chosen consistently across processes with preference
+  /// for short edges; call repeatedly to coarsen further.
+  ///
+  /// The cells of the coarsened mesh stay on the process that held
+  /// their parent cells. The coarsened mesh stores the parent of
+  /// each cell ("parent_cell") and vertex ("parent_vertex") as mesh
+  /// data, in the local numbering of the original mesh, which is
+  /// used to transfer functions to the coarsened mesh.
+
+  class ParallelCoarsening
+  {
+  public:
+
+    /// Coarsen mesh around vertices whose cells are all marked
+    static void coarsen(Mesh& new_mesh, const Mesh& mesh,
+                        const MeshFunction<bool>& cell_markers,
+                        double min_quality = 0.2);
+
+    /// Interpolate function on original mesh into function on the
+    /// coarsened mesh. The dofs of each cell are evaluated from the
+    /// cells of the original mesh around its parent cell.
+    ///
+    /// In parallel, only the cells of the original mesh on this
+    /// process are searched. Where a vertex shared with other
+    /// processes has been removed, a cell may extend over cells of
+    /// the original mesh held by another process; the function is
+    /// then extrapolated from the nearest local cell. This is exact
+    /// for functions that are polynomials of at most the degree of
+    /// the original element over the whole domain, but not in
+    /// general.
+    static void transfer(Function& new_function, const Function& function);
+
+  private:
+
+    // Compute vertex to collapse each vertex onto (or
+    // std::numeric_limits<std::size_t>::max() if none)
+    static void compute_collapses(std::vector<std::size_t>& targets,
+                                  const Mesh& mesh,
+                                  const MeshFunction<bool>& cell_markers,
+                                  double min_quality);
+
+    // Select independent set of collapses, resetting the targets of
+    // vertices which are not removed
+    static void select_collapses(std::vector<std::size_t>& targets,
+                                 const Mesh& mesh);
+
+    // Build coarsened mesh from original mesh and collapses
+    static void build(Mesh& new_mesh, const Mesh& mesh,
+                      const std::vector<std::size_t>& targets);
+
+    // Combine flags of shared vertices across processes (and if all
+    // is true, or if all is false)
+    static void reduce_shared_flags(const Mesh& mesh,
+                                    std::vector<bool>& flags, bool all);
+
+  };
+
+}
+
+#endif
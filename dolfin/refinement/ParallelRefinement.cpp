@@ -22,6 +22,7 @@
 #include <unordered_map>
 #include <vector>
 #include <boost/multi_array.hpp>
+
 #include <dolfin/common/MPI.h>
 #include <dolfin/common/Timer.h>
 #include <dolfin/common/types.h>
@@ -332,35 +333,20 @@ void ParallelRefinement::build_local(Mesh& new_mesh) const
   const std::size_t tdim = _mesh.topology().dim();
   const std::size_t gdim = _mesh.geometry().dim();
   dolfin_assert(new_vertex_coordinates.size()%gdim == 0);
-  const std::size_t num_vertices = new_vertex_coordinates.size()/gdim;
-
-  const std::size_t num_cell_vertices = tdim + 1;
-  dolfin_assert(new_cell_topology.size()%num_cell_vertices == 0);
-  const std::size_t num_cells = new_cell_topology.size()/num_cell_vertices;
+  dolfin_assert(new_cell_topology.size()%(tdim + 1) == 0);
 
   ed.open(new_mesh, tdim, gdim);
-  ed.init_vertices(num_vertices);
-  std::size_t i = 0;
-  for (auto p = new_vertex_coordinates.begin();
-       p != new_vertex_coordinates.end(); p += gdim)
-  {
-    std::vector<double> vertex(p, p + gdim);
-    ed.add_vertex(i, vertex);
-    ++i;
-  }
 
-  ed.init_cells(num_cells);
-  i = 0;
-  std::vector<std::size_t> cell(num_cell_vertices);
-  for (auto p = new_cell_topology.begin(); p != new_cell_topology.end();
-       p += num_cell_vertices)
-  {
-    std::copy(p, p + num_cell_vertices, cell.begin());
-    ed.add_cell(i, cell);
-    ++i;
-  }
-  ed.close();
+  // Hand vertex coordinates and cell vertices over to the mesh
+  // directly, bypassing MeshEditor::add_vertex/add_cell
+  std::vector<double> x(new_vertex_coordinates);
+  ed.set_vertices(x);
 
+  std::vector<unsigned int> cells(new_cell_topology.begin(),
+                                  new_cell_topology.end());
+  ed.set_cells(cells);
+
+  ed.close();
 }
 //-----------------------------------------------------------------------------
 void ParallelRefinement::partition(Mesh& new_mesh, bool redistribute) const
@@ -439,3 +425,12 @@ void ParallelRefinement::new_cell(const std::vector<std::size_t>& idx)
   new_cell_topology.insert(new_cell_topology.end(), idx.begin(), idx.end());
 }
 //-----------------------------------------------------------------------------
+void ParallelRefinement::new_cells(std::vector<std::size_t>& idx)
+{
+  if (new_cell_topology.empty())
+    new_cell_topology.swap(idx);
+  else
+    new_cell_topology.insert(new_cell_topology.end(), idx.begin(), idx.end());
+  idx.clear();
+}
+//-----------------------------------------------------------------------------
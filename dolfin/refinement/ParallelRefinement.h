@@ -88,6 +88,11 @@ namespace dolfin
     void new_cell(std::size_t i0, std::size_t i1, std::size_t i2);
     void new_cell(const std::vector<std::size_t>& idx);
 
+    /// Add a list of new cells (flattened vertex indices). The
+    /// contents of idx are moved into the refinement and idx is left
+    /// empty
+    void new_cells(std::vector<std::size_t>& idx);
+
     /// Use vertex and topology data to partition new mesh across processes
     void partition(Mesh& new_mesh, bool redistribute) const;
 
@@ -19,9 +19,12 @@
 
 #include <boost/multi_array.hpp>
 
+#include <algorithm>
 #include <vector>
 #include <set>
 #include <map>
+#include <limits>
+#include <unordered_map>
 
 #include <dolfin/common/Timer.h>
 #include <dolfin/mesh/Mesh.h>
@@ -30,7 +33,10 @@
 #include <dolfin/mesh/Edge.h>
 #include <dolfin/mesh/Face.h>
 #include <dolfin/mesh/Facet.h>
+#include <dolfin/mesh/MeshConnectivity.h>
+#include <dolfin/mesh/MeshTopology.h>
 #include <dolfin/mesh/Vertex.h>
+#include <dolfin/parameter/GlobalParameters.h>
 
 #include "PlazaRefinementND.h"
 #include "ParallelRefinement.h"
@@ -61,8 +67,6 @@ void PlazaRefinementND::get_triangles
  const std::vector<bool>& marked_edges,
  const std::size_t longest_edge)
 {
-  Timer t0("PLAZA: Get triangles");
-
   // Longest edge must be marked
   dolfin_assert(marked_edges[longest_edge]);
 
@@ -102,8 +106,6 @@ void PlazaRefinementND::get_tetrahedra(
             const std::vector<bool>& marked_edges,
             const std::vector<std::size_t> longest_edge)
 {
-  Timer t0("PLAZA: Get tetrahedra");
-
   tet_set.clear();
 
   // Connectivity matrix
@@ -340,79 +342,132 @@ void PlazaRefinementND::do_refine(Mesh& new_mesh, const Mesh& mesh,
   const std::map<std::size_t, std::size_t>& new_vertex_map
     = p_ref.edge_to_new_vertex();
 
-  std::vector<std::size_t> parent_cell;
-  std::vector<std::size_t> indices(num_cell_vertices + num_cell_edges);
-  std::vector<std::size_t> marked_edge_list;
-
-  for (CellIterator cell(mesh); !cell.end(); ++cell)
+  // Copy map from edge to new vertex into an array for fast lookup
+  std::vector<std::size_t> edge_to_vertex(mesh.num_edges());
+  for (auto &p : new_vertex_map)
+    edge_to_vertex[p.first] = p.second;
+
+  // Make sure connectivity is computed before entering threaded
+  // region
+  mesh.init(tdim, 1);
+  if (tdim == 3)
+    mesh.init(tdim, 2);
+  const MeshConnectivity& cell_to_vertex = mesh.topology()(tdim, 0);
+  const MeshConnectivity& cell_to_edge = mesh.topology()(tdim, 1);
+  const std::vector<std::size_t>& global_vertices
+    = mesh.topology().global_indices(0);
+
+  // Cells are refined in blocks, each block writing new cells into
+  // its own buffer. The buffers are then copied in block order into
+  // the new topology, so the result does not depend on the number of
+  // threads.
+  const std::size_t num_cells = mesh.num_cells();
+  const std::size_t block_size = 1024;
+  const std::size_t num_blocks = (num_cells + block_size - 1)/block_size;
+  std::vector<std::vector<std::size_t> > block_topology(num_blocks);
+  std::vector<std::vector<std::size_t> > block_parent_cell(num_blocks);
+
+  Timer t0("PLAZA: Refine cells");
+  #ifdef HAS_OPENMP
+  const int num_threads = dolfin::parameters["num_threads"];
+  #pragma omp parallel num_threads(std::max(num_threads, 1)) \
+    if (num_threads > 0)
+  #endif
   {
-    // Create vector of indices in the order
-    // [vertices][edges], 3+3 in 2D, 4+6 in 3D
-    std::size_t j = 0;
-    for (VertexIterator v(*cell); !v.end(); ++v)
-      indices[j++] = v->global_index();
-
-    marked_edge_list = p_ref.marked_edge_list(*cell);
-
-    if (marked_edge_list.size() == 0)
+    std::vector<std::size_t> indices(num_cell_vertices + num_cell_edges);
+    std::vector<bool> markers(num_cell_edges);
+    std::vector<std::size_t> longest_edge(tdim == 3 ? 4 : 1);
+    std::vector<std::vector<std::size_t> > simplex_set;
+
+    #ifdef HAS_OPENMP
+    #pragma omp for schedule(dynamic)
+    #endif
+    for (int b = 0; b < (int) num_blocks; ++b)
     {
-      indices.resize(num_cell_vertices);
-      p_ref.new_cell(indices);
-      parent_cell.push_back(cell->index());
-    }
-    else
-    {
-      indices.resize(num_cell_vertices + num_cell_edges);
-      // Get the marked edge indices for new vertices
-      // and make bool vector of marked edges
-      std::vector<bool> markers(num_cell_edges, false);
-      EdgeIterator e(*cell);
-      for (auto &p : marked_edge_list)
-      {
-        markers[p] = true;
-        const std::size_t edge_index = e[p].index();
-        auto it = new_vertex_map.find(edge_index);
-        dolfin_assert (it != new_vertex_map.end());
-        indices[num_cell_vertices + p] = it->second;
-      }
-
-      // Need longest edges of each facet in cell local indexing
-      std::vector<std::size_t> longest_edge;
-      if (tdim == 3)
+      std::vector<std::size_t>& topology = block_topology[b];
+      std::vector<std::size_t>& parent_cell = block_parent_cell[b];
+      const std::size_t cell_end = std::min(num_cells, (b + 1)*block_size);
+      for (std::size_t c = b*block_size; c < cell_end; ++c)
       {
-        for (FaceIterator f(*cell); !f.end(); ++f)
-          longest_edge.push_back(long_edge[f->index()]);
-      }
-      else if (tdim == 2)
-        longest_edge.push_back(long_edge[cell->index()]);
-
-      // Convert to cell local index
-      for (auto &p : longest_edge)
-      {
-        for (EdgeIterator ej(*cell); !ej.end(); ++ej)
+        // Create vector of indices in the order
+        // [vertices][edges], 3+3 in 2D, 4+6 in 3D
+        const unsigned int* v = cell_to_vertex(c);
+        const unsigned int* e = cell_to_edge(c);
+        for (std::size_t j = 0; j < num_cell_vertices; ++j)
+          indices[j] = global_vertices[v[j]];
+
+        // Get the marked edge indices for new vertices and make bool
+        // vector of marked edges
+        bool any_marked = false;
+        for (std::size_t j = 0; j < num_cell_edges; ++j)
         {
-          if (p == ej->index())
+          markers[j] = p_ref.is_marked(e[j]);
+          if (markers[j])
           {
-            p = ej.pos();
-            break;
+            dolfin_assert(new_vertex_map.find(e[j]) != new_vertex_map.end());
+            indices[num_cell_vertices + j] = edge_to_vertex[e[j]];
+            any_marked = true;
           }
         }
-      }
 
-      std::vector<std::vector<std::size_t> > simplex_set;
-      get_simplices(simplex_set, markers, longest_edge, tdim);
+        if (!any_marked)
+        {
+          topology.insert(topology.end(), indices.begin(),
+                          indices.begin() + num_cell_vertices);
+          parent_cell.push_back(c);
+          continue;
+        }
 
-      // Convert from cell local index to mesh index
-      for (auto &it : simplex_set)
-      {
-        for (auto &vit : it)
-          vit = indices[vit];
-        p_ref.new_cell(it);
-        parent_cell.push_back(cell->index());
+        // Need longest edges of each facet in cell local indexing
+        if (tdim == 3)
+        {
+          const unsigned int* f = mesh.topology()(tdim, 2)(c);
+          for (std::size_t j = 0; j < 4; ++j)
+            longest_edge[j] = long_edge[f[j]];
+        }
+        else
+          longest_edge[0] = long_edge[c];
+
+        // Convert to cell local index
+        for (auto &p : longest_edge)
+          p = std::find(e, e + num_cell_edges, p) - e;
+
+        get_simplices(simplex_set, markers, longest_edge, tdim);
+
+        // Convert from cell local index to mesh index
+        for (auto &it : simplex_set)
+        {
+          for (auto &vit : it)
+            topology.push_back(indices[vit]);
+          parent_cell.push_back(c);
+        }
       }
     }
   }
 
+  // Compute offsets of blocks in new cell list and gather
+  std::vector<std::size_t> offset(num_blocks + 1, 0);
+  for (std::size_t b = 0; b < num_blocks; ++b)
+    offset[b + 1] = offset[b] + block_parent_cell[b].size();
+
+  std::vector<std::size_t> new_topology(offset.back()*num_cell_vertices);
+  std::vector<std::size_t> parent_cell(offset.back());
+  #ifdef HAS_OPENMP
+  #pragma omp parallel for schedule(static) \
+    num_threads(std::max(num_threads, 1)) if (num_threads > 0)
+  #endif
+  for (int b = 0; b < (int) num_blocks; ++b)
+  {
+    std::copy(block_topology[b].begin(), block_topology[b].end(),
+              new_topology.begin() + offset[b]*num_cell_vertices);
+    std::copy(block_parent_cell[b].begin(), block_parent_cell[b].end(),
+              parent_cell.begin() + offset[b]);
+  }
+  block_topology.clear();
+  block_parent_cell.clear();
+  p_ref.new_cells(new_topology);
+  t0.stop();
+
   const bool serial = (MPI::size(mesh.mpi_comm()) == 1);
 
   if (serial)
@@ -428,11 +483,60 @@ void PlazaRefinementND::do_refine(Mesh& new_mesh, const Mesh& mesh,
 
     new_parent_cell = parent_cell;
 
+    set_parent_vertex_markers(mesh, new_mesh, new_vertex_map);
+
     if (new_mesh.topology().dim() == 2 and calculate_parent_facets)
       set_parent_facet_markers(mesh, new_mesh, new_vertex_map);
   }
 }
 //-----------------------------------------------------------------------------
+void PlazaRefinementND::set_parent_vertex_markers(const Mesh& mesh,
+                                                  Mesh& new_mesh,
+           const std::map<std::size_t, std::size_t>& new_vertex_map)
+{
+  const std::size_t none = std::numeric_limits<std::size_t>::max();
+  std::vector<std::size_t>& new_parent_vertex
+    = new_mesh.data().create_array("parent_vertex", 0);
+  std::vector<std::size_t>& new_parent_edge
+    = new_mesh.data().create_array("parent_edge", 0);
+  new_parent_vertex.assign(new_mesh.num_vertices(), none);
+  new_parent_edge.assign(new_mesh.num_vertices(), none);
+
+  // Old vertices keep their global index, and new vertices are
+  // numbered after them, so the parent of each new vertex can be
+  // found from its global index
+  const std::vector<std::size_t>& global_vertices
+    = mesh.topology().global_indices(0);
+  std::unordered_map<std::size_t, std::size_t> old_vertex_map;
+  for (std::size_t i = 0; i < global_vertices.size(); ++i)
+    old_vertex_map[global_vertices[i]] = i;
+
+  // Make reverse map from new vertex to parent edge
+  std::unordered_map<std::size_t, std::size_t> reverse_map;
+  for (auto &p : new_vertex_map)
+    reverse_map[p.second] = p.first;
+
+  const std::size_t num_old_vertices = mesh.size_global(0);
+  const std::vector<std::size_t>& new_global_vertices
+    = new_mesh.topology().global_indices(0);
+  for (std::size_t i = 0; i < new_global_vertices.size(); ++i)
+  {
+    const std::size_t v = new_global_vertices[i];
+    if (v < num_old_vertices)
+    {
+      auto it = old_vertex_map.find(v);
+      if (it != old_vertex_map.end())
+        new_parent_vertex[i] = it->second;
+    }
+    else
+    {
+      auto it = reverse_map.find(v);
+      if (it != reverse_map.end())
+        new_parent_edge[i] = it->second;
+    }
+  }
+}
+//-----------------------------------------------------------------------------
 void PlazaRefinementND::set_parent_facet_markers(const Mesh& mesh,
                                                  Mesh& new_mesh,
            const std::map<std::size_t, std::size_t>& new_vertex_map)
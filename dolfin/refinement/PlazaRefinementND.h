@@ -29,6 +29,12 @@ namespace dolfin
   /// based on the skeleton"
   /// (Applied Numerical Mathematics 32 (2000) 195-218)
   ///
+  /// Unless the refined mesh is redistributed, it stores the parent
+  /// of each new cell ("parent_cell") and of each new vertex
+  /// ("parent_vertex" for original vertices, "parent_edge" for edge
+  /// midpoints) as mesh data, in the local numbering of the original
+  /// mesh.
+  ///
   class PlazaRefinementND
   {
   public:
@@ -84,6 +90,10 @@ namespace dolfin
                               const Mesh& mesh,
                               const std::vector<std::size_t>& long_edge);
 
+    // Add parent vertex and parent edge markers to new mesh
+    static void set_parent_vertex_markers(const Mesh& mesh, Mesh& new_mesh,
+                  const std::map<std::size_t, std::size_t>& new_vertex_map);
+
     // Add parent facet markers to new mesh, based on new vertices
     // Only works in 2D at present
     static void set_parent_facet_markers(const Mesh& mesh, Mesh& new_mesh,
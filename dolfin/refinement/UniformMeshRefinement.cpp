@@ -18,8 +18,10 @@
 // Modified by Garth N. Wells, 2010
 //
 // First added:  2006-06-08
-// Last changed: 2014-02-06
+// Last changed: 2015-01-22
 
+#include <algorithm>
+#include <limits>
 #include <dolfin/math/dolfin_math.h>
 #include <dolfin/log/dolfin_log.h>
 #include <dolfin/mesh/Mesh.h>
@@ -30,6 +32,7 @@
 #include <dolfin/mesh/Vertex.h>
 #include <dolfin/mesh/Edge.h>
 #include <dolfin/mesh/Cell.h>
+#include <dolfin/parameter/GlobalParameters.h>
 #include "UniformMeshRefinement.h"
 
 using namespace dolfin;
@@ -71,38 +74,86 @@ void UniformMeshRefinement::refine(Mesh& refined_mesh,
               mesh.topology().dim(), mesh.geometry().dim());
 
   // Get size of mesh
+  const std::size_t tdim = mesh.topology().dim();
+  const std::size_t gdim = mesh.geometry().dim();
   const std::size_t num_vertices = mesh.size(0);
   const std::size_t num_edges = mesh.size(1);
-  const std::size_t num_cells = mesh.size(mesh.topology().dim());
-
-  // Specify number of vertices and cells
-  editor.init_vertices_global(num_vertices + num_edges, num_vertices + num_edges);
-  editor.init_cells_global(ipow(2, mesh.topology().dim())*num_cells,
-                           ipow(2, mesh.topology().dim())*num_cells);
-
-  // Add old vertices
-  std::size_t vertex = 0;
-  for (VertexIterator v(mesh); !v.end(); ++v)
-  {
-    editor.add_vertex(vertex, v->point());
-    vertex++;
-  }
-
-  // Add new vertices
-  for (EdgeIterator e(mesh); !e.end(); ++e)
+  const std::size_t num_cells = mesh.size(tdim);
+  const std::size_t num_children = ipow(2, tdim);
+  const std::size_t num_cell_vertices = cell_type.num_vertices(tdim);
+
+  // Vertices and cells are computed directly into flat arrays which
+  // are then handed over to the mesh: old vertex v keeps index v, the
+  // new vertex on edge e gets index num_vertices + e, and the
+  // children of cell c get indices num_children*c, ...,
+  // num_children*(c + 1) - 1
+  std::vector<double> x(gdim*(num_vertices + num_edges));
+  std::vector<unsigned int> cells(num_children*num_cells*num_cell_vertices);
+
+  #ifdef HAS_OPENMP
+  const int num_threads = parameters["num_threads"];
+  #pragma omp parallel num_threads(std::max(num_threads, 1)) \
+    if (num_threads > 0)
+  #endif
   {
-    editor.add_vertex(vertex, e->midpoint());
-    vertex++;
+    // Add old vertices
+    const std::vector<double>& coordinates = mesh.coordinates();
+    #ifdef HAS_OPENMP
+    #pragma omp for schedule(static)
+    #endif
+    for (int i = 0; i < (int) (gdim*num_vertices); ++i)
+      x[i] = coordinates[i];
+
+    // Add new vertices
+    #ifdef HAS_OPENMP
+    #pragma omp for schedule(static)
+    #endif
+    for (int e = 0; e < (int) num_edges; ++e)
+    {
+      const Point p = Edge(mesh, e).midpoint();
+      std::copy(p.coordinates(), p.coordinates() + gdim,
+                x.begin() + gdim*(num_vertices + e));
+    }
+
+    // Add cells
+    std::vector<std::size_t> children(num_children*num_cell_vertices);
+    #ifdef HAS_OPENMP
+    #pragma omp for schedule(static)
+    #endif
+    for (int c = 0; c < (int) num_cells; ++c)
+    {
+      cell_type.refine_cell(Cell(mesh, c), children.data());
+      std::copy(children.begin(), children.end(),
+                cells.begin() + c*children.size());
+    }
   }
 
-  // Add cells
-  std::size_t current_cell = 0;
-  for (CellIterator c(mesh); !c.end(); ++c)
-    cell_type.refine_cell(*c, editor, current_cell);
+  editor.set_vertices(x);
+  editor.set_cells(cells);
 
   // Close editor
   editor.close();
 
+  // Store parent cell of each new cell, and parent vertex or edge of
+  // each new vertex
+  const std::size_t none = std::numeric_limits<std::size_t>::max();
+  std::vector<std::size_t>& parent_cell
+    = refined_mesh.data().create_array("parent_cell", tdim);
+  std::vector<std::size_t>& parent_vertex
+    = refined_mesh.data().create_array("parent_vertex", 0);
+  std::vector<std::size_t>& parent_edge
+    = refined_mesh.data().create_array("parent_edge", 0);
+  parent_cell.resize(num_children*num_cells);
+  parent_vertex.assign(num_vertices + num_edges, none);
+  parent_edge.assign(num_vertices + num_edges, none);
+
+  for (std::size_t c = 0; c < num_children*num_cells; ++c)
+    parent_cell[c] = c/num_children;
+  for (std::size_t v = 0; v < num_vertices; ++v)
+    parent_vertex[v] = v;
+  for (std::size_t e = 0; e < num_edges; ++e)
+    parent_edge[num_vertices + e] = e;
+
   // Make sure that mesh is ordered after refinement
   //refined_mesh.order();
 }
@@ -18,7 +18,7 @@
 // Modified by Garth N. Wells, 2010
 //
 // First added:  2006-06-07
-// Last changed: 2010-02-26
+// Last changed: 2015-01-22
 
 #ifndef __UNIFORM_MESH_REFINEMENT_H
 #define __UNIFORM_MESH_REFINEMENT_H
@@ -29,6 +29,13 @@ namespace dolfin
   class Mesh;
 
   /// This class implements uniform mesh refinement.
+  ///
+  /// The refined mesh stores the parent of each new entity as mesh
+  /// data: "parent_cell" (the cell of the original mesh containing
+  /// each new cell), and "parent_vertex" and "parent_edge" (for each
+  /// new vertex, the original vertex it coincides with or the
+  /// original edge whose midpoint it is, with the other entry set to
+  /// std::numeric_limits<std::size_t>::max()).
 
   class UniformMeshRefinement
   {
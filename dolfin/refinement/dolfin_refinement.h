@@ -4,5 +4,6 @@
 // DOLFIN mesh refinement interface
 
 #include <dolfin/refinement/refine.h>
+#include <dolfin/refinement/ParallelCoarsening.h>
 
 #endif
@@ -18,13 +18,14 @@
 // Modified by Anders Logg, 2010-2011.
 //
 // First added:  2010-02-10
-// Last changed: 2013-01-13
+// Last changed: 2015-01-22
 
 #include <dolfin/mesh/Mesh.h>
 #include <dolfin/mesh/MeshFunction.h>
 #include "UniformMeshRefinement.h"
 #include "LocalMeshRefinement.h"
 #include "PlazaRefinementND.h"
+#include "ParallelCoarsening.h"
 #include "refine.h"
 
 using namespace dolfin;
@@ -93,3 +94,21 @@ void dolfin::refine(Mesh& refined_mesh, const Mesh& mesh,
   }
 }
 //-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+dolfin::Mesh dolfin::coarsen(const Mesh& mesh,
+                             const MeshFunction<bool>& cell_markers,
+                             double min_quality)
+{
+  Mesh coarsened_mesh(mesh.mpi_comm());
+  coarsen(coarsened_mesh, mesh, cell_markers, min_quality);
+  return coarsened_mesh;
+}
+//-----------------------------------------------------------------------------
+void dolfin::coarsen(Mesh& coarsened_mesh, const Mesh& mesh,
+                     const MeshFunction<bool>& cell_markers,
+                     double min_quality)
+{
+  ParallelCoarsening::coarsen(coarsened_mesh, mesh, cell_markers,
+                              min_quality);
+}
+//-----------------------------------------------------------------------------
@@ -18,9 +18,9 @@
 // Modified by Anders Logg, 2010.
 //
 // First added:  2010-02-10
-// Last changed: 2013-05-12
+// Last changed: 2015-01-22
 //
-// This file defines free functions for mesh refinement.
+// This file defines free functions for mesh refinement and coarsening.
 //
 
 #ifndef __DOLFIN_REFINE_H
@@ -115,6 +115,50 @@ namespace dolfin
   void refine(Mesh& refined_mesh, const Mesh& mesh,
               const MeshFunction<bool>& cell_markers, bool redistribute = true);
 
+  /// Create locally coarsened mesh
+  ///
+  /// *Arguments*
+  ///     mesh (_Mesh_)
+  ///         The mesh to coarsen.
+  ///     cell_markers (_MeshFunction_ <bool>)
+  ///         A mesh function over booleans specifying which cells
+  ///         may be coarsened (a vertex is removed only if all cells
+  ///         around it are marked).
+  ///     min_quality (double)
+  ///         Optional argument giving the minimum radius ratio of
+  ///         cells created by coarsening (see ParallelCoarsening).
+  ///
+  /// *Returns*
+  ///     _Mesh_
+  ///         The locally coarsened mesh.
+  ///
+  /// *Example*
+  ///     .. code-block:: c++
+  ///
+  ///         CellFunction<bool> cell_markers(mesh);
+  ///         cell_markers.set_all(true);
+  ///         mesh = coarsen(mesh, cell_markers);
+  ///
+  Mesh coarsen(const Mesh& mesh, const MeshFunction<bool>& cell_markers,
+               double min_quality = 0.2);
+
+  /// Create locally coarsened mesh
+  ///
+  /// *Arguments*
+  ///     coarsened_mesh (_Mesh_)
+  ///         The mesh that will be the coarsened mesh.
+  ///     mesh (_Mesh_)
+  ///         The original mesh.
+  ///     cell_markers (_MeshFunction_ <bool>)
+  ///         A mesh function over booleans specifying which cells
+  ///         may be coarsened.
+  ///     min_quality (double)
+  ///         Optional argument giving the minimum radius ratio of
+  ///         cells created by coarsening.
+  void coarsen(Mesh& coarsened_mesh, const Mesh& mesh,
+               const MeshFunction<bool>& cell_markers,
+               double min_quality = 0.2);
+
 }
 
 #endif
@@ -85,6 +85,12 @@
 //-----------------------------------------------------------------------------
 %ignore dolfin::Hierarchical::operator=;
 
+//-----------------------------------------------------------------------------
+// Ignores for MemoryTracked (use memory_summary)
+//-----------------------------------------------------------------------------
+%ignore dolfin::MemoryTracked::memory_usage_by_subsystem;
+%ignore dolfin::MemoryTracked::operator=;
+
 //-----------------------------------------------------------------------------
 // Ignore all foo and rename foo_shared_ptr to _foo for SWIG >= 2.0
 // and ignore foo_shared_ptr for SWIG < 2.0
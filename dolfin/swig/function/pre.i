@@ -82,6 +82,14 @@
                                                  const Array<double>& x,
                                                  const ufc::cell& cell) const;
 
+//-----------------------------------------------------------------------------
+// Ignore batched evaluation (C++ only; Python subclasses implement eval)
+//-----------------------------------------------------------------------------
+%ignore dolfin::GenericFunction::restrict_many;
+%ignore dolfin::Expression::restrict_many;
+%ignore dolfin::Expression::eval_many;
+%ignore dolfin::Expression::eval_many_threaded;
+
 //-----------------------------------------------------------------------------
 // Modifying the interface of Constant
 //-----------------------------------------------------------------------------
@@ -94,6 +102,8 @@
 %feature("director") dolfin::Expression;
 %feature("nodirector") dolfin::Expression::evaluate;
 %feature("nodirector") dolfin::Expression::restrict;
+%feature("nodirector") dolfin::Expression::restrict_many;
+%feature("nodirector") dolfin::Expression::eval_many;
 %feature("nodirector") dolfin::Expression::update;
 %feature("nodirector") dolfin::Expression::value_dimension;
 %feature("nodirector") dolfin::Expression::value_rank;
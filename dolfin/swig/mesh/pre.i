@@ -100,6 +100,10 @@ ALL_VALUES(dolfin::MeshFunction<std::size_t>, size_t)
 // Misc ignores
 //-----------------------------------------------------------------------------
 %ignore dolfin::MeshEditor::open(Mesh&, CellType::Type, std::size_t, std::size_t);
+%ignore dolfin::MeshEditor::set_vertices;
+%ignore dolfin::MeshEditor::set_vertices_global;
+%ignore dolfin::MeshEditor::set_cells;
+%ignore dolfin::MeshEditor::set_cells_global;
 %ignore dolfin::Mesh::operator=;
 %ignore dolfin::MeshData::operator=;
 %ignore dolfin::MeshFunction::operator=;
@@ -17,7 +17,7 @@
 // along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 //
 // First added:  2013-04-23
-// Last changed: 2013-04-24
+// Last changed: 2015-01-22
 
 //=============================================================================
 // SWIG directives for the DOLFIN multistage kernel module (pre)
@@ -30,6 +30,7 @@
 // to a wrapped Python class
 %ignore dolfin::MultiStageScheme::stage_forms;
 %ignore dolfin::MultiStageScheme::last_stage;
+%ignore dolfin::MultiStageScheme::error_stage;
 %ignore dolfin::MultiStageScheme::stage_solutions;
 %ignore dolfin::MultiStageScheme::solution;
 %ignore dolfin::MultiStageScheme::t;
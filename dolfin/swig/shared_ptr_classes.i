@@ -195,6 +195,7 @@
 %shared_ptr(dolfin::GenericLUSolver)
 %shared_ptr(dolfin::KrylovSolver)
 %shared_ptr(dolfin::LUSolver)
+%shared_ptr(dolfin::MixedPrecisionSolver)
 
 %shared_ptr(dolfin::GenericSparsityPattern)
 %shared_ptr(dolfin::SparsityPattern)
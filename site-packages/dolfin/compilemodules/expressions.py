@@ -55,7 +55,15 @@ public:
   {
 %(evalcode)s
   }
-};
+%(eval_many)s};
+"""
+
+_eval_many_template = """
+  void eval_many(dolfin::Array<double>& values, const dolfin::Array<double>& x,
+                 const std::vector<const ufc::cell*>& cells) const
+  {
+    eval_many_threaded(values, x, cells);
+  }
 """
 
 def flatten_and_check_expression(expr):
@@ -112,6 +120,13 @@ def expression_to_dolfin_expression(expr, generic_function_members):
         "__array_, x", "__array_, x, cell")
     fragments["value_shape"] = "\n".join(value_shape_code)
 
+    # Evaluate batches of points with threads, unless eval calls
+    # GenericFunction members which may be implemented in Python
+    if generic_function_members:
+        fragments["eval_many"] = ""
+    else:
+        fragments["eval_many"] = _eval_many_template
+
     # Assign classname
     classname = "Expression_" + hashlib.sha1(fragments["evalcode"].\
                                              encode("utf-8")).hexdigest()
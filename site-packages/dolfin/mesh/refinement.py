@@ -1,4 +1,4 @@
-"This module provides uniform and local mesh refinement."
+"This module provides uniform and local mesh refinement and coarsening."
 
 # Copyright (C) 2009 Anders Logg
 #
@@ -18,9 +18,9 @@
 # along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
 #
 # First added:  2010-02-26
-# Last changed: 2010-02-26
+# Last changed: 2015-01-22
 
-__all__ = ["refine"]
+__all__ = ["refine", "coarsen"]
 
 # Import C++ interface
 import dolfin.cpp as cpp
@@ -78,3 +78,46 @@ def refine(mesh, cell_markers=None, redistribute=True):
         cpp.refine(refined_mesh, mesh, cell_markers, redistribute)
 
     return refined_mesh
+
+def coarsen(mesh, cell_markers, min_quality=0.2):
+    """
+    Coarsen given mesh by edge collapse and return the coarsened
+    mesh.
+
+    *Arguments*
+        mesh
+            the :py:class:`Mesh <dolfin.cpp.Mesh>` to be coarsened.
+        cell_markers
+            a boolean :py:class:`MeshFunction
+            <dolfin.cpp.MeshFunctionBool>` over cells. Interior
+            vertices whose cells are all marked as True may be
+            removed.
+        min_quality
+            an optional argument (float) giving the minimum radius
+            ratio of cells created by coarsening. Default is 0.2.
+
+    *Example of usage*
+
+        .. code-block:: python
+
+            cell_markers = CellFunction("bool", mesh)
+            cell_markers.set_all(True)
+            coarse_mesh = coarsen(mesh, cell_markers)
+
+        Functions on the original mesh are transferred to the
+        coarsened mesh by
+
+        .. code-block:: python
+
+            u_coarse = Function(FunctionSpace(coarse_mesh, "Lagrange", 1))
+            ParallelCoarsening.transfer(u_coarse, u)
+
+    """
+
+    # Create empty mesh
+    coarsened_mesh = cpp.Mesh(mesh.mpi_comm())
+
+    # Call C++ coarsening
+    cpp.coarsen(coarsened_mesh, mesh, cell_markers, min_quality)
+
+    return coarsened_mesh
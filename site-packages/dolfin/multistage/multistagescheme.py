@@ -21,7 +21,7 @@ passed to a RKSolver or PointIntegralSolver"""
 # Modified by Patrick Farrell, 2013
 #
 # First added:  2013-02-22
-# Last changed: 2013-06-18
+# Last changed: 2015-01-22
 
 import numpy as np
 import functools
@@ -242,13 +242,14 @@ def _butcher_scheme_generator(a, b, c, time, solution, rhs_form):
         last_stage = Form(ufl.inner(y_+sum([dt*float(bi)*ki for bi, ki in \
                                             zip(b, k)], zero_), v)*DX)
     else:
-        # FIXME: Add support for adaptivity in RKSolver and MultiStageScheme
-        
+        # The first row gives the solution and the difference to the
+        # second row (the embedded scheme) the error estimate
         last_stage = [Form(ufl.inner(y_+sum([dt*float(bi)*ki for bi, ki in \
                                              zip(b[0,:], k)], zero_), v)*DX),
-                      Form(ufl.inner(y_+sum([dt*float(bi)*ki for bi, ki in \
-                                             zip(b[1,:], k)], zero_), v)*DX)]
-    
+                      Form(ufl.inner(sum([dt*float(b0i-b1i)*ki for b0i, b1i, ki \
+                                          in zip(b[0,:], b[1,:], k)], zero_),
+                                     v)*DX)]
+
     # Create the Function holding the solution at end of time step
     #k.append(solution.copy())
 
@@ -269,10 +270,12 @@ def _butcher_scheme_generator(a, b, c, time, solution, rhs_form):
             human_form.append("k_%(i)s = f(t_n%(cih)s, y_n + %(kterm)s)" % \
                           {"i": i, "cih": cih, "kterm": kterm})
 
-    parentheses = "(%s)" if np.sum(b>0) > 1 else "%s"
-    human_form.append("y_{n+1} = y_n + h*" + parentheses % (" + ".join(\
-        "%sk_%s" % ("" if b[i] == 1.0 else "%s*" % b[i], i) \
-        for i in range(size) if b[i] > 0)))
+    bs = [b] if len(b.shape) == 1 else [b[0,:], b[1,:]]
+    for b_, y in zip(bs, ["y_{n+1}", "yhat_{n+1}"]):
+        parentheses = "(%s)" if np.sum(b_!=0) > 1 else "%s"
+        human_form.append(y + " = y_n + h*" + parentheses % (" + ".join(\
+            "%sk_%s" % ("" if b_[i] == 1.0 else "%s*" % b_[i], i) \
+            for i in range(size) if b_[i] != 0)))
 
     human_form = "\n".join(human_form)
 
@@ -563,7 +566,8 @@ class MultiStageScheme(cpp.MultiStageScheme):
     def __init__(self, rhs_form, ufl_stage_forms,
                  dolfin_stage_forms, last_stage, stage_solutions,
                  solution, time, dt, dt_stage_offsets, jacobian_indices, order,
-                 name, human_form, bcs, contraction=None):
+                 name, human_form, bcs, contraction=None, error_stage=None,
+                 error_order=0):
 
         # Store Python data
         self._rhs_form = rhs_form
@@ -578,13 +582,22 @@ class MultiStageScheme(cpp.MultiStageScheme):
         self._order = order
         self.jacobian_indices = jacobian_indices
         self.contraction = contraction
+        self._error_stage = error_stage
 
         # Pass args to C++ constructor
-        cpp.MultiStageScheme.__init__(self, dolfin_stage_forms, last_stage, \
-                                      stage_solutions, solution, time, dt,
-                                      dt_stage_offsets, jacobian_indices, order,\
-                                      self.__class__.__name__,
-                                      human_form, bcs)
+        if error_stage is None:
+            cpp.MultiStageScheme.__init__(self, dolfin_stage_forms, last_stage, \
+                                          stage_solutions, solution, time, dt,
+                                          dt_stage_offsets, jacobian_indices, \
+                                          order, self.__class__.__name__,
+                                          human_form, bcs)
+        else:
+            cpp.MultiStageScheme.__init__(self, dolfin_stage_forms, last_stage, \
+                                          stage_solutions, solution, time, dt,
+                                          dt_stage_offsets, jacobian_indices, \
+                                          order, self.__class__.__name__,
+                                          human_form, bcs, error_stage, \
+                                          error_order)
 
     def rhs_form(self):
         "Return the original rhs form"
@@ -614,9 +627,14 @@ class MultiStageScheme(cpp.MultiStageScheme):
         "Return the form describing the last stage"
         return self._last_stage
 
+    def error_stage(self):
+        "Return the form describing the error estimate (or None)"
+        return self._error_stage
+
     def stage_solutions(self):
         "Return the stage solutions"
         return self._stage_solutions
+
     def to_tlm(self, perturbation):
         raise NotImplementedError("'to_tlm:' implement in derived classes")
 
@@ -628,13 +646,21 @@ class ButcherMultiStageScheme(MultiStageScheme):
     Base class for all MultiStageSchemes
     """
     def __init__(self, rhs_form, solution, time, bcs, a, b, c, order, \
-                 generator=_butcher_scheme_generator):
+                 generator=_butcher_scheme_generator, error_order=0):
         bcs = bcs or []
         time = time or Constant(0.0)
         ufl_stage_forms, dolfin_stage_forms, jacobian_indices, last_stage, \
                          stage_solutions, dt, human_form, contraction = \
                          generator(a, b, c, time, solution, rhs_form)
 
+        # A 2 row b gives an embedded error estimate
+        error_stage = None
+        if isinstance(last_stage, list):
+            last_stage, error_stage = last_stage
+            if not error_order:
+                raise ValueError("Expected the order of the embedded scheme "\
+                                 "for a 2 row b.")
+
         # Store data
         self.a = a
         self.b = b
@@ -645,7 +671,11 @@ class ButcherMultiStageScheme(MultiStageScheme):
                                   stage_solutions, solution, time, dt,
                                   c, jacobian_indices, order,\
                                   self.__class__.__name__, human_form,
-                                  bcs, contraction)
+                                  bcs, contraction, error_stage, error_order)
+
+    def _solution_b(self):
+        "Return the b vector of the solution (without the embedded scheme)"
+        return self.b if len(self.b.shape) == 1 else self.b[0,:].copy()
 
     def to_tlm(self, perturbation):
         r"""
@@ -662,7 +692,8 @@ class ButcherMultiStageScheme(MultiStageScheme):
         new_solution = self._solution.copy()
         new_form = ufl.replace(self._rhs_form, {self._solution: new_solution})
         return ButcherMultiStageScheme(new_form, new_solution, self._t, self._bcs, 
-                                       self.a, self.b, self.c, self._order,
+                                       self.a, self._solution_b(), self.c,
+                                       self._order,
                                        generator=generator)
         
     def to_adm(self, adj):
@@ -679,7 +710,8 @@ class ButcherMultiStageScheme(MultiStageScheme):
         new_solution = self._solution.copy()
         new_form = ufl.replace(self._rhs_form, {self._solution: new_solution})
         return ButcherMultiStageScheme(new_form, new_solution, self._t, self._bcs, 
-                                       self.a, self.b, self.c, self._order,
+                                       self.a, self._solution_b(), self.c,
+                                       self._order,
                                        generator=generator)
 
 class ERK1(ButcherMultiStageScheme):
@@ -766,6 +798,69 @@ class ESDIRK4(ButcherMultiStageScheme):
         c = a.sum(1)
         ButcherMultiStageScheme.__init__(self, rhs_form, solution, t, bcs, a, b, c, 4)
 
+class HeunEuler(ButcherMultiStageScheme):
+    """
+    Explicit 2nd order scheme with embedded 1st order error estimate
+    """
+    def __init__(self, rhs_form, solution, t=None, bcs=None):
+        a = np.array([[0, 0],
+                      [1, 0]])
+        b = np.array([[0.5, 0.5],
+                      [1.0, 0.0]])
+        c = np.array([0, 1.0])
+        ButcherMultiStageScheme.__init__(self, rhs_form, solution, t, bcs, a, b, c, 2,
+                                         error_order=1)
+
+class BogackiShampine(ButcherMultiStageScheme):
+    """
+    Explicit 3rd order scheme with embedded 2nd order error estimate
+    """
+    def __init__(self, rhs_form, solution, t=None, bcs=None):
+        a = np.array([[0,     0,     0,     0],
+                      [1./2,  0,     0,     0],
+                      [0,     3./4,  0,     0],
+                      [2./9,  1./3,  4./9,  0]])
+        b = np.array([[2./9,  1./3,  4./9,  0],
+                      [7./24, 1./4,  1./3,  1./8]])
+        c = np.array([0, 0.5, 0.75, 1])
+        ButcherMultiStageScheme.__init__(self, rhs_form, solution, t, bcs, a, b, c, 3,
+                                         error_order=2)
+
+class DormandPrince(ButcherMultiStageScheme):
+    """
+    Explicit 5th order scheme with embedded 4th order error estimate
+    """
+    def __init__(self, rhs_form, solution, t=None, bcs=None):
+        a = np.array([[0,           0,            0,           0,         0,           0,      0],
+                      [1./5,        0,            0,           0,         0,           0,      0],
+                      [3./40,       9./40,        0,           0,         0,           0,      0],
+                      [44./45,     -56./15,       32./9,       0,         0,           0,      0],
+                      [19372./6561,-25360./2187,  64448./6561,-212./729,  0,           0,      0],
+                      [9017./3168, -355./33,      46732./5247, 49./176,  -5103./18656, 0,      0],
+                      [35./384,     0,            500./1113,   125./192, -2187./6784,  11./84, 0]])
+        b = np.array([a[-1,:],
+                      [5179./57600, 0,            7571./16695, 393./640, -92097./339200, 187./2100, 1./40]])
+        c = np.array([0, 1./5, 3./10, 4./5, 8./9, 1, 1])
+        ButcherMultiStageScheme.__init__(self, rhs_form, solution, t, bcs, a, b, c, 5,
+                                         error_order=4)
+
+class TRBDF2(ButcherMultiStageScheme):
+    """
+    Explicit implicit 2nd order scheme with embedded 3rd order error estimate
+    """
+    def __init__(self, rhs_form, solution, t=None, bcs=None):
+        gamma = 2 - np.sqrt(2)
+        d = gamma/2
+        w = np.sqrt(2)/4
+        a = np.array([[0, 0, 0],
+                      [d, d, 0],
+                      [w, w, d]])
+        b = np.array([[w,         w,           d],
+                      [(1-w)/3,   (3*w+1)/3,   d/3]])
+        c = np.array([0, gamma, 1])
+        ButcherMultiStageScheme.__init__(self, rhs_form, solution, t, bcs, a, b, c, 2,
+                                         error_order=3)
+
 # Aliases
 CrankNicolson = CN2
 ExplicitEuler = ERK1
@@ -774,6 +869,7 @@ ImplicitEuler = BDF1
 BackwardEuler = BDF1
 ERK = ERK1
 RK4 = ERK4
+RK45 = DormandPrince
 
 __all__ = [name for name, attr in list(globals().items()) \
            if isinstance(attr, type) and issubclass(attr, MultiStageScheme)]
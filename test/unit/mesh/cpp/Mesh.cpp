@@ -18,12 +18,14 @@
 // Modified by Benjamin Kehlet 2012
 //
 // First added:  2007-05-14
-// Last changed: 2012-11-12
+// Last changed: 2015-01-22
 //
 // Unit tests for the mesh library
 
 #include <dolfin.h>
 #include <dolfin/common/unittest.h>
+#include <dolfin/mesh/MeshOrdering.h>
+#include <dolfin/mesh/MeshPartitioning.h>
 
 using namespace dolfin;
 
@@ -32,6 +34,7 @@ class SimpleShapes : public CppUnit::TestFixture
   CPPUNIT_TEST_SUITE(SimpleShapes);
   CPPUNIT_TEST(testUnitSquareMesh);
   CPPUNIT_TEST(testUnitCubeMesh);
+  CPPUNIT_TEST(testBulkConstruction);
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -52,6 +55,29 @@ public:
     CPPUNIT_ASSERT(mesh.num_cells() == 1890);
   }
 
+  void testBulkConstruction()
+  {
+    // Create mesh of unit square from flat arrays
+    Mesh mesh;
+    MeshEditor editor;
+    editor.open(mesh, 2, 2);
+    std::vector<double> x = {0.0, 0.0, 1.0, 0.0, 0.0, 1.0, 1.0, 1.0};
+    std::vector<unsigned int> cells = {0, 1, 3, 0, 2, 3};
+    editor.set_vertices(x);
+    editor.set_cells(cells);
+    editor.close();
+
+    CPPUNIT_ASSERT(x.empty() && cells.empty());
+    CPPUNIT_ASSERT(mesh.num_vertices() == 4);
+    CPPUNIT_ASSERT(mesh.num_cells() == 2);
+    CPPUNIT_ASSERT(mesh.topology().global_indices(0)[3] == 3);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(Vertex(mesh, 3).x(1), 1.0, DOLFIN_EPS);
+    double area = 0.0;
+    for (CellIterator c(mesh); !c.end(); ++c)
+      area += c->volume();
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(area, 1.0, DOLFIN_EPS);
+  }
+
 };
 
 class MeshRefinement : public CppUnit::TestFixture
@@ -303,6 +329,119 @@ public:
 
 };
 
+class MeshRebalancing : public CppUnit::TestFixture
+{
+  CPPUNIT_TEST_SUITE(MeshRebalancing);
+  CPPUNIT_TEST(testRebalance);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+
+  void testRebalance()
+  {
+    // Make cells on the left of the domain ten times as expensive
+    // and mark cells in the lower half of the domain
+    UnitSquareMesh mesh(16, 16);
+    const std::size_t D = mesh.topology().dim();
+    MeshFunction<double> weights(mesh, D);
+    MeshFunction<std::size_t> markers(mesh, D);
+    for (CellIterator c(mesh); !c.end(); ++c)
+    {
+      weights[*c] = weight(*c);
+      markers[*c] = c->midpoint().y() < 0.5 ? 1 : 0;
+    }
+
+    const double imbalance_before = imbalance(mesh);
+    std::vector<MeshFunction<std::size_t>*> mesh_functions(1, &markers);
+    MeshPartitioning::rebalance(mesh, weights, mesh_functions);
+    const double imbalance_after = imbalance(mesh);
+
+    // Check that the load is more evenly distributed
+    if (dolfin::MPI::size(mesh.mpi_comm()) > 1)
+      CPPUNIT_ASSERT(imbalance_before > imbalance_after);
+
+    // Check that no cells are lost and that markers follow the cells
+    CPPUNIT_ASSERT(dolfin::MPI::sum(mesh.mpi_comm(), mesh.num_cells()) == 512);
+    CPPUNIT_ASSERT(markers.size() == mesh.num_cells());
+    for (CellIterator c(mesh); !c.end(); ++c)
+    {
+      const std::size_t expected = c->midpoint().y() < 0.5 ? 1 : 0;
+      CPPUNIT_ASSERT(markers[*c] == expected);
+    }
+  }
+
+  // Cell weight used by testRebalance
+  static double weight(const Cell& cell)
+  { return cell.midpoint().x() < 0.25 ? 10.0 : 1.0; }
+
+  // Ratio of largest to mean process load
+  static double imbalance(const Mesh& mesh)
+  {
+    double load = 0.0;
+    for (CellIterator c(mesh); !c.end(); ++c)
+      load += weight(*c);
+    const MPI_Comm comm = mesh.mpi_comm();
+    const double mean_load
+      = dolfin::MPI::sum(comm, load)/dolfin::MPI::size(comm);
+    return dolfin::MPI::max(comm, load)/mean_load;
+  }
+
+};
+
+class MeshReordering : public CppUnit::TestFixture
+{
+  CPPUNIT_TEST_SUITE(MeshReordering);
+  CPPUNIT_TEST(testReorderHilbert);
+  CPPUNIT_TEST(testReorderRCM);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+
+  void testReorderHilbert()
+  { reorder("hilbert"); }
+
+  void testReorderRCM()
+  { reorder("rcm"); }
+
+  void reorder(std::string method)
+  {
+    // Mark cells in the lower half of the domain
+    UnitCubeMesh mesh(4, 4, 4);
+    mesh.init(2);
+    const std::size_t D = mesh.topology().dim();
+    MeshFunction<std::size_t> markers(mesh, D);
+    for (CellIterator c(mesh); !c.end(); ++c)
+      markers[*c] = c->midpoint().z() < 0.5 ? 1 : 0;
+    const double volume = assemble_volume(mesh);
+
+    std::vector<MeshFunction<std::size_t>*> mesh_functions(1, &markers);
+    MeshOrdering::reorder(mesh, method, mesh_functions);
+
+    // Check that the mesh is unchanged and that markers follow the
+    // cells
+    CPPUNIT_ASSERT(mesh.num_cells() == 384);
+    CPPUNIT_ASSERT(mesh.num_vertices() == 125);
+    CPPUNIT_ASSERT(mesh.ordered());
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(volume, assemble_volume(mesh), 1e-12);
+    for (CellIterator c(mesh); !c.end(); ++c)
+    {
+      const std::size_t expected = c->midpoint().z() < 0.5 ? 1 : 0;
+      CPPUNIT_ASSERT(markers[*c] == expected);
+    }
+  }
+
+private:
+
+  double assemble_volume(const Mesh& mesh)
+  {
+    double volume = 0.0;
+    for (CellIterator c(mesh); !c.end(); ++c)
+      volume += c->volume();
+    return volume;
+  }
+
+};
+
 int main()
 {
   CPPUNIT_TEST_SUITE_REGISTRATION(MeshIterators);
@@ -316,7 +455,12 @@ int main()
     CPPUNIT_TEST_SUITE_REGISTRATION(MeshFunctions);
     CPPUNIT_TEST_SUITE_REGISTRATION(InputOutput);
     CPPUNIT_TEST_SUITE_REGISTRATION(PyCCInterface);
+    CPPUNIT_TEST_SUITE_REGISTRATION(MeshReordering);
   }
 
+  // Rebalancing requires ParMETIS and more than one process
+  if (dolfin::MPI::size(MPI_COMM_WORLD) > 1 && has_parmetis())
+    CPPUNIT_TEST_SUITE_REGISTRATION(MeshRebalancing);
+
   DOLFIN_TEST;
 }
@@ -0,0 +1,58 @@
+#!/usr/bin/env py.test
+
+"""Unit tests for Timer and the summary of timings"""
+
+# Copyright (C) 2015 The FEniCS Project
+#
+# This file is part of DOLFIN.
+#
+# DOLFIN is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# DOLFIN is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+# GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+#
+# First added:  2015-01-22
+# Last changed:
+
+
+import pytest
+from dolfin import *
+
+
+def test_memory_usage():
+    mesh = UnitSquareMesh(8, 8)
+    mesh.init(1)
+    assert mesh.topology().memory_usage() > 0
+    assert mesh.geometry().memory_usage() >= 81*2*8
+
+    V = FunctionSpace(mesh, "Lagrange", 1)
+    assert V.dofmap().memory_usage() > 0
+
+    tree = BoundingBoxTree()
+    tree.build(mesh)
+    assert tree.memory_usage() > 0
+
+
+def test_memory_summary():
+    mesh = UnitSquareMesh(8, 8)
+    table = memory_summary()
+    assert int(table.get("Mesh topology", "Objects")) >= 1
+    assert int(table.get("Mesh geometry", "Objects")) >= 1
+    assert int(table.get("Total", "Objects")) >= 2
+
+    # Objects are no longer counted when deleted
+    tree = BoundingBoxTree()
+    num_trees = int(memory_summary().get("Bounding box trees", "Objects"))
+    del tree
+    table = memory_summary()
+    if "Bounding box trees" in table.str(True):
+        assert int(table.get("Bounding box trees", "Objects")) \
+            == num_trees - MPI.size(mpi_comm_world())
@@ -0,0 +1,100 @@
+#!/usr/bin/env py.test
+
+"""Unit tests for Timer and the summary of timings"""
+
+# Copyright (C) 2015 The FEniCS Project
+#
+# This file is part of DOLFIN.
+#
+# DOLFIN is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# DOLFIN is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+# GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+#
+# First added:  2015-01-22
+# Last changed:
+
+import os
+import json
+import pytest
+from dolfin import *
+from dolfin_utils.test import tempdir
+
+
+def test_nested_timers():
+    outer = Timer("test_timer outer")
+    for i in range(3):
+        inner = Timer("test_timer inner")
+        inner.stop()
+    outer.stop()
+
+    table = timings()
+    assert table.get("test_timer outer", "Reps") == "1"
+    assert table.get("test_timer inner", "Reps") == "3"
+    assert outer.value() >= 0.0
+
+    # Both timings are cleared when read
+    assert timing("test_timer inner") >= 0.0
+    assert timing("test_timer outer") >= outer.value()
+    with pytest.raises(RuntimeError):
+        timing("test_timer inner")
+
+    # The call tree is printed without errors
+    list_timings()
+
+
+def test_timer_task_id():
+    task = Timer.task_id("test_timer task")
+    assert Timer.task_id("test_timer task") == task
+    for i in range(4):
+        timer = Timer(task)
+        timer.stop()
+
+    table = timings()
+    assert table.get("test_timer task", "Reps") == "4"
+    timing("test_timer task")
+
+
+def test_trace(tempdir):
+    start_trace(10)
+    for i in range(15):
+        timer = Timer("test_timer traced")
+        timer.stop()
+    stop_trace()
+    timer = Timer("test_timer not traced")
+    timer.stop()
+
+    filename = os.path.join(tempdir, "trace.json")
+    write_trace(filename)
+    if MPI.rank(mpi_comm_world()) == 0:
+        with open(filename) as f:
+            events = json.load(f)["traceEvents"]
+        names = [e["name"] for e in events if e["ph"] == "X"]
+        assert names.count("test_timer traced") == 10
+        assert "test_timer not traced" not in names
+    timing("test_timer traced")
+    timing("test_timer not traced")
+
+
+def test_performance_counters():
+    # Counters may be unavailable (e.g. in virtual machines), in which
+    # case only the timings are reported
+    set_performance_counters_active()
+    for i in range(2):
+        timer = Timer("test_timer counted")
+        timer.stop()
+    set_performance_counters_active(False)
+
+    table = timings()
+    assert table.get("test_timer counted", "Reps") == "2"
+    if "IPC" in table.str(True):
+        assert float(table.get("test_timer counted", "Cycles")) >= 0
+    timing("test_timer counted")
@@ -408,6 +408,25 @@ def test_mpi_dofmap_stats(mesh):
         assert owner in neighbours
 
 
+@pytest.mark.parametrize("ghost_mode", ["none", "shared_vertex",
+                                        "shared_facet"])
+def test_dofmap_ghost_modes(ghost_mode):
+    """Number edges and facets of meshes with and without ghost cells"""
+    old_ghost_mode = parameters["ghost_mode"]
+    parameters["ghost_mode"] = ghost_mode
+    mesh = UnitCubeMesh(4, 5, 3)
+    parameters["ghost_mode"] = old_ghost_mode
+
+    # Dofs on vertices and edges, and on facets
+    assert FunctionSpace(mesh, "CG", 2).dim() == 120 + 573
+    assert FunctionSpace(mesh, "CR", 1).dim() == 814
+
+    rank = MPI.rank(mesh.mpi_comm())
+    dofmap = FunctionSpace(mesh, "CG", 2).dofmap()
+    for owner in dofmap.off_process_owner():
+        assert owner != rank and owner in dofmap.neighbours()
+
+
 
 def test_local_dimension(V, Q, W):
     for space in [V, Q, W]:
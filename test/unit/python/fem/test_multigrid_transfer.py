@@ -0,0 +1,103 @@
+#!/usr/bin/env py.test
+
+"""Unit tests for MultigridTransfer and the parent maps of refined
+meshes"""
+
+# Copyright (C) 2015 The FEniCS Project
+#
+# This file is part of DOLFIN.
+#
+# DOLFIN is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# DOLFIN is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+# GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+#
+# First added:  2015-01-22
+# Last changed:
+
+import pytest
+import numpy
+from dolfin import *
+
+
+@pytest.mark.parametrize("mesh", [UnitSquareMesh(6, 5),
+                                  UnitCubeMesh(3, 2, 4)])
+def test_parent_maps(mesh):
+    tdim = mesh.topology().dim()
+    fine = refine(mesh, False)
+
+    parent_cell = fine.data().array("parent_cell", tdim)
+    parent_vertex = fine.data().array("parent_vertex", 0)
+    parent_edge = fine.data().array("parent_edge", 0)
+    assert len(parent_cell) == fine.num_cells()
+    assert len(parent_vertex) == fine.num_vertices()
+    assert len(parent_edge) == fine.num_vertices()
+
+    # Each cell lies in its parent cell
+    for c in cells(fine):
+        assert Cell(mesh, int(parent_cell[c.index()])).collides(c.midpoint())
+
+    # Each vertex is an old vertex or the midpoint of an old edge
+    mesh.init(1)
+    none = numpy.iinfo(parent_vertex.dtype).max
+    for v in vertices(fine):
+        i = v.index()
+        assert (parent_vertex[i] == none) != (parent_edge[i] == none)
+        if parent_vertex[i] != none:
+            p = Vertex(mesh, int(parent_vertex[i])).point()
+        else:
+            p = Edge(mesh, int(parent_edge[i])).midpoint()
+        assert p.distance(v.point()) < 1.0e-14
+
+
+@pytest.mark.parametrize("degree", [1, 2])
+def test_prolongation_restriction(degree):
+    mesh = UnitSquareMesh(6, 5)
+    meshes = [mesh, refine(mesh, False)]
+    meshes.append(refine(meshes[1], False))
+
+    # Function in the coarse (and fine) space
+    if degree == 1:
+        f = Expression("1.0 + x[0] + 2.0*x[1]", degree=1)
+    else:
+        f = Expression("1.0 + x[0] + 2.0*x[1]*x[1]", degree=2)
+    for coarse, fine in zip(meshes[:-1], meshes[1:]):
+        Vc = FunctionSpace(coarse, "Lagrange", degree)
+        Vf = FunctionSpace(fine, "Lagrange", degree)
+        transfer = cpp.MultigridTransfer(Vc, Vf)
+
+        # Prolongation is exact for functions in the coarse space
+        uc = interpolate(f, Vc)
+        uf = Function(Vf)
+        transfer.apply_prolongation(uf.vector(), uc.vector())
+        uf_exact = interpolate(f, Vf)
+        assert round((uf.vector() - uf_exact.vector()).norm("linf"), 12) == 0
+
+        # Assembled prolongation matches matrix-free prolongation
+        P = Matrix()
+        transfer.assemble_prolongation(P)
+        y = uf.vector().copy()
+        P.mult(uc.vector(), y)
+        assert round((y - uf.vector()).norm("linf"), 12) == 0
+
+        # Restriction is the transpose of prolongation
+        xc = Vector()
+        transfer.apply_restriction(xc, uf_exact.vector())
+        assert round(uf.vector().inner(uf_exact.vector())
+                     - uc.vector().inner(xc), 8) == 0
+
+
+def test_incompatible_spaces():
+    mesh = UnitSquareMesh(4, 4)
+    fine = refine(mesh, False)
+    with pytest.raises(RuntimeError):
+        cpp.MultigridTransfer(FunctionSpace(mesh, "Lagrange", 1),
+                              FunctionSpace(fine, "Lagrange", 2))
@@ -216,6 +216,50 @@ def test_compute_vertex_values(mesh):
     assert all(e1_values[mesh.num_vertices()*2:mesh.num_vertices()*3]==3)
 
 
+def test_interpolate_with_threads(mesh, W):
+    e = Expression(("x[0]", "x[1]*x[2]", "sin(x[0])"), degree=2)
+    u0 = interpolate(e, W)
+    v0 = e.compute_vertex_values(mesh)
+
+    num_threads = parameters["num_threads"]
+    parameters["num_threads"] = 4
+    try:
+        u1 = interpolate(e, W)
+        v1 = e.compute_vertex_values(mesh)
+    finally:
+        parameters["num_threads"] = num_threads
+
+    assert (u0.vector() - u1.vector()).norm("linf") < DOLFIN_EPS
+    assert abs(v0 - v1).max() < DOLFIN_EPS
+    assert abs(v0[:mesh.num_vertices()] - mesh.coordinates()[:, 0]).max() \
+        < DOLFIN_EPS
+
+
+def test_interpolate_python_expression_with_threads(mesh, W):
+    class F0(Expression):
+        def eval(self, values, x):
+            values[0] = x[0]
+            values[1] = x[1]*x[2]
+            values[2] = sin(x[0])
+        def value_shape(self):
+            return (3,)
+
+    e = F0()
+    u0 = interpolate(e, W)
+    v0 = e.compute_vertex_values(mesh)
+
+    num_threads = parameters["num_threads"]
+    parameters["num_threads"] = 4
+    try:
+        u1 = interpolate(e, W)
+        v1 = e.compute_vertex_values(mesh)
+    finally:
+        parameters["num_threads"] = num_threads
+
+    assert (u0.vector() - u1.vector()).norm("linf") < DOLFIN_EPS
+    assert abs(v0 - v1).max() < DOLFIN_EPS
+
+
 def test_wrong_sub_classing():
 
     def noAttributes():
@@ -0,0 +1,113 @@
+#!/usr/bin/env py.test
+
+"""Unit tests for interpolation using InterpolationPlan"""
+
+# Copyright (C) 2015 The FEniCS Project
+#
+# This file is part of DOLFIN.
+#
+# DOLFIN is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# DOLFIN is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+# GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with DOLFIN. If not, see <http://www.gnu.org/licenses/>.
+#
+# First added:  2015-01-22
+# Last changed: 2015-01-22
+
+import pytest
+import numpy
+from dolfin import *
+
+
+def test_scalar():
+    """Test that plan gives the same result as LagrangeInterpolator"""
+
+    mesh0 = UnitSquareMesh(8, 8)
+    mesh1 = UnitSquareMesh(31, 29)
+    V0 = FunctionSpace(mesh0, "Lagrange", 2)
+    V1 = FunctionSpace(mesh1, "Lagrange", 2)
+
+    plan = InterpolationPlan(V1, V0)
+    ll = LagrangeInterpolator()
+
+    u0 = Function(V0)
+    u1 = Function(V1)
+    v1 = Function(V1)
+    for k in range(3):
+        # Reuse plan for new values
+        f = Expression("x[0]*x[0] + k*x[1]*x[1] + 1.0", k=k)
+        ll.interpolate(u0, f)
+        plan.interpolate(u1, u0)
+        ll.interpolate(v1, u0)
+        assert numpy.allclose(u1.vector().array(), v1.vector().array())
+
+    assert round(assemble(u0*dx) - assemble(u1*dx), 10) == 0
+    assert plan.num_points_not_found() == 0
+    assert MPI.sum(mesh1.mpi_comm(), plan.num_points()) \
+        == MPI.sum(mesh1.mpi_comm(), plan.num_evaluations())
+
+
+def test_vector():
+    """Test interpolation of vector valued functions"""
+
+    mesh0 = UnitCubeMesh(4, 4, 4)
+    mesh1 = UnitCubeMesh(5, 6, 7)
+    V0 = VectorFunctionSpace(mesh0, "Lagrange", 1)
+    V1 = VectorFunctionSpace(mesh1, "Lagrange", 1)
+
+    f = Expression(("1.0 + x[0]", "x[1] - x[2]", "2.0*x[2]"))
+    u0 = interpolate(f, V0)
+    u1 = Function(V1)
+    InterpolationPlan(V1, V0).interpolate(u1, u0)
+
+    v1 = interpolate(f, V1)
+    assert numpy.allclose(u1.vector().array(), v1.vector().array())
+
+
+def test_function_space_mismatch():
+    """Test that functions must be in the function spaces of the plan"""
+
+    mesh = UnitSquareMesh(4, 4)
+    V0 = FunctionSpace(mesh, "Lagrange", 1)
+    V1 = FunctionSpace(mesh, "Lagrange", 2)
+    plan = InterpolationPlan(V1, V0)
+    with pytest.raises(RuntimeError):
+        plan.interpolate(Function(V0), Function(V1))
+
+
+def test_matrix():
+    """Test that interpolation matrix gives the interpolant"""
+
+    mesh0 = UnitSquareMesh(8, 8)
+    mesh1 = UnitSquareMesh(13, 11)
+    V0 = FunctionSpace(mesh0, "Lagrange", 2)
+    V1 = FunctionSpace(mesh1, "Lagrange", 1)
+
+    plan = InterpolationPlan(V1, V0)
+    A = Matrix()
+    plan.assemble(A)
+    assert A.size(0) == V1.dim()
+    assert A.size(1) == V0.dim()
+
+    u0 = interpolate(Expression("sin(x[0])*x[1]"), V0)
+    u1 = Function(V1)
+    plan.interpolate(u1, u0)
+
+    y = Vector()
+    A.init_vector(y, 0)
+    A.mult(u0.vector(), y)
+    assert numpy.allclose(y.array(), u1.vector().array())
+
+    # Transpose gives adjoint of interpolation
+    z = Vector()
+    A.init_vector(z, 1)
+    A.transpmult(u1.vector(), z)
+    assert round(u1.vector().inner(y) - u0.vector().inner(z), 10) == 0
@@ -21,7 +21,7 @@
 
 from dolfin import *
 import pytest
-from dolfin_utils.test import skip_if_not_PETSc
+from dolfin_utils.test import skip_if_not_PETSc, skip_in_parallel
 
 @skip_if_not_PETSc
 def test_krylov_samg_solver_elasticity():
@@ -121,3 +121,101 @@ def test_krylov_samg_solver_elasticity():
             assert niter < 12
 
     parameters["linear_algebra_backend"] = previous_backend
+
+
+@skip_in_parallel
+def test_ublas_krylov_preconditioners():
+    "Test uBLASKrylovSolver with the available preconditioners"
+
+    # Set backend
+    previous_backend = parameters["linear_algebra_backend"]
+    parameters["linear_algebra_backend"] = "uBLAS"
+
+    # Define problem (2D elasticity-like vector Poisson problem, so
+    # that the DofMap block size is larger than one)
+    mesh = UnitSquareMesh(16, 16)
+    V = VectorFunctionSpace(mesh, 'CG', 1)
+    bc = DirichletBC(V, Constant((0.0, 0.0)),
+                     lambda x, on_boundary: on_boundary)
+    u, v = TrialFunction(V), TestFunction(V)
+    a = inner(grad(u), grad(v))*dx + inner(u, v)*dx
+    L = dot(Constant((1.0, 2.0)), v)*dx
+    A, b = assemble_system(a, L, bc)
+
+    # Block Jacobi takes the block size of the matrix (DofMap)
+    assert as_backend_type(A).block_size() == V.dofmap().block_size
+
+    # Reference solution
+    x_ref = Vector()
+    solve(A, x_ref, b, "gmres", "none")
+
+    for pc, fill_level in [("ilu", 0), ("ilu", 1), ("ilu", 2),
+                           ("jacobi", 0), ("chebyshev", 0)]:
+        solver = uBLASKrylovSolver("gmres", pc)
+        solver.parameters["relative_tolerance"] = 1.0e-10
+        solver.parameters["preconditioner"]["ilu"]["fill_level"] = fill_level
+        x = Vector()
+        solver.solve(A, x, b)
+        x -= x_ref
+        assert x.norm("l2") < 1.0e-6*x_ref.norm("l2")
+
+    parameters["linear_algebra_backend"] = previous_backend
+
+
+@skip_in_parallel
+@pytest.mark.parametrize('method', ["cg", "bicgstab"])
+def test_mixed_precision_solver(method):
+    "Test that mixed precision iterative refinement reaches double accuracy"
+
+    mesh = UnitSquareMesh(32, 32)
+    V = FunctionSpace(mesh, 'CG', 1)
+    bc = DirichletBC(V, Constant(0.0), lambda x, on_boundary: on_boundary)
+    u, v = TrialFunction(V), TestFunction(V)
+    a = inner(grad(u), grad(v))*dx
+    L = Constant(1.0)*v*dx
+    A, b = assemble_system(a, L, bc)
+
+    solver = MixedPrecisionSolver(A, method)
+    solver.parameters["relative_tolerance"] = 1.0e-12
+    x = Vector()
+    solver.solve(x, b)
+
+    # Residual is computed in double precision, so should be far below
+    # single precision round-off
+    r = b.copy()
+    A.mult(x, r)
+    r -= b
+    assert r.norm("l2") < 1.0e-11*b.norm("l2")
+
+
+@skip_if_not_PETSc
+@pytest.mark.parametrize("method", ["pipecg", "pipecr", "groppcg", "pgmres"])
+def test_pipelined_krylov_methods(method):
+    "Test PETScKrylovSolver with the pipelined Krylov methods"
+
+    if method not in [m[0] for m in PETScKrylovSolver.methods()]:
+        pytest.skip("Krylov method %s requires PETSc > 3.3" % method)
+
+    previous_backend = parameters["linear_algebra_backend"]
+    parameters["linear_algebra_backend"] = "PETSc"
+    try:
+        mesh = UnitSquareMesh(16, 16)
+        V = FunctionSpace(mesh, 'CG', 1)
+        bc = DirichletBC(V, Constant(0.0), "on_boundary")
+        u, v = TrialFunction(V), TestFunction(V)
+        a = inner(grad(u), grad(v))*dx
+        L = v*dx
+        A, b = assemble_system(a, L, bc)
+
+        # Reference solution
+        x_ref = Vector()
+        solve(A, x_ref, b, "lu")
+
+        solver = PETScKrylovSolver(method, "jacobi")
+        solver.parameters["relative_tolerance"] = 1.0e-10
+        x = Vector()
+        solver.solve(A, x, b)
+        x -= x_ref
+        assert x.norm("l2") < 1.0e-6*x_ref.norm("l2")
+    finally:
+        parameters["linear_algebra_backend"] = previous_backend
@@ -110,3 +110,95 @@ def test_lu_solver_reuse(backend):
 
     # Reset backend
     parameters["linear_algebra_backend"] = prev_backend
+
+
+@pytest.mark.parametrize('backend', ["PETSc", skip_in_parallel("uBLAS")])
+def test_lu_solver_factorization_stages(backend):
+    """Test that symbolic and numeric factorisation can be performed
+    separately and that numeric re-factorisation picks up changed
+    matrix values"""
+
+    # Check whether backend is available
+    if not has_linear_algebra_backend(backend):
+        pytest.skip('Need %s as backend to run this test' % backend)
+
+    # Set linear algebra backend
+    prev_backend = parameters["linear_algebra_backend"]
+    parameters["linear_algebra_backend"] = backend
+
+    # Check that we have UMFPACK if using uBLAS
+    if backend == "uBLAS" and not has_lu_solver_method("umfpack"):
+        parameters["linear_algebra_backend"] = prev_backend
+        pytest.skip('Need UMFPACK to run this test with UBLAS as backend')
+
+    mesh = UnitSquareMesh(12, 12)
+    V = FunctionSpace(mesh, "Lagrange", 1)
+    u, v = TrialFunction(V), TestFunction(V)
+    b = assemble(Constant(1.0)*v*dx)
+
+    A = assemble(Constant(1.0)*u*v*dx)
+    norm = 13.0
+
+    solver = LUSolver(A)
+    solver.symbolic_factorize()
+    solver.numeric_factorize()
+    x = Vector()
+    solver.solve(x, b)
+    assert round(x.norm("l2") - norm, 10) == 0
+
+    # Re-assemble into same matrix (same nonzero pattern)
+    assemble(Constant(0.5)*u*v*dx, tensor=A)
+    solver.numeric_factorize()
+    solver.solve(x, b)
+    assert round(x.norm("l2") - 2.0*norm, 10) == 0
+
+    # Reset backend
+    parameters["linear_algebra_backend"] = prev_backend
+
+
+@pytest.mark.parametrize('backend', ["PETSc", skip_in_parallel("uBLAS")])
+def test_lu_solver_multiple_rhs(backend):
+    """Test that solving for several right-hand sides at once gives
+    the same solutions as separate solves"""
+
+    # Check whether backend is available
+    if not has_linear_algebra_backend(backend):
+        pytest.skip('Need %s as backend to run this test' % backend)
+
+    # Set linear algebra backend
+    prev_backend = parameters["linear_algebra_backend"]
+    parameters["linear_algebra_backend"] = backend
+
+    # Check that we have UMFPACK if using uBLAS
+    if backend == "uBLAS" and not has_lu_solver_method("umfpack"):
+        parameters["linear_algebra_backend"] = prev_backend
+        pytest.skip('Need UMFPACK to run this test with UBLAS as backend')
+
+    mesh = UnitSquareMesh(12, 12)
+    V = FunctionSpace(mesh, "Lagrange", 1)
+    u, v = TrialFunction(V), TestFunction(V)
+    A = assemble(Constant(1.0)*u*v*dx)
+    f = [Constant(1.0), Expression("x[0]"), Expression("sin(x[1])")]
+    b = [assemble(fi*v*dx) for fi in f]
+
+    # Reference solutions from separate solves
+    x_ref = []
+    for bi in b:
+        x = Vector()
+        LUSolver(A).solve(x, bi)
+        x_ref.append(x)
+
+    # Solve through LUSolver and through the backend solver
+    if backend == "PETSc":
+        backend_solver = PETScLUSolver(as_backend_type(A))
+    else:
+        backend_solver = UmfpackLUSolver(A)
+    for solver in [LUSolver(A), backend_solver]:
+        x = [Vector() for bi in b]
+        assert solver.solve(x, b) == len(b)
+        for xi, xi_ref in zip(x, x_ref):
+            xi.axpy(-1.0, xi_ref)
+            assert round(xi.norm("l2"), 10) == 0
+
+    # Reset backend
+    parameters["linear_algebra_backend"] = prev_backend
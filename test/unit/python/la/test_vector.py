@@ -365,3 +365,63 @@ class TestVectorForAnyBackend:
             v.data()
         with pytest.raises(AttributeError):
             no_attribute()
+
+
+@skip_if_not_PETSc
+@skip_in_serial
+def test_petsc_shared_memory_ghosts():
+    "Test local access to ghosted PETSc vectors with entries in shared memory"
+    from numpy import arange, zeros, array, float_
+    old_backend = parameters["linear_algebra_backend"]
+    old_shared = parameters["petsc_shared_memory_ghosts"]
+    try:
+        parameters["linear_algebra_backend"] = "PETSc"
+        parameters["petsc_shared_memory_ghosts"] = True
+
+        mesh = UnitSquareMesh(16, 16)
+        V = FunctionSpace(mesh, "Lagrange", 1)
+        u = Function(V)
+        x = as_backend_type(u.vector())
+
+        l2g = array(V.dofmap().tabulate_local_to_global_dofs(), dtype=float_)
+        num_owned = x.local_size()
+        rows = arange(len(l2g), dtype=la_index_dtype())
+        owned = rows[:num_owned]
+
+        # Owned entries
+        x.set_local(l2g[:num_owned], owned)
+        x.apply("insert")
+        values = zeros(num_owned)
+        x.get_local(values, owned)
+        assert (values == l2g[:num_owned]).all()
+        assert (x.get_local() == l2g[:num_owned]).all()
+
+        # Ghost entries, on-node and off-node
+        x.update_ghost_values()
+        values = zeros(len(rows))
+        x.get_local(values, rows)
+        assert (values == l2g).all()
+
+        # Set entries by local index, including ghosts
+        x.set_local(2*l2g, rows)
+        x.apply("insert")
+        x.update_ghost_values()
+        x.get_local(values, rows)
+        assert (values == 2*l2g).all()
+
+        # Add to owned entries
+        x.add_local(l2g[:num_owned], owned)
+        x.apply("add")
+        x.update_ghost_values()
+        x.get_local(values, rows)
+        assert (values == 3*l2g).all()
+
+        # Copies keep the shared layout and the ghost values
+        y = as_backend_type(x.copy())
+        y.update_ghost_values()
+        values = zeros(len(rows))
+        y.get_local(values, rows)
+        assert (values == 3*l2g).all()
+    finally:
+        parameters["linear_algebra_backend"] = old_backend
+        parameters["petsc_shared_memory_ghosts"] = old_shared
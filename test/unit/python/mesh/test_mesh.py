@@ -26,7 +26,7 @@
 # Modified by Oeyvind Evju 2013
 #
 # First added:  2006-08-08
-# Last changed: 2014-08-12
+# Last changed: 2015-01-22
 
 from __future__ import print_function
 import pytest
@@ -179,6 +179,110 @@ def test_UnitCubeMeshDistributedLocal():
     assert mesh.num_cells() == 1890
 
 
+@pytest.mark.parametrize("partitioner", ["Hilbert", "Morton"])
+def test_UnitCubeMeshSpaceFillingCurvePartition(partitioner):
+    """Create mesh of unit cube distributed with a space-filling curve."""
+    old_partitioner = parameters["mesh_partitioner"]
+    old_partitioning = parameters["structured_mesh_partitioning"]
+    try:
+        parameters["mesh_partitioner"] = partitioner
+        parameters["structured_mesh_partitioning"] = "partitioner"
+        mesh = UnitCubeMesh(5, 7, 9)
+    finally:
+        parameters["structured_mesh_partitioning"] = old_partitioning
+        parameters["mesh_partitioner"] = old_partitioner
+    assert mesh.size_global(0) == 480
+    assert mesh.size_global(3) == 1890
+    assert MPI.max(mesh.mpi_comm(), float(mesh.num_cells())) \
+        <= 1890 // MPI.size(mesh.mpi_comm()) + 1
+
+
+@pytest.mark.parametrize("ghost_mode", ["none", "shared_vertex", "shared_facet"])
+def test_BuiltinMeshDistributedBlocks(ghost_mode):
+    """Create meshes of unit square and cube with each process
+    generating its own block."""
+    old_ghost_mode = parameters["ghost_mode"]
+    try:
+        parameters["ghost_mode"] = ghost_mode
+        meshes = [(UnitSquareMesh(5, 7, "crossed"), 83, 140),
+                  (UnitCubeMesh(5, 7, 9), 480, 1890)]
+    finally:
+        parameters["ghost_mode"] = old_ghost_mode
+
+    for mesh, num_vertices, num_cells in meshes:
+        tdim = mesh.topology().dim()
+        assert mesh.size_global(0) == num_vertices
+        assert mesh.size_global(tdim) == num_cells
+
+        # Regular cells cover the domain exactly once
+        num_regular_cells = mesh.topology().ghost_offset(tdim)
+        assert MPI.sum(mesh.mpi_comm(), float(num_regular_cells)) == num_cells
+        volume = sum(Cell(mesh, i).volume() for i in range(num_regular_cells))
+        assert round(MPI.sum(mesh.mpi_comm(), volume) - 1.0, 7) == 0
+
+        # Ghost cells are only present when requested
+        num_ghost_cells = mesh.num_cells() - num_regular_cells
+        if ghost_mode == "none" or MPI.size(mesh.mpi_comm()) == 1:
+            assert num_ghost_cells == 0
+        else:
+            assert MPI.sum(mesh.mpi_comm(), float(num_ghost_cells)) > 0
+
+
+@pytest.mark.parametrize("ghost_mode", ["shared_vertex", "shared_facet"])
+def test_GhostLayers(ghost_mode):
+    """Create meshes with several layers of ghost cells."""
+    old_ghost_mode = parameters["ghost_mode"]
+    old_ghost_layers = parameters["ghost_layers"]
+    num_ghost_cells = []
+    for num_layers in [1, 2, 3]:
+        try:
+            parameters["ghost_mode"] = ghost_mode
+            parameters["ghost_layers"] = num_layers
+            mesh = UnitCubeMesh(5, 4, 6)
+        finally:
+            parameters["ghost_layers"] = old_ghost_layers
+            parameters["ghost_mode"] = old_ghost_mode
+        tdim = mesh.topology().dim()
+        assert mesh.size_global(tdim) == 720
+
+        # Ghost cells are ordered by layer and owned by other processes
+        num_regular_cells = mesh.topology().ghost_offset(tdim)
+        assert MPI.sum(mesh.mpi_comm(), float(num_regular_cells)) == 720
+        rank = MPI.rank(mesh.mpi_comm())
+        assert all(p != rank for p in mesh.topology().cell_owner())
+        num_ghost_cells.append(MPI.sum(mesh.mpi_comm(),
+                               float(mesh.num_cells() - num_regular_cells)))
+
+    # Each layer adds ghost cells
+    if MPI.size(mesh.mpi_comm()) > 1:
+        assert num_ghost_cells[0] < num_ghost_cells[1] <= num_ghost_cells[2]
+    else:
+        assert num_ghost_cells == [0, 0, 0]
+
+
+@pytest.mark.skipif(MPI.size(mpi_comm_world()) < 3 or not has_scotch(),
+                    reason="Needs SCOTCH and a process without cells")
+@pytest.mark.parametrize("ghost_mode", ["shared_vertex", "shared_facet"])
+def test_GhostCellsWithoutBoundaryCells(ghost_mode):
+    """Create a ghosted mesh where one process has no cells on a
+    partition boundary."""
+    old_ghost_mode = parameters["ghost_mode"]
+    old_partitioner = parameters["mesh_partitioner"]
+    num_cells = MPI.size(mpi_comm_world()) - 1
+    try:
+        parameters["ghost_mode"] = ghost_mode
+        parameters["mesh_partitioner"] = "SCOTCH"
+        mesh = UnitIntervalMesh(num_cells)
+    finally:
+        parameters["mesh_partitioner"] = old_partitioner
+        parameters["ghost_mode"] = old_ghost_mode
+    assert mesh.size_global(1) == num_cells
+    num_regular_cells = mesh.topology().ghost_offset(1)
+    assert MPI.sum(mesh.mpi_comm(), float(num_regular_cells)) == num_cells
+    rank = MPI.rank(mesh.mpi_comm())
+    assert all(p != rank for p in mesh.topology().cell_owner())
+
+
 def test_RefineUnitSquareMesh():
     """Refine mesh of unit square."""
     mesh = UnitSquareMesh(5, 7)
@@ -195,6 +299,97 @@ def test_RefineUnitCubeMesh():
     assert mesh.size_global(3) == 15120
 
 
+@pytest.mark.parametrize("marked", [False, True])
+def test_RefineUnitCubeMeshThreaded(marked):
+    """Refine mesh of unit cube using threads."""
+    mesh = UnitCubeMesh(5, 7, 9)
+    markers = CellFunction("bool", mesh, True)
+    refined = [None, None]
+    for i, num_threads in enumerate([0, 4]):
+        parameters["num_threads"] = num_threads
+        refined[i] = refine(mesh, markers) if marked else refine(mesh)
+    parameters["num_threads"] = 0
+
+    # Result must not depend on the number of threads
+    assert refined[1].size_global(0) == refined[0].size_global(0)
+    assert refined[1].size_global(3) == refined[0].size_global(3)
+    assert (refined[1].cells() == refined[0].cells()).all()
+    assert (refined[1].coordinates() == refined[0].coordinates()).all()
+
+
+@pytest.mark.parametrize("mesh", [UnitSquareMesh(16, 16),
+                                  UnitCubeMesh(6, 6, 6)])
+def test_CoarsenMesh(mesh):
+    """Coarsen mesh by edge collapse."""
+    tdim = mesh.topology().dim()
+    for i in range(2):
+        markers = CellFunction("bool", mesh, True)
+        coarse = coarsen(mesh, markers)
+
+        # Fewer vertices, same domain and quality above bound
+        assert coarse.size_global(0) < mesh.size_global(0)
+        volume = MPI.sum(mesh.mpi_comm(), sum(c.volume() for c in cells(mesh)))
+        volume_coarse = MPI.sum(coarse.mpi_comm(),
+                                sum(c.volume() for c in cells(coarse)))
+        assert round(volume - volume_coarse, 12) == 0
+        qmin = MeshQuality.radius_ratio_min_max(mesh)[0]
+        assert MeshQuality.radius_ratio_min_max(coarse)[0] \
+            >= min(0.2, qmin) - 1.0e-12
+
+        # Vertices of coarsened mesh are vertices of parent mesh
+        parent_vertex = coarse.data().array("parent_vertex", 0)
+        x = mesh.coordinates()
+        assert (coarse.coordinates() == x[parent_vertex]).all()
+        assert len(coarse.data().array("parent_cell", tdim)) \
+            == coarse.num_cells()
+        mesh = coarse
+
+    # Nothing to do without markers
+    markers = CellFunction("bool", mesh, False)
+    assert coarsen(mesh, markers).size_global(0) == mesh.size_global(0)
+
+
+@pytest.mark.parametrize("degree", [1, 2])
+def test_CoarsenFunctionTransfer(degree):
+    """Transfer functions to coarsened mesh."""
+    mesh = UnitSquareMesh(16, 16)
+    markers = CellFunction("bool", mesh, True)
+    coarse = coarsen(mesh, markers)
+    assert coarse.size_global(0) < mesh.size_global(0)
+
+    # A higher quality bound removes fewer vertices
+    coarse_high_quality = coarsen(mesh, markers, 0.5)
+    qmin = MeshQuality.radius_ratio_min_max(mesh)[0]
+    assert MeshQuality.radius_ratio_min_max(coarse_high_quality)[0] \
+        >= min(0.5, qmin) - 1.0e-12
+    assert coarse_high_quality.size_global(0) >= coarse.size_global(0)
+
+    V = FunctionSpace(mesh, "Lagrange", degree)
+    V_coarse = FunctionSpace(coarse, "Lagrange", degree)
+    u_coarse = Function(V_coarse)
+
+    # Polynomials of the element degree are transferred exactly, also
+    # where they are extrapolated in parallel
+    if degree == 1:
+        f = Expression("1.0 + x[0] - 2.0*x[1]")
+    else:
+        f = Expression("x[0]*x[0] + 2.0*x[0]*x[1] - x[1]")
+    u = interpolate(f, V)
+    ParallelCoarsening.transfer(u_coarse, u)
+    diff = u_coarse.vector() - interpolate(f, V_coarse).vector()
+    assert round(diff.norm("linf"), 10) == 0
+
+    # Other functions take the values of the original function at the
+    # dofs of the coarsened mesh (in serial; in parallel they are
+    # extrapolated near removed shared vertices)
+    if MPI.size(mesh.mpi_comm()) == 1:
+        u = interpolate(Expression("sin(3.0*x[0])*cos(2.0*x[1])"), V)
+        ParallelCoarsening.transfer(u_coarse, u)
+        x = V_coarse.dofmap().tabulate_all_coordinates(coarse).reshape(-1, 2)
+        for i in range(len(x)):
+            assert round(u_coarse.vector()[i] - u(x[i]), 10) == 0
+
+
 def test_BoundaryComputation():
     """Compute boundary of mesh."""
     mesh = UnitCubeMesh(2, 2, 2)
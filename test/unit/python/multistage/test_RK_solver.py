@@ -103,3 +103,30 @@ def test_butcher_schemes_vector():
         assert scheme.order()-min(convergence_order(u_errors_1))<0.1
 
     cpp.set_log_level(LEVEL)
+
+
+@skip_in_parallel
+@pytest.mark.parametrize("Scheme", [BogackiShampine, DormandPrince, TRBDF2])
+def test_butcher_schemes_adaptive(Scheme):
+
+    mesh = UnitSquareMesh(4, 4)
+
+    V = VectorFunctionSpace(mesh, "R", 0, dim=2)
+    u = Function(V)
+    v = TestFunction(V)
+    form = inner(as_vector((-u[1], u[0])), v)*dx
+
+    tstop = 1.0
+    u_true = Expression(("cos(t)", "sin(t)"), t=tstop)
+
+    scheme = Scheme(form, u)
+    solver = RKSolver(scheme)
+    solver.parameters["time_step_controller"]["relative_tolerance"] = 1e-6
+    solver.parameters["time_step_controller"]["absolute_tolerance"] = 1e-8
+    u.interpolate(Constant((1.0, 0.0)))
+    solver.step_interval_adaptive(0., tstop, 0.1)
+
+    assert round(float(scheme.t()) - tstop, 12) == 0
+    assert abs(u_true(0.0, 0.0)[0] - u(0.0, 0.0)[0]) < 1e-4
+    assert abs(u_true(0.0, 0.0)[1] - u(0.0, 0.0)[1]) < 1e-4
+    assert solver.num_accepted_steps() > 2
@@ -159,3 +159,70 @@ def test_butcher_schemes_vector(Scheme, optimize):
         u_errors.append(errornorm(u_true, u))
 
     assert scheme.order()-min(convergence_order(u_errors))<0.1
+
+
+@pytest.mark.parametrize("Scheme", [RK4, ESDIRK3])
+def test_point_integral_solver_threaded(Scheme):
+
+    mesh = UnitSquareMesh(10, 10)
+    V = VectorFunctionSpace(mesh, "CG", 1, dim=2)
+    v = TestFunction(V)
+    u = Function(V)
+    form = (-u[1]*v[0]+u[0]*v[1])*dP
+
+    # Step with and without threads
+    solutions = []
+    for num_threads in [0, 2]:
+        parameters["num_threads"] = num_threads
+        scheme = Scheme(form, u)
+        solver = PointIntegralSolver(scheme)
+        u.interpolate(Expression(("1.0 + x[0]", "x[1]")))
+        solver.step_interval(0., 0.5, 0.05)
+        solutions.append(u.vector().copy())
+    parameters["num_threads"] = 0
+
+    assert round((solutions[0] - solutions[1]).norm("linf"), 10) == 0
+
+
+@pytest.mark.parametrize("Scheme", [HeunEuler, BogackiShampine,
+                                    DormandPrince, TRBDF2])
+@pytest.mark.parametrize("local_time_stepping", [False, True])
+def test_point_integral_solver_adaptive(Scheme, local_time_stepping):
+
+    mesh = UnitSquareMesh(10, 10)
+    V = VectorFunctionSpace(mesh, "CG", 1, dim=2)
+    v = TestFunction(V)
+    u = Function(V)
+    form = (-u[1]*v[0]+u[0]*v[1])*dP
+
+    tstop = 1.0
+    u_true = Expression(("cos(t)", "sin(t)"), t=tstop)
+
+    scheme = Scheme(form, u)
+    assert scheme.error_stage() is not None
+
+    solver = PointIntegralSolver(scheme)
+    solver.parameters["local_time_stepping"] = local_time_stepping
+    solver.parameters["time_step_controller"]["relative_tolerance"] = 1e-6
+    solver.parameters["time_step_controller"]["absolute_tolerance"] = 1e-8
+    u.interpolate(Constant((1.0, 0.0)))
+    dt = solver.step_interval_adaptive(0., 0.5, 0.1)
+    solver.step_interval_adaptive(0.5, tstop, dt)
+
+    assert round(float(scheme.t()) - tstop, 12) == 0
+    assert errornorm(u_true, u) < 1e-4
+    if local_time_stepping:
+        assert solver.num_accepted_local_steps() > 0
+    else:
+        assert solver.num_accepted_steps() > 2
+
+
+def test_point_integral_solver_adaptive_requires_error_estimate():
+
+    mesh = UnitSquareMesh(4, 4)
+    V = FunctionSpace(mesh, "CG", 1)
+    v = TestFunction(V)
+    u = Function(V)
+    solver = PointIntegralSolver(RK4((1-u)*v*dP, u))
+    with pytest.raises(RuntimeError):
+        solver.step_interval_adaptive(0., 1., 0.1)